@@ -10,6 +10,8 @@
 #ifndef __VISIODOCUMENT_H__
 #define __VISIODOCUMENT_H__
 
+#include <memory>
+
 #include <librevenge/librevenge.h>
 
 #ifdef DLL_EXPORT
@@ -29,6 +31,83 @@
 namespace libvisio
 {
 
+class VisioParseCallback
+{
+public:
+  virtual ~VisioParseCallback() {}
+
+  // return false to cancel the parsing
+  virtual bool progress(unsigned pagesDone, unsigned long bytesConsumed) = 0;
+};
+
+class VSDMasterCache;
+
+/* Keeps the masters parsed from VSDX documents, so that documents built
+ * from the same stencils do not parse the same masters again. A master is
+ * found again only if the XML of its part is the same, byte for byte.
+ *
+ * One cache may be given to the parses of many documents, also from
+ * several threads at once. It holds masters with up to maxBytes of XML;
+ * the least recently used ones are dropped first.
+ */
+class VisioMasterCache
+{
+public:
+  VSDAPI explicit VisioMasterCache(unsigned long maxBytes);
+  VSDAPI ~VisioMasterCache();
+
+  VSDAPI void clear();
+
+private:
+  VisioMasterCache(const VisioMasterCache &);
+  VisioMasterCache &operator=(const VisioMasterCache &);
+
+  friend VSDMasterCache *getMasterCacheImpl(const VisioMasterCache &cache);
+  std::unique_ptr<VSDMasterCache> m_impl;
+};
+
+/* How embedded bitmaps, metafiles and OLE objects are passed to the painter.
+ *
+ * VISIO_IMAGES_EMBED paints them with their data. VISIO_IMAGES_SKIP drops
+ * them without reading their data. VISIO_IMAGES_PLACEHOLDER paints them with
+ * their position, size and mime type, but without "office:binary-data".
+ */
+enum VisioImageHandling
+{
+  VISIO_IMAGES_EMBED,
+  VISIO_IMAGES_SKIP,
+  VISIO_IMAGES_PLACEHOLDER
+};
+
+struct VisioParseOptions
+{
+  VisioParseOptions()
+    : maxDecompressedBytes(0), maxElementsPerPage(0), maxPathPoints(0),
+      maxNestingDepth(0), maxParseTime(0), imageHandling(VISIO_IMAGES_EMBED),
+      curveTolerance(0.0), masterCache(nullptr), callback(nullptr), stats(nullptr) {}
+
+  // 0 means that there is no limit
+  unsigned long maxDecompressedBytes;
+  unsigned long maxElementsPerPage;
+  unsigned long maxPathPoints;
+  unsigned maxNestingDepth;
+  unsigned long maxParseTime; // in milliseconds
+
+  VisioImageHandling imageHandling;
+  // in inches; 0 means the default of 0.001
+  double curveTolerance;
+  VisioMasterCache *masterCache;
+
+  VisioParseCallback *callback;
+  librevenge::RVNGPropertyList *stats;
+};
+
+/* All functions are reentrant: documents may be parsed from several
+ * threads at once, as long as no input stream, painter, callback or
+ * stats list is used by two of them at the same time. A master cache
+ * may be shared. Changing the C locale while a document is parsed is
+ * not supported.
+ */
 class VisioDocument
 {
 public:
@@ -37,6 +116,24 @@ public:
 
   static VSDAPI bool parse(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter);
 
+  static VSDAPI bool parse(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, const VisioParseOptions &options);
+
+  static VSDAPI bool parsePage(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, unsigned pageIndex);
+
+  static VSDAPI bool parsePage(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, unsigned pageIndex, const VisioParseOptions &options);
+
+  static VSDAPI bool parsePages(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, const librevenge::RVNGStringVector &pageNames);
+
+  static VSDAPI bool parsePages(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, const librevenge::RVNGStringVector &pageNames, const VisioParseOptions &options);
+
+  static VSDAPI bool parseText(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter);
+
+  static VSDAPI bool parseText(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, const VisioParseOptions &options);
+
+  static VSDAPI bool probe(librevenge::RVNGInputStream *input, librevenge::RVNGPropertyList &info);
+
+  static VSDAPI bool probe(librevenge::RVNGInputStream *input, librevenge::RVNGPropertyList &info, const VisioParseOptions &options);
+
   static VSDAPI bool parseStencils(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter);
 };
 
@@ -0,0 +1,346 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "batchconvert.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <set>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#include <dirent.h>
+#include <sys/stat.h>
+
+// The memory needed to convert a file is estimated from its size
+#define BATCH_MEMORY_PER_INPUT_BYTE 16
+#define BATCH_MEMORY_PER_INPUT (1024 * 1024)
+
+namespace libvisio
+{
+
+namespace
+{
+
+struct BatchJob
+{
+  BatchJob(const std::string &input_, unsigned long size_)
+    : input(input_), output(), size(size_), converted(false), error(), milliseconds(0.0) {}
+  std::string input;
+  std::string output;
+  unsigned long size;
+  bool converted;
+  std::string error;
+  double milliseconds;
+};
+
+/* Limits the estimated memory of the inputs being converted at the same
+ * time. The decompressed streams, the parsed document and the output, which
+ * is kept until the conversion ends, are all much larger than the input, so
+ * every input is charged a multiple of its size; see estimateMemory().
+ *
+ * An input needing more than the whole budget takes all of it, so that it
+ * is converted alone rather than never.
+ */
+class MemoryBudget
+{
+public:
+  explicit MemoryBudget(unsigned long limit)
+    : m_limit(limit), m_used(0), m_mutex(), m_released() {}
+
+  unsigned long acquire(unsigned long size);
+  void release(unsigned long size);
+
+private:
+  const unsigned long m_limit;
+  unsigned long m_used;
+  std::mutex m_mutex;
+  std::condition_variable m_released;
+};
+
+unsigned long MemoryBudget::acquire(unsigned long size)
+{
+  size = std::min(size, m_limit);
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_released.wait(lock, [this, size]()
+  {
+    return m_used + size <= m_limit;
+  });
+  m_used += size;
+  return size;
+}
+
+void MemoryBudget::release(unsigned long size)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_used -= size;
+  }
+  m_released.notify_all();
+}
+
+unsigned long estimateMemory(unsigned long size)
+{
+  const unsigned long maxSize = (std::numeric_limits<unsigned long>::max() - BATCH_MEMORY_PER_INPUT) / BATCH_MEMORY_PER_INPUT_BYTE;
+  if (size > maxSize)
+    return std::numeric_limits<unsigned long>::max();
+  return size * BATCH_MEMORY_PER_INPUT_BYTE + BATCH_MEMORY_PER_INPUT;
+}
+
+bool isDirectory(const std::string &path)
+{
+  struct stat info;
+  return !stat(path.c_str(), &info) && S_ISDIR(info.st_mode);
+}
+
+bool getFileSize(const std::string &path, unsigned long &size)
+{
+  struct stat info;
+  if (stat(path.c_str(), &info) || !S_ISREG(info.st_mode))
+    return false;
+  size = (unsigned long)info.st_size;
+  return true;
+}
+
+// the regular files directly in the directory, sorted by name
+void listDirectory(const std::string &path, std::vector<std::string> &files)
+{
+  DIR *const dir = opendir(path.c_str());
+  if (!dir)
+    return;
+  std::vector<std::string> names;
+  while (const struct dirent *const entry = readdir(dir))
+  {
+    if (entry->d_name[0] != '.')
+      names.push_back(entry->d_name);
+  }
+  closedir(dir);
+  std::sort(names.begin(), names.end());
+  for (const auto &name : names)
+  {
+    const std::string file = path + "/" + name;
+    unsigned long size = 0;
+    if (getFileSize(file, size))
+      files.push_back(file);
+  }
+}
+
+bool readFileList(const char *path, std::vector<std::string> &inputs)
+{
+  FILE *const file = strcmp(path, "-") ? fopen(path, "r") : stdin;
+  if (!file)
+    return false;
+  char line[4096];
+  while (fgets(line, sizeof(line), file))
+  {
+    size_t length = strlen(line);
+    while (length && (line[length - 1] == '\n' || line[length - 1] == '\r'))
+      --length;
+    if (length)
+      inputs.push_back(std::string(line, length));
+  }
+  if (file != stdin)
+    fclose(file);
+  return true;
+}
+
+std::string getBaseName(const std::string &path)
+{
+  const size_t slash = path.find_last_of("/\\");
+  std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+  const size_t dot = name.rfind('.');
+  if (dot != std::string::npos && dot > 0)
+    name.erase(dot);
+  return name;
+}
+
+// inputs with the same base name in different directories get numbered outputs
+std::vector<BatchJob> createJobs(const BatchOptions &options, const char *extension)
+{
+  std::vector<std::string> files;
+  for (const auto &input : options.inputs)
+  {
+    if (isDirectory(input))
+      listDirectory(input, files);
+    else
+      files.push_back(input);
+  }
+
+  std::vector<BatchJob> jobs;
+  std::set<std::string> outputs;
+  for (const auto &file : files)
+  {
+    unsigned long size = 0;
+    jobs.push_back(BatchJob(file, 0));
+    if (!getFileSize(file, size))
+    {
+      jobs.back().error = "cannot read the file";
+      continue;
+    }
+    jobs.back().size = size;
+
+    const std::string baseName = getBaseName(file);
+    std::string output = baseName + "." + extension;
+    for (unsigned n = 2; outputs.count(output); ++n)
+      output = baseName + "-" + std::to_string(n) + "." + extension;
+    outputs.insert(output);
+    jobs.back().output = options.outputDirectory + "/" + output;
+  }
+  return jobs;
+}
+
+bool writeFile(const std::string &path, const std::string &data)
+{
+  FILE *const file = fopen(path.c_str(), "wb");
+  if (!file)
+    return false;
+  const bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+  return !fclose(file) && written;
+}
+
+void convertJob(BatchJob &job, const BatchConvertFunction &convert)
+{
+  const auto start = std::chrono::steady_clock::now();
+  try
+  {
+    librevenge::RVNGFileStream input(job.input.c_str());
+    std::string output;
+    if (!VisioDocument::isSupported(&input))
+      job.error = "unsupported file format (unsupported version) or file is encrypted";
+    else if (!convert(input, output, job.error))
+    {
+      if (job.error.empty())
+        job.error = "conversion failed";
+    }
+    else if (!writeFile(job.output, output))
+      job.error = "cannot write " + job.output;
+    else
+      job.converted = true;
+  }
+  catch (const std::bad_alloc &)
+  {
+    job.error = "out of memory";
+  }
+  catch (...)
+  {
+    job.error = "conversion failed";
+  }
+  job.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // anonymous namespace
+
+bool parseBatchOption(int argc, char *argv[], int &i, BatchOptions &options, bool &valid)
+{
+  if (!strcmp(argv[i], "--batch") || !strcmp(argv[i], "--files-from")
+      || !strcmp(argv[i], "--jobs") || !strcmp(argv[i], "--max-memory"))
+  {
+    if (i + 1 >= argc)
+    {
+      valid = false;
+      return true;
+    }
+    const char *const option = argv[i++];
+    const char *const value = argv[i];
+    if (!strcmp(option, "--batch"))
+      options.outputDirectory = value;
+    else if (!strcmp(option, "--files-from"))
+      valid = readFileList(value, options.inputs) && valid;
+    else if (atoi(value) > 0 && !strcmp(option, "--jobs"))
+      options.jobs = unsigned(atoi(value));
+    else if (atoi(value) > 0)
+      options.maxMemory = unsigned(atoi(value));
+    else
+      valid = false;
+    return true;
+  }
+  return false;
+}
+
+void printBatchUsage()
+{
+  printf("\t--batch DIR           convert every INPUT to a file in DIR; INPUT may be a directory\n");
+  printf("\t--files-from FILE     with --batch, also convert the files listed in FILE, or - for stdin\n");
+  printf("\t--jobs N              with --batch, convert N files at a time (default: one per CPU)\n");
+  printf("\t--max-memory MB       with --batch, the memory for the files converted at a time, estimated\n");
+  printf("\t                      as 16 times their size plus 1 MB each (default 1024)\n");
+}
+
+VisioParseOptions getBatchParseOptions()
+{
+  VisioParseOptions options;
+  options.maxDecompressedBytes = 256 * 1024 * 1024;
+  options.maxElementsPerPage = 1000000;
+  options.maxPathPoints = 100000;
+  options.maxNestingDepth = 64;
+  options.maxParseTime = 60000;
+  return options;
+}
+
+int runBatch(const BatchOptions &options, const char *extension, const BatchConvertFunction &convert)
+{
+  if (!isDirectory(options.outputDirectory))
+  {
+    fprintf(stderr, "ERROR: %s is not a directory!\n", options.outputDirectory.c_str());
+    return 1;
+  }
+
+  std::vector<BatchJob> jobs = createJobs(options, extension);
+  unsigned threadCount = options.jobs ? options.jobs : std::thread::hardware_concurrency();
+  threadCount = std::max(1u, std::min(threadCount, unsigned(jobs.size())));
+
+  const auto start = std::chrono::steady_clock::now();
+  MemoryBudget budget((unsigned long)options.maxMemory * 1024 * 1024);
+  std::atomic<size_t> nextJob(0);
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < threadCount; ++t)
+  {
+    threads.push_back(std::thread([&]()
+    {
+      for (size_t j = nextJob++; j < jobs.size(); j = nextJob++)
+      {
+        if (!jobs[j].error.empty())
+          continue;
+        const unsigned long reserved = budget.acquire(estimateMemory(jobs[j].size));
+        convertJob(jobs[j], convert);
+        budget.release(reserved);
+      }
+    }));
+  }
+  for (auto &thread : threads)
+    thread.join();
+  const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  unsigned failed = 0;
+  for (const auto &job : jobs)
+  {
+    if (job.converted)
+    {
+      printf("OK     %10.1f ms  %s -> %s\n", job.milliseconds, job.input.c_str(), job.output.c_str());
+    }
+    else
+    {
+      printf("FAILED %10.1f ms  %s: %s\n", job.milliseconds, job.input.c_str(), job.error.c_str());
+      ++failed;
+    }
+  }
+  printf("%u files, %u converted, %u failed, %.1f ms on %u threads\n",
+         unsigned(jobs.size()), unsigned(jobs.size()) - failed, failed, milliseconds, threadCount);
+
+  return failed ? 1 : 0;
+}
+
+} // namespace libvisio
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,68 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __BATCHCONVERT_H__
+#define __BATCHCONVERT_H__
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <librevenge-stream/librevenge-stream.h>
+#include <libvisio/libvisio.h>
+
+namespace libvisio
+{
+
+struct BatchOptions
+{
+  BatchOptions()
+    : outputDirectory(), inputs(), jobs(0), maxMemory(1024) {}
+  // where the outputs are written; batch mode is off while it is empty
+  std::string outputDirectory;
+  // files and directories, with the contents of --files-from expanded
+  std::vector<std::string> inputs;
+  // number of files converted at the same time, 0 for one per CPU
+  unsigned jobs;
+  // MiB of memory, estimated from the input sizes, for the files converted at the same time
+  unsigned maxMemory;
+};
+
+/* Converts the document read from input to output. On failure, error
+ * says why. It is called from several threads at once.
+ */
+typedef std::function<bool (librevenge::RVNGInputStream &input, std::string &output, std::string &error)> BatchConvertFunction;
+
+/* Handles the batch options at argv[i], moving i past their arguments.
+ *
+ * Returns false if argv[i] is not a batch option. Sets valid to false if
+ * it is one but cannot be used.
+ */
+bool parseBatchOption(int argc, char *argv[], int &i, BatchOptions &options, bool &valid);
+
+void printBatchUsage();
+
+/* The parse options for the inputs of a batch. These are not trusted, so
+ * they are parsed within limits, to keep a crafted input from taking the
+ * memory or the time of the whole batch.
+ */
+VisioParseOptions getBatchParseOptions();
+
+/* Converts all inputs on a pool of threads, writing every output to
+ * a file named after its input, with the given extension, and prints
+ * a line with the time taken or the error for every input.
+ *
+ * Returns the exit status of the program: 0 if all inputs have been
+ * converted, 1 otherwise.
+ */
+int runBatch(const BatchOptions &options, const char *extension, const BatchConvertFunction &convert);
+
+} // namespace libvisio
+
+#endif // __BATCHCONVERT_H__
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
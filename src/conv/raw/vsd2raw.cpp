@@ -37,6 +37,7 @@ int printUsage()
   printf("Options:\n");
   printf("\t--callgraph           display the call graph nesting level\n");
   printf("\t--help                show this help message\n");
+  printf("\t--stats               print parsing statistics to the standard error\n");
   printf("\t--version             show version information\n");
   printf("\n");
   printf("Report bugs to <https://bugs.documentfoundation.org/>.\n");
@@ -49,11 +50,25 @@ int printVersion()
   return 0;
 }
 
+void printStats(const librevenge::RVNGPropertyList &stats)
+{
+  librevenge::RVNGPropertyList::Iter i(stats);
+  for (i.rewind(); i.next();)
+  {
+    if (!i.child())
+      fprintf(stderr, "%s: %s\n", i.key(), i()->getStr().cstr());
+  }
+  const librevenge::RVNGPropertyListVector *chunks = stats.child("libvisio:chunks");
+  for (unsigned long j = 0; chunks && j < chunks->count(); ++j)
+    fprintf(stderr, "libvisio:chunks: 0x%x: %s\n", (*chunks)[j]["libvisio:chunk-type"]->getInt(), (*chunks)[j]["libvisio:count"]->getStr().cstr());
+}
+
 } // anonymous namespace
 
 int main(int argc, char *argv[])
 {
   bool printIndentLevel = false;
+  bool printParseStats = false;
   char *file = nullptr;
 
   if (argc < 2)
@@ -63,6 +78,8 @@ int main(int argc, char *argv[])
   {
     if (!strcmp(argv[i], "--callgraph"))
       printIndentLevel = true;
+    else if (!strcmp(argv[i], "--stats"))
+      printParseStats = true;
     else if (!strcmp(argv[i], "--version"))
       return printVersion();
     else if (!file && strncmp(argv[i], "--", 2))
@@ -83,7 +100,14 @@ int main(int argc, char *argv[])
   }
 
   librevenge::RVNGRawDrawingGenerator painter(printIndentLevel);
-  if (!libvisio::VisioDocument::parse(&input, &painter))
+  librevenge::RVNGPropertyList stats;
+  libvisio::VisioParseOptions options;
+  if (printParseStats)
+    options.stats = &stats;
+  const bool parsed = libvisio::VisioDocument::parse(&input, &painter, options);
+  if (printParseStats)
+    printStats(stats);
+  if (!parsed)
   {
     fprintf(stderr, "ERROR: Parsing of document failed!\n");
     return 1;
@@ -20,6 +20,8 @@
 #include <librevenge/librevenge.h>
 #include <libvisio/libvisio.h>
 
+#include "batchconvert.h"
+
 #ifndef VERSION
 #define VERSION "UNKNOWN VERSION"
 #endif
@@ -32,9 +34,12 @@ int printUsage()
   printf("`vsd2xhtml' converts Microsoft Visio documents to SVG.\n");
   printf("\n");
   printf("Usage: vsd2xhtml [OPTION] INPUT\n");
+  printf("   or: vsd2xhtml --batch DIR [OPTION] INPUT...\n");
   printf("\n");
   printf("Options:\n");
+  libvisio::printBatchUsage();
   printf("\t--help                show this help message\n");
+  printf("\t--stats               print parsing statistics to the standard error\n");
   printf("\t--version             show version information\n");
   printf("\n");
   printf("Report bugs to <https://bugs.documentfoundation.org/>.\n");
@@ -47,6 +52,66 @@ int printVersion()
   return 0;
 }
 
+void printStats(const librevenge::RVNGPropertyList &stats)
+{
+  librevenge::RVNGPropertyList::Iter i(stats);
+  for (i.rewind(); i.next();)
+  {
+    if (!i.child())
+      fprintf(stderr, "%s: %s\n", i.key(), i()->getStr().cstr());
+  }
+  const librevenge::RVNGPropertyListVector *chunks = stats.child("libvisio:chunks");
+  for (unsigned long j = 0; chunks && j < chunks->count(); ++j)
+    fprintf(stderr, "libvisio:chunks: 0x%x: %s\n", (*chunks)[j]["libvisio:chunk-type"]->getInt(), (*chunks)[j]["libvisio:count"]->getStr().cstr());
+}
+
+void writeXHTML(std::ostream &output, const librevenge::RVNGStringVector &pages)
+{
+  output << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << std::endl;
+  output << "<!DOCTYPE html PUBLIC \"-//W3C//DTD XHTML 1.0 Strict//EN\" \"http://www.w3.org/TR/xhtml1/DTD/xhtml1-strict.dtd\">" << std::endl;
+  output << "<html xmlns=\"http://www.w3.org/1999/xhtml\" xmlns:svg=\"http://www.w3.org/2000/svg\" xmlns:xlink=\"http://www.w3.org/1999/xlink\">" << std::endl;
+  output << "<body>" << std::endl;
+  output << "<?import namespace=\"svg\" urn=\"http://www.w3.org/2000/svg\"?>" << std::endl;
+
+  for (unsigned k = 0; k<pages.size(); ++k)
+  {
+    if (k>0)
+      output << "<hr/>\n";
+
+    output << "<!-- \n";
+    output << "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\"?>\n";
+    output << "<!DOCTYPE svg PUBLIC \"-//W3C//DTD SVG 1.1//EN\"";
+    output << " \"http://www.w3.org/Graphics/SVG/1.1/DTD/svg11.dtd\">\n";
+    output << " -->\n";
+
+    output << pages[k].cstr() << std::endl;
+  }
+
+  output << "</body>" << std::endl;
+  output << "</html>" << std::endl;
+}
+
+bool convertToXHTML(librevenge::RVNGInputStream &input, std::string &output, std::string &error)
+{
+  librevenge::RVNGStringVector pages;
+  librevenge::RVNGSVGDrawingGenerator generator(pages, "svg");
+  if (!libvisio::VisioDocument::parse(&input, &generator, libvisio::getBatchParseOptions()))
+  {
+    error = "SVG generation failed";
+    return false;
+  }
+  if (pages.empty())
+  {
+    error = "no SVG document generated";
+    return false;
+  }
+
+  std::ostringstream stream;
+  writeXHTML(stream, pages);
+  output = stream.str();
+  return true;
+}
+
 } // anonymous namespace
 
 int main(int argc, char *argv[])
@@ -54,22 +119,38 @@ int main(int argc, char *argv[])
   if (argc < 2)
     return printUsage();
 
-  char *file = nullptr;
+  libvisio::BatchOptions batch;
+  bool printParseStats = false;
 
   for (int i = 1; i < argc; i++)
   {
-    if (!strcmp(argv[i], "--version"))
+    bool valid = true;
+    if (libvisio::parseBatchOption(argc, argv, i, batch, valid))
+    {
+      if (!valid)
+        return printUsage();
+    }
+    else if (!strcmp(argv[i], "--version"))
       return printVersion();
-    else if (!file && strncmp(argv[i], "--", 2))
-      file = argv[i];
+    else if (!strcmp(argv[i], "--stats"))
+      printParseStats = true;
+    else if (strncmp(argv[i], "--", 2))
+      batch.inputs.push_back(argv[i]);
     else
       return printUsage();
   }
 
-  if (!file)
+  if (!batch.outputDirectory.empty())
+  {
+    if (printParseStats || batch.inputs.empty())
+      return printUsage();
+    return libvisio::runBatch(batch, "xhtml", convertToXHTML);
+  }
+
+  if (batch.inputs.size() != 1)
     return printUsage();
 
-  librevenge::RVNGFileStream input(file);
+  librevenge::RVNGFileStream input(batch.inputs[0].c_str());
 
   if (!libvisio::VisioDocument::isSupported(&input))
   {
@@ -79,7 +160,14 @@ int main(int argc, char *argv[])
 
   librevenge::RVNGStringVector output;
   librevenge::RVNGSVGDrawingGenerator generator(output, "svg");
-  if (!libvisio::VisioDocument::parse(&input, &generator))
+  librevenge::RVNGPropertyList stats;
+  libvisio::VisioParseOptions options;
+  if (printParseStats)
+    options.stats = &stats;
+  const bool parsed = libvisio::VisioDocument::parse(&input, &generator, options);
+  if (printParseStats)
+    printStats(stats);
+  if (!parsed)
   {
     std::cerr << "ERROR: SVG Generation failed!" << std::endl;
     return 1;
@@ -90,28 +178,7 @@ int main(int argc, char *argv[])
     return 1;
   }
 
-  std::cout << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" << std::endl;
-  std::cout << "<!DOCTYPE html PUBLIC \"-//W3C//DTD XHTML 1.0 Strict//EN\" \"http://www.w3.org/TR/xhtml1/DTD/xhtml1-strict.dtd\">" << std::endl;
-  std::cout << "<html xmlns=\"http://www.w3.org/1999/xhtml\" xmlns:svg=\"http://www.w3.org/2000/svg\" xmlns:xlink=\"http://www.w3.org/1999/xlink\">" << std::endl;
-  std::cout << "<body>" << std::endl;
-  std::cout << "<?import namespace=\"svg\" urn=\"http://www.w3.org/2000/svg\"?>" << std::endl;
-
-  for (unsigned k = 0; k<output.size(); ++k)
-  {
-    if (k>0)
-      std::cout << "<hr/>\n";
-
-    std::cout << "<!-- \n";
-    std::cout << "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\"?>\n";
-    std::cout << "<!DOCTYPE svg PUBLIC \"-//W3C//DTD SVG 1.1//EN\"";
-    std::cout << " \"http://www.w3.org/Graphics/SVG/1.1/DTD/svg11.dtd\">\n";
-    std::cout << " -->\n";
-
-    std::cout << output[k].cstr() << std::endl;
-  }
-
-  std::cout << "</body>" << std::endl;
-  std::cout << "</html>" << std::endl;
+  writeXHTML(std::cout, output);
 
   return 0;
 }
@@ -14,11 +14,15 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <functional>
+
 #include <librevenge-stream/librevenge-stream.h>
 #include <librevenge-generators/librevenge-generators.h>
 #include <librevenge/librevenge.h>
 #include <libvisio/libvisio.h>
 
+#include "batchconvert.h"
+
 #ifndef VERSION
 #define VERSION "UNKNOWN VERSION"
 #endif
@@ -31,8 +35,11 @@ int printUsage()
   printf("`vsd2text' converts Microsoft Visio documents to plain text.\n");
   printf("\n");
   printf("Usage: vsd2text [OPTION] INPUT\n");
+  printf("   or: vsd2text --batch DIR [OPTION] INPUT...\n");
   printf("\n");
   printf("Options:\n");
+  libvisio::printBatchUsage();
+  printf("\t--fast                read only the text, which is faster; the texts are not in z-order\n");
   printf("\t--help                show this help message\n");
   printf("\t--version             show version information\n");
   printf("\n");
@@ -46,6 +53,29 @@ int printVersion()
   return 0;
 }
 
+bool parse(librevenge::RVNGInputStream &input, librevenge::RVNGDrawingInterface &painter, bool fast,
+           const libvisio::VisioParseOptions &options = libvisio::VisioParseOptions())
+{
+  if (fast)
+    return libvisio::VisioDocument::parseText(&input, &painter, options);
+  return libvisio::VisioDocument::parse(&input, &painter, options);
+}
+
+bool convertToText(bool fast, librevenge::RVNGInputStream &input, std::string &output, std::string &error)
+{
+  librevenge::RVNGStringVector pages;
+  librevenge::RVNGTextDrawingGenerator painter(pages);
+  if (!parse(input, painter, fast, libvisio::getBatchParseOptions()))
+  {
+    error = "parsing of document failed";
+    return false;
+  }
+
+  for (unsigned i = 0; i != pages.size(); ++i)
+    output += pages[i].cstr();
+  return true;
+}
+
 } // anonymous namespace
 
 int main(int argc, char *argv[])
@@ -53,22 +83,39 @@ int main(int argc, char *argv[])
   if (argc < 2)
     return printUsage();
 
-  char *file = nullptr;
+  libvisio::BatchOptions batch;
+  bool fast = false;
 
   for (int i = 1; i < argc; i++)
   {
-    if (!strcmp(argv[i], "--version"))
+    bool valid = true;
+    if (libvisio::parseBatchOption(argc, argv, i, batch, valid))
+    {
+      if (!valid)
+        return printUsage();
+    }
+    else if (!strcmp(argv[i], "--fast"))
+      fast = true;
+    else if (!strcmp(argv[i], "--version"))
       return printVersion();
-    else if (!file && strncmp(argv[i], "--", 2))
-      file = argv[i];
+    else if (strncmp(argv[i], "--", 2))
+      batch.inputs.push_back(argv[i]);
     else
       return printUsage();
   }
 
-  if (!file)
+  if (!batch.outputDirectory.empty())
+  {
+    if (batch.inputs.empty())
+      return printUsage();
+    using namespace std::placeholders;
+    return libvisio::runBatch(batch, "txt", std::bind(convertToText, fast, _1, _2, _3));
+  }
+
+  if (batch.inputs.size() != 1)
     return printUsage();
 
-  librevenge::RVNGFileStream input(file);
+  librevenge::RVNGFileStream input(batch.inputs[0].c_str());
 
   if (!libvisio::VisioDocument::isSupported(&input))
   {
@@ -78,7 +125,7 @@ int main(int argc, char *argv[])
 
   librevenge::RVNGStringVector pages;
   librevenge::RVNGTextDrawingGenerator painter(pages);
-  if (!libvisio::VisioDocument::parse(&input, &painter))
+  if (!parse(input, painter, fast))
   {
     fprintf(stderr, "ERROR: Parsing of document failed!\n");
     return 1;
@@ -20,7 +20,13 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
 {
   librevenge::RVNGStringStream input(data, size);
   librevenge::RVNGDummyDrawingGenerator generator;
-  libvisio::VisioDocument::parse(&input, &generator);
+  // keep the fuzzer from reporting mere resource exhaustion
+  libvisio::VisioParseOptions options;
+  options.maxDecompressedBytes = 64 * 1024 * 1024;
+  options.maxElementsPerPage = 100000;
+  options.maxPathPoints = 100000;
+  options.maxNestingDepth = 64;
+  libvisio::VisioDocument::parse(&input, &generator, options);
   return 0;
 }
 
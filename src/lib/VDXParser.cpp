@@ -9,7 +9,10 @@
 
 #include "VDXParser.h"
 
+#include <algorithm>
+#include <cctype>
 #include <memory>
+#include <string>
 #include <string.h>
 #include <libxml/xmlIO.h>
 #include <libxml/xmlstring.h>
@@ -17,7 +20,9 @@
 #include "libvisio_utils.h"
 #include "libvisio_xml.h"
 #include "VSDContentCollector.h"
+#include "VSDInfoCollector.h"
 #include "VSDStylesCollector.h"
+#include "VSDTextCollector.h"
 #include "VSDXMLHelper.h"
 #include "VSDXMLTokenMap.h"
 
@@ -38,6 +43,24 @@ bool libvisio::VDXParser::parseMain()
 
   try
   {
+    if (m_infoCollector)
+    {
+      m_collector = m_infoCollector;
+      m_input->seek(0, librevenge::RVNG_SEEK_SET);
+      return processXmlDocument(m_input);
+    }
+
+    if (m_extractText)
+    {
+      // The masters precede the pages, so one pass is enough
+      VSDTextCollector textCollector(m_painter, m_stencils);
+      textCollector.setParseLimits(m_limits);
+      textCollector.setParseProgress(&m_progress);
+      m_collector = &textCollector;
+      m_input->seek(0, librevenge::RVNG_SEEK_SET);
+      return processXmlDocument(m_input);
+    }
+
     std::vector<std::map<unsigned, XForm> > groupXFormsSequence;
     std::vector<std::map<unsigned, unsigned> > groupMembershipsSequence;
     std::vector<std::list<unsigned> > documentPageShapeOrders;
@@ -45,16 +68,30 @@ bool libvisio::VDXParser::parseMain()
     VSDStylesCollector stylesCollector(groupXFormsSequence, groupMembershipsSequence, documentPageShapeOrders);
     m_collector = &stylesCollector;
     m_input->seek(0, librevenge::RVNG_SEEK_SET);
+    VSDParseStats::TimePoint passStart = VSDParseStats::now();
     if (!processXmlDocument(m_input))
       return false;
+    if (m_stats)
+      m_stats->collectStylesPass(passStart);
+
+    if (!m_pageSelection.hasSelectedPages())
+      return false;
+    m_pageSelection.endFirstPass(groupXFormsSequence, groupMembershipsSequence, documentPageShapeOrders);
 
     VSDStyles styles = stylesCollector.getStyleSheets();
 
     VSDContentCollector contentCollector(m_painter, groupXFormsSequence, groupMembershipsSequence, documentPageShapeOrders, styles, m_stencils);
+    contentCollector.hideBackgroundPages(m_pageSelection.getHiddenPages());
+    contentCollector.setParseLimits(m_limits);
+    contentCollector.setParseProgress(&m_progress);
+    contentCollector.setParseStats(m_stats.get());
     m_collector = &contentCollector;
     m_input->seek(0, librevenge::RVNG_SEEK_SET);
+    passStart = VSDParseStats::now();
     if (!processXmlDocument(m_input))
       return false;
+    if (m_stats)
+      m_stats->collectContentPass(passStart);
 
     return true;
   }
@@ -70,6 +107,23 @@ bool libvisio::VDXParser::extractStencils()
   return parseMain();
 }
 
+bool libvisio::VDXParser::extractText()
+{
+  m_extractText = true;
+  return parseMain();
+}
+
+bool libvisio::VDXParser::probe(librevenge::RVNGPropertyList &info)
+{
+  VSDInfoCollector infoCollector;
+  m_infoCollector = &infoCollector;
+  const bool retVal = parseMain();
+  m_infoCollector = nullptr;
+  if (retVal)
+    infoCollector.getInfo(info);
+  return retVal;
+}
+
 bool libvisio::VDXParser::processXmlDocument(librevenge::RVNGInputStream *input)
 {
   if (!input)
@@ -85,6 +139,9 @@ bool libvisio::VDXParser::processXmlDocument(librevenge::RVNGInputStream *input)
 
     ret = xmlTextReaderRead(reader.get());
   }
+  const long bytesConsumed = xmlTextReaderByteConsumed(reader.get());
+  if (bytesConsumed > 0)
+    m_progress.collectBytes((unsigned long)bytesConsumed);
 
   return true;
 }
@@ -152,7 +209,7 @@ void libvisio::VDXParser::processXmlNode(xmlTextReaderPtr reader)
     else if (XML_READER_TYPE_END_ELEMENT == tokenType)
     {
       if (m_isStencilStarted && m_currentStencil)
-        m_currentStencil->addStencilShape(m_shape.m_shapeId, m_shape);
+        _addStencilShape();
       else
         _flushShape();
       m_shape.clear();
@@ -161,7 +218,12 @@ void libvisio::VDXParser::processXmlNode(xmlTextReaderPtr reader)
     }
     break;
   case XML_SHAPES:
-    if (XML_READER_TYPE_ELEMENT == tokenType)
+    if (XML_READER_TYPE_ELEMENT == tokenType && m_infoCollector)
+      skipShapes(reader);
+    // groups nested too deep are skipped with all their shapes
+    else if (XML_READER_TYPE_ELEMENT == tokenType && m_isShapeStarted && m_limits.isTooDeep(m_shapeStack.size() + 1))
+      skipElement(reader);
+    else if (XML_READER_TYPE_ELEMENT == tokenType)
     {
       if (m_isShapeStarted)
       {
@@ -211,7 +273,9 @@ void libvisio::VDXParser::processXmlNode(xmlTextReaderPtr reader)
       readStyleSheet(reader);
     break;
   case XML_STYLESHEETS:
-    if (XML_READER_TYPE_ELEMENT == tokenType)
+    if (XML_READER_TYPE_ELEMENT == tokenType && (m_extractText || m_infoCollector))
+      skipElement(reader);
+    else if (XML_READER_TYPE_ELEMENT == tokenType)
       m_isInStyles = true;
     else if (XML_READER_TYPE_END_ELEMENT == tokenType)
     {
@@ -224,7 +288,9 @@ void libvisio::VDXParser::processXmlNode(xmlTextReaderPtr reader)
       readForeignInfo(reader);
     break;
   case XML_FOREIGNDATA:
-    if (XML_READER_TYPE_ELEMENT == tokenType)
+    if (XML_READER_TYPE_ELEMENT == tokenType && m_extractText)
+      skipElement(reader);
+    else if (XML_READER_TYPE_ELEMENT == tokenType)
       readForeignData(reader);
     break;
   case XML_XFORM:
@@ -236,7 +302,9 @@ void libvisio::VDXParser::processXmlNode(xmlTextReaderPtr reader)
       readMisc(reader);
     break;
   case XML_GEOM:
-    if (XML_READER_TYPE_ELEMENT == tokenType)
+    if (XML_READER_TYPE_ELEMENT == tokenType && m_extractText)
+      skipElement(reader);
+    else if (XML_READER_TYPE_ELEMENT == tokenType)
       readGeometry(reader);
     break;
   case XML_LAYER:
@@ -308,6 +376,24 @@ void libvisio::VDXParser::processXmlNode(xmlTextReaderPtr reader)
 #endif
 }
 
+void libvisio::VDXParser::skipShapes(xmlTextReaderPtr reader)
+{
+  if (xmlTextReaderIsEmptyElement(reader))
+    return;
+  // The shapes are skipped without being read, only their images are counted
+  const int depth = xmlTextReaderDepth(reader);
+  int ret = 1;
+  int tokenType = -1;
+  do
+  {
+    ret = xmlTextReaderRead(reader);
+    tokenType = xmlTextReaderNodeType(reader);
+    if (XML_READER_TYPE_ELEMENT == tokenType && XML_FOREIGNDATA == getElementToken(reader))
+      m_infoCollector->collectImage();
+  }
+  while ((XML_READER_TYPE_END_ELEMENT != tokenType || depth != xmlTextReaderDepth(reader)) && 1 == ret && (!m_watcher || !m_watcher->isError()));
+}
+
 // Functions reading the DiagramML document content
 
 void libvisio::VDXParser::readLine(xmlTextReaderPtr reader)
@@ -922,6 +1008,8 @@ xmlChar *libvisio::VDXParser::readStringData(xmlTextReaderPtr reader)
 
 int libvisio::VDXParser::getElementToken(xmlTextReaderPtr reader)
 {
+  if (m_stats)
+    m_stats->collectXmlNode();
   return VSDXMLTokenMap::getTokenId(xmlTextReaderConstName(reader));
 }
 
@@ -940,8 +1028,25 @@ void libvisio::VDXParser::getBinaryData(xmlTextReaderPtr reader)
     {
       if (!m_shape.m_foreign)
         m_shape.m_foreign = make_unique<ForeignData>();
-      m_shape.m_foreign->data.clear();
-      m_shape.m_foreign->data.appendBase64Data(librevenge::RVNGString((const char *)data));
+      m_shape.m_foreign->data = librevenge::RVNGBinaryData();
+      const unsigned long length = m_limits.getImageReadLength((unsigned long)-1);
+      if (m_limits.isImageEmbedded())
+        m_shape.m_foreign->data.appendBase64Data(librevenge::RVNGString((const char *)data));
+      else if (length)
+      {
+        // Only decode the characters that encode the first length bytes
+        const std::string::size_type maxChars = (length + 2) / 3 * 4;
+        std::string prefix;
+        for (const xmlChar *c = data; *c && prefix.size() < maxChars; ++c)
+        {
+          if (!isspace(*c))
+            prefix.push_back((char)*c);
+        }
+        librevenge::RVNGBinaryData decoded;
+        decoded.appendBase64Data(librevenge::RVNGString(prefix.c_str()));
+        if (!decoded.empty())
+          m_shape.m_foreign->data.append(decoded.getDataBuffer(), std::min(decoded.size(), length));
+      }
     }
   }
 }
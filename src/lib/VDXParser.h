@@ -31,6 +31,8 @@ public:
   ~VDXParser() override;
   bool parseMain() override;
   bool extractStencils() override;
+  bool extractText() override;
+  bool probe(librevenge::RVNGPropertyList &info) override;
 
 private:
   VDXParser();
@@ -48,6 +50,7 @@ private:
 
   bool processXmlDocument(librevenge::RVNGInputStream *input);
   void processXmlNode(xmlTextReaderPtr reader);
+  void skipShapes(xmlTextReaderPtr reader);
 
   // Functions reading the DiagramML document content
 
@@ -425,6 +425,7 @@ void libvisio::VSD5Parser::readShape(librevenge::RVNGInputStream *input)
 void libvisio::VSD5Parser::readPage(librevenge::RVNGInputStream *input)
 {
   unsigned backgroundPageID = getUInt(input);
+  m_pageSelection.collectBackgroundPage(backgroundPageID);
   m_collector->collectPage(m_header.id, m_header.level, backgroundPageID, m_isBackgroundPage, m_currentPageName);
 }
 
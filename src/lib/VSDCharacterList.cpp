@@ -30,14 +30,6 @@ public:
 class VSDCharIX : public VSDCharacterListElement
 {
 public:
-  VSDCharIX(unsigned id, unsigned level, unsigned charCount, const boost::optional<VSDName> &font,
-            const boost::optional<Colour> &fontColour, const boost::optional<double> &fontSize, const boost::optional<bool> &bold,
-            const boost::optional<bool> &italic, const boost::optional<bool> &underline, const boost::optional<bool> &doubleunderline,
-            const boost::optional<bool> &strikeout, const boost::optional<bool> &doublestrikeout, const boost::optional<bool> &allcaps,
-            const boost::optional<bool> &initcaps, const boost::optional<bool> &smallcaps, const boost::optional<bool> &superscript,
-            const boost::optional<bool> &subscript, const boost::optional<double> &scaleWidth) : VSDCharacterListElement(id, level),
-    m_style(charCount, font, fontColour, fontSize, bold, italic, underline, doubleunderline, strikeout,
-            doublestrikeout, allcaps, initcaps,  smallcaps,  superscript,  subscript, scaleWidth) {}
   VSDCharIX(unsigned id, unsigned level, const VSDOptionalCharStyle &style) : VSDCharacterListElement(id, level), m_style(style) {}
   ~VSDCharIX() override {}
   void handle(VSDCollector *collector) const override;
@@ -58,18 +50,15 @@ public:
 
 void libvisio::VSDCharIX::handle(VSDCollector *collector) const
 {
-  collector->collectCharIX(m_id, m_level, m_style.charCount, m_style.font, m_style.colour, m_style.size,
-                           m_style.bold, m_style.italic, m_style.underline, m_style.doubleunderline, m_style.strikeout,
-                           m_style.doublestrikeout, m_style.allcaps, m_style.initcaps, m_style.smallcaps,
-                           m_style.superscript, m_style.subscript, m_style.scaleWidth);
+  collector->collectCharIX(m_id, m_level, m_style.charCount, m_style.font(), m_style.colour(), m_style.size(),
+                           m_style.bold(), m_style.italic(), m_style.underline(), m_style.doubleunderline(), m_style.strikeout(),
+                           m_style.doublestrikeout(), m_style.allcaps(), m_style.initcaps(), m_style.smallcaps(),
+                           m_style.superscript(), m_style.subscript(), m_style.scaleWidth());
 }
 
 libvisio::VSDCharacterListElement *libvisio::VSDCharIX::clone()
 {
-  return new VSDCharIX(m_id, m_level, m_style.charCount, m_style.font, m_style.colour, m_style.size,
-                       m_style.bold, m_style.italic, m_style.underline, m_style.doubleunderline, m_style.strikeout,
-                       m_style.doublestrikeout, m_style.allcaps, m_style.initcaps, m_style.smallcaps,
-                       m_style.superscript, m_style.subscript, m_style.scaleWidth);
+  return new VSDCharIX(m_id, m_level, m_style);
 }
 
 
@@ -80,20 +69,16 @@ libvisio::VSDCharacterList::VSDCharacterList() :
 }
 
 libvisio::VSDCharacterList::VSDCharacterList(const libvisio::VSDCharacterList &charList) :
-  m_elements(),
+  m_elements(charList.m_elements),
   m_elementsOrder(charList.m_elementsOrder)
 {
-  for (auto iter = charList.m_elements.begin(); iter != charList.m_elements.end(); ++iter)
-    m_elements[iter->first] = clone(iter->second);
 }
 
 libvisio::VSDCharacterList &libvisio::VSDCharacterList::operator=(const libvisio::VSDCharacterList &charList)
 {
   if (this != &charList)
   {
-    clear();
-    for (auto iter = charList.m_elements.begin(); iter != charList.m_elements.end(); ++iter)
-      m_elements[iter->first] = clone(iter->second);
+    m_elements = charList.m_elements;
     m_elementsOrder = charList.m_elementsOrder;
   }
   return *this;
@@ -111,22 +96,17 @@ void libvisio::VSDCharacterList::addCharIX(unsigned id, unsigned level, unsigned
                                            const boost::optional<bool> &allcaps, const boost::optional<bool> &initcaps, const boost::optional<bool> &smallcaps,
                                            const boost::optional<bool> &superscript, const boost::optional<bool> &subscript, const boost::optional<double> &scaleWidth)
 {
-  auto *tmpElement = dynamic_cast<VSDCharIX *>(m_elements[id].get());
-  if (!tmpElement)
-  {
-    m_elements[id] = make_unique<VSDCharIX>(id, level, charCount, font, fontColour, fontSize, bold, italic, underline, doubleunderline,
-                                            strikeout, doublestrikeout, allcaps, initcaps, smallcaps, superscript, subscript, scaleWidth);
-  }
-  else
-    tmpElement->m_style.override(VSDOptionalCharStyle(charCount, font, fontColour, fontSize, bold, italic, underline,
-                                                      doubleunderline, strikeout, doublestrikeout, allcaps, initcaps, smallcaps, superscript, subscript, scaleWidth));
+  addCharIX(id, level, VSDOptionalCharStyle(charCount, font, fontColour, fontSize, bold, italic, underline, doubleunderline,
+                                            strikeout, doublestrikeout, allcaps, initcaps, smallcaps, superscript, subscript, scaleWidth));
 }
 
 void libvisio::VSDCharacterList::addCharIX(unsigned id, unsigned level, const VSDOptionalCharStyle &style)
 {
-  addCharIX(id, level, style.charCount, style.font, style.colour, style.size, style.bold, style.italic, style.underline,
-            style.doubleunderline, style.strikeout, style.doublestrikeout, style.allcaps, style.initcaps, style.smallcaps,
-            style.superscript, style.subscript, style.scaleWidth);
+  auto *tmpElement = dynamic_cast<VSDCharIX *>(detach(m_elements[id]));
+  if (!tmpElement)
+    m_elements[id] = make_unique<VSDCharIX>(id, level, style);
+  else
+    tmpElement->m_style.override(style);
 }
 
 unsigned libvisio::VSDCharacterList::getCharCount(unsigned id) const
@@ -141,14 +121,17 @@ unsigned libvisio::VSDCharacterList::getCharCount(unsigned id) const
 void libvisio::VSDCharacterList::setCharCount(unsigned id, unsigned charCount)
 {
   auto iter = m_elements.find(id);
-  if (iter !=  m_elements.end() && iter->second)
-    iter->second->setCharCount(charCount);
+  if (iter != m_elements.end() && iter->second)
+    detach(iter->second)->setCharCount(charCount);
 }
 
 void libvisio::VSDCharacterList::resetCharCount()
 {
   for (auto &element : m_elements)
-    element.second->setCharCount(0);
+  {
+    if (element.second && element.second->getCharCount())
+      detach(element.second)->setCharCount(0);
+  }
 }
 
 unsigned libvisio::VSDCharacterList::getLevel() const
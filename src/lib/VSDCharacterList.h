@@ -12,7 +12,7 @@
 
 #include <memory>
 #include <vector>
-#include <map>
+#include "VSDIdMap.h"
 #include "VSDTypes.h"
 #include "VSDStyles.h"
 
@@ -49,7 +49,8 @@ public:
     return (m_elements.empty());
   }
 private:
-  std::map<unsigned, std::unique_ptr<VSDCharacterListElement>> m_elements;
+  // Elements are shared between copies of the list; see detach()
+  VSDIdMap<std::shared_ptr<VSDCharacterListElement>> m_elements;
   std::vector<unsigned> m_elementsOrder;
 };
 
@@ -27,7 +27,8 @@
 #endif
 
 #if DUMP_BITMAP
-static unsigned bitmapId = 0;
+#include <atomic>
+static std::atomic<unsigned> bitmapId(0);
 #include <sstream>
 #endif
 
@@ -35,6 +36,8 @@ static unsigned bitmapId = 0;
 #define M_PI 3.14159265358979323846
 #endif
 
+#define LIBVISIO_EPSILON 1E-10
+
 namespace
 {
 
@@ -75,21 +78,33 @@ void computeRounding(double &prevX, double &prevY, double x0, double y0, double
   prevY = y0;
 }
 
-unsigned computeBMPDataOffset(librevenge::RVNGInputStream *const input, const unsigned long maxLength)
+unsigned readLE32(const unsigned char *data, unsigned long size, unsigned long offset)
 {
-  assert(input);
+  if (size < 4 || offset > size - 4)
+    return 0;
+  return (unsigned)data[offset] | ((unsigned)data[offset + 1] << 8) | ((unsigned)data[offset + 2] << 16) | ((unsigned)data[offset + 3] << 24);
+}
 
-  using namespace libvisio;
+unsigned readLE16(const unsigned char *data, unsigned long size, unsigned long offset)
+{
+  if (size < 2 || offset > size - 2)
+    return 0;
+  return (unsigned)data[offset] | ((unsigned)data[offset + 1] << 8);
+}
 
+/* Reads the bitmap info header in place; going through a stream
+ * would copy the whole bitmap.
+ */
+unsigned computeBMPDataOffset(const unsigned char *data, const unsigned long maxLength)
+{
   // determine header size
-  unsigned headerSize = readU32(input);
+  unsigned headerSize = readLE32(data, maxLength, 0);
   if (headerSize > maxLength)
     headerSize = 40; // assume v.3 bitmap header size
   unsigned off = headerSize;
 
   // determine palette size
-  input->seek(10, librevenge::RVNG_SEEK_CUR);
-  unsigned bpp = readU16(input);
+  unsigned bpp = readLE16(data, maxLength, 14);
   // sanitize bpp - limit to the allowed range and then round up to one
   // of the allowed values
   if (bpp > 32)
@@ -100,12 +115,10 @@ unsigned computeBMPDataOffset(librevenge::RVNGInputStream *const input, const un
     ++bppIdx;
   if (bpp < allowedBpp[bppIdx])
     bpp = allowedBpp[bppIdx];
-  input->seek(16, librevenge::RVNG_SEEK_CUR);
-  unsigned paletteColors = readU32(input);
+  unsigned paletteColors = readLE32(data, maxLength, 32);
   if (bpp < 16 && paletteColors == 0)
     paletteColors = 1 << bpp;
-  assert(maxLength >= off);
-  if (paletteColors > 0 && (paletteColors < (maxLength - off) / 4))
+  if (maxLength >= off && paletteColors > 0 && (paletteColors < (maxLength - off) / 4))
     off += 4 * paletteColors;
 
   off += 14; // file header size
@@ -113,6 +126,98 @@ unsigned computeBMPDataOffset(librevenge::RVNGInputStream *const input, const un
   return off;
 }
 
+/* Text styles apply to a number of characters. The last style of each kind
+ * applies to the rest of the text, and a count of zero to a single character.
+ */
+
+unsigned getCharCount(const libvisio::VSDParaStyle &style)
+{
+  return style.charCount;
+}
+
+unsigned getCharCount(const libvisio::VSDCharStyle &style)
+{
+  return style.charCount;
+}
+
+unsigned getCharCount(const libvisio::VSDTabSet &tabSet)
+{
+  return tabSet.m_numChars;
+}
+
+template<typename T>
+unsigned long getStyleRunLength(const std::vector<T> &styles, typename std::vector<T>::const_iterator it, unsigned numRemaining)
+{
+  if (it + 1 == styles.end())
+    return std::numeric_limits<unsigned long>::max();
+  return numRemaining ? numRemaining : 1;
+}
+
+template<typename T>
+bool isStyleFinished(const std::vector<T> &styles, typename std::vector<T>::const_iterator it, unsigned numRemaining, unsigned long count)
+{
+  return it + 1 != styles.end() && count >= (numRemaining ? numRemaining : 1);
+}
+
+template<typename T>
+void skipStyledCharacters(const std::vector<T> &styles, typename std::vector<T>::const_iterator &it, unsigned &numRemaining, unsigned long count)
+{
+  if (isStyleFinished(styles, it, numRemaining, count))
+  {
+    ++it;
+    numRemaining = getCharCount(*it);
+  }
+  else
+    numRemaining -= std::min<unsigned long>(numRemaining, count);
+}
+
+const char *skipUTF8Characters(const char *text, const char *end, unsigned long count)
+{
+  for (; text != end && count; --count)
+  {
+    ++text;
+    while (text != end && (static_cast<unsigned char>(*text) & 0xc0) == 0x80)
+      ++text;
+  }
+  return text;
+}
+
+// Finds the next paragraph break, tab or field placeholder (U+FFFC)
+const char *findSpecialUTF8Character(const char *text, const char *end)
+{
+  for (; text != end; ++text)
+  {
+    if (*text == '\n' || *text == '\t')
+      return text;
+    if (*text == '\xef' && end - text >= 3 && text[1] == '\xbf' && text[2] == '\xbc')
+      return text;
+  }
+  return end;
+}
+
+// RVNGString cannot append a part of a string, so the part is copied to a reused buffer first
+void appendUTF8Characters(librevenge::RVNGString &text, const char *begin, const char *end, std::string &buffer)
+{
+  buffer.assign(begin, end);
+  text.append(buffer.c_str());
+}
+
+bool isParagraphBreak(unsigned char c)
+{
+  return c == (unsigned char)'\n' || c == 0x0d || c == 0x0e;
+}
+
+// Finds the next paragraph break, tab or field placeholder (0x1e)
+const unsigned char *findSpecialCharacter(const unsigned char *text, const unsigned char *end)
+{
+  for (; text != end; ++text)
+  {
+    if (isParagraphBreak(*text) || *text == (unsigned char)'\t' || *text == 0x1e)
+      return text;
+  }
+  return end;
+}
+
 } // anonymous namespace
 
 libvisio::VSDContentCollector::VSDContentCollector(
@@ -133,16 +238,17 @@ libvisio::VSDContentCollector::VSDContentCollector(
   m_groupXFormsSequence(groupXFormsSequence), m_groupMembershipsSequence(groupMembershipsSequence),
   m_groupMemberships(m_groupMembershipsSequence.begin()),
   m_currentPageNumber(0), m_shapeOutputDrawing(nullptr), m_shapeOutputText(nullptr),
-  m_pageOutputDrawing(), m_pageOutputText(), m_documentPageShapeOrders(documentPageShapeOrders),
-  m_pageShapeOrder(m_documentPageShapeOrders.begin()), m_isFirstGeometry(true), m_NURBSData(), m_polylineData(),
-  m_currentText(), m_names(), m_stencilNames(), m_fields(), m_stencilFields(), m_fieldIndex(0),
+  m_pageOutputDrawing(), m_pageOutputText(), m_pageArena(), m_pageElementCount(0), m_documentPageShapeOrders(documentPageShapeOrders),
+  m_pageShapeOrder(m_documentPageShapeOrders.begin()), m_isFirstGeometry(true), m_NURBSData(), m_polylineData(), m_NURBSCache(), m_NURBSCachePoints(0),
+  m_spanPropertiesCache(), m_paragraphPropertiesCache(),
+  m_currentText(), m_textBuffer(), m_textPiece(), m_names(), m_stencilNames(), m_fields(), m_stencilFields(nullptr), m_fieldIndex(0),
   m_charFormats(), m_paraFormats(), m_lineStyle(), m_fillStyle(), m_textBlockStyle(),
   m_defaultCharStyle(), m_defaultParaStyle(), m_currentStyleSheet(0), m_styles(styles),
   m_stencils(stencils), m_stencilShape(nullptr), m_isStencilStarted(false), m_currentGeometryCount(0),
   m_backgroundPageID(MINUS_ONE), m_currentPageID(0), m_currentPage(), m_pages(), m_layerList(),
   m_splineControlPoints(), m_splineKnotVector(), m_splineX(0.0), m_splineY(0.0),
   m_splineLastKnot(0.0), m_splineDegree(0), m_splineLevel(0), m_currentShapeLevel(0),
-  m_isBackgroundPage(false), m_currentLayerList(), m_currentLayerMem(), m_tabSets(), m_documentTheme(nullptr)
+  m_isBackgroundPage(false), m_currentLayerList(), m_currentLayerMem(), m_tabSets(), m_documentTheme(nullptr), m_limits(), m_progress(nullptr), m_stats(nullptr)
 {
 }
 
@@ -332,6 +438,21 @@ void libvisio::VSDContentCollector::_flushShape()
     }
   }
 
+  // Once the page has got all the elements it may have, the remaining shapes are dropped
+  if (m_limits.isPageFull(m_pageElementCount))
+  {
+    m_currentFillGeometry.clear();
+    m_currentLineGeometry.clear();
+    m_currentForeignData = librevenge::RVNGBinaryData();
+    m_currentForeignProps.clear();
+    m_currentText.clear();
+    m_isShapeStarted = false;
+    return;
+  }
+  m_pageElementCount += numPathElements+numForeignElements+numTextElements;
+  if (m_stats)
+    m_stats->collectShape(numPathElements);
+
   if (numPathElements+numForeignElements+numTextElements > 1)
   {
     librevenge::RVNGPropertyList propList;
@@ -379,10 +500,6 @@ void libvisio::VSDContentCollector::_flushCurrentPath(unsigned shapeId)
   librevenge::RVNGPropertyList styleProps;
   _lineProperties(m_lineStyle, styleProps);
   _fillAndShadowProperties(m_fillStyle, styleProps);
-  librevenge::RVNGPropertyList fillPathProps(styleProps);
-  fillPathProps.insert("draw:stroke", "none");
-  librevenge::RVNGPropertyList linePathProps(styleProps);
-  linePathProps.insert("draw:fill", "none");
 
   std::vector<librevenge::RVNGPropertyList> tmpPath;
   if (m_fillStyle.pattern && !m_currentFillGeometry.empty())
@@ -438,6 +555,8 @@ void libvisio::VSDContentCollector::_flushCurrentPath(unsigned shapeId)
     {
       librevenge::RVNGPropertyListVector path;
       _convertToPath(tmpPath, path, m_scale*m_lineStyle.rounding);
+      librevenge::RVNGPropertyList fillPathProps(styleProps);
+      fillPathProps.insert("draw:stroke", "none");
       m_shapeOutputDrawing->addStyle(fillPathProps);
       librevenge::RVNGPropertyList propList;
       propList.insert("svg:d", path);
@@ -528,7 +647,9 @@ void libvisio::VSDContentCollector::_flushCurrentPath(unsigned shapeId)
     {
       librevenge::RVNGPropertyListVector path;
       _convertToPath(tmpPath, path, m_scale*m_lineStyle.rounding);
-      m_shapeOutputDrawing->addStyle(linePathProps);
+      // the line path is the last user of styleProps
+      styleProps.insert("draw:fill", "none");
+      m_shapeOutputDrawing->addStyle(styleProps);
       librevenge::RVNGPropertyList propList;
       propList.insert("svg:d", path);
       if (shapeId && shapeId != MINUS_ONE)
@@ -767,378 +888,251 @@ void libvisio::VSDContentCollector::_flushText()
   std::vector<unsigned char> sOutputVector;
   librevenge::RVNGString sOutputText;
 
+  /* The text is split into runs of characters with the same styles, and each
+   * run into pieces of plain text separated by paragraph breaks, tabs and
+   * field placeholders. */
+
   // Unfortunately, we have to handle the unicode formats differently then the 8-bit formats
   if (m_currentText.m_format == VSD_TEXT_UTF8 || m_currentText.m_format == VSD_TEXT_UTF16)
   {
-    std::vector<unsigned char> tmpBuffer(m_currentText.m_data.size());
-    memcpy(&tmpBuffer[0], m_currentText.m_data.getDataBuffer(), m_currentText.m_data.size());
-    librevenge::RVNGString textString;
-    appendCharacters(textString, tmpBuffer, m_currentText.m_format);
-    /* Iterate over the text character by character */
-    librevenge::RVNGString::Iter textIt(textString);
-    for (textIt.rewind(); textIt.next();)
+    /* UTF-8 text is scanned where it is; UTF-16 text is converted once to
+     * UTF-8 into a buffer that is kept for the next shape. Either ends at
+     * the first null character. */
+    const char *textIt = reinterpret_cast<const char *>(m_currentText.m_data.getDataBuffer());
+    unsigned long textSize = m_currentText.m_data.size();
+    if (m_currentText.m_format == VSD_TEXT_UTF16)
     {
-      /* Any character will cause a paragraph to open if it is not yet opened. */
-      if (!isParagraphOpened)
+      m_textBuffer.clear();
+      appendUTF16Characters(m_textBuffer, m_currentText.m_data.getDataBuffer(), textSize);
+      textIt = m_textBuffer.data();
+      textSize = m_textBuffer.size();
+    }
+    const char *const textEnd = std::find(textIt, textIt + textSize, '\0');
+    while (textIt != textEnd)
+    {
+      /* The styles do not change within a run of characters */
+      const unsigned long runLength = std::min(getStyleRunLength(m_paraFormats, paraIt, paraNumRemaining),
+                                               std::min(getStyleRunLength(m_charFormats, charIt, charNumRemaining),
+                                                        getStyleRunLength(m_tabSets, tabIt, tabNumRemaining)));
+      const char *const runEnd = skipUTF8Characters(textIt, textEnd, runLength);
+      while (textIt != runEnd)
       {
-        librevenge::RVNGPropertyList paraProps;
-        _fillParagraphProperties(paraProps, *paraIt);
-
-        if (m_textBlockStyle.defaultTabStop > 0.0)
-          paraProps.insert("style:tab-stop-distance", m_textBlockStyle.defaultTabStop);
+        const char *const special = findSpecialUTF8Character(textIt, runEnd);
+        const bool isBreak = special == textIt && *textIt == '\n';
 
-        _fillTabSet(paraProps, *tabIt);
-
-        VSDBullet bullet;
-        _bulletFromParaFormat(bullet, *paraIt);
-
-        /* Bullet definition changed with regard to the last paragraph style. */
-        if (bullet != currentBullet)
+        /* Any text will cause a paragraph to open if it is not yet opened. */
+        if (!isParagraphOpened)
         {
-          /* If the previous paragraph style had a bullet, close the list level. */
-          if (!!currentBullet)
-            m_shapeOutputText->addCloseUnorderedListLevel();
+          const ParagraphProperties &paragraph = _getParagraphProperties(*paraIt, *tabIt);
 
-          currentBullet = bullet;
-          /* If the current paragraph style has a bullet, open a new list level. */
-          if (!!currentBullet)
+          /* Bullet definition changed with regard to the last paragraph style. */
+          if (paragraph.bullet != currentBullet)
           {
-            librevenge::RVNGPropertyList bulletList;
-            _listLevelFromBullet(bulletList, currentBullet);
-            m_shapeOutputText->addOpenUnorderedListLevel(bulletList);
+            /* If the previous paragraph style had a bullet, close the list level. */
+            if (!!currentBullet)
+              m_shapeOutputText->addCloseUnorderedListLevel();
+
+            currentBullet = paragraph.bullet;
+            /* If the current paragraph style has a bullet, open a new list level. */
+            if (!!currentBullet)
+              m_shapeOutputText->addOpenUnorderedListLevel(paragraph.listLevelProps);
           }
-        }
 
-        if (!currentBullet)
-          m_shapeOutputText->addOpenParagraph(paraProps);
-        else
-          m_shapeOutputText->addOpenListElement(paraProps);
-        isParagraphOpened = true;
-        isParagraphWithoutSpan = true;
-      }
-
-      /* Any character will cause a span to open if it is not yet opened.
-       * The additional conditions aim to avoid superfluous empty span but
-       * also a paragraph without span at all. */
-      if (!isSpanOpened && ((*(textIt()) != '\n') || isParagraphWithoutSpan))
-      {
-        librevenge::RVNGPropertyList textProps;
-        _fillCharProperties(textProps, *charIt);
-
-        // TODO: In draw, text span background cannot be specified the same way as in writer span
-        if (m_textBlockStyle.isTextBkgndFilled)
-        {
-          textProps.insert("fo:background-color", getColourString(m_textBlockStyle.textBkgndColour));
-#if 0
-          if (m_textBlockStyle.textBkgndColour.a)
-            textProps.insert("fo:background-opacity", 1.0 - m_textBlockStyle.textBkgndColour.a/255.0, librevenge::RVNG_PERCENT);
-#endif
+          if (!currentBullet)
+            m_shapeOutputText->addOpenParagraph(paragraph.paraProps);
+          else
+            m_shapeOutputText->addOpenListElement(paragraph.paraProps);
+          isParagraphOpened = true;
+          isParagraphWithoutSpan = true;
         }
-        m_shapeOutputText->addOpenSpan(textProps);
-        isSpanOpened = true;
-        isParagraphWithoutSpan = false;
-      }
 
-      /* Current character is a paragraph break,
-       * which will cause the paragraph to close. */
-      if (*(textIt()) == '\n')
-      {
-        if (!sOutputText.empty())
-          m_shapeOutputText->addInsertText(sOutputText);
-        sOutputText.clear();
-        if (isSpanOpened)
+        /* Any text will cause a span to open if it is not yet opened.
+         * The additional conditions aim to avoid superfluous empty span but
+         * also a paragraph without span at all. */
+        if (!isSpanOpened && (!isBreak || isParagraphWithoutSpan))
         {
-          m_shapeOutputText->addCloseSpan();
-          isSpanOpened = false;
+          m_shapeOutputText->addOpenSpan(_getSpanProperties(*charIt));
+          isSpanOpened = true;
+          isParagraphWithoutSpan = false;
         }
 
-        if (isParagraphOpened)
+        /* Plain text is appended to the current text buffer at once. */
+        if (special != textIt)
         {
-          if (!currentBullet)
-            m_shapeOutputText->addCloseParagraph();
-          else
-            m_shapeOutputText->addCloseListElement();
-          isParagraphOpened = false;
+          appendUTF8Characters(sOutputText, textIt, special, m_textPiece);
+          textIt = special;
         }
-      }
-      /* Current character is a tabulator. We have to output
-       * the current text buffer and insert the tab. */
-      else if (*(textIt()) == '\t')
-      {
-        if (!sOutputText.empty())
-          m_shapeOutputText->addInsertText(sOutputText);
-        sOutputText.clear();
-        m_shapeOutputText->addInsertTab();
-      }
-      /* Current character is a field placeholder. We append
-       * to the current text buffer a text representation
-       * of the field. */
-      else if (strlen(textIt()) == 3 &&
-               textIt()[0] == '\xef' &&
-               textIt()[1] == '\xbf' &&
-               textIt()[2] == '\xbc')
-        _appendField(sOutputText);
-      /* We have a normal UTF8 character and we append it
-       * to the current text buffer. */
-      else
-        sOutputText.append(textIt());
-
-      /* Decrease the count of remaining characters in the same paragraph,
-       * if it is possible. */
-      if (paraNumRemaining)
-        paraNumRemaining--;
-      /* Fetch next paragraph style if it exists. If not, just use the
-       * last one. */
-      if (!paraNumRemaining)
-      {
-        ++paraIt;
-        if (paraIt != m_paraFormats.end())
-          paraNumRemaining = paraIt->charCount;
-        else
-          --paraIt;
-      }
-
-      /* Decrease the count of remaining characters in the same span,
-       * if it is possible. */
-      if (charNumRemaining)
-        charNumRemaining--;
-      /* Fetch next character style if it exists and close span, since
-       * the next span will have to use the new character style.
-       * If there is no more character style to fetch, just finish using
-       * the last one. */
-      if (!charNumRemaining)
-      {
-        ++charIt;
-        if (charIt != m_charFormats.end())
+        /* Current character is a paragraph break,
+         * which will cause the paragraph to close. */
+        else if (isBreak)
         {
-          charNumRemaining = charIt->charCount;
+          _insertText(sOutputText, sOutputVector, charIt->font.m_format);
           if (isSpanOpened)
           {
-            if (!sOutputText.empty())
-              m_shapeOutputText->addInsertText(sOutputText);
-            sOutputText.clear();
             m_shapeOutputText->addCloseSpan();
             isSpanOpened = false;
           }
+
+          if (isParagraphOpened)
+          {
+            if (!currentBullet)
+              m_shapeOutputText->addCloseParagraph();
+            else
+              m_shapeOutputText->addCloseListElement();
+            isParagraphOpened = false;
+          }
+          ++textIt;
         }
+        /* Current character is a tabulator. We have to output
+         * the current text buffer and insert the tab. */
+        else if (*textIt == '\t')
+        {
+          _insertText(sOutputText, sOutputVector, charIt->font.m_format);
+          m_shapeOutputText->addInsertTab();
+          ++textIt;
+        }
+        /* Current character is a field placeholder. We append
+         * to the current text buffer a text representation
+         * of the field. */
         else
-          --charIt;
+        {
+          _appendField(sOutputText);
+          textIt += 3;
+        }
       }
 
-      /* Decrease the count of remaining characters using the same
-       * tab-set definition, if it is possible. */
-      if (tabNumRemaining)
-        tabNumRemaining--;
-      /* Fetch next tab-set definition if it exists. If not, just use the
-       * last one. */
-      if (!tabNumRemaining)
+      /* Fetch the next character style and close the span, since the next
+       * span will have to use the new character style. */
+      if (isSpanOpened && isStyleFinished(m_charFormats, charIt, charNumRemaining, runLength))
       {
-        ++tabIt;
-        if (tabIt != m_tabSets.end())
-          tabNumRemaining = tabIt->m_numChars;
-        else
-          --tabIt;
+        _insertText(sOutputText, sOutputVector, charIt->font.m_format);
+        m_shapeOutputText->addCloseSpan();
+        isSpanOpened = false;
       }
+      skipStyledCharacters(m_charFormats, charIt, charNumRemaining, runLength);
+      skipStyledCharacters(m_paraFormats, paraIt, paraNumRemaining, runLength);
+      skipStyledCharacters(m_tabSets, tabIt, tabNumRemaining, runLength);
     }
   }
   else // 8-bit charsets
   {
-    /* Iterate over the text character by character */
-    const unsigned char *tmpBuffer = m_currentText.m_data.getDataBuffer();
-    unsigned long tmpBufferLength = m_currentText.m_data.size();
+    const unsigned char *textIt = m_currentText.m_data.getDataBuffer();
+    unsigned long textLength = m_currentText.m_data.size();
     // Remove the terminating \0 character from the buffer
-    while (tmpBufferLength > 1 &&!tmpBuffer[tmpBufferLength-1])
+    while (textLength > 1 && !textIt[textLength-1])
     {
-      --tmpBufferLength;
+      --textLength;
     }
-    for (unsigned long i = 0; i < tmpBufferLength; ++i)
+    const unsigned char *const textEnd = textIt + textLength;
+    while (textIt != textEnd)
     {
-      /* Any character will cause a paragraph to open if it is not yet opened. */
-      if (!isParagraphOpened)
+      /* The styles do not change within a run of characters */
+      const unsigned long runLength = std::min(getStyleRunLength(m_paraFormats, paraIt, paraNumRemaining),
+                                               std::min(getStyleRunLength(m_charFormats, charIt, charNumRemaining),
+                                                        getStyleRunLength(m_tabSets, tabIt, tabNumRemaining)));
+      const unsigned char *const runEnd = textIt + std::min<unsigned long>(runLength, textEnd - textIt);
+      while (textIt != runEnd)
       {
-        librevenge::RVNGPropertyList paraProps;
-        _fillParagraphProperties(paraProps, *paraIt);
-
-        if (m_textBlockStyle.defaultTabStop > 0.0)
-          paraProps.insert("style:tab-stop-distance", m_textBlockStyle.defaultTabStop);
-
-        _fillTabSet(paraProps, *tabIt);
-
-        VSDBullet bullet;
-        _bulletFromParaFormat(bullet, *paraIt);
+        const unsigned char *const special = findSpecialCharacter(textIt, runEnd);
+        const bool isBreak = special == textIt && isParagraphBreak(*textIt);
 
-        /* Bullet definition changed with regard to the last paragraph style. */
-        if (bullet != currentBullet)
+        /* Any text will cause a paragraph to open if it is not yet opened. */
+        if (!isParagraphOpened)
         {
-          /* If the previous paragraph style had a bullet, close the list level. */
-          if (!!currentBullet)
-            m_shapeOutputText->addCloseUnorderedListLevel();
+          const ParagraphProperties &paragraph = _getParagraphProperties(*paraIt, *tabIt);
 
-          currentBullet = bullet;
-          /* If the current paragraph style has a bullet, open a new list level. */
-          if (!!currentBullet)
+          /* Bullet definition changed with regard to the last paragraph style. */
+          if (paragraph.bullet != currentBullet)
           {
-            librevenge::RVNGPropertyList bulletList;
-            _listLevelFromBullet(bulletList, currentBullet);
-            m_shapeOutputText->addOpenUnorderedListLevel(bulletList);
+            /* If the previous paragraph style had a bullet, close the list level. */
+            if (!!currentBullet)
+              m_shapeOutputText->addCloseUnorderedListLevel();
+
+            currentBullet = paragraph.bullet;
+            /* If the current paragraph style has a bullet, open a new list level. */
+            if (!!currentBullet)
+              m_shapeOutputText->addOpenUnorderedListLevel(paragraph.listLevelProps);
           }
-        }
-
-        if (!currentBullet)
-          m_shapeOutputText->addOpenParagraph(paraProps);
-        else
-          m_shapeOutputText->addOpenListElement(paraProps);
-        isParagraphOpened = true;
-        isParagraphWithoutSpan = true;
-      }
-
-      /* Any character will cause a span to open if it is not yet opened.
-       * The additional conditions aim to avoid superfluous empty span but
-       * also a paragraph without span at all. */
-      if (!isSpanOpened && ((tmpBuffer[i] != (unsigned char)'\n' && tmpBuffer[i] != 0x0d && tmpBuffer[i] != 0x0e) || isParagraphWithoutSpan))
-      {
-        librevenge::RVNGPropertyList textProps;
-        _fillCharProperties(textProps, *charIt);
 
-        // TODO: In draw, text span background cannot be specified the same way as in writer span
-        if (m_textBlockStyle.isTextBkgndFilled)
-        {
-          textProps.insert("fo:background-color", getColourString(m_textBlockStyle.textBkgndColour));
-#if 0
-          if (m_textBlockStyle.textBkgndColour.a)
-            textProps.insert("fo:background-opacity", 1.0 - m_textBlockStyle.textBkgndColour.a/255.0, librevenge::RVNG_PERCENT);
-#endif
+          if (!currentBullet)
+            m_shapeOutputText->addOpenParagraph(paragraph.paraProps);
+          else
+            m_shapeOutputText->addOpenListElement(paragraph.paraProps);
+          isParagraphOpened = true;
+          isParagraphWithoutSpan = true;
         }
-        m_shapeOutputText->addOpenSpan(textProps);
-        isSpanOpened = true;
-        isParagraphWithoutSpan = false;
-      }
 
-      /* Current character is a paragraph break,
-       * which will cause the paragraph to close. */
-      if (tmpBuffer[i] == (unsigned char)'\n' || tmpBuffer[i] == 0x0d || tmpBuffer[i] == 0x0e)
-      {
-        if (!sOutputVector.empty())
-        {
-          appendCharacters(sOutputText, sOutputVector, charIt->font.m_format);
-          sOutputVector.clear();
-        }
-        if (!sOutputText.empty())
-        {
-          m_shapeOutputText->addInsertText(sOutputText);
-          sOutputText.clear();
-        }
-        if (isSpanOpened)
+        /* Any text will cause a span to open if it is not yet opened.
+         * The additional conditions aim to avoid superfluous empty span but
+         * also a paragraph without span at all. */
+        if (!isSpanOpened && (!isBreak || isParagraphWithoutSpan))
         {
-          m_shapeOutputText->addCloseSpan();
-          isSpanOpened = false;
+          m_shapeOutputText->addOpenSpan(_getSpanProperties(*charIt));
+          isSpanOpened = true;
+          isParagraphWithoutSpan = false;
         }
 
-        if (isParagraphOpened)
+        /* Plain text is appended to the current text buffer at once. */
+        if (special != textIt)
         {
-          if (!currentBullet)
-            m_shapeOutputText->addCloseParagraph();
-          else
-            m_shapeOutputText->addCloseListElement();
-          isParagraphOpened = false;
+          sOutputVector.insert(sOutputVector.end(), textIt, special);
+          textIt = special;
         }
-      }
-      /* Current character is a tabulator. We have to output
-       * the current text buffer and insert the tab. */
-      else if (tmpBuffer[i] == (unsigned char)'\t')
-      {
-        if (!sOutputVector.empty())
+        /* Current character is a paragraph break,
+         * which will cause the paragraph to close. */
+        else if (isBreak)
         {
-          appendCharacters(sOutputText, sOutputVector, charIt->font.m_format);
-          sOutputVector.clear();
-        }
-        if (!sOutputText.empty())
-        {
-          m_shapeOutputText->addInsertText(sOutputText);
-          sOutputText.clear();
+          _insertText(sOutputText, sOutputVector, charIt->font.m_format);
+          if (isSpanOpened)
+          {
+            m_shapeOutputText->addCloseSpan();
+            isSpanOpened = false;
+          }
+
+          if (isParagraphOpened)
+          {
+            if (!currentBullet)
+              m_shapeOutputText->addCloseParagraph();
+            else
+              m_shapeOutputText->addCloseListElement();
+            isParagraphOpened = false;
+          }
+          ++textIt;
         }
-        m_shapeOutputText->addInsertTab();
-      }
-      /* Current character is a field placeholder. We append
-       * to the current text buffer a text representation
-       * of the field. */
-      else if (tmpBuffer[i] == 0x1e)
-      {
-        if (!sOutputVector.empty())
+        /* Current character is a tabulator. We have to output
+         * the current text buffer and insert the tab. */
+        else if (*textIt == (unsigned char)'\t')
         {
-          appendCharacters(sOutputText, sOutputVector, charIt->font.m_format);
-          sOutputVector.clear();
+          _insertText(sOutputText, sOutputVector, charIt->font.m_format);
+          m_shapeOutputText->addInsertTab();
+          ++textIt;
         }
-        _appendField(sOutputText);
-      }
-      /* We have a normal UTF8 character and we append it
-       * to the current text buffer. */
-      else
-        sOutputVector.push_back(tmpBuffer[i]);
-
-      /* Decrease the count of remaining characters in the same paragraph,
-       * if it is possible. */
-      if (paraNumRemaining)
-        paraNumRemaining--;
-      /* Fetch next paragraph style if it exists. If not, just use the
-       * last one. */
-      if (!paraNumRemaining)
-      {
-        ++paraIt;
-        if (paraIt != m_paraFormats.end())
-          paraNumRemaining = paraIt->charCount;
+        /* Current character is a field placeholder. We append
+         * to the current text buffer a text representation
+         * of the field. */
         else
-          --paraIt;
-      }
-
-      /* Decrease the count of remaining characters in the same span,
-       * if it is possible. */
-      if (charNumRemaining)
-        charNumRemaining--;
-      /* Fetch next character style if it exists and close span, since
-       * the next span will have to use the new character style.
-       * If there is no more character style to fetch, just finish using
-       * the last one. */
-      if (!charNumRemaining)
-      {
-        ++charIt;
-        if (charIt != m_charFormats.end())
         {
-          charNumRemaining = charIt->charCount;
-          if (isSpanOpened)
+          if (!sOutputVector.empty())
           {
-            if (!sOutputVector.empty())
-            {
-              appendCharacters(sOutputText, sOutputVector, charIt->font.m_format);
-              sOutputVector.clear();
-            }
-            if (!sOutputText.empty())
-            {
-              m_shapeOutputText->addInsertText(sOutputText);
-              sOutputText.clear();
-            }
-            m_shapeOutputText->addCloseSpan();
-            isSpanOpened = false;
+            appendCharacters(sOutputText, sOutputVector, charIt->font.m_format);
+            sOutputVector.clear();
           }
+          _appendField(sOutputText);
+          ++textIt;
         }
-        else
-          --charIt;
       }
 
-      /* Decrease the count of remaining characters using the same
-       * tab-set definition, if it is possible. */
-      if (tabNumRemaining)
-        tabNumRemaining--;
-      /* Fetch next tab-set definition if it exists. If not, just use the
-       * last one. */
-      if (!tabNumRemaining)
+      /* Fetch the next character style and close the span, since the next
+       * span will have to use the new character style. */
+      if (isSpanOpened && isStyleFinished(m_charFormats, charIt, charNumRemaining, runLength))
       {
-        ++tabIt;
-        if (tabIt != m_tabSets.end())
-          tabNumRemaining = tabIt->m_numChars;
-        else
-          --tabIt;
+        _insertText(sOutputText, sOutputVector, charIt->font.m_format);
+        m_shapeOutputText->addCloseSpan();
+        isSpanOpened = false;
       }
+      skipStyledCharacters(m_charFormats, charIt, charNumRemaining, runLength);
+      skipStyledCharacters(m_paraFormats, paraIt, paraNumRemaining, runLength);
+      skipStyledCharacters(m_tabSets, tabIt, tabNumRemaining, runLength);
     }
   }
 
@@ -1147,16 +1141,7 @@ void libvisio::VSDContentCollector::_flushText()
   {
     if (isSpanOpened)
     {
-      if (!sOutputVector.empty())
-      {
-        appendCharacters(sOutputText, sOutputVector, charIt->font.m_format);
-        sOutputVector.clear();
-      }
-      if (!sOutputText.empty())
-      {
-        m_shapeOutputText->addInsertText(sOutputText);
-        sOutputText.clear();
-      }
+      _insertText(sOutputText, sOutputVector, charIt->font.m_format);
       m_shapeOutputText->addCloseSpan();
     }
 
@@ -1175,6 +1160,89 @@ void libvisio::VSDContentCollector::_flushText()
   m_currentText.clear();
 }
 
+void libvisio::VSDContentCollector::_insertText(librevenge::RVNGString &text, std::vector<unsigned char> &characters, TextFormat format)
+{
+  if (!characters.empty())
+  {
+    appendCharacters(text, characters, format);
+    characters.clear();
+  }
+  if (!text.empty())
+  {
+    m_shapeOutputText->addInsertText(text);
+    text.clear();
+  }
+}
+
+#define VSD_MAX_TEXT_PROPERTIES_CACHE_SIZE 1024
+
+const librevenge::RVNGPropertyList &libvisio::VSDContentCollector::_getSpanProperties(const VSDCharStyle &style)
+{
+  SpanPropertiesKey key;
+  key.charStyle = style;
+  key.charStyle.charCount = 0;
+  const Colour *pColour = m_currentLayerList.getColour(m_currentLayerMem);
+  if (pColour)
+  {
+    key.hasLayerColour = true;
+    key.layerColour = *pColour;
+  }
+  key.isTextBkgndFilled = m_textBlockStyle.isTextBkgndFilled;
+  if (key.isTextBkgndFilled)
+    key.textBkgndColour = m_textBlockStyle.textBkgndColour;
+
+  auto iter = m_spanPropertiesCache.find(key);
+  if (iter != m_spanPropertiesCache.end())
+    return iter->second;
+
+  librevenge::RVNGPropertyList textProps;
+  _fillCharProperties(textProps, style);
+
+  // TODO: In draw, text span background cannot be specified the same way as in writer span
+  if (m_textBlockStyle.isTextBkgndFilled)
+  {
+    textProps.insert("fo:background-color", getColourString(m_textBlockStyle.textBkgndColour));
+#if 0
+    if (m_textBlockStyle.textBkgndColour.a)
+      textProps.insert("fo:background-opacity", 1.0 - m_textBlockStyle.textBkgndColour.a/255.0, librevenge::RVNG_PERCENT);
+#endif
+  }
+
+  // Callers only keep the returned reference until the next lookup, so a full cache can simply be dropped
+  if (m_spanPropertiesCache.size() >= VSD_MAX_TEXT_PROPERTIES_CACHE_SIZE)
+    m_spanPropertiesCache.clear();
+  return m_spanPropertiesCache[key] = std::move(textProps);
+}
+
+const libvisio::ParagraphProperties &libvisio::VSDContentCollector::_getParagraphProperties(const VSDParaStyle &style, const VSDTabSet &tabSet)
+{
+  ParagraphPropertiesKey key;
+  key.paraStyle = style;
+  key.paraStyle.charCount = 0;
+  key.tabSet = tabSet;
+  key.tabSet.m_numChars = 0;
+  key.defaultTabStop = m_textBlockStyle.defaultTabStop;
+
+  auto iter = m_paragraphPropertiesCache.find(key);
+  if (iter != m_paragraphPropertiesCache.end())
+    return iter->second;
+
+  if (m_paragraphPropertiesCache.size() >= VSD_MAX_TEXT_PROPERTIES_CACHE_SIZE)
+    m_paragraphPropertiesCache.clear();
+  ParagraphProperties &paragraph = m_paragraphPropertiesCache[key];
+  _fillParagraphProperties(paragraph.paraProps, style);
+
+  if (m_textBlockStyle.defaultTabStop > 0.0)
+    paragraph.paraProps.insert("style:tab-stop-distance", m_textBlockStyle.defaultTabStop);
+
+  _fillTabSet(paragraph.paraProps, tabSet);
+
+  _bulletFromParaFormat(paragraph.bullet, style);
+  if (!!paragraph.bullet)
+    _listLevelFromBullet(paragraph.listLevelProps, paragraph.bullet);
+  return paragraph;
+}
+
 void libvisio::VSDContentCollector::_fillCharProperties(librevenge::RVNGPropertyList &propList, const VSDCharStyle &style)
 {
   librevenge::RVNGString fontName;
@@ -1319,10 +1387,13 @@ void libvisio::VSDContentCollector::_flushCurrentForeignData()
   if (m_currentForeignData.size() && m_currentForeignProps["librevenge:mime-type"] && m_foreignWidth != 0.0 && m_foreignHeight != 0.0)
   {
     m_shapeOutputDrawing->addStyle(styleProps);
-    m_currentForeignProps.insert("office:binary-data", m_currentForeignData);
+    // A placeholder only keeps the start of the data, which is not a valid image
+    if (m_limits.isImageEmbedded())
+      m_currentForeignProps.insert("office:binary-data", m_currentForeignData);
     m_shapeOutputDrawing->addGraphicObject(m_currentForeignProps);
   }
-  m_currentForeignData.clear();
+  // The data may be shared with the emitted graphic object, which clear() would copy first
+  m_currentForeignData = librevenge::RVNGBinaryData();
   m_currentForeignProps.clear();
 }
 
@@ -1331,6 +1402,13 @@ void libvisio::VSDContentCollector::_flushCurrentPage()
   if (m_pageShapeOrder != m_documentPageShapeOrders.end() && !m_pageShapeOrder->empty() &&
       m_groupMemberships != m_groupMembershipsSequence.end())
   {
+    size_t numElements = m_currentPage.m_pageElements.size();
+    for (const auto &output : m_pageOutputDrawing)
+      numElements += output.second.size();
+    for (const auto &output : m_pageOutputText)
+      numElements += output.second.size();
+    m_currentPage.m_pageElements.reserve(numElements);
+
     std::stack<std::pair<unsigned, VSDOutputElementList> > groupTextStack;
     for (unsigned int &iterList : *m_pageShapeOrder)
     {
@@ -1339,7 +1417,7 @@ void libvisio::VSDContentCollector::_flushCurrentPage()
       {
         while (!groupTextStack.empty())
         {
-          m_currentPage.append(groupTextStack.top().second);
+          m_currentPage.append(std::move(groupTextStack.top().second));
           groupTextStack.pop();
         }
       }
@@ -1347,7 +1425,7 @@ void libvisio::VSDContentCollector::_flushCurrentPage()
       {
         while (!groupTextStack.empty() && groupTextStack.top().first != iterGroup->second)
         {
-          m_currentPage.append(groupTextStack.top().second);
+          m_currentPage.append(std::move(groupTextStack.top().second));
           groupTextStack.pop();
         }
       }
@@ -1355,16 +1433,16 @@ void libvisio::VSDContentCollector::_flushCurrentPage()
       std::map<unsigned, VSDOutputElementList>::iterator iter;
       iter = m_pageOutputDrawing.find(iterList);
       if (iter != m_pageOutputDrawing.end())
-        m_currentPage.append(iter->second);
+        m_currentPage.append(std::move(iter->second));
       iter = m_pageOutputText.find(iterList);
       if (iter != m_pageOutputText.end())
-        groupTextStack.push(std::make_pair(iterList, iter->second));
+        groupTextStack.push(std::make_pair(iterList, std::move(iter->second)));
       else
         groupTextStack.push(std::make_pair(iterList, VSDOutputElementList()));
     }
     while (!groupTextStack.empty())
     {
-      m_currentPage.append(groupTextStack.top().second);
+      m_currentPage.append(std::move(groupTextStack.top().second));
       groupTextStack.pop();
     }
   }
@@ -1378,7 +1456,6 @@ void libvisio::VSDContentCollector::collectDocumentTheme(const VSDXTheme *theme)
     m_documentTheme = theme;
 }
 
-#define LIBVISIO_EPSILON 1E-10
 void libvisio::VSDContentCollector::collectEllipticalArcTo(unsigned /* id */, unsigned level, double x3, double y3, double x2, double y2, double angle, double ecc)
 {
   _handleLevelChange(level);
@@ -1708,7 +1785,7 @@ void libvisio::VSDContentCollector::collectForeignData(unsigned level, const lib
 void libvisio::VSDContentCollector::collectOLEList(unsigned /* id */, unsigned level)
 {
   _handleLevelChange(level);
-  m_currentForeignData.clear();
+  m_currentForeignData = librevenge::RVNGBinaryData();
   librevenge::RVNGBinaryData binaryData;
   _handleForeignData(binaryData);
 }
@@ -1716,37 +1793,39 @@ void libvisio::VSDContentCollector::collectOLEList(unsigned /* id */, unsigned l
 void libvisio::VSDContentCollector::collectOLEData(unsigned /* id */, unsigned level, const librevenge::RVNGBinaryData &oleData)
 {
   _handleLevelChange(level);
-  m_currentForeignData.append(oleData);
+  if (m_currentForeignData.empty())
+    m_currentForeignData = oleData;
+  else
+    m_currentForeignData.append(oleData);
 }
 
 void libvisio::VSDContentCollector::_handleForeignData(const librevenge::RVNGBinaryData &binaryData)
 {
   if (m_foreignType == 0 || m_foreignType == 1 || m_foreignType == 4) // Image
   {
-    m_currentForeignData.clear();
-    // If bmp data found, reconstruct header
-    if (m_foreignType == 1 && m_foreignFormat == 0)
+    m_currentForeignData = librevenge::RVNGBinaryData();
+    // If bmp data found, reconstruct header, unless the data are not painted anyway
+    if (m_foreignType == 1 && m_foreignFormat == 0 && m_limits.isImageEmbedded())
     {
-      m_currentForeignData.append(0x42);
-      m_currentForeignData.append(0x4d);
-
-      m_currentForeignData.append((unsigned char)((binaryData.size() + 14) & 0x000000ff));
-      m_currentForeignData.append((unsigned char)(((binaryData.size() + 14) & 0x0000ff00) >> 8));
-      m_currentForeignData.append((unsigned char)(((binaryData.size() + 14) & 0x00ff0000) >> 16));
-      m_currentForeignData.append((unsigned char)(((binaryData.size() + 14) & 0xff000000) >> 24));
-
-      m_currentForeignData.append((unsigned char)0x00);
-      m_currentForeignData.append((unsigned char)0x00);
-      m_currentForeignData.append((unsigned char)0x00);
-      m_currentForeignData.append((unsigned char)0x00);
-
-      const unsigned dataOff = computeBMPDataOffset(binaryData.getDataStream(), binaryData.size());
-      m_currentForeignData.append((unsigned char)(dataOff & 0xff));
-      m_currentForeignData.append((unsigned char)((dataOff >> 8) & 0xff));
-      m_currentForeignData.append((unsigned char)((dataOff >> 16) & 0xff));
-      m_currentForeignData.append((unsigned char)((dataOff >> 24) & 0xff));
+      const unsigned long fileSize = binaryData.size() + 14;
+      const unsigned dataOff = computeBMPDataOffset(binaryData.getDataBuffer(), binaryData.size());
+      const unsigned char header[] =
+      {
+        0x42, 0x4d,
+        (unsigned char)(fileSize & 0xff), (unsigned char)((fileSize >> 8) & 0xff),
+        (unsigned char)((fileSize >> 16) & 0xff), (unsigned char)((fileSize >> 24) & 0xff),
+        0x00, 0x00, 0x00, 0x00,
+        (unsigned char)(dataOff & 0xff), (unsigned char)((dataOff >> 8) & 0xff),
+        (unsigned char)((dataOff >> 16) & 0xff), (unsigned char)((dataOff >> 24) & 0xff)
+      };
+      m_currentForeignData.append(header, sizeof(header));
+      m_currentForeignData.append(binaryData);
+    }
+    else
+    {
+      // share the buffer instead of copying it
+      m_currentForeignData = binaryData;
     }
-    m_currentForeignData.append(binaryData);
 
     if (m_foreignType == 1)
     {
@@ -1783,7 +1862,10 @@ void libvisio::VSDContentCollector::_handleForeignData(const librevenge::RVNGBin
   else if (m_foreignType == 2)
   {
     m_currentForeignProps.insert("librevenge:mime-type", "object/ole");
-    m_currentForeignData.append(binaryData);
+    if (m_currentForeignData.empty())
+      m_currentForeignData = binaryData;
+    else
+      m_currentForeignData.append(binaryData);
   }
 
 #if DUMP_BITMAP
@@ -1938,77 +2020,68 @@ void libvisio::VSDContentCollector::collectArcTo(unsigned /* id */, unsigned lev
 }
 
 
-void libvisio::VSDContentCollector::_outputCubicBezierSegment(const std::vector<std::pair<double, double> > &points)
+void libvisio::VSDContentCollector::_outputNURBSSegments(const std::vector<NURBSSegment> &segments)
 {
-  if (points.size() < 4)
+  if (m_noShow || (m_noFill && m_noLine))
     return;
-  librevenge::RVNGPropertyList node;
-  node.insert("librevenge:path-action", "C");
-  double x = points[1].first;
-  double y = points[1].second;
-  transformPoint(x, y);
-  node.insert("svg:x1", m_scale*x);
-  node.insert("svg:y1", m_scale*y);
-  x = points[2].first;
-  y = points[2].second;
-  transformPoint(x, y);
-  node.insert("svg:x2", m_scale*x);
-  node.insert("svg:y2", m_scale*y);
-  x = points[3].first;
-  y = points[3].second;
-  transformPoint(x, y);
-  node.insert("svg:x", m_scale*x);
-  node.insert("svg:y", m_scale*y);
 
-  if (!m_noFill && !m_noShow)
-    m_currentFillGeometry.push_back(node);
-  if (!m_noLine && !m_noShow)
-    m_currentLineGeometry.push_back(node);
-}
-
-void libvisio::VSDContentCollector::_outputQuadraticBezierSegment(const std::vector<std::pair<double, double> > &points)
-{
-  if (points.size() < 3)
-    return;
-  librevenge::RVNGPropertyList node;
-  node.insert("librevenge:path-action", "Q");
-  double x = points[1].first;
-  double y = points[1].second;
-  transformPoint(x, y);
-  node.insert("svg:x1", m_scale*x);
-  node.insert("svg:y1", m_scale*y);
-  x = points[2].first;
-  y = points[2].second;
-  transformPoint(x, y);
-  node.insert("svg:x", m_scale*x);
-  node.insert("svg:y", m_scale*y);
-
-  if (!m_noFill && !m_noShow)
-    m_currentFillGeometry.push_back(node);
-  if (!m_noLine && !m_noShow)
-    m_currentLineGeometry.push_back(node);
-}
+  if (!m_noFill)
+    m_currentFillGeometry.reserve(m_currentFillGeometry.size() + segments.size());
+  if (!m_noLine)
+    m_currentLineGeometry.reserve(m_currentLineGeometry.size() + segments.size());
 
-void libvisio::VSDContentCollector::_outputLinearBezierSegment(const std::vector<std::pair<double, double> > &points)
-{
-  if (points.size() < 2)
-    return;
-  librevenge::RVNGPropertyList node;
-  node.insert("librevenge:path-action", "L");
-  double x = points[1].first;
-  double y = points[1].second;
-  transformPoint(x, y);
-  node.insert("svg:x", m_scale*x);
-  node.insert("svg:y", m_scale*y);
+  for (const auto &segment : segments)
+  {
+    if (_isPathFull())
+      break;
+    librevenge::RVNGPropertyList node;
+    double x = 0.0;
+    double y = 0.0;
+    switch (segment.degree)
+    {
+    case 1:
+      node.insert("librevenge:path-action", "L");
+      break;
+    case 2:
+      node.insert("librevenge:path-action", "Q");
+      x = segment.points[0].first;
+      y = segment.points[0].second;
+      transformPoint(x, y);
+      node.insert("svg:x1", m_scale*x);
+      node.insert("svg:y1", m_scale*y);
+      break;
+    case 3:
+      node.insert("librevenge:path-action", "C");
+      x = segment.points[0].first;
+      y = segment.points[0].second;
+      transformPoint(x, y);
+      node.insert("svg:x1", m_scale*x);
+      node.insert("svg:y1", m_scale*y);
+      x = segment.points[1].first;
+      y = segment.points[1].second;
+      transformPoint(x, y);
+      node.insert("svg:x2", m_scale*x);
+      node.insert("svg:y2", m_scale*y);
+      break;
+    default:
+      continue;
+    }
+    x = segment.points[segment.degree-1].first;
+    y = segment.points[segment.degree-1].second;
+    transformPoint(x, y);
+    node.insert("svg:x", m_scale*x);
+    node.insert("svg:y", m_scale*y);
 
-  if (!m_noFill && !m_noShow)
-    m_currentFillGeometry.push_back(node);
-  if (!m_noLine && !m_noShow)
-    m_currentLineGeometry.push_back(node);
+    if (!m_noFill)
+      m_currentFillGeometry.push_back(node);
+    if (!m_noLine)
+      m_currentLineGeometry.push_back(node);
+  }
 }
 
 void libvisio::VSDContentCollector::_generateBezierSegmentsFromNURBS(unsigned degree,
-                                                                     const std::vector<std::pair<double, double> > &controlPoints, const std::vector<double> &knotVector)
+                                                                     const std::vector<std::pair<double, double> > &controlPoints, const std::vector<double> &knotVector,
+                                                                     std::vector<NURBSSegment> &segments)
 {
   if (controlPoints.size() <= degree || knotVector.empty() || degree == 0)
     return;
@@ -2065,18 +2138,13 @@ void libvisio::VSDContentCollector::_generateBezierSegmentsFromNURBS(unsigned de
       }
     }
     // Pass the segment to the path
-
-    switch (degree)
+    if (degree <= 3)
     {
-    case 1:
-      _outputLinearBezierSegment(points);
-      break;
-    case 2:
-      _outputQuadraticBezierSegment(points);
-      break;
-    case 3:
-      _outputCubicBezierSegment(points);
-      break;
+      NURBSSegment segment;
+      segment.degree = degree;
+      for (unsigned k = 1; k <= degree; k++)
+        segment.points[k-1] = points[k];
+      segments.push_back(segment);
     }
 
     std::swap(points, nextPoints);
@@ -2097,67 +2165,9 @@ void libvisio::VSDContentCollector::_generateBezierSegmentsFromNURBS(unsigned de
   }
 }
 
-double libvisio::VSDContentCollector::_NURBSBasis(unsigned knot, unsigned degree, double point, const std::vector<double> &knotVector)
-{
-  double basis = 0;
-  if (knotVector.empty())
-    return basis;
-  if (degree == 0)
-  {
-    if (knotVector[knot] <= point && point < knotVector[knot+1])
-      return 1;
-    else
-      return 0;
-  }
-  if (knotVector.size() > knot+degree && fabs(knotVector[knot+degree]-knotVector[knot]) > LIBVISIO_EPSILON)
-    basis = (point-knotVector[knot])/(knotVector[knot+degree]-knotVector[knot]) * _NURBSBasis(knot, degree-1, point, knotVector);
-
-  if (knotVector.size() > knot+degree+1 && fabs(knotVector[knot+degree+1] - knotVector[knot+1]) > LIBVISIO_EPSILON)
-    basis += (knotVector[knot+degree+1]-point)/(knotVector[knot+degree+1]-knotVector[knot+1]) * _NURBSBasis(knot+1, degree-1, point, knotVector);
-
-  return basis;
-}
-
-#define VSD_NUM_POLYLINES_PER_KNOT 100
-
-void libvisio::VSDContentCollector::_generatePolylineFromNURBS(unsigned degree, const std::vector<std::pair<double, double> > &controlPoints,
-                                                               const std::vector<double> &knotVector, const std::vector<double> &weights)
+bool libvisio::VSDContentCollector::_isPathFull() const
 {
-  if (m_noShow)
-    return;
-
-  if (!m_noFill)
-    m_currentFillGeometry.reserve(VSD_NUM_POLYLINES_PER_KNOT * knotVector.size());
-  if (!m_noLine)
-    m_currentLineGeometry.reserve(VSD_NUM_POLYLINES_PER_KNOT * knotVector.size());
-
-  for (size_t i = 0; i < VSD_NUM_POLYLINES_PER_KNOT * knotVector.size(); i++)
-  {
-    librevenge::RVNGPropertyList node;
-
-    node.insert("librevenge:path-action", "L");
-    double x = 0;
-    double y = 0;
-    double denominator = LIBVISIO_EPSILON;
-
-    for (unsigned p = 0; p < controlPoints.size() && p < weights.size(); p++)
-    {
-      double basis = _NURBSBasis(p, degree, (double)i / (VSD_NUM_POLYLINES_PER_KNOT * knotVector.size()), knotVector);
-      x += basis * controlPoints[p].first * weights[p];
-      y += basis * controlPoints[p].second * weights[p];
-      denominator += weights[p] * basis;
-    }
-    x /= denominator;
-    y /= denominator;
-    transformPoint(x, y);
-    node.insert("svg:x", m_scale*x);
-    node.insert("svg:y", m_scale*y);
-
-    if (!m_noFill)
-      m_currentFillGeometry.push_back(node);
-    if (!m_noLine)
-      m_currentLineGeometry.push_back(node);
-  }
+  return m_limits.isPathFull(std::max(m_currentFillGeometry.size(), m_currentLineGeometry.size()));
 }
 
 bool libvisio::VSDContentCollector::_isUniform(const std::vector<double> &weights) const
@@ -2175,9 +2185,20 @@ bool libvisio::VSDContentCollector::_isUniform(const std::vector<double> &weight
   return true;
 }
 
+bool libvisio::VSDContentCollector::_isSameNURBSInput(const NURBSCacheEntry &entry, const NURBSCacheEntry &input,
+                                                     const std::vector<std::pair<double, double> > &controlPoints,
+                                                     const std::vector<double> &knotVector, const std::vector<double> &weights) const
+{
+  return std::tie(entry.degree, entry.xType, entry.yType, entry.start, entry.end, entry.width, entry.height, entry.tolerance)
+         == std::tie(input.degree, input.xType, input.yType, input.start, input.end, input.width, input.height, input.tolerance)
+         && entry.controlPoints == controlPoints && entry.knotVector == knotVector && entry.weights == weights;
+}
+
 #define MAX_ALLOWED_NURBS_DEGREE 8
+// Maximum number of control points and segments of the cached NURBS curves
+#define VSD_MAX_NURBS_CACHE_POINTS 0x40000
 
-void libvisio::VSDContentCollector::collectNURBSTo(unsigned /* id */, unsigned level, double x2, double y2,
+void libvisio::VSDContentCollector::collectNURBSTo(unsigned id, unsigned level, double x2, double y2,
                                                    unsigned char xType, unsigned char yType, unsigned degree, const std::vector<std::pair<double, double> > &ctrlPnts,
                                                    const std::vector<double> &kntVec, const std::vector<double> &weights)
 {
@@ -2187,6 +2208,33 @@ void libvisio::VSDContentCollector::collectNURBSTo(unsigned /* id */, unsigned l
     // Here, maybe we should just draw line to (x2,y2)
     return;
 
+  /* The segments are in shape-local co-ordinates, so instances of the same
+   * master share them and only need the per-instance transform applied.
+   */
+  const double tolerance = m_scale > 0.0 ? m_limits.getCurveTolerance() / m_scale : m_limits.getCurveTolerance();
+  NURBSCacheEntry input;
+  input.degree = degree;
+  input.xType = xType;
+  input.yType = yType;
+  input.start = std::make_pair(m_originalX, m_originalY);
+  input.end = std::make_pair(x2, y2);
+  input.width = xType == 0 ? m_xform.width : 0.0;
+  input.height = yType == 0 ? m_xform.height : 0.0;
+  input.tolerance = tolerance;
+  const NURBSCacheKey key(m_stencilShape, m_currentGeometryCount, id);
+  if (m_stencilShape)
+  {
+    auto iter = m_NURBSCache.find(key);
+    if (iter != m_NURBSCache.end() && _isSameNURBSInput(iter->second, input, ctrlPnts, kntVec, weights))
+    {
+      if (m_stats)
+        m_stats->collectNURBSPoints(iter->second.segments.size());
+      _outputNURBSSegments(iter->second.segments);
+      _finishNURBSTo(x2, y2);
+      return;
+    }
+  }
+
   if (degree > MAX_ALLOWED_NURBS_DEGREE)
     degree = MAX_ALLOWED_NURBS_DEGREE;
 
@@ -2229,11 +2277,30 @@ void libvisio::VSDContentCollector::collectNURBSTo(unsigned /* id */, unsigned l
     knot /= lastKnot;
   }
 
+  std::vector<NURBSSegment> segments;
   if (degree <= 3 && _isUniform(weights))
-    _generateBezierSegmentsFromNURBS(degree, controlPoints, knotVector);
+    _generateBezierSegmentsFromNURBS(degree, controlPoints, knotVector, segments);
   else
-    _generatePolylineFromNURBS(degree, controlPoints, knotVector, weights);
+    tessellateNURBS(degree, controlPoints, knotVector, weights, tolerance, m_limits, segments);
+  if (m_stats)
+    m_stats->collectNURBSPoints(segments.size());
+  _outputNURBSSegments(segments);
+
+  const unsigned long points = ctrlPnts.size() + segments.size();
+  if (m_stencilShape && !m_NURBSCache.count(key) && m_NURBSCachePoints + points <= VSD_MAX_NURBS_CACHE_POINTS)
+  {
+    NURBSCacheEntry &entry = m_NURBSCache[key] = input;
+    entry.controlPoints = ctrlPnts;
+    entry.knotVector = kntVec;
+    entry.weights = weights;
+    entry.segments = std::move(segments);
+    m_NURBSCachePoints += points;
+  }
+  _finishNURBSTo(x2, y2);
+}
 
+void libvisio::VSDContentCollector::_finishNURBSTo(double x2, double y2)
+{
   m_originalX = x2;
   m_originalY = y2;
   m_x = x2;
@@ -2306,7 +2373,7 @@ void libvisio::VSDContentCollector::collectPolylineTo(unsigned /* id */, unsigne
 
   librevenge::RVNGPropertyList polyline;
   std::vector<std::pair<double, double> > tmpPoints(points);
-  for (size_t i = 0; i< points.size(); i++)
+  for (size_t i = 0; i< points.size() && !_isPathFull(); i++)
   {
     polyline.clear();
     if (xType == 0)
@@ -2612,8 +2679,8 @@ void libvisio::VSDContentCollector::collectShape(unsigned id, unsigned level, un
   m_paraFormats.clear();
 
   m_currentShapeId = id;
-  m_pageOutputDrawing[m_currentShapeId] = VSDOutputElementList();
-  m_pageOutputText[m_currentShapeId] = VSDOutputElementList();
+  m_pageOutputDrawing[m_currentShapeId] = VSDOutputElementList(m_pageArena);
+  m_pageOutputText[m_currentShapeId] = VSDOutputElementList(m_pageArena);
   m_shapeOutputDrawing = &m_pageOutputDrawing[m_currentShapeId];
   m_shapeOutputText = &m_pageOutputText[m_currentShapeId];
   m_isShapeStarted = true;
@@ -2622,7 +2689,7 @@ void libvisio::VSDContentCollector::collectShape(unsigned id, unsigned level, un
   m_names.clear();
   m_stencilNames.clear();
   m_fields.clear();
-  m_stencilFields.clear();
+  m_stencilFields = nullptr;
 
   // Get stencil shape
   m_stencilShape = m_stencils.getStencilShape(masterPage, masterShape);
@@ -2642,7 +2709,7 @@ void libvisio::VSDContentCollector::collectShape(unsigned id, unsigned level, un
       m_foreignOffsetY = m_stencilShape->m_foreign->offsetY;
       m_foreignWidth = m_stencilShape->m_foreign->width;
       m_foreignHeight = m_stencilShape->m_foreign->height;
-      m_currentForeignData.clear();
+      m_currentForeignData = librevenge::RVNGBinaryData();
       _handleForeignData(m_stencilShape->m_foreign->data);
     }
 
@@ -2656,10 +2723,11 @@ void libvisio::VSDContentCollector::collectShape(unsigned id, unsigned level, un
     if (m_stencilShape->m_txtxform)
       m_txtxform.reset(new XForm(*(m_stencilShape->m_txtxform)));
 
-    m_stencilFields = m_stencilShape->m_fields;
-    for (size_t i = 0; i < m_stencilFields.size(); i++)
+    // The master's field list outlives the shape, so refer to it instead of copying
+    m_stencilFields = &m_stencilShape->m_fields;
+    for (size_t i = 0; i < m_stencilFields->size(); i++)
     {
-      VSDFieldListElement *elem = m_stencilFields.getElement(i);
+      VSDFieldListElement *elem = m_stencilFields->getElement(i);
       if (elem)
         m_fields.push_back(elem->getString(m_stencilNames));
       else
@@ -3482,7 +3550,7 @@ void libvisio::VSDContentCollector::collectFieldList(unsigned /* id */, unsigned
 void libvisio::VSDContentCollector::collectTextField(unsigned id, unsigned level, int nameId, int formatStringId)
 {
   _handleLevelChange(level);
-  VSDFieldListElement *element = m_stencilFields.getElement(m_fields.size());
+  VSDFieldListElement *element = m_stencilFields ? m_stencilFields->getElement(m_fields.size()) : nullptr;
   if (element)
   {
     if (nameId == -2)
@@ -3505,7 +3573,7 @@ void libvisio::VSDContentCollector::collectTextField(unsigned id, unsigned level
 void libvisio::VSDContentCollector::collectNumericField(unsigned id, unsigned level, unsigned short format, unsigned short cellType, double number, int formatStringId)
 {
   _handleLevelChange(level);
-  VSDFieldListElement *pElement = m_stencilFields.getElement(m_fields.size());
+  VSDFieldListElement *pElement = m_stencilFields ? m_stencilFields->getElement(m_fields.size()) : nullptr;
   if (pElement)
   {
     std::unique_ptr<VSDFieldListElement> element{pElement->clone()};
@@ -3596,6 +3664,8 @@ void libvisio::VSDContentCollector::startPage(unsigned pageId)
     m_pageShapeOrder = m_documentPageShapeOrders.begin() + (m_currentPageNumber-1);
   m_currentPage = libvisio::VSDPage();
   m_currentPage.m_currentPageID = pageId;
+  m_pageArena = std::make_shared<VSDOutputElementArena>();
+  m_pageElementCount = 0;
   m_isPageStarted = true;
 }
 
@@ -3610,189 +3680,43 @@ void libvisio::VSDContentCollector::endPage()
     if (m_currentPage.m_backgroundPageID == m_currentPage.m_currentPageID)
       m_currentPage.m_backgroundPageID = MINUS_ONE;
     if (m_isBackgroundPage)
-      m_pages.addBackgroundPage(m_currentPage);
+      m_pages.addBackgroundPage(std::move(m_currentPage));
     else
-      m_pages.addPage(m_currentPage);
+      m_pages.addPage(std::move(m_currentPage));
+    m_currentPage = libvisio::VSDPage();
     m_isPageStarted = false;
     m_isBackgroundPage = false;
+    if (m_progress)
+      m_progress->collectPage();
   }
 }
 
 void libvisio::VSDContentCollector::endPages()
 {
+  const VSDParseStats::TimePoint drawStart = m_stats ? VSDParseStats::now() : VSDParseStats::TimePoint();
   m_pages.draw(m_painter);
+  if (m_stats)
+    m_stats->collectDraw(drawStart);
 }
 
-bool libvisio::VSDContentCollector::parseFormatId(const char *formatString, unsigned short &result)
+void libvisio::VSDContentCollector::hideBackgroundPages(const std::set<unsigned> &pageIds)
 {
-  using namespace boost::spirit::qi;
-
-  result = 0xffff;
-
-  uint_parser<unsigned short,10,1,5> ushort5;
-  auto first = formatString;
-  const auto last = first + strlen(formatString);
-  if (phrase_parse(first, last,
-                   (
-                     "{<" >> ushort5 >> ">}"
-                     | "esc(" >> ushort5 >> ')'
-                   ),
-                   space, result))
-  {
-    return first == last;
-  }
-  return false;
+  m_pages.hideBackgroundPages(pageIds);
 }
 
-void libvisio::VSDContentCollector::appendCharacters(librevenge::RVNGString &text, const std::vector<unsigned char> &characters, TextFormat format)
+void libvisio::VSDContentCollector::setParseLimits(const VSDParseLimits &limits)
 {
-  if (format == VSD_TEXT_UTF16)
-    return appendCharacters(text, characters);
-  if (format == VSD_TEXT_UTF8)
-  {
-    // TODO: revisit for librevenge 0.1
-    std::vector<unsigned char> buf;
-    buf.reserve(characters.size() + 1);
-    buf.assign(characters.begin(), characters.end());
-    buf.push_back(0);
-    text.append(reinterpret_cast<const char *>(buf.data()));
-    return;
-  }
-
-  static const UChar32 symbolmap [] =
-  {
-    0x0020, 0x0021, 0x2200, 0x0023, 0x2203, 0x0025, 0x0026, 0x220D, // 0x20 ..
-    0x0028, 0x0029, 0x2217, 0x002B, 0x002C, 0x2212, 0x002E, 0x002F,
-    0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037,
-    0x0038, 0x0039, 0x003A, 0x003B, 0x003C, 0x003D, 0x003E, 0x003F,
-    0x2245, 0x0391, 0x0392, 0x03A7, 0x0394, 0x0395, 0x03A6, 0x0393,
-    0x0397, 0x0399, 0x03D1, 0x039A, 0x039B, 0x039C, 0x039D, 0x039F,
-    0x03A0, 0x0398, 0x03A1, 0x03A3, 0x03A4, 0x03A5, 0x03C2, 0x03A9,
-    0x039E, 0x03A8, 0x0396, 0x005B, 0x2234, 0x005D, 0x22A5, 0x005F,
-    0xF8E5, 0x03B1, 0x03B2, 0x03C7, 0x03B4, 0x03B5, 0x03C6, 0x03B3,
-    0x03B7, 0x03B9, 0x03D5, 0x03BA, 0x03BB, 0x03BC, 0x03BD, 0x03BF,
-    0x03C0, 0x03B8, 0x03C1, 0x03C3, 0x03C4, 0x03C5, 0x03D6, 0x03C9,
-    0x03BE, 0x03C8, 0x03B6, 0x007B, 0x007C, 0x007D, 0x223C, 0x0020, // .. 0x7F
-    0x0080, 0x0081, 0x0082, 0x0083, 0x0084, 0x0085, 0x0086, 0x0087,
-    0x0088, 0x0089, 0x008a, 0x008b, 0x008c, 0x008d, 0x008e, 0x008f,
-    0x0090, 0x0091, 0x0092, 0x0093, 0x0094, 0x0095, 0x0096, 0x0097,
-    0x0098, 0x0099, 0x009a, 0x009b, 0x009c, 0x009d, 0x009E, 0x009f,
-    0x20AC, 0x03D2, 0x2032, 0x2264, 0x2044, 0x221E, 0x0192, 0x2663, // 0xA0 ..
-    0x2666, 0x2665, 0x2660, 0x2194, 0x2190, 0x2191, 0x2192, 0x2193,
-    0x00B0, 0x00B1, 0x2033, 0x2265, 0x00D7, 0x221D, 0x2202, 0x2022,
-    0x00F7, 0x2260, 0x2261, 0x2248, 0x2026, 0x23D0, 0x23AF, 0x21B5,
-    0x2135, 0x2111, 0x211C, 0x2118, 0x2297, 0x2295, 0x2205, 0x2229,
-    0x222A, 0x2283, 0x2287, 0x2284, 0x2282, 0x2286, 0x2208, 0x2209,
-    0x2220, 0x2207, 0x00AE, 0x00A9, 0x2122, 0x220F, 0x221A, 0x22C5,
-    0x00AC, 0x2227, 0x2228, 0x21D4, 0x21D0, 0x21D1, 0x21D2, 0x21D3,
-    0x25CA, 0x3008, 0x00AE, 0x00A9, 0x2122, 0x2211, 0x239B, 0x239C,
-    0x239D, 0x23A1, 0x23A2, 0x23A3, 0x23A7, 0x23A8, 0x23A9, 0x23AA,
-    0xF8FF, 0x3009, 0x222B, 0x2320, 0x23AE, 0x2321, 0x239E, 0x239F,
-    0x23A0, 0x23A4, 0x23A5, 0x23A6, 0x23AB, 0x23AC, 0x23AD, 0x0020  // .. 0xFE
-  };
-
-  UChar32  ucs4Character = 0;
-  if (format == VSD_TEXT_SYMBOL) // SYMBOL
-  {
-    for (unsigned char character : characters)
-    {
-      if (0x1e == ucs4Character)
-        ucs4Character = 0xfffc;
-      else if (character < 0x20)
-        ucs4Character = 0x20;
-      else
-        ucs4Character = symbolmap[character - 0x20];
-      appendUCS4(text, ucs4Character);
-    }
-  }
-  else
-  {
-    UErrorCode status = U_ZERO_ERROR;
-    UConverter *conv = nullptr;
-    switch (format)
-    {
-    case VSD_TEXT_JAPANESE:
-      conv = ucnv_open("windows-932", &status);
-      break;
-    case VSD_TEXT_KOREAN:
-      conv = ucnv_open("windows-949", &status);
-      break;
-    case VSD_TEXT_CHINESE_SIMPLIFIED:
-      conv = ucnv_open("windows-936", &status);
-      break;
-    case VSD_TEXT_CHINESE_TRADITIONAL:
-      conv = ucnv_open("windows-950", &status);
-      break;
-    case VSD_TEXT_GREEK:
-      conv = ucnv_open("windows-1253", &status);
-      break;
-    case VSD_TEXT_TURKISH:
-      conv = ucnv_open("windows-1254", &status);
-      break;
-    case VSD_TEXT_VIETNAMESE:
-      conv = ucnv_open("windows-1258", &status);
-      break;
-    case VSD_TEXT_HEBREW:
-      conv = ucnv_open("windows-1255", &status);
-      break;
-    case VSD_TEXT_ARABIC:
-      conv = ucnv_open("windows-1256", &status);
-      break;
-    case VSD_TEXT_BALTIC:
-      conv = ucnv_open("windows-1257", &status);
-      break;
-    case VSD_TEXT_RUSSIAN:
-      conv = ucnv_open("windows-1251", &status);
-      break;
-    case VSD_TEXT_THAI:
-      conv = ucnv_open("windows-874", &status);
-      break;
-    case VSD_TEXT_CENTRAL_EUROPE:
-      conv = ucnv_open("windows-1250", &status);
-      break;
-    default:
-      conv = ucnv_open("windows-1252", &status);
-      break;
-    }
-    if (U_SUCCESS(status) && conv)
-    {
-      const auto *src = (const char *)&characters[0];
-      const char *srcLimit = (const char *)src + characters.size();
-      while (src < srcLimit)
-      {
-        ucs4Character = ucnv_getNextUChar(conv, &src, srcLimit, &status);
-        if (U_SUCCESS(status) && U_IS_UNICODE_CHAR(ucs4Character))
-        {
-          if (0x1e == ucs4Character)
-            appendUCS4(text, 0xfffc);
-          else
-            appendUCS4(text, ucs4Character);
-        }
-      }
-    }
-    if (conv)
-      ucnv_close(conv);
-  }
+  m_limits = limits;
 }
 
-void libvisio::VSDContentCollector::appendCharacters(librevenge::RVNGString &text, const std::vector<unsigned char> &characters)
+void libvisio::VSDContentCollector::setParseProgress(VSDParseProgress *progress)
 {
-  UErrorCode status = U_ZERO_ERROR;
-  UConverter *conv = ucnv_open("UTF-16LE", &status);
+  m_progress = progress;
+}
 
-  if (U_SUCCESS(status) && conv)
-  {
-    const auto *src = (const char *)&characters[0];
-    const char *srcLimit = (const char *)src + characters.size();
-    while (src < srcLimit)
-    {
-      UChar32 ucs4Character = ucnv_getNextUChar(conv, &src, srcLimit, &status);
-      if (U_SUCCESS(status) && U_IS_UNICODE_CHAR(ucs4Character))
-        appendUCS4(text, ucs4Character);
-    }
-  }
-  if (conv)
-    ucnv_close(conv);
+void libvisio::VSDContentCollector::setParseStats(VSDParseStats *stats)
+{
+  m_stats = stats;
 }
 
 void libvisio::VSDContentCollector::_appendField(librevenge::RVNGString &text)
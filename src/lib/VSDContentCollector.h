@@ -17,10 +17,13 @@
 #include <map>
 #include <memory>
 #include <list>
+#include <set>
+#include <tuple>
 #include <vector>
 #include "libvisio_utils.h"
 #include "VSDCollector.h"
 #include "VSDParser.h"
+#include "VSDNURBS.h"
 #include "VSDOutputElementList.h"
 #include "VSDStyles.h"
 #include "VSDPages.h"
@@ -28,6 +31,79 @@
 namespace libvisio
 {
 
+// Identifies a NURBS row of a master shape
+struct NURBSCacheKey
+{
+  NURBSCacheKey(const VSDShape *m, unsigned g, unsigned r) : master(m), geometry(g), row(r) {}
+  bool operator<(const NURBSCacheKey &key) const
+  {
+    return std::tie(master, geometry, row) < std::tie(key.master, key.geometry, key.row);
+  }
+  const VSDShape *master;
+  unsigned geometry;
+  unsigned row;
+};
+
+/* A NURBS curve of a master shape, with the input it was computed from.
+ * An instance can override the row of its master, so the input has to
+ * match before the segments are reused.
+ */
+struct NURBSCacheEntry
+{
+  NURBSCacheEntry()
+    : degree(0), xType(0), yType(0), start(), end(), width(0.0), height(0.0), tolerance(0.0),
+      controlPoints(), knotVector(), weights(), segments() {}
+  unsigned degree;
+  unsigned char xType;
+  unsigned char yType;
+  std::pair<double, double> start;
+  std::pair<double, double> end;
+  double width; // only used for percentage co-ordinates
+  double height; // only used for percentage co-ordinates
+  double tolerance;
+  std::vector<std::pair<double, double> > controlPoints;
+  std::vector<double> knotVector;
+  std::vector<double> weights;
+  std::vector<NURBSSegment> segments;
+};
+
+// Everything the span properties of a text run are resolved from
+struct SpanPropertiesKey
+{
+  SpanPropertiesKey() : charStyle(), hasLayerColour(false), layerColour(), isTextBkgndFilled(false), textBkgndColour() {}
+  bool operator<(const SpanPropertiesKey &key) const
+  {
+    return std::tie(charStyle, hasLayerColour, layerColour, isTextBkgndFilled, textBkgndColour)
+           < std::tie(key.charStyle, key.hasLayerColour, key.layerColour, key.isTextBkgndFilled, key.textBkgndColour);
+  }
+  VSDCharStyle charStyle;
+  bool hasLayerColour;
+  Colour layerColour;
+  bool isTextBkgndFilled;
+  Colour textBkgndColour;
+};
+
+// Everything the paragraph properties and the bullet of a paragraph are resolved from
+struct ParagraphPropertiesKey
+{
+  ParagraphPropertiesKey() : paraStyle(), tabSet(), defaultTabStop(0.0) {}
+  bool operator<(const ParagraphPropertiesKey &key) const
+  {
+    return std::tie(paraStyle, tabSet, defaultTabStop) < std::tie(key.paraStyle, key.tabSet, key.defaultTabStop);
+  }
+  VSDParaStyle paraStyle;
+  VSDTabSet tabSet;
+  double defaultTabStop;
+};
+
+struct ParagraphProperties
+{
+  ParagraphProperties() : paraProps(), bullet(), listLevelProps() {}
+  librevenge::RVNGPropertyList paraProps;
+  VSDBullet bullet;
+  librevenge::RVNGPropertyList listLevelProps;
+};
+
 class VSDContentCollector : public VSDCollector
 {
 public:
@@ -176,6 +252,10 @@ public:
   void endPage() override;
   void endPages() override;
 
+  void hideBackgroundPages(const std::set<unsigned> &pageIds);
+  void setParseLimits(const VSDParseLimits &limits);
+  void setParseProgress(VSDParseProgress *progress);
+  void setParseStats(VSDParseStats *stats);
 
 private:
   VSDContentCollector(const VSDContentCollector &);
@@ -188,8 +268,6 @@ private:
   void transformAngle(double &angle, XForm *txtxform = nullptr);
   void transformFlips(bool &flipX, bool &flipY);
 
-  double _NURBSBasis(unsigned knot, unsigned degree, double point, const std::vector<double> &knotVector);
-
   void _flushShape();
   void _flushCurrentPath(unsigned id);
   void _flushText();
@@ -208,27 +286,28 @@ private:
   const char *_linePropertiesMarkerPath(unsigned marker);
   double _linePropertiesMarkerScale(unsigned marker);
 
-  void appendCharacters(librevenge::RVNGString &text, const std::vector<unsigned char> &characters, TextFormat format);
-  void appendCharacters(librevenge::RVNGString &text, const std::vector<unsigned char> &characters);
   void _convertDataToString(librevenge::RVNGString &result, const librevenge::RVNGBinaryData &data, TextFormat format);
-  bool parseFormatId(const char *formatString, unsigned short &result);
   void _appendField(librevenge::RVNGString &text);
 
   // NURBS processing functions
   bool _isUniform(const std::vector<double> &weights) const;
-  void _generatePolylineFromNURBS(unsigned degree, const std::vector<std::pair<double, double> > &controlPoints,
-                                  const std::vector<double> &knotVector, const std::vector<double> &weights);
+  bool _isSameNURBSInput(const NURBSCacheEntry &entry, const NURBSCacheEntry &input,
+                         const std::vector<std::pair<double, double> > &controlPoints,
+                         const std::vector<double> &knotVector, const std::vector<double> &weights) const;
+  void _finishNURBSTo(double x2, double y2);
+  bool _isPathFull() const;
   void _generateBezierSegmentsFromNURBS(unsigned degree, const std::vector<std::pair<double, double> > &controlPoints,
-                                        const std::vector<double> &knotVector);
-  void _outputCubicBezierSegment(const std::vector<std::pair<double, double> > &points);
-  void _outputQuadraticBezierSegment(const std::vector<std::pair<double, double> > &points);
-  void _outputLinearBezierSegment(const std::vector<std::pair<double, double> > &points);
+                                        const std::vector<double> &knotVector, std::vector<NURBSSegment> &segments);
+  void _outputNURBSSegments(const std::vector<NURBSSegment> &segments);
   void _appendVisibleAndPrintable(librevenge::RVNGPropertyList &propList);
   void _bulletFromParaFormat(VSDBullet &bullet, const VSDParaStyle &paraStyle);
   void _listLevelFromBullet(librevenge::RVNGPropertyList &propList, const VSDBullet &bullet);
   void _fillParagraphProperties(librevenge::RVNGPropertyList &propList, const VSDParaStyle &style);
   void _fillTabSet(librevenge::RVNGPropertyList &propList, const VSDTabSet &tabSet);
   void _fillCharProperties(librevenge::RVNGPropertyList &propList, const VSDCharStyle &style);
+  void _insertText(librevenge::RVNGString &text, std::vector<unsigned char> &characters, TextFormat format);
+  const librevenge::RVNGPropertyList &_getSpanProperties(const VSDCharStyle &style);
+  const ParagraphProperties &_getParagraphProperties(const VSDParaStyle &style, const VSDTabSet &tabSet);
   void _convertToPath(const std::vector<librevenge::RVNGPropertyList> &segmentVector,
                       librevenge::RVNGPropertyListVector &path, double rounding);
 
@@ -271,16 +350,26 @@ private:
   VSDOutputElementList *m_shapeOutputDrawing, *m_shapeOutputText;
   std::map<unsigned, VSDOutputElementList> m_pageOutputDrawing;
   std::map<unsigned, VSDOutputElementList> m_pageOutputText;
+  std::shared_ptr<VSDOutputElementArena> m_pageArena;
+  unsigned long m_pageElementCount;
   std::vector<std::list<unsigned> > &m_documentPageShapeOrders;
   std::vector<std::list<unsigned> >::iterator m_pageShapeOrder;
   bool m_isFirstGeometry;
 
   std::map<unsigned, NURBSData> m_NURBSData;
   std::map<unsigned, PolylineData> m_polylineData;
+  std::map<NURBSCacheKey, NURBSCacheEntry> m_NURBSCache;
+  unsigned long m_NURBSCachePoints;
+  // Resolved text properties, shared by all text runs of the document with the same formatting
+  std::map<SpanPropertiesKey, librevenge::RVNGPropertyList> m_spanPropertiesCache;
+  std::map<ParagraphPropertiesKey, ParagraphProperties> m_paragraphPropertiesCache;
   libvisio::VSDName m_currentText;
+  // Buffers reused by _flushText for the UTF-8 text and its pieces
+  std::string m_textBuffer;
+  std::string m_textPiece;
   std::map<unsigned, librevenge::RVNGString> m_names, m_stencilNames;
   std::vector<librevenge::RVNGString> m_fields;
-  VSDFieldList m_stencilFields;
+  const VSDFieldList *m_stencilFields;
   unsigned m_fieldIndex;
   std::vector<VSDCharStyle> m_charFormats;
   std::vector<VSDParaStyle> m_paraFormats;
@@ -295,7 +384,7 @@ private:
   unsigned m_currentStyleSheet;
   VSDStyles m_styles;
 
-  VSDStencils m_stencils;
+  const VSDStencils &m_stencils;
   const VSDShape *m_stencilShape;
   bool m_isStencilStarted;
 
@@ -322,6 +411,9 @@ private:
   std::vector<VSDTabSet> m_tabSets;
 
   const VSDXTheme *m_documentTheme;
+  VSDParseLimits m_limits;
+  VSDParseProgress *m_progress;
+  VSDParseStats *m_stats;
 };
 
 } // namespace libvisio
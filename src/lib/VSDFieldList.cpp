@@ -11,6 +11,9 @@
 
 #include <time.h>
 #include <cmath>
+#include <stdio.h>
+#include <string.h>
+#include <boost/spirit/include/qi.hpp>
 #include "VSDCollector.h"
 #include "libvisio_utils.h"
 
@@ -59,15 +62,27 @@ librevenge::RVNGString libvisio::VSDNumericField::datetimeToString(const char *f
   librevenge::RVNGString result;
   char buffer[MAX_BUFFER];
   auto timer = (time_t)(86400 * datetime - 2209161600.0);
-  const struct tm *const time = gmtime(&timer);
-  if (time)
+  struct tm time;
+  if (getUTCTime(timer, time))
   {
-    strftime(&buffer[0], MAX_BUFFER-1, format, time);
+    strftime(&buffer[0], MAX_BUFFER-1, format, &time);
     result.append(&buffer[0]);
   }
   return result;
 }
 
+// The decimal point of the current locale, found the way sprintf uses it.
+// Unlike localeconv, this does not share a buffer with other threads.
+static std::string getDecimalPoint()
+{
+  char buffer[16];
+  snprintf(buffer, sizeof(buffer), "%.1f", 0.5);
+  const size_t length = strlen(buffer);
+  if (length < 3)
+    return ".";
+  return std::string(buffer + 1, length - 2);
+}
+
 // This method is copied from:
 // https://sourceforge.net/p/libwpd/librevenge/ci/master/tree/src/lib/RVNGProperty.cpp#l35
 // to avoid ABI breakage. If upstream file was modified, please update method accordingly.
@@ -78,11 +93,7 @@ static librevenge::RVNGString doubleToString(const double value, const char *for
     tempString.sprintf(format, 0.0, postfix);
   else
     tempString.sprintf(format, value, postfix);
-#ifndef __ANDROID__
-  std::string decimalPoint(localeconv()->decimal_point);
-#else
-  std::string decimalPoint(".");
-#endif
+  const std::string decimalPoint(getDecimalPoint());
   if ((decimalPoint.size() == 0) || (decimalPoint == "."))
     return tempString;
   std::string stringValue(tempString.cstr());
@@ -539,7 +550,7 @@ void libvisio::VSDFieldList::clear()
   m_elementsOrder.clear();
 }
 
-libvisio::VSDFieldListElement *libvisio::VSDFieldList::getElement(unsigned index)
+libvisio::VSDFieldListElement *libvisio::VSDFieldList::getElement(unsigned index) const
 {
   if (m_elementsOrder.size() > index)
     index = m_elementsOrder[index];
@@ -550,4 +561,25 @@ libvisio::VSDFieldListElement *libvisio::VSDFieldList::getElement(unsigned index
   else
     return nullptr;
 }
+
+bool libvisio::parseFormatId(const char *formatString, unsigned short &result)
+{
+  using namespace boost::spirit::qi;
+
+  result = 0xffff;
+
+  uint_parser<unsigned short,10,1,5> ushort5;
+  auto first = formatString;
+  const auto last = first + strlen(formatString);
+  if (phrase_parse(first, last,
+                   (
+                     "{<" >> ushort5 >> ">}"
+                     | "esc(" >> ushort5 >> ')'
+                   ),
+                   space, result))
+  {
+    return first == last;
+  }
+  return false;
+}
 /* vim:set shiftwidth=2 softtabstop=2 expandtab: */
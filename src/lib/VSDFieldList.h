@@ -15,6 +15,7 @@
 #include <map>
 #include <librevenge/librevenge.h>
 #include "VSDDocumentStructure.h"
+#include "VSDIdMap.h"
 #include "VSDTypes.h"
 
 namespace libvisio
@@ -106,13 +107,16 @@ public:
   {
     return (m_elements.empty());
   }
-  VSDFieldListElement *getElement(unsigned index);
+  VSDFieldListElement *getElement(unsigned index) const;
 private:
-  std::map<unsigned, std::unique_ptr<VSDFieldListElement>> m_elements;
+  VSDIdMap<std::unique_ptr<VSDFieldListElement>> m_elements;
   std::vector<unsigned> m_elementsOrder;
   unsigned m_id, m_level;
 };
 
+// Parses a field format given as a string, like "{<12>}" or "esc(12)"
+bool parseFormatId(const char *formatString, unsigned short &result);
+
 } // namespace libvisio
 
 #endif // __VSDFIELDLIST_H__
@@ -0,0 +1,151 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "VSDGeometryFormula.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <boost/spirit/include/qi.hpp>
+
+namespace
+{
+
+class FormulaScanner
+{
+public:
+  explicit FormulaScanner(const char *formula)
+    : m_first(formula), m_last(formula + std::strlen(formula)), m_isFirstArgument(true) {}
+
+  // Estimates the number of arguments, assuming they are separated by commas
+  unsigned long countArguments() const
+  {
+    return (unsigned long)std::count(m_first, m_last, ',') + 1;
+  }
+
+  bool parseLiteral(const char *literal)
+  {
+    skipSpaces();
+    const size_t length = std::strlen(literal);
+    if ((size_t)(m_last - m_first) < length || std::strncmp(m_first, literal, length))
+      return false;
+    m_first += length;
+    return true;
+  }
+
+  // Reads an argument, preceded by an optional comma unless it is the first one
+  template<typename T>
+  bool parseArgument(T &value)
+  {
+    skipSpaces();
+    if (!m_isFirstArgument && m_first != m_last && ',' == *m_first)
+    {
+      ++m_first;
+      skipSpaces();
+    }
+    m_isFirstArgument = false;
+    return parseNumber(value);
+  }
+
+  bool isAtEndOfArguments()
+  {
+    skipSpaces();
+    return m_first != m_last && ')' == *m_first;
+  }
+
+  bool parseEnd()
+  {
+    if (!parseLiteral(")"))
+      return false;
+    skipSpaces();
+    return m_first == m_last;
+  }
+
+private:
+  void skipSpaces()
+  {
+    while (m_first != m_last && std::isspace((unsigned char)*m_first))
+      ++m_first;
+  }
+
+  bool parseNumber(double &value)
+  {
+    return boost::spirit::qi::parse(m_first, m_last, boost::spirit::qi::double_, value);
+  }
+
+  bool parseNumber(int &value)
+  {
+    return boost::spirit::qi::parse(m_first, m_last, boost::spirit::qi::int_, value);
+  }
+
+  const char *m_first;
+  const char *const m_last;
+  bool m_isFirstArgument;
+};
+
+} // anonymous namespace
+
+bool libvisio::parseNURBSFormula(const char *formula, NURBSData &data)
+{
+  FormulaScanner scanner(formula);
+  int degree = 0;
+  int xType = 0;
+  int yType = 0;
+  if (!scanner.parseLiteral("NURBS") || !scanner.parseLiteral("(")
+      || !scanner.parseArgument(data.lastKnot) || !scanner.parseArgument(degree)
+      || !scanner.parseArgument(xType) || !scanner.parseArgument(yType))
+    return false;
+  data.degree = degree;
+  data.xType = xType;
+  data.yType = yType;
+
+  const unsigned long count = scanner.countArguments() / 4;
+  data.points.reserve(count);
+  data.knots.reserve(count);
+  data.weights.reserve(count);
+  do
+  {
+    std::pair<double, double> point;
+    double knot = 0.0;
+    double weight = 0.0;
+    if (!scanner.parseArgument(point.first) || !scanner.parseArgument(point.second)
+        || !scanner.parseArgument(knot) || !scanner.parseArgument(weight))
+      return false;
+    data.points.push_back(point);
+    data.knots.push_back(knot);
+    data.weights.push_back(weight);
+  }
+  while (!scanner.isAtEndOfArguments());
+  return scanner.parseEnd();
+}
+
+bool libvisio::parsePolylineFormula(const char *formula, PolylineData &data)
+{
+  FormulaScanner scanner(formula);
+  int xType = 0;
+  int yType = 0;
+  if (!scanner.parseLiteral("POLYLINE") || !scanner.parseLiteral("(")
+      || !scanner.parseArgument(xType) || !scanner.parseArgument(yType))
+    return false;
+  data.xType = xType;
+  data.yType = yType;
+
+  data.points.reserve(scanner.countArguments() / 2);
+  do
+  {
+    std::pair<double, double> point;
+    if (!scanner.parseArgument(point.first) || !scanner.parseArgument(point.second))
+      return false;
+    data.points.push_back(point);
+  }
+  while (!scanner.isAtEndOfArguments());
+  return scanner.parseEnd();
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
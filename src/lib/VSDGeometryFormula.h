@@ -0,0 +1,34 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __VSDGEOMETRYFORMULA_H__
+#define __VSDGEOMETRYFORMULA_H__
+
+#include "VSDTypes.h"
+
+namespace libvisio
+{
+
+/* Parse the formulas of the geometry cells of VDX and VSDX files,
+ *
+ *   NURBS(lastKnot, degree, xType, yType, x1, y1, knot1, weight1, ...)
+ *   POLYLINE(xType, yType, x1, y1, ...)
+ *
+ * in a single pass over the zero-terminated string. Commas between the
+ * arguments are optional and spaces are allowed around them. On failure,
+ * false is returned and the content of data is unspecified.
+ */
+bool parseNURBSFormula(const char *formula, NURBSData &data);
+bool parsePolylineFormula(const char *formula, PolylineData &data);
+
+} // namespace libvisio
+
+#endif // __VSDGEOMETRYFORMULA_H__
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
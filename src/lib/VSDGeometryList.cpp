@@ -571,20 +571,16 @@ libvisio::VSDGeometryList::VSDGeometryList() :
 }
 
 libvisio::VSDGeometryList::VSDGeometryList(const VSDGeometryList &geomList) :
-  m_elements(),
+  m_elements(geomList.m_elements),
   m_elementsOrder(geomList.m_elementsOrder)
 {
-  for (auto iter = geomList.m_elements.begin(); iter != geomList.m_elements.end(); ++iter)
-    m_elements[iter->first] = clone(iter->second);
 }
 
 libvisio::VSDGeometryList &libvisio::VSDGeometryList::operator=(const VSDGeometryList &geomList)
 {
   if (this != &geomList)
   {
-    clear();
-    for (auto iter = geomList.m_elements.begin(); iter != geomList.m_elements.end(); ++iter)
-      m_elements[iter->first] = clone(iter->second);
+    m_elements = geomList.m_elements;
     m_elementsOrder = geomList.m_elementsOrder;
   }
   return *this;
@@ -597,7 +593,7 @@ libvisio::VSDGeometryList::~VSDGeometryList()
 void libvisio::VSDGeometryList::addGeometry(unsigned id, unsigned level, const boost::optional<bool> &noFill,
                                             const boost::optional<bool> &noLine, const boost::optional<bool> &noShow)
 {
-  auto *tmpElement = dynamic_cast<VSDGeometry *>(m_elements[id].get());
+  auto *tmpElement = dynamic_cast<VSDGeometry *>(detach(m_elements[id]));
   if (!tmpElement)
   {
     m_elements[id] = make_unique<VSDGeometry>(id, level, noFill, noLine, noShow);
@@ -618,7 +614,7 @@ void libvisio::VSDGeometryList::addEmpty(unsigned id, unsigned level)
 void libvisio::VSDGeometryList::addMoveTo(unsigned id, unsigned level, const boost::optional<double> &x,
                                           const boost::optional<double> &y)
 {
-  auto *tmpElement = dynamic_cast<VSDMoveTo *>(m_elements[id].get());
+  auto *tmpElement = dynamic_cast<VSDMoveTo *>(detach(m_elements[id]));
   if (!tmpElement)
   {
     m_elements[id] = make_unique<VSDMoveTo>(id, level, x, y);
@@ -632,7 +628,7 @@ void libvisio::VSDGeometryList::addMoveTo(unsigned id, unsigned level, const boo
 
 void libvisio::VSDGeometryList::addLineTo(unsigned id, unsigned level, const boost::optional<double> &x, const boost::optional<double> &y)
 {
-  auto *tmpElement = dynamic_cast<VSDLineTo *>(m_elements[id].get());
+  auto *tmpElement = dynamic_cast<VSDLineTo *>(detach(m_elements[id]));
   if (!tmpElement)
   {
     m_elements[id] = make_unique<VSDLineTo>(id, level, x, y);
@@ -647,7 +643,7 @@ void libvisio::VSDGeometryList::addLineTo(unsigned id, unsigned level, const boo
 void libvisio::VSDGeometryList::addArcTo(unsigned id, unsigned level, const boost::optional<double> &x2,
                                          const boost::optional<double> &y2, const boost::optional<double> &bow)
 {
-  auto *tmpElement = dynamic_cast<VSDArcTo *>(m_elements[id].get());
+  auto *tmpElement = dynamic_cast<VSDArcTo *>(detach(m_elements[id]));
   if (!tmpElement)
   {
     m_elements[id] = make_unique<VSDArcTo>(id, level, x2, y2, bow);
@@ -675,7 +671,7 @@ void libvisio::VSDGeometryList::addNURBSTo(unsigned id, unsigned level, const bo
                                            const boost::optional<double> &knot, const boost::optional<double> &knotPrev, const boost::optional<double> &weight,
                                            const boost::optional<double> &weightPrev, const boost::optional<NURBSData> &data)
 {
-  auto *tmpElement = dynamic_cast<VSDNURBSTo3 *>(m_elements[id].get());
+  auto *tmpElement = dynamic_cast<VSDNURBSTo3 *>(detach(m_elements[id]));
   if (!tmpElement)
   {
     m_elements[id] = make_unique<VSDNURBSTo3>(id, level, x2, y2, knot, knotPrev, weight, weightPrev, data);
@@ -705,7 +701,7 @@ void libvisio::VSDGeometryList::addPolylineTo(unsigned id, unsigned level, doubl
 
 void libvisio::VSDGeometryList::addPolylineTo(unsigned id, unsigned level, boost::optional<double> &x, boost::optional<double> &y, boost::optional<PolylineData> &data)
 {
-  auto *tmpElement = dynamic_cast<VSDPolylineTo3 *>(m_elements[id].get());
+  auto *tmpElement = dynamic_cast<VSDPolylineTo3 *>(detach(m_elements[id]));
   if (!tmpElement)
   {
     m_elements[id] = make_unique<VSDPolylineTo3>(id, level, x, y, data);
@@ -722,7 +718,7 @@ void libvisio::VSDGeometryList::addEllipse(unsigned id, unsigned level, const bo
                                            const boost::optional<double> &cy,const boost::optional<double> &xleft, const boost::optional<double> &yleft,
                                            const boost::optional<double> &xtop, const boost::optional<double> &ytop)
 {
-  auto *tmpElement = dynamic_cast<VSDEllipse *>(m_elements[id].get());
+  auto *tmpElement = dynamic_cast<VSDEllipse *>(detach(m_elements[id]));
   if (!tmpElement)
   {
     m_elements[id] = make_unique<VSDEllipse>(id, level, cx, cy, xleft, yleft, xtop, ytop);
@@ -742,7 +738,7 @@ void libvisio::VSDGeometryList::addEllipticalArcTo(unsigned id, unsigned level,
                                                    const boost::optional<double> &y3, const boost::optional<double> &x2, const boost::optional<double> &y2,
                                                    const boost::optional<double> &angle, const boost::optional<double> &ecc)
 {
-  auto *tmpElement = dynamic_cast<VSDEllipticalArcTo *>(m_elements[id].get());
+  auto *tmpElement = dynamic_cast<VSDEllipticalArcTo *>(detach(m_elements[id]));
   if (!tmpElement)
   {
     m_elements[id] = make_unique<VSDEllipticalArcTo>(id, level, x3, y3, x2, y2, angle, ecc);
@@ -762,7 +758,7 @@ void libvisio::VSDGeometryList::addSplineStart(unsigned id, unsigned level, cons
                                                const boost::optional<double> &y, const boost::optional<double> &secondKnot, const boost::optional<double> &firstKnot,
                                                const boost::optional<double> &lastKnot, const boost::optional<unsigned> &degree)
 {
-  auto *tmpElement = dynamic_cast<VSDSplineStart *>(m_elements[id].get());
+  auto *tmpElement = dynamic_cast<VSDSplineStart *>(detach(m_elements[id]));
   if (!tmpElement)
   {
     m_elements[id] = make_unique<VSDSplineStart>(id, level, x, y, secondKnot, firstKnot, lastKnot, degree);
@@ -781,7 +777,7 @@ void libvisio::VSDGeometryList::addSplineStart(unsigned id, unsigned level, cons
 void libvisio::VSDGeometryList::addSplineKnot(unsigned id, unsigned level, const boost::optional<double> &x,
                                               const boost::optional<double> &y, const boost::optional<double> &knot)
 {
-  auto *tmpElement = dynamic_cast<VSDSplineKnot *>(m_elements[id].get());
+  auto *tmpElement = dynamic_cast<VSDSplineKnot *>(detach(m_elements[id]));
   if (!tmpElement)
   {
     m_elements[id] = make_unique<VSDSplineKnot>(id, level, x, y, knot);
@@ -797,7 +793,7 @@ void libvisio::VSDGeometryList::addSplineKnot(unsigned id, unsigned level, const
 void libvisio::VSDGeometryList::addInfiniteLine(unsigned id, unsigned level, const boost::optional<double> &x1,
                                                 const boost::optional<double> &y1, const boost::optional<double> &x2, const boost::optional<double> &y2)
 {
-  auto *tmpElement = dynamic_cast<VSDInfiniteLine *>(m_elements[id].get());
+  auto *tmpElement = dynamic_cast<VSDInfiniteLine *>(detach(m_elements[id]));
   if (!tmpElement)
   {
     m_elements[id] = make_unique<VSDInfiniteLine>(id, level, x1, y1, x2, y2);
@@ -815,7 +811,7 @@ void libvisio::VSDGeometryList::addRelCubBezTo(unsigned id, unsigned level, cons
                                                const boost::optional<double> &y, const boost::optional<double> &a, const boost::optional<double> &b,
                                                const boost::optional<double> &c, const boost::optional<double> &d)
 {
-  auto *tmpElement = dynamic_cast<VSDRelCubBezTo *>(m_elements[id].get());
+  auto *tmpElement = dynamic_cast<VSDRelCubBezTo *>(detach(m_elements[id]));
   if (!tmpElement)
   {
     m_elements[id] = make_unique<VSDRelCubBezTo>(id, level, x, y, a, b, c, d);
@@ -835,7 +831,7 @@ void libvisio::VSDGeometryList::addRelEllipticalArcTo(unsigned id, unsigned leve
                                                       const boost::optional<double> &y3, const boost::optional<double> &x2, const boost::optional<double> &y2,
                                                       const boost::optional<double> &angle, const boost::optional<double> &ecc)
 {
-  auto *tmpElement = dynamic_cast<VSDRelEllipticalArcTo *>(m_elements[id].get());
+  auto *tmpElement = dynamic_cast<VSDRelEllipticalArcTo *>(detach(m_elements[id]));
   if (!tmpElement)
   {
     m_elements[id] = make_unique<VSDRelEllipticalArcTo>(id, level, x3, y3, x2, y2, angle, ecc);
@@ -853,7 +849,7 @@ void libvisio::VSDGeometryList::addRelEllipticalArcTo(unsigned id, unsigned leve
 
 void libvisio::VSDGeometryList::addRelMoveTo(unsigned id, unsigned level, const boost::optional<double> &x, const boost::optional<double> &y)
 {
-  auto *tmpElement = dynamic_cast<VSDRelMoveTo *>(m_elements[id].get());
+  auto *tmpElement = dynamic_cast<VSDRelMoveTo *>(detach(m_elements[id]));
   if (!tmpElement)
   {
     m_elements[id] = make_unique<VSDRelMoveTo>(id, level, x, y);
@@ -867,7 +863,7 @@ void libvisio::VSDGeometryList::addRelMoveTo(unsigned id, unsigned level, const
 
 void libvisio::VSDGeometryList::addRelLineTo(unsigned id, unsigned level, const boost::optional<double> &x, const boost::optional<double> &y)
 {
-  auto *tmpElement = dynamic_cast<VSDRelLineTo *>(m_elements[id].get());
+  auto *tmpElement = dynamic_cast<VSDRelLineTo *>(detach(m_elements[id]));
   if (!tmpElement)
   {
     m_elements[id] = make_unique<VSDRelLineTo>(id, level, x, y);
@@ -881,7 +877,7 @@ void libvisio::VSDGeometryList::addRelLineTo(unsigned id, unsigned level, const
 
 void libvisio::VSDGeometryList::addRelQuadBezTo(unsigned id, unsigned level, const boost::optional<double> &x, const boost::optional<double> &y, const boost::optional<double> &a, const boost::optional<double> &b)
 {
-  auto *tmpElement = dynamic_cast<VSDRelQuadBezTo *>(m_elements[id].get());
+  auto *tmpElement = dynamic_cast<VSDRelQuadBezTo *>(detach(m_elements[id]));
   if (!tmpElement)
   {
     m_elements[id] = make_unique<VSDRelQuadBezTo>(id, level, x, y, a, b);
@@ -917,18 +913,9 @@ void libvisio::VSDGeometryList::handle(VSDCollector *collector) const
   }
   else
   {
-    std::vector<unsigned> tmpVector;
-
+    // the elements are sorted by id already
     for (auto iter = m_elements.begin(); iter != m_elements.end(); ++iter)
-      tmpVector.push_back(iter->first);
-    std::sort(tmpVector.begin(), tmpVector.end());
-
-    for (unsigned int i : tmpVector)
-    {
-      auto iter = m_elements.find(i);
-      if (iter != m_elements.end())
-        iter->second->handle(collector);
-    }
+      iter->second->handle(collector);
   }
   collector->collectSplineEnd();
 }
@@ -954,8 +941,10 @@ libvisio::VSDGeometryListElement *libvisio::VSDGeometryList::getElement(unsigned
 void libvisio::VSDGeometryList::resetLevel(unsigned level)
 {
   for (auto &element : m_elements)
-    element.second->setLevel(level);
-
+  {
+    if (element.second && element.second->getLevel() != level)
+      detach(element.second)->setLevel(level);
+  }
 }
 
 /* vim:set shiftwidth=2 softtabstop=2 expandtab: */
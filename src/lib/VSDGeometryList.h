@@ -10,12 +10,12 @@
 #ifndef __VSDGEOMETRYLIST_H__
 #define __VSDGEOMETRYLIST_H__
 
-#include <map>
 #include <memory>
 #include <vector>
 #include <functional>
 #include <algorithm>
 #include <boost/optional.hpp>
+#include "VSDIdMap.h"
 #include "VSDTypes.h"
 
 namespace libvisio
@@ -39,6 +39,10 @@ public:
   {
     m_level = level;
   }
+  unsigned getLevel() const
+  {
+    return m_level;
+  }
 protected:
   unsigned m_id;
   unsigned m_level;
@@ -111,7 +115,8 @@ public:
   }
   void resetLevel(unsigned level);
 private:
-  std::map<unsigned, std::unique_ptr<VSDGeometryListElement>> m_elements;
+  // Elements are shared between copies of the list; see detach()
+  VSDIdMap<std::shared_ptr<VSDGeometryListElement>> m_elements;
   std::vector<unsigned> m_elementsOrder;
 };
 
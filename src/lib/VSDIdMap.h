@@ -0,0 +1,153 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __VSDIDMAP_H__
+#define __VSDIDMAP_H__
+
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace libvisio
+{
+
+/* Maps the ids of the rows of a list, which are small and mostly dense,
+ * to their elements.
+ *
+ * The elements are kept in a vector sorted by id, so that iterating over
+ * them walks contiguous memory. When the ids are consecutive, a lookup
+ * takes a single comparison; otherwise it is a binary search. Rows mostly
+ * arrive in the order of their ids, so insertions are appends. The few
+ * that do not are kept aside in a std::map and merged into the vector when
+ * the map is next read, so that rows arriving in any order cost O(log n)
+ * each, like with std::map.
+ *
+ * Unlike with std::map, an insertion invalidates all iterators and
+ * references, and so does a read after an insertion out of order, even by
+ * the const members. Thus a map may only be read from several threads at
+ * once after it has been read once.
+ */
+template<typename T>
+class VSDIdMap
+{
+public:
+  typedef std::pair<unsigned, T> value_type;
+  typedef typename std::vector<value_type>::iterator iterator;
+  typedef typename std::vector<value_type>::const_iterator const_iterator;
+
+  VSDIdMap() : m_elements(), m_pending() {}
+
+  iterator begin()
+  {
+    merge();
+    return m_elements.begin();
+  }
+  iterator end()
+  {
+    merge();
+    return m_elements.end();
+  }
+  const_iterator begin() const
+  {
+    merge();
+    return m_elements.begin();
+  }
+  const_iterator end() const
+  {
+    merge();
+    return m_elements.end();
+  }
+  bool empty() const
+  {
+    return m_elements.empty() && m_pending.empty();
+  }
+  size_t size() const
+  {
+    return m_elements.size() + m_pending.size();
+  }
+  void clear()
+  {
+    m_elements.clear();
+    m_pending.clear();
+  }
+
+  iterator find(unsigned id)
+  {
+    merge();
+    const size_t pos = lowerBound(id);
+    return pos < m_elements.size() && m_elements[pos].first == id ? m_elements.begin() + pos : m_elements.end();
+  }
+  const_iterator find(unsigned id) const
+  {
+    merge();
+    const size_t pos = lowerBound(id);
+    return pos < m_elements.size() && m_elements[pos].first == id ? m_elements.begin() + pos : m_elements.end();
+  }
+
+  T &operator[](unsigned id)
+  {
+    if (m_pending.empty() && (m_elements.empty() || m_elements.back().first < id))
+    {
+      m_elements.push_back(value_type(id, T()));
+      return m_elements.back().second;
+    }
+    const size_t pos = lowerBound(id);
+    if (pos < m_elements.size() && m_elements[pos].first == id)
+      return m_elements[pos].second;
+    return m_pending[id];
+  }
+
+private:
+  size_t lowerBound(unsigned id) const
+  {
+    if (m_elements.empty() || m_elements.back().first < id)
+      return m_elements.size();
+    const unsigned first = m_elements.front().first;
+    if (id <= first)
+      return 0;
+    if (id - first < m_elements.size() && m_elements[id - first].first == id)
+      return id - first;
+    return size_t(std::lower_bound(m_elements.begin(), m_elements.end(), id, compareId) - m_elements.begin());
+  }
+
+  static bool compareId(const value_type &element, unsigned id)
+  {
+    return element.first < id;
+  }
+
+  // Moves the elements inserted out of order into the vector
+  void merge() const
+  {
+    if (m_pending.empty())
+      return;
+    std::vector<value_type> merged;
+    merged.reserve(m_elements.size() + m_pending.size());
+    auto element = m_elements.begin();
+    for (auto &pending : m_pending)
+    {
+      for (; element != m_elements.end() && element->first < pending.first; ++element)
+        merged.push_back(std::move(*element));
+      merged.push_back(value_type(pending.first, std::move(pending.second)));
+    }
+    for (; element != m_elements.end(); ++element)
+      merged.push_back(std::move(*element));
+    m_elements.swap(merged);
+    m_pending.clear();
+  }
+
+  mutable std::vector<value_type> m_elements;
+  // The elements inserted out of order, whose ids are not in m_elements
+  mutable std::map<unsigned, T> m_pending;
+};
+
+} // namespace libvisio
+
+#endif // __VSDIDMAP_H__
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
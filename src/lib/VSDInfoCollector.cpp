@@ -0,0 +1,89 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "VSDInfoCollector.h"
+
+#include "libvisio_utils.h"
+
+libvisio::VSDInfoCollector::VSDInfoCollector()
+  : m_isPageStarted(false), m_currentPage(), m_pages(), m_metaData(),
+    m_masterCount(0), m_imageCount(0)
+{
+}
+
+void libvisio::VSDInfoCollector::collectPageProps(unsigned /* id */, unsigned /* level */, double pageWidth, double pageHeight,
+                                                  double /* shadowOffsetX */, double /* shadowOffsetY */, double scale)
+{
+  // Masters have page sheets too
+  if (!m_isPageStarted)
+    return;
+  m_currentPage.insert("svg:width", scale*pageWidth);
+  m_currentPage.insert("svg:height", scale*pageHeight);
+}
+
+void libvisio::VSDInfoCollector::collectPage(unsigned /* id */, unsigned /* level */, unsigned /* backgroundPageID */, bool isBackgroundPage, const VSDName &pageName)
+{
+  if (!m_isPageStarted)
+    return;
+  if (!pageName.empty())
+  {
+    librevenge::RVNGString name;
+    std::vector<unsigned char> tmpData(pageName.m_data.getDataBuffer(), pageName.m_data.getDataBuffer() + pageName.m_data.size());
+    appendCharacters(name, tmpData, pageName.m_format);
+    m_currentPage.insert("draw:name", name);
+  }
+  m_currentPage.insert("libvisio:background", isBackgroundPage);
+}
+
+void libvisio::VSDInfoCollector::collectMetaData(const librevenge::RVNGPropertyList &metaData)
+{
+  m_metaData = metaData;
+}
+
+void libvisio::VSDInfoCollector::startPage(unsigned /* pageID */)
+{
+  m_currentPage.clear();
+  m_currentPage.insert("svg:width", 0.0);
+  m_currentPage.insert("svg:height", 0.0);
+  m_isPageStarted = true;
+}
+
+void libvisio::VSDInfoCollector::endPage()
+{
+  if (!m_isPageStarted)
+    return;
+  m_pages.append(m_currentPage);
+  m_currentPage.clear();
+  m_isPageStarted = false;
+}
+
+void libvisio::VSDInfoCollector::collectMaster()
+{
+  ++m_masterCount;
+}
+
+void libvisio::VSDInfoCollector::collectImage()
+{
+  ++m_imageCount;
+}
+
+void libvisio::VSDInfoCollector::getInfo(librevenge::RVNGPropertyList &info) const
+{
+  librevenge::RVNGPropertyList::Iter i(m_metaData);
+  for (i.rewind(); i.next();)
+  {
+    if (!i.child())
+      info.insert(i.key(), i()->clone());
+  }
+  info.insert("libvisio:pages", m_pages);
+  info.insert("libvisio:masters", (int)m_masterCount);
+  info.insert("libvisio:images", (int)m_imageCount);
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -11,7 +11,10 @@
 
 #include <string.h>
 
-VSDInternalStream::VSDInternalStream(librevenge::RVNGInputStream *input, unsigned long size, bool compressed) :
+/* A non-zero maxSize bounds the size of the decompressed data; the rest
+ * of the stream is dropped.
+ */
+VSDInternalStream::VSDInternalStream(librevenge::RVNGInputStream *input, unsigned long size, bool compressed, unsigned long maxSize) :
   librevenge::RVNGInputStream(),
   m_offset(0),
   m_buffer()
@@ -25,6 +28,8 @@ VSDInternalStream::VSDInternalStream(librevenge::RVNGInputStream *input, unsigne
 
   if (!compressed)
   {
+    if (maxSize && tmpNumBytesRead > maxSize)
+      tmpNumBytesRead = maxSize;
     m_buffer.assign(tmpBuffer, tmpBuffer + tmpNumBytesRead);
   }
   else
@@ -33,14 +38,14 @@ VSDInternalStream::VSDInternalStream(librevenge::RVNGInputStream *input, unsigne
     unsigned pos = 0;
     unsigned offset = 0;
 
-    while (offset < tmpNumBytesRead)
+    while (offset < tmpNumBytesRead && (!maxSize || m_buffer.size() < maxSize))
     {
       unsigned flag = tmpBuffer[offset++];
       if (offset > tmpNumBytesRead-1)
         break;
 
       unsigned mask = 1;
-      for (unsigned bit = 0; bit < 8 && offset < tmpNumBytesRead; ++bit)
+      for (unsigned bit = 0; bit < 8 && offset < tmpNumBytesRead && (!maxSize || m_buffer.size() < maxSize); ++bit)
       {
         if (flag & mask)
         {
@@ -62,6 +67,8 @@ VSDInternalStream::VSDInternalStream(librevenge::RVNGInputStream *input, unsigne
           else
             pointer += 18;
 
+          if (maxSize && m_buffer.size() + length > maxSize)
+            length = maxSize - m_buffer.size();
           for (unsigned j = 0; j < length; ++j)
           {
             buffer[(pos+j) & 4095] = buffer[(pointer+j) & 4095];
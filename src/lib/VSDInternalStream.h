@@ -18,7 +18,7 @@
 class VSDInternalStream : public librevenge::RVNGInputStream
 {
 public:
-  VSDInternalStream(librevenge::RVNGInputStream *input, unsigned long size, bool compressed=false);
+  VSDInternalStream(librevenge::RVNGInputStream *input, unsigned long size, bool compressed=false, unsigned long maxSize=0);
   ~VSDInternalStream() override {}
 
   bool isStructured() override
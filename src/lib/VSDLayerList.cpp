@@ -67,10 +67,10 @@ void libvisio::VSDLayerList::addLayer(unsigned id, const libvisio::VSDLayer &lay
 
 const libvisio::Colour *libvisio::VSDLayerList::getColour(const std::vector<unsigned> &ids)
 {
-  std::map<unsigned, libvisio::VSDLayer>::const_iterator iterColour = m_elements.end();
+  auto iterColour = m_elements.end();
   for (unsigned int id : ids)
   {
-    std::map<unsigned, libvisio::VSDLayer>::const_iterator iterMap = m_elements.find(id);
+    auto iterMap = m_elements.find(id);
     // It is enough that one layer does not override colour and the original colour is used
     if (iterMap == m_elements.end() || !iterMap->second.m_colour)
       return nullptr;
@@ -93,7 +93,7 @@ bool libvisio::VSDLayerList::getVisible(const std::vector<unsigned> &ids)
 
   for (unsigned int id : ids)
   {
-    std::map<unsigned, libvisio::VSDLayer>::const_iterator iterMap = m_elements.find(id);
+    auto iterMap = m_elements.find(id);
     if (iterMap == m_elements.end())
       return true;
     else if (iterMap->second.m_visible)
@@ -109,7 +109,7 @@ bool libvisio::VSDLayerList::getPrintable(const std::vector<unsigned> &ids)
 
   for (unsigned int id : ids)
   {
-    std::map<unsigned, libvisio::VSDLayer>::const_iterator iterMap = m_elements.find(id);
+    auto iterMap = m_elements.find(id);
     if (iterMap == m_elements.end())
       return true;
     else if (iterMap->second.m_printable)
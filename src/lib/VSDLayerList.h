@@ -10,9 +10,9 @@
 #ifndef __VSDLAYERLIST_H__
 #define __VSDLAYERLIST_H__
 
-#include <map>
 #include <vector>
 #include <boost/optional.hpp>
+#include "VSDIdMap.h"
 #include "VSDTypes.h"
 
 namespace libvisio
@@ -47,7 +47,7 @@ public:
   bool getPrintable(const std::vector<unsigned> &ids);
 
 private:
-  std::map<unsigned, VSDLayer> m_elements;
+  VSDIdMap<VSDLayer> m_elements;
 };
 
 
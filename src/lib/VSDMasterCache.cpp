@@ -0,0 +1,95 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "VSDMasterCache.h"
+
+#include <cstring>
+#include <tuple>
+#include <boost/functional/hash.hpp>
+#include <libvisio/libvisio.h>
+
+bool libvisio::operator<(const VSDMasterCacheKey &left, const VSDMasterCacheKey &right)
+{
+  return std::tie(left.masterId, left.level, left.isTextOnly, left.maxNestingDepth)
+         < std::tie(right.masterId, right.level, right.isTextOnly, right.maxNestingDepth);
+}
+
+libvisio::VSDMasterCache::VSDMasterCache(unsigned long maxBytes)
+  : m_maxBytes(maxBytes), m_bytes(0), m_entries(), m_uses(), m_mutex()
+{
+}
+
+bool libvisio::VSDMasterCache::find(const VSDMasterCacheKey &key, const librevenge::RVNGBinaryData &content, VSDStencil &stencil)
+{
+  const EntryKey entryKey(key, hash(content));
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_entries.find(entryKey);
+  if (it == m_entries.end())
+    return false;
+  const librevenge::RVNGBinaryData &cachedContent = it->second.content;
+  if (cachedContent.size() != content.size()
+      || (content.size() && std::memcmp(cachedContent.getDataBuffer(), content.getDataBuffer(), content.size())))
+    return false;
+  m_uses.splice(m_uses.begin(), m_uses, it->second.use);
+  stencil = it->second.stencil;
+  return true;
+}
+
+void libvisio::VSDMasterCache::insert(const VSDMasterCacheKey &key, const librevenge::RVNGBinaryData &content, const VSDStencil &stencil)
+{
+  if (content.size() > m_maxBytes)
+    return;
+  const EntryKey entryKey(key, hash(content));
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_entries.find(entryKey);
+  if (it != m_entries.end())
+  {
+    // Either another thread has parsed the same master, or the hashes collide
+    m_uses.splice(m_uses.begin(), m_uses, it->second.use);
+    return;
+  }
+
+  while (!m_uses.empty() && m_bytes + content.size() > m_maxBytes)
+  {
+    auto oldest = m_entries.find(m_uses.back());
+    m_bytes -= oldest->second.content.size();
+    m_entries.erase(oldest);
+    m_uses.pop_back();
+  }
+
+  m_uses.push_front(entryKey);
+  Entry &entry = m_entries[entryKey];
+  entry.content = content;
+  entry.stencil = stencil;
+  entry.use = m_uses.begin();
+  m_bytes += content.size();
+}
+
+void libvisio::VSDMasterCache::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_entries.clear();
+  m_uses.clear();
+  m_bytes = 0;
+}
+
+std::size_t libvisio::VSDMasterCache::hash(const librevenge::RVNGBinaryData &content)
+{
+  const unsigned char *const buffer = content.getDataBuffer();
+  if (!buffer)
+    return 0;
+  return boost::hash_range(buffer, buffer + content.size());
+}
+
+libvisio::VSDMasterCache *libvisio::getMasterCacheImpl(const VisioMasterCache &cache)
+{
+  return cache.m_impl.get();
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
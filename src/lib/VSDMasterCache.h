@@ -0,0 +1,89 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __VSDMASTERCACHE_H__
+#define __VSDMASTERCACHE_H__
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <librevenge/librevenge.h>
+#include "VSDStencils.h"
+
+namespace libvisio
+{
+
+/* Identifies the parse of a master part: besides the XML of the part, the
+ * result depends on the master and on how the document is parsed.
+ */
+struct VSDMasterCacheKey
+{
+  VSDMasterCacheKey()
+    : masterId(), level(0), isTextOnly(false), maxNestingDepth(0) {}
+
+  std::string masterId; // BaseID and UniqueID of the master
+  int level; // depth of the part in the document
+  bool isTextOnly;
+  unsigned maxNestingDepth;
+};
+
+bool operator<(const VSDMasterCacheKey &left, const VSDMasterCacheKey &right);
+
+class VisioMasterCache;
+class VSDMasterCache;
+
+// Returns the implementation of a cache given in VisioParseOptions
+VSDMasterCache *getMasterCacheImpl(const VisioMasterCache &cache);
+
+/* The implementation of VisioMasterCache.
+ *
+ * The masters are stored with a copy of the XML they were parsed from,
+ * which is compared with the XML of the part before a master is returned,
+ * so that a hash collision cannot return the wrong master. The shapes of
+ * a returned copy share their elements with the cached ones; these are
+ * never changed, as the lists only change elements they own alone.
+ */
+class VSDMasterCache
+{
+public:
+  explicit VSDMasterCache(unsigned long maxBytes);
+
+  // Copies the master parsed from content into stencil; returns false if it is not cached
+  bool find(const VSDMasterCacheKey &key, const librevenge::RVNGBinaryData &content, VSDStencil &stencil);
+  void insert(const VSDMasterCacheKey &key, const librevenge::RVNGBinaryData &content, const VSDStencil &stencil);
+  void clear();
+
+private:
+  typedef std::pair<VSDMasterCacheKey, std::size_t> EntryKey;
+
+  struct Entry
+  {
+    librevenge::RVNGBinaryData content;
+    VSDStencil stencil;
+    std::list<EntryKey>::iterator use;
+  };
+
+  VSDMasterCache(const VSDMasterCache &);
+  VSDMasterCache &operator=(const VSDMasterCache &);
+
+  static std::size_t hash(const librevenge::RVNGBinaryData &content);
+
+  const unsigned long m_maxBytes;
+  unsigned long m_bytes;
+  std::map<EntryKey, Entry> m_entries;
+  std::list<EntryKey> m_uses; // the most recently used first
+  std::mutex m_mutex;
+};
+
+} // namespace libvisio
+
+#endif // __VSDMASTERCACHE_H__
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
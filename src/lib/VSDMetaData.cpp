@@ -271,11 +271,11 @@ librevenge::RVNGString libvisio::VSDMetaData::readCodePageString(librevenge::RVN
     {
     case 1252:
       // http://msdn.microsoft.com/en-us/goglobal/bb964654
-      conv = ucnv_open("windows-1252", &status);
+      conv = getConverter("windows-1252");
       break;
     }
 
-    if (U_SUCCESS(status) && conv)
+    if (conv)
     {
       assert(!characters.empty());
       const auto *src = (const char *)&characters[0];
@@ -287,9 +287,6 @@ librevenge::RVNGString libvisio::VSDMetaData::readCodePageString(librevenge::RVN
           appendUCS4(string, ucs4Character);
       }
     }
-
-    if (conv)
-      ucnv_close(conv);
   }
 
   return string;
@@ -331,12 +328,12 @@ bool libvisio::VSDMetaData::parseTimes(librevenge::RVNGInputStream *input)
   // modifiedTime is number of 100ns since Jan 1 1601
   const uint64_t epoch = uint64_t(116444736UL) * 100;
   time_t sec = (modifiedTime / 10000000) - epoch;
-  const struct tm *time = localtime(&sec);
-  if (time)
+  struct tm time;
+  if (getUTCTime(sec, time))
   {
     static const int MAX_BUFFER = 1024;
     char buffer[MAX_BUFFER];
-    strftime(&buffer[0], MAX_BUFFER-1, "%Y-%m-%dT%H:%M:%SZ", time);
+    strftime(&buffer[0], MAX_BUFFER-1, "%Y-%m-%dT%H:%M:%SZ", &time);
     librevenge::RVNGString result;
     result.append(buffer);
     // Visio UI uses modifiedTime for both purposes.
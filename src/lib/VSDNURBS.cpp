@@ -0,0 +1,167 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "VSDNURBS.h"
+
+#include <algorithm>
+#include <cmath>
+
+#define LIBVISIO_EPSILON 1E-10
+
+#define VSD_NURBS_MIN_SUBDIVISION_DEPTH 2
+#define VSD_NURBS_MAX_SUBDIVISION_DEPTH 10
+
+namespace
+{
+
+double distanceFromChord(const std::pair<double, double> &point, const std::pair<double, double> &start, const std::pair<double, double> &end)
+{
+  const double dx = end.first - start.first;
+  const double dy = end.second - start.second;
+  const double length = hypot(dx, dy);
+  if (length <= LIBVISIO_EPSILON)
+    return hypot(point.first - start.first, point.second - start.second);
+  return fabs(dy * (point.first - start.first) - dx * (point.second - start.second)) / length;
+}
+
+void subdivideNURBS(libvisio::NURBSEvaluator &evaluator, double u0, const std::pair<double, double> &p0, double u1, const std::pair<double, double> &p1,
+                    double tolerance, unsigned depth, std::vector<libvisio::NURBSSegment> &segments)
+{
+  const double um = (u0 + u1) / 2.0;
+  const std::pair<double, double> pm = evaluator.evaluate(um);
+  if (depth >= VSD_NURBS_MAX_SUBDIVISION_DEPTH ||
+      (depth >= VSD_NURBS_MIN_SUBDIVISION_DEPTH && distanceFromChord(pm, p0, p1) <= tolerance))
+  {
+    libvisio::NURBSSegment segment;
+    segment.degree = 1;
+    segment.points[0] = p1;
+    segments.push_back(segment);
+    return;
+  }
+  subdivideNURBS(evaluator, u0, p0, um, pm, tolerance, depth + 1, segments);
+  subdivideNURBS(evaluator, um, pm, u1, p1, tolerance, depth + 1, segments);
+}
+
+} // anonymous namespace
+
+unsigned libvisio::findNURBSSpan(unsigned lastCtrlPoint, unsigned degree, double u, const std::vector<double> &knotVector)
+{
+  if (u >= knotVector[lastCtrlPoint+1])
+  {
+    unsigned span = lastCtrlPoint;
+    while (span > degree && !(knotVector[span] < knotVector[span+1]))
+      span--;
+    return span;
+  }
+  if (u <= knotVector[degree])
+  {
+    unsigned span = degree;
+    while (span < lastCtrlPoint && !(knotVector[span] < knotVector[span+1]))
+      span++;
+    return span;
+  }
+  unsigned low = degree;
+  unsigned high = lastCtrlPoint+1;
+  unsigned mid = (low + high) / 2;
+  while (u < knotVector[mid] || u >= knotVector[mid+1])
+  {
+    if (u < knotVector[mid])
+      high = mid;
+    else
+      low = mid;
+    mid = (low + high) / 2;
+  }
+  return mid;
+}
+
+void libvisio::computeNURBSBasis(unsigned span, unsigned degree, double u, const std::vector<double> &knotVector,
+                                 std::vector<double> &basis, std::vector<double> &left, std::vector<double> &right)
+{
+  basis[0] = 1.0;
+  for (unsigned j = 1; j <= degree; j++)
+  {
+    left[j] = u - knotVector[span+1-j];
+    right[j] = knotVector[span+j] - u;
+    double saved = 0.0;
+    for (unsigned r = 0; r < j; r++)
+    {
+      const double denominator = right[r+1] + left[j-r];
+      const double temp = fabs(denominator) > LIBVISIO_EPSILON ? basis[r] / denominator : 0.0;
+      basis[r] = saved + right[r+1] * temp;
+      saved = left[j-r] * temp;
+    }
+    basis[j] = saved;
+  }
+}
+
+libvisio::NURBSEvaluator::NURBSEvaluator(unsigned degree, const std::vector<std::pair<double, double> > &controlPoints,
+                                         const std::vector<double> &knotVector, const std::vector<double> &weights)
+  : m_degree(degree), m_controlPoints(controlPoints), m_knotVector(knotVector), m_weights(weights),
+    m_lastCtrlPoint((unsigned)std::min(controlPoints.size(), weights.size()) - 1),
+    m_basis(degree + 1), m_left(degree + 1), m_right(degree + 1)
+{
+}
+
+std::pair<double, double> libvisio::NURBSEvaluator::evaluate(double u)
+{
+  const unsigned span = findNURBSSpan(m_lastCtrlPoint, m_degree, u, m_knotVector);
+  computeNURBSBasis(span, m_degree, u, m_knotVector, m_basis, m_left, m_right);
+  double x = 0.0;
+  double y = 0.0;
+  double denominator = 0.0;
+  for (unsigned j = 0; j <= m_degree; j++)
+  {
+    const unsigned p = span - m_degree + j;
+    const double weightedBasis = m_basis[j] * m_weights[p];
+    x += weightedBasis * m_controlPoints[p].first;
+    y += weightedBasis * m_controlPoints[p].second;
+    denominator += weightedBasis;
+  }
+  if (fabs(denominator) <= LIBVISIO_EPSILON)
+    return m_controlPoints[span];
+  return std::make_pair(x / denominator, y / denominator);
+}
+
+void libvisio::tessellateNURBS(unsigned degree, const std::vector<std::pair<double, double> > &controlPoints,
+                               const std::vector<double> &knotVector, const std::vector<double> &weights,
+                               double tolerance, const VSDParseLimits &limits, std::vector<NURBSSegment> &segments)
+{
+  const size_t numCtrlPoints = std::min(controlPoints.size(), weights.size());
+  if (!numCtrlPoints)
+    return;
+  if (degree >= numCtrlPoints)
+    degree = (unsigned)numCtrlPoints - 1;
+  if (knotVector.size() < numCtrlPoints + degree + 1)
+    return;
+
+  NURBSEvaluator evaluator(degree, controlPoints, knotVector, weights);
+  // Subdivide every non-empty knot span of the curve's domain until it is flat enough
+  double u0 = knotVector[degree];
+  std::pair<double, double> p0 = evaluator.evaluate(u0);
+  for (size_t i = degree + 1; i <= numCtrlPoints && !limits.isPathFull(segments.size()); i++)
+  {
+    const double u1 = knotVector[i];
+    if (u1 - u0 <= LIBVISIO_EPSILON)
+      continue;
+    const std::pair<double, double> p1 = evaluator.evaluate(u1);
+    if (degree == 1)
+    {
+      NURBSSegment segment;
+      segment.degree = 1;
+      segment.points[0] = p1;
+      segments.push_back(segment);
+    }
+    else
+      subdivideNURBS(evaluator, u0, p0, u1, p1, tolerance, 0, segments);
+    u0 = u1;
+    p0 = p1;
+  }
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
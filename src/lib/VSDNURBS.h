@@ -0,0 +1,73 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __VSDNURBS_H__
+#define __VSDNURBS_H__
+
+#include <utility>
+#include <vector>
+#include "VSDParseLimits.h"
+
+namespace libvisio
+{
+
+// Bezier segment of a NURBS curve in shape-local co-ordinates, without its start point
+struct NURBSSegment
+{
+  NURBSSegment() : degree(0), points() {}
+  unsigned degree;
+  std::pair<double, double> points[3];
+};
+
+/* Iterative evaluation of rational B-spline curves, adapted from the
+ * algorithms FindSpan, BasisFuns and CurvePoint (Les Piegl, Wayne Tiller:
+ * The NURBS Book, 2nd Edition, 1997)
+ */
+
+// Returns the span u lies in; the ends of the domain belong to its first and last non-empty spans
+unsigned findNURBSSpan(unsigned lastCtrlPoint, unsigned degree, double u, const std::vector<double> &knotVector);
+
+/* Computes the degree + 1 basis functions that are non-zero at u into basis.
+ * left and right are scratch space; all three have degree + 1 elements.
+ */
+void computeNURBSBasis(unsigned span, unsigned degree, double u, const std::vector<double> &knotVector,
+                       std::vector<double> &basis, std::vector<double> &left, std::vector<double> &right);
+
+class NURBSEvaluator
+{
+public:
+  NURBSEvaluator(unsigned degree, const std::vector<std::pair<double, double> > &controlPoints,
+                 const std::vector<double> &knotVector, const std::vector<double> &weights);
+
+  std::pair<double, double> evaluate(double u);
+
+private:
+  unsigned m_degree;
+  const std::vector<std::pair<double, double> > &m_controlPoints;
+  const std::vector<double> &m_knotVector;
+  const std::vector<double> &m_weights;
+  unsigned m_lastCtrlPoint;
+  std::vector<double> m_basis;
+  std::vector<double> m_left;
+  std::vector<double> m_right;
+};
+
+/* Appends line segments to segments, which are no further than tolerance
+ * from the curve, subdividing each knot span until it is flat enough. The
+ * knot vector has to be clamped and non-decreasing.
+ */
+void tessellateNURBS(unsigned degree, const std::vector<std::pair<double, double> > &controlPoints,
+                     const std::vector<double> &knotVector, const std::vector<double> &weights,
+                     double tolerance, const VSDParseLimits &limits, std::vector<NURBSSegment> &segments);
+
+} // namespace libvisio
+
+#endif // __VSDNURBS_H__
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
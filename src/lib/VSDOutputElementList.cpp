@@ -9,6 +9,7 @@
 
 #include "VSDOutputElementList.h"
 
+#include <algorithm>
 #include "libvisio_utils.h"
 
 namespace libvisio
@@ -57,568 +58,301 @@ static void separateSpacesAndInsertText(librevenge::RVNGDrawingInterface *iface,
 
 } // anonymous namespace
 
-class VSDOutputElement
-{
-public:
-  VSDOutputElement() {}
-  virtual ~VSDOutputElement() {}
-  virtual void draw(librevenge::RVNGDrawingInterface *painter) = 0;
-  virtual VSDOutputElement *clone() = 0;
-};
-
-
-class VSDStyleOutputElement : public VSDOutputElement
-{
-public:
-  VSDStyleOutputElement(const librevenge::RVNGPropertyList &propList);
-  ~VSDStyleOutputElement() override {}
-  void draw(librevenge::RVNGDrawingInterface *painter) override;
-  VSDOutputElement *clone() override
-  {
-    return new VSDStyleOutputElement(m_propList);
-  }
-private:
-  librevenge::RVNGPropertyList m_propList;
-};
-
-
-class VSDPathOutputElement : public VSDOutputElement
-{
-public:
-  VSDPathOutputElement(const librevenge::RVNGPropertyList &propList);
-  ~VSDPathOutputElement() override {}
-  void draw(librevenge::RVNGDrawingInterface *painter) override;
-  VSDOutputElement *clone() override
-  {
-    return new VSDPathOutputElement(m_propList);
-  }
-private:
-  librevenge::RVNGPropertyList m_propList;
-};
-
-
-class VSDGraphicObjectOutputElement : public VSDOutputElement
-{
-public:
-  VSDGraphicObjectOutputElement(const librevenge::RVNGPropertyList &propList);
-  ~VSDGraphicObjectOutputElement() override {}
-  void draw(librevenge::RVNGDrawingInterface *painter) override;
-  VSDOutputElement *clone() override
-  {
-    return new VSDGraphicObjectOutputElement(m_propList);
-  }
-private:
-  librevenge::RVNGPropertyList m_propList;
-};
-
-
-class VSDStartTextObjectOutputElement : public VSDOutputElement
-{
-public:
-  VSDStartTextObjectOutputElement(const librevenge::RVNGPropertyList &propList);
-  ~VSDStartTextObjectOutputElement() override {}
-  void draw(librevenge::RVNGDrawingInterface *painter) override;
-  VSDOutputElement *clone() override
-  {
-    return new VSDStartTextObjectOutputElement(m_propList);
-  }
-private:
-  librevenge::RVNGPropertyList m_propList;
-};
-
-
-class VSDOpenParagraphOutputElement : public VSDOutputElement
-{
-public:
-  VSDOpenParagraphOutputElement(const librevenge::RVNGPropertyList &propList);
-  ~VSDOpenParagraphOutputElement() override {}
-  void draw(librevenge::RVNGDrawingInterface *painter) override;
-  VSDOutputElement *clone() override
-  {
-    return new VSDOpenParagraphOutputElement(m_propList);
-  }
-private:
-  librevenge::RVNGPropertyList m_propList;
-};
-
-
-class VSDStartLayerOutputElement : public VSDOutputElement
-{
-public:
-  VSDStartLayerOutputElement(const librevenge::RVNGPropertyList &propList);
-  ~VSDStartLayerOutputElement() override {}
-  void draw(librevenge::RVNGDrawingInterface *painter) override;
-  VSDOutputElement *clone() override
-  {
-    return new VSDStartLayerOutputElement(m_propList);
-  }
-private:
-  librevenge::RVNGPropertyList m_propList;
-};
-
-
-class VSDEndLayerOutputElement : public VSDOutputElement
-{
-public:
-  VSDEndLayerOutputElement();
-  ~VSDEndLayerOutputElement() override {}
-  void draw(librevenge::RVNGDrawingInterface *painter) override;
-  VSDOutputElement *clone() override
-  {
-    return new VSDEndLayerOutputElement();
-  }
-};
-
-
-class VSDOpenSpanOutputElement : public VSDOutputElement
-{
-public:
-  VSDOpenSpanOutputElement(const librevenge::RVNGPropertyList &propList);
-  ~VSDOpenSpanOutputElement() override {}
-  void draw(librevenge::RVNGDrawingInterface *painter) override;
-  VSDOutputElement *clone() override
-  {
-    return new VSDOpenSpanOutputElement(m_propList);
-  }
-private:
-  librevenge::RVNGPropertyList m_propList;
-};
-
-
-class VSDInsertTextOutputElement : public VSDOutputElement
-{
-public:
-  VSDInsertTextOutputElement(const librevenge::RVNGString &text);
-  ~VSDInsertTextOutputElement() override {}
-  void draw(librevenge::RVNGDrawingInterface *painter) override;
-  VSDOutputElement *clone() override
-  {
-    return new VSDInsertTextOutputElement(m_text);
-  }
-private:
-  librevenge::RVNGString m_text;
-};
-
-
-class VSDInsertLineBreakOutputElement : public VSDOutputElement
-{
-public:
-  VSDInsertLineBreakOutputElement();
-  ~VSDInsertLineBreakOutputElement() override {}
-  void draw(librevenge::RVNGDrawingInterface *painter) override;
-  VSDOutputElement *clone() override
-  {
-    return new VSDInsertLineBreakOutputElement();
-  }
-};
-
-
-class VSDInsertTabOutputElement : public VSDOutputElement
-{
-public:
-  VSDInsertTabOutputElement();
-  ~VSDInsertTabOutputElement() override {}
-  void draw(librevenge::RVNGDrawingInterface *painter) override;
-  VSDOutputElement *clone() override
-  {
-    return new VSDInsertTabOutputElement();
-  }
-};
-
-
-class VSDCloseSpanOutputElement : public VSDOutputElement
-{
-public:
-  VSDCloseSpanOutputElement();
-  ~VSDCloseSpanOutputElement() override {}
-  void draw(librevenge::RVNGDrawingInterface *painter) override;
-  VSDOutputElement *clone() override
-  {
-    return new VSDCloseSpanOutputElement();
-  }
-};
-
-
-class VSDCloseParagraphOutputElement : public VSDOutputElement
-{
-public:
-  VSDCloseParagraphOutputElement();
-  ~VSDCloseParagraphOutputElement() override {}
-  void draw(librevenge::RVNGDrawingInterface *painter) override;
-  VSDOutputElement *clone() override
-  {
-    return new VSDCloseParagraphOutputElement();
-  }
-};
-
-
-class VSDEndTextObjectOutputElement : public VSDOutputElement
-{
-public:
-  VSDEndTextObjectOutputElement();
-  ~VSDEndTextObjectOutputElement() override {}
-  void draw(librevenge::RVNGDrawingInterface *painter) override;
-  VSDOutputElement *clone() override
-  {
-    return new VSDEndTextObjectOutputElement();
-  }
-};
-
-class VSDOpenListElementOutputElement : public VSDOutputElement
-{
-public:
-  VSDOpenListElementOutputElement(const librevenge::RVNGPropertyList &propList);
-  ~VSDOpenListElementOutputElement() override {}
-  void draw(librevenge::RVNGDrawingInterface *painter) override;
-  VSDOutputElement *clone() override
-  {
-    return new VSDOpenListElementOutputElement(m_propList);
-  }
-private:
-  librevenge::RVNGPropertyList m_propList;
-};
-
-
-class VSDCloseListElementOutputElement : public VSDOutputElement
-{
-public:
-  VSDCloseListElementOutputElement();
-  ~VSDCloseListElementOutputElement() override {}
-  void draw(librevenge::RVNGDrawingInterface *painter) override;
-  VSDOutputElement *clone() override
-  {
-    return new VSDCloseListElementOutputElement();
-  }
-};
-
-
-class VSDOpenUnorderedListLevelOutputElement : public VSDOutputElement
-{
-public:
-  VSDOpenUnorderedListLevelOutputElement(const librevenge::RVNGPropertyList &propList);
-  ~VSDOpenUnorderedListLevelOutputElement() override {}
-  void draw(librevenge::RVNGDrawingInterface *painter) override;
-  VSDOutputElement *clone() override
-  {
-    return new VSDOpenUnorderedListLevelOutputElement(m_propList);
-  }
-private:
-  librevenge::RVNGPropertyList m_propList;
-};
-
-
-class VSDCloseUnorderedListLevelOutputElement : public VSDOutputElement
-{
-public:
-  VSDCloseUnorderedListLevelOutputElement();
-  ~VSDCloseUnorderedListLevelOutputElement() override {}
-  void draw(librevenge::RVNGDrawingInterface *painter) override;
-  VSDOutputElement *clone() override
-  {
-    return new VSDCloseUnorderedListLevelOutputElement();
-  }
-};
-
-
 } // namespace libvisio
 
-libvisio::VSDStyleOutputElement::VSDStyleOutputElement(const librevenge::RVNGPropertyList &propList) :
-  m_propList(propList) {}
-
-void libvisio::VSDStyleOutputElement::draw(librevenge::RVNGDrawingInterface *painter)
-{
-  if (painter)
-    painter->setStyle(m_propList);
-}
-
-
-libvisio::VSDPathOutputElement::VSDPathOutputElement(const librevenge::RVNGPropertyList &propList) :
-  m_propList(propList) {}
-
-void libvisio::VSDPathOutputElement::draw(librevenge::RVNGDrawingInterface *painter)
+libvisio::VSDOutputElementArena::VSDOutputElementArena()
+  : m_propLists(), m_texts(), m_internedPropLists(), m_key()
 {
-  if (painter)
-    painter->drawPath(m_propList);
 }
 
-
-libvisio::VSDGraphicObjectOutputElement::VSDGraphicObjectOutputElement(const librevenge::RVNGPropertyList &propList) :
-  m_propList(propList) {}
-
-void libvisio::VSDGraphicObjectOutputElement::draw(librevenge::RVNGDrawingInterface *painter)
+const librevenge::RVNGPropertyList *libvisio::VSDOutputElementArena::store(const librevenge::RVNGPropertyList &propList)
 {
-  if (painter)
-    painter->drawGraphicObject(m_propList);
+  m_propLists.push_back(propList);
+  return &m_propLists.back();
 }
 
-
-libvisio::VSDStartTextObjectOutputElement::VSDStartTextObjectOutputElement(const librevenge::RVNGPropertyList &propList) :
-  m_propList(propList) {}
-
-void libvisio::VSDStartTextObjectOutputElement::draw(librevenge::RVNGDrawingInterface *painter)
+const librevenge::RVNGString *libvisio::VSDOutputElementArena::store(const librevenge::RVNGString &text)
 {
-  if (painter)
-    painter->startTextObject(m_propList);
+  m_texts.push_back(text);
+  return &m_texts.back();
 }
 
-libvisio::VSDOpenSpanOutputElement::VSDOpenSpanOutputElement(const librevenge::RVNGPropertyList &propList) :
-  m_propList(propList) {}
-
-void libvisio::VSDOpenSpanOutputElement::draw(librevenge::RVNGDrawingInterface *painter)
+const librevenge::RVNGPropertyList *libvisio::VSDOutputElementArena::intern(const librevenge::RVNGPropertyList &propList)
 {
-  if (painter)
-    painter->openSpan(m_propList);
-}
-
-
-libvisio::VSDStartLayerOutputElement::VSDStartLayerOutputElement(const librevenge::RVNGPropertyList &propList) :
-  m_propList(propList) {}
-
-void libvisio::VSDStartLayerOutputElement::draw(librevenge::RVNGDrawingInterface *painter)
-{
-  if (painter)
-    painter->startLayer(m_propList);
-}
-
-
-libvisio::VSDEndLayerOutputElement::VSDEndLayerOutputElement() {}
+  m_key.clear();
+  librevenge::RVNGPropertyList::Iter i(propList);
+  for (i.rewind(); i.next();)
+  {
+    // child vectors are not part of the key, so lists having any are not shared
+    if (i.child() || !i())
+      return store(propList);
+    m_key.append(i.key());
+    m_key.push_back('\0');
+    appendValue(*i());
+  }
 
-void libvisio::VSDEndLayerOutputElement::draw(librevenge::RVNGDrawingInterface *painter)
-{
-  if (painter)
-    painter->endLayer();
+  auto iter = m_internedPropLists.find(m_key);
+  if (iter == m_internedPropLists.end())
+    iter = m_internedPropLists.insert(std::make_pair(m_key, store(propList))).first;
+  return iter->second;
 }
 
-
-libvisio::VSDOpenParagraphOutputElement::VSDOpenParagraphOutputElement(const librevenge::RVNGPropertyList &propList) :
-  m_propList(propList) {}
-
-void libvisio::VSDOpenParagraphOutputElement::draw(librevenge::RVNGDrawingInterface *painter)
+size_t libvisio::VSDOutputElementArena::propListCount() const
 {
-  if (painter)
-    painter->openParagraph(m_propList);
+  return m_propLists.size();
 }
 
-
-libvisio::VSDInsertTextOutputElement::VSDInsertTextOutputElement(const librevenge::RVNGString &text) :
-  m_text(text) {}
-
-void libvisio::VSDInsertTextOutputElement::draw(librevenge::RVNGDrawingInterface *painter)
+void libvisio::VSDOutputElementArena::appendValue(const librevenge::RVNGProperty &prop)
 {
-  if (painter)
-    separateSpacesAndInsertText(painter, m_text);
+  /* The value is added as the bits of the double and the int, so that no
+   * number is formatted. Only strings, which are all 0 as numbers, have to
+   * be added as text; a generic 0 is added as text too, which is cheap.
+   */
+  const librevenge::RVNGUnit unit = prop.getUnit();
+  const double value = prop.getDouble();
+  m_key.push_back(char(unit));
+  if (unit == librevenge::RVNG_GENERIC && !(value < 0.0 || value > 0.0))
+  {
+    m_key.append(prop.getStr().cstr());
+    m_key.push_back('\0');
+    return;
+  }
+  const int intValue = prop.getInt();
+  m_key.append(reinterpret_cast<const char *>(&value), sizeof(value));
+  m_key.append(reinterpret_cast<const char *>(&intValue), sizeof(intValue));
 }
 
-libvisio::VSDInsertLineBreakOutputElement::VSDInsertLineBreakOutputElement() {}
-
-void libvisio::VSDInsertLineBreakOutputElement::draw(librevenge::RVNGDrawingInterface *painter)
+void libvisio::VSDOutputElement::draw(librevenge::RVNGDrawingInterface *painter) const
 {
-  if (painter)
+  if (!painter)
+    return;
+  switch (m_type)
+  {
+  case VSD_OUTPUT_STYLE:
+    painter->setStyle(*m_propList);
+    break;
+  case VSD_OUTPUT_PATH:
+    painter->drawPath(*m_propList);
+    break;
+  case VSD_OUTPUT_GRAPHIC_OBJECT:
+    painter->drawGraphicObject(*m_propList);
+    break;
+  case VSD_OUTPUT_START_TEXT_OBJECT:
+    painter->startTextObject(*m_propList);
+    break;
+  case VSD_OUTPUT_END_TEXT_OBJECT:
+    painter->endTextObject();
+    break;
+  case VSD_OUTPUT_OPEN_UNORDERED_LIST_LEVEL:
+    painter->openUnorderedListLevel(*m_propList);
+    break;
+  case VSD_OUTPUT_CLOSE_UNORDERED_LIST_LEVEL:
+    painter->closeUnorderedListLevel();
+    break;
+  case VSD_OUTPUT_OPEN_LIST_ELEMENT:
+    painter->openListElement(*m_propList);
+    break;
+  case VSD_OUTPUT_CLOSE_LIST_ELEMENT:
+    painter->closeListElement();
+    break;
+  case VSD_OUTPUT_OPEN_PARAGRAPH:
+    painter->openParagraph(*m_propList);
+    break;
+  case VSD_OUTPUT_CLOSE_PARAGRAPH:
+    painter->closeParagraph();
+    break;
+  case VSD_OUTPUT_OPEN_SPAN:
+    painter->openSpan(*m_propList);
+    break;
+  case VSD_OUTPUT_CLOSE_SPAN:
+    painter->closeSpan();
+    break;
+  case VSD_OUTPUT_INSERT_TEXT:
+    separateSpacesAndInsertText(painter, *m_text);
+    break;
+  case VSD_OUTPUT_INSERT_LINE_BREAK:
     painter->insertLineBreak();
-}
-
-libvisio::VSDInsertTabOutputElement::VSDInsertTabOutputElement() {}
-
-void libvisio::VSDInsertTabOutputElement::draw(librevenge::RVNGDrawingInterface *painter)
-{
-  if (painter)
+    break;
+  case VSD_OUTPUT_INSERT_TAB:
     painter->insertTab();
+    break;
+  case VSD_OUTPUT_START_LAYER:
+    painter->startLayer(*m_propList);
+    break;
+  case VSD_OUTPUT_END_LAYER:
+    painter->endLayer();
+    break;
+  }
 }
 
-libvisio::VSDCloseSpanOutputElement::VSDCloseSpanOutputElement() {}
 
-void libvisio::VSDCloseSpanOutputElement::draw(librevenge::RVNGDrawingInterface *painter)
+libvisio::VSDOutputElementList::VSDOutputElementList()
+  : m_elements(), m_arenas()
 {
-  if (painter)
-    painter->closeSpan();
 }
 
-
-libvisio::VSDCloseParagraphOutputElement::VSDCloseParagraphOutputElement() {}
-
-void libvisio::VSDCloseParagraphOutputElement::draw(librevenge::RVNGDrawingInterface *painter)
+libvisio::VSDOutputElementList::VSDOutputElementList(const std::shared_ptr<VSDOutputElementArena> &arena)
+  : m_elements(), m_arenas()
 {
-  if (painter)
-    painter->closeParagraph();
+  if (arena)
+    m_arenas.push_back(arena);
 }
 
+libvisio::VSDOutputElementList::VSDOutputElementList(const libvisio::VSDOutputElementList &elementList) = default;
 
-libvisio::VSDEndTextObjectOutputElement::VSDEndTextObjectOutputElement() {}
-
-void libvisio::VSDEndTextObjectOutputElement::draw(librevenge::RVNGDrawingInterface *painter)
-{
-  if (painter)
-    painter->endTextObject();
-}
+libvisio::VSDOutputElementList::VSDOutputElementList(libvisio::VSDOutputElementList &&elementList) = default;
 
+libvisio::VSDOutputElementList &libvisio::VSDOutputElementList::operator=(const libvisio::VSDOutputElementList &elementList) = default;
 
-libvisio::VSDOpenListElementOutputElement::VSDOpenListElementOutputElement(const librevenge::RVNGPropertyList &propList) :
-  m_propList(propList) {}
+libvisio::VSDOutputElementList &libvisio::VSDOutputElementList::operator=(libvisio::VSDOutputElementList &&elementList) = default;
 
-void libvisio::VSDOpenListElementOutputElement::draw(librevenge::RVNGDrawingInterface *painter)
+libvisio::VSDOutputElementList::~VSDOutputElementList()
 {
-  if (painter)
-    painter->openListElement(m_propList);
 }
 
-
-libvisio::VSDCloseListElementOutputElement::VSDCloseListElementOutputElement() {}
-
-void libvisio::VSDCloseListElementOutputElement::draw(librevenge::RVNGDrawingInterface *painter)
+void libvisio::VSDOutputElementList::append(const libvisio::VSDOutputElementList &elementList)
 {
-  if (painter)
-    painter->closeListElement();
+  if (&elementList == this)
+    return;
+  m_elements.insert(m_elements.end(), elementList.m_elements.begin(), elementList.m_elements.end());
+  _addArenas(elementList.m_arenas);
 }
 
-
-libvisio::VSDOpenUnorderedListLevelOutputElement::VSDOpenUnorderedListLevelOutputElement(const librevenge::RVNGPropertyList &propList) :
-  m_propList(propList) {}
-
-void libvisio::VSDOpenUnorderedListLevelOutputElement::draw(librevenge::RVNGDrawingInterface *painter)
+void libvisio::VSDOutputElementList::append(libvisio::VSDOutputElementList &&elementList)
 {
-  if (painter)
-    painter->openUnorderedListLevel(m_propList);
+  if (&elementList == this)
+    return;
+  // Taking over the other buffer is only cheaper if it is not smaller than the reserved one
+  if (m_elements.empty() && m_elements.capacity() <= elementList.m_elements.capacity())
+    m_elements.swap(elementList.m_elements);
+  else
+    m_elements.insert(m_elements.end(), elementList.m_elements.begin(), elementList.m_elements.end());
+  _addArenas(elementList.m_arenas);
+  elementList.clear();
 }
 
-
-libvisio::VSDCloseUnorderedListLevelOutputElement::VSDCloseUnorderedListLevelOutputElement() {}
-
-void libvisio::VSDCloseUnorderedListLevelOutputElement::draw(librevenge::RVNGDrawingInterface *painter)
+void libvisio::VSDOutputElementList::reserve(size_t size)
 {
-  if (painter)
-    painter->closeUnorderedListLevel();
+  m_elements.reserve(size);
 }
 
-
-libvisio::VSDOutputElementList::VSDOutputElementList()
-  : m_elements()
+void libvisio::VSDOutputElementList::clear()
 {
+  m_elements.clear();
+  m_arenas.clear();
 }
 
-libvisio::VSDOutputElementList::VSDOutputElementList(const libvisio::VSDOutputElementList &elementList)
-  : m_elements()
+libvisio::VSDOutputElementArena &libvisio::VSDOutputElementList::_getArena()
 {
-  for (const auto &elem : elementList.m_elements)
-    m_elements.push_back(clone(elem));
+  if (m_arenas.empty())
+    m_arenas.push_back(std::make_shared<VSDOutputElementArena>());
+  return *m_arenas.front();
 }
 
-libvisio::VSDOutputElementList &libvisio::VSDOutputElementList::operator=(const libvisio::VSDOutputElementList &elementList)
+void libvisio::VSDOutputElementList::_addArenas(const std::vector<std::shared_ptr<VSDOutputElementArena> > &arenas)
 {
-  if (&elementList != this)
+  for (const auto &arena : arenas)
   {
-    m_elements.clear();
-
-    for (const auto &elem : elementList.m_elements)
-      m_elements.push_back(clone(elem));
+    if (std::find(m_arenas.begin(), m_arenas.end(), arena) == m_arenas.end())
+      m_arenas.push_back(arena);
   }
-
-  return *this;
-}
-
-void libvisio::VSDOutputElementList::append(const libvisio::VSDOutputElementList &elementList)
-{
-  for (const auto &elem : elementList.m_elements)
-    m_elements.push_back(clone(elem));
-}
-
-libvisio::VSDOutputElementList::~VSDOutputElementList()
-{
 }
 
 void libvisio::VSDOutputElementList::draw(librevenge::RVNGDrawingInterface *painter) const
 {
   for (const auto &elem : m_elements)
-    elem->draw(painter);
+    elem.draw(painter);
 }
 
 void libvisio::VSDOutputElementList::addStyle(const librevenge::RVNGPropertyList &propList)
 {
-  m_elements.push_back(make_unique<VSDStyleOutputElement>(propList));
+  // shapes mostly share a few styles
+  m_elements.push_back(VSDOutputElement(VSD_OUTPUT_STYLE, _getArena().intern(propList)));
 }
 
 void libvisio::VSDOutputElementList::addPath(const librevenge::RVNGPropertyList &propList)
 {
-  m_elements.push_back(make_unique<VSDPathOutputElement>(propList));
+  m_elements.push_back(VSDOutputElement(VSD_OUTPUT_PATH, _getArena().store(propList)));
 }
 
 void libvisio::VSDOutputElementList::addGraphicObject(const librevenge::RVNGPropertyList &propList)
 {
-  m_elements.push_back(make_unique<VSDGraphicObjectOutputElement>(propList));
+  m_elements.push_back(VSDOutputElement(VSD_OUTPUT_GRAPHIC_OBJECT, _getArena().store(propList)));
 }
 
 void libvisio::VSDOutputElementList::addStartTextObject(const librevenge::RVNGPropertyList &propList)
 {
-  m_elements.push_back(make_unique<VSDStartTextObjectOutputElement>(propList));
+  m_elements.push_back(VSDOutputElement(VSD_OUTPUT_START_TEXT_OBJECT, _getArena().store(propList)));
 }
 
 void libvisio::VSDOutputElementList::addOpenParagraph(const librevenge::RVNGPropertyList &propList)
 {
-  m_elements.push_back(make_unique<VSDOpenParagraphOutputElement>(propList));
+  m_elements.push_back(VSDOutputElement(VSD_OUTPUT_OPEN_PARAGRAPH, _getArena().intern(propList)));
 }
 
 void libvisio::VSDOutputElementList::addOpenSpan(const librevenge::RVNGPropertyList &propList)
 {
-  m_elements.push_back(make_unique<VSDOpenSpanOutputElement>(propList));
+  m_elements.push_back(VSDOutputElement(VSD_OUTPUT_OPEN_SPAN, _getArena().intern(propList)));
 }
 
 void libvisio::VSDOutputElementList::addInsertText(const librevenge::RVNGString &text)
 {
-  m_elements.push_back(make_unique<VSDInsertTextOutputElement>(text));
+  m_elements.push_back(VSDOutputElement(_getArena().store(text)));
 }
 
 void libvisio::VSDOutputElementList::addInsertLineBreak()
 {
-  m_elements.push_back(make_unique<VSDInsertLineBreakOutputElement>());
+  m_elements.push_back(VSDOutputElement(VSD_OUTPUT_INSERT_LINE_BREAK));
 }
 
 void libvisio::VSDOutputElementList::addInsertTab()
 {
-  m_elements.push_back(make_unique<VSDInsertTabOutputElement>());
+  m_elements.push_back(VSDOutputElement(VSD_OUTPUT_INSERT_TAB));
 }
 
 void libvisio::VSDOutputElementList::addCloseSpan()
 {
-  m_elements.push_back(make_unique<VSDCloseSpanOutputElement>());
+  m_elements.push_back(VSDOutputElement(VSD_OUTPUT_CLOSE_SPAN));
 }
 
 void libvisio::VSDOutputElementList::addCloseParagraph()
 {
-  m_elements.push_back(make_unique<VSDCloseParagraphOutputElement>());
+  m_elements.push_back(VSDOutputElement(VSD_OUTPUT_CLOSE_PARAGRAPH));
 }
 
 void libvisio::VSDOutputElementList::addEndTextObject()
 {
-  m_elements.push_back(make_unique<VSDEndTextObjectOutputElement>());
+  m_elements.push_back(VSDOutputElement(VSD_OUTPUT_END_TEXT_OBJECT));
 }
 
 void libvisio::VSDOutputElementList::addStartLayer(const librevenge::RVNGPropertyList &propList)
 {
-  m_elements.push_back(make_unique<VSDStartLayerOutputElement>(propList));
+  m_elements.push_back(VSDOutputElement(VSD_OUTPUT_START_LAYER, _getArena().store(propList)));
 }
 
 void libvisio::VSDOutputElementList::addEndLayer()
 {
-  m_elements.push_back(make_unique<VSDEndLayerOutputElement>());
+  m_elements.push_back(VSDOutputElement(VSD_OUTPUT_END_LAYER));
 }
 
 void libvisio::VSDOutputElementList::addOpenListElement(const librevenge::RVNGPropertyList &propList)
 {
-  m_elements.push_back(make_unique<VSDOpenListElementOutputElement>(propList));
+  m_elements.push_back(VSDOutputElement(VSD_OUTPUT_OPEN_LIST_ELEMENT, _getArena().intern(propList)));
 }
 
 void libvisio::VSDOutputElementList::addOpenUnorderedListLevel(const librevenge::RVNGPropertyList &propList)
 {
-  m_elements.push_back(make_unique<VSDOpenUnorderedListLevelOutputElement>(propList));
+  m_elements.push_back(VSDOutputElement(VSD_OUTPUT_OPEN_UNORDERED_LIST_LEVEL, _getArena().intern(propList)));
 }
 
 void libvisio::VSDOutputElementList::addCloseListElement()
 {
-  m_elements.push_back(make_unique<VSDCloseListElementOutputElement>());
+  m_elements.push_back(VSDOutputElement(VSD_OUTPUT_CLOSE_LIST_ELEMENT));
 }
 
 void libvisio::VSDOutputElementList::addCloseUnorderedListLevel()
 {
-  m_elements.push_back(make_unique<VSDCloseUnorderedListLevelOutputElement>());
+  m_elements.push_back(VSDOutputElement(VSD_OUTPUT_CLOSE_UNORDERED_LIST_LEVEL));
 }
 
 /* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -10,25 +10,96 @@
 #ifndef __VSDOUTPUTELEMENTLIST_H__
 #define __VSDOUTPUTELEMENTLIST_H__
 
-#include <map>
+#include <deque>
 #include <memory>
-#include <list>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include <librevenge/librevenge.h>
 
 namespace libvisio
 {
 
-class VSDOutputElement;
+/* Append-only storage for the payloads of output elements. An arena is
+ * shared by the element lists of a page, so that the lists can be copied
+ * and spliced without copying the property lists themselves.
+ */
+class VSDOutputElementArena
+{
+public:
+  VSDOutputElementArena();
+  const librevenge::RVNGPropertyList *store(const librevenge::RVNGPropertyList &propList);
+  const librevenge::RVNGString *store(const librevenge::RVNGString &text);
+  // Like store(), but equal property lists are stored only once
+  const librevenge::RVNGPropertyList *intern(const librevenge::RVNGPropertyList &propList);
+  size_t propListCount() const;
+private:
+  VSDOutputElementArena(const VSDOutputElementArena &);
+  VSDOutputElementArena &operator=(const VSDOutputElementArena &);
+  void appendValue(const librevenge::RVNGProperty &prop);
+  std::deque<librevenge::RVNGPropertyList> m_propLists;
+  std::deque<librevenge::RVNGString> m_texts;
+  std::unordered_map<std::string, const librevenge::RVNGPropertyList *> m_internedPropLists;
+  // The key of the last interned list, kept to reuse its buffer
+  std::string m_key;
+};
+
+enum VSDOutputElementType
+{
+  VSD_OUTPUT_STYLE,
+  VSD_OUTPUT_PATH,
+  VSD_OUTPUT_GRAPHIC_OBJECT,
+  VSD_OUTPUT_START_TEXT_OBJECT,
+  VSD_OUTPUT_END_TEXT_OBJECT,
+  VSD_OUTPUT_OPEN_UNORDERED_LIST_LEVEL,
+  VSD_OUTPUT_CLOSE_UNORDERED_LIST_LEVEL,
+  VSD_OUTPUT_OPEN_LIST_ELEMENT,
+  VSD_OUTPUT_CLOSE_LIST_ELEMENT,
+  VSD_OUTPUT_OPEN_PARAGRAPH,
+  VSD_OUTPUT_CLOSE_PARAGRAPH,
+  VSD_OUTPUT_OPEN_SPAN,
+  VSD_OUTPUT_CLOSE_SPAN,
+  VSD_OUTPUT_INSERT_TEXT,
+  VSD_OUTPUT_INSERT_LINE_BREAK,
+  VSD_OUTPUT_INSERT_TAB,
+  VSD_OUTPUT_START_LAYER,
+  VSD_OUTPUT_END_LAYER
+};
+
+// Tagged element, whose payload (if any) lives in an arena
+class VSDOutputElement
+{
+public:
+  explicit VSDOutputElement(VSDOutputElementType type)
+    : m_type(type), m_propList(nullptr) {}
+  VSDOutputElement(VSDOutputElementType type, const librevenge::RVNGPropertyList *propList)
+    : m_type(type), m_propList(propList) {}
+  explicit VSDOutputElement(const librevenge::RVNGString *text)
+    : m_type(VSD_OUTPUT_INSERT_TEXT), m_text(text) {}
+  void draw(librevenge::RVNGDrawingInterface *painter) const;
+private:
+  VSDOutputElementType m_type;
+  union
+  {
+    const librevenge::RVNGPropertyList *m_propList;
+    const librevenge::RVNGString *m_text;
+  };
+};
 
 class VSDOutputElementList
 {
 public:
   VSDOutputElementList();
+  explicit VSDOutputElementList(const std::shared_ptr<VSDOutputElementArena> &arena);
   VSDOutputElementList(const VSDOutputElementList &elementList);
+  VSDOutputElementList(VSDOutputElementList &&elementList);
   VSDOutputElementList &operator=(const VSDOutputElementList &elementList);
+  VSDOutputElementList &operator=(VSDOutputElementList &&elementList);
   ~VSDOutputElementList();
   void append(const VSDOutputElementList &elementList);
+  void append(VSDOutputElementList &&elementList);
+  void reserve(size_t size);
+  void clear();
   void draw(librevenge::RVNGDrawingInterface *painter) const;
   void addStyle(const librevenge::RVNGPropertyList &propList);
   void addPath(const librevenge::RVNGPropertyList &propList);
@@ -52,8 +123,17 @@ public:
   {
     return m_elements.empty();
   }
+  size_t size() const
+  {
+    return m_elements.size();
+  }
 private:
-  std::vector<std::unique_ptr<VSDOutputElement>> m_elements;
+  VSDOutputElementArena &_getArena();
+  void _addArenas(const std::vector<std::shared_ptr<VSDOutputElementArena> > &arenas);
+
+  std::vector<VSDOutputElement> m_elements;
+  // New payloads go to the first arena; the rest keep appended elements alive
+  std::vector<std::shared_ptr<VSDOutputElementArena> > m_arenas;
 };
 
 
@@ -0,0 +1,169 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "VSDPageSelection.h"
+
+#include <utility>
+#include <unicode/ucnv.h>
+#include "libvisio_utils.h"
+
+namespace
+{
+
+std::string getPageName(const libvisio::VSDName &name)
+{
+  if (name.empty())
+    return std::string();
+
+  const auto *src = reinterpret_cast<const char *>(name.m_data.getDataBuffer());
+  const char *const srcLimit = src + name.m_data.size();
+  if (libvisio::VSD_TEXT_UTF8 == name.m_format)
+    return std::string(src, srcLimit);
+
+  librevenge::RVNGString text;
+  UErrorCode status = U_ZERO_ERROR;
+  UConverter *const conv = libvisio::getConverter(libvisio::VSD_TEXT_UTF16 == name.m_format ? "UTF-16LE" : "windows-1252");
+  if (conv)
+  {
+    while (src < srcLimit)
+    {
+      UChar32 ucs4Character = ucnv_getNextUChar(conv, &src, srcLimit, &status);
+      if (U_SUCCESS(status) && U_IS_UNICODE_CHAR(ucs4Character))
+        libvisio::appendUCS4(text, ucs4Character);
+    }
+  }
+  return std::string(text.cstr());
+}
+
+template<typename T>
+void removeUnneededPages(std::vector<T> &sequence, const std::vector<bool> &isNeeded)
+{
+  std::vector<T> neededPages;
+  neededPages.reserve(sequence.size());
+  for (size_t i = 0; i < sequence.size(); ++i)
+  {
+    if (i >= isNeeded.size() || isNeeded[i])
+      neededPages.push_back(std::move(sequence[i]));
+  }
+  sequence.swap(neededPages);
+}
+
+} // anonymous namespace
+
+libvisio::VSDPageSelection::VSDPageSelection()
+  : m_indexes(), m_names(), m_pages(), m_hiddenPages(),
+    m_foregroundCount(0), m_pageCount(0), m_isFirstPass(true)
+{
+}
+
+void libvisio::VSDPageSelection::addPageIndex(unsigned index)
+{
+  m_indexes.insert(index);
+}
+
+void libvisio::VSDPageSelection::addPageName(const librevenge::RVNGString &name)
+{
+  m_names.insert(std::string(name.cstr()));
+}
+
+bool libvisio::VSDPageSelection::empty() const
+{
+  return m_indexes.empty() && m_names.empty();
+}
+
+bool libvisio::VSDPageSelection::startPage(unsigned pageId, bool isBackgroundPage, const VSDName &pageName)
+{
+  if (empty())
+    return true;
+
+  if (!m_isFirstPass)
+  {
+    if (m_pageCount >= m_pages.size())
+      return false;
+    const Page &page = m_pages[m_pageCount++];
+    return page.m_isParsed && page.m_isNeeded;
+  }
+
+  bool isSelected = false;
+  if (!isBackgroundPage)
+  {
+    isSelected = m_indexes.count(m_foregroundCount++) || (!m_names.empty() && m_names.count(getPageName(pageName)));
+  }
+  // Any background page might turn out to be used by a selected page
+  const bool isParsed = isSelected || isBackgroundPage;
+  m_pages.push_back(Page(pageId, isBackgroundPage, isSelected, isParsed));
+  return isParsed;
+}
+
+void libvisio::VSDPageSelection::collectBackgroundPage(unsigned backgroundPageId)
+{
+  if (m_isFirstPass && !m_pages.empty())
+    m_pages.back().m_backgroundPageId = backgroundPageId;
+}
+
+void libvisio::VSDPageSelection::endFirstPass(std::vector<std::map<unsigned, XForm> > &groupXFormsSequence,
+                                              std::vector<std::map<unsigned, unsigned> > &groupMembershipsSequence,
+                                              std::vector<std::list<unsigned> > &documentPageShapeOrders)
+{
+  if (empty() || !m_isFirstPass)
+    return;
+  m_isFirstPass = false;
+
+  std::map<unsigned, unsigned> backgroundPages;
+  for (const auto &page : m_pages)
+  {
+    if (page.m_isParsed && page.m_isBackground)
+      backgroundPages[page.m_id] = page.m_backgroundPageId;
+  }
+
+  // Follow the chains of background pages; every page is visited once, so cycles end too
+  std::set<unsigned> usedBackgroundPages;
+  for (const auto &page : m_pages)
+  {
+    if (!page.m_isSelected)
+      continue;
+    unsigned backgroundPageId = page.m_backgroundPageId;
+    while (MINUS_ONE != backgroundPageId && usedBackgroundPages.insert(backgroundPageId).second)
+    {
+      auto iter = backgroundPages.find(backgroundPageId);
+      backgroundPageId = backgroundPages.end() != iter ? iter->second : MINUS_ONE;
+    }
+  }
+
+  std::vector<bool> isNeeded;
+  for (auto &page : m_pages)
+  {
+    if (!page.m_isParsed)
+      continue;
+    if (page.m_isBackground && usedBackgroundPages.count(page.m_id))
+    {
+      page.m_isNeeded = true;
+      m_hiddenPages.insert(page.m_id);
+    }
+    isNeeded.push_back(page.m_isNeeded);
+  }
+
+  removeUnneededPages(groupXFormsSequence, isNeeded);
+  removeUnneededPages(groupMembershipsSequence, isNeeded);
+  removeUnneededPages(documentPageShapeOrders, isNeeded);
+}
+
+bool libvisio::VSDPageSelection::hasSelectedPages() const
+{
+  if (empty())
+    return true;
+  for (const auto &page : m_pages)
+  {
+    if (page.m_isSelected)
+      return true;
+  }
+  return false;
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
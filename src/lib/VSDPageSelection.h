@@ -0,0 +1,80 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __VSDPAGESELECTION_H__
+#define __VSDPAGESELECTION_H__
+
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <librevenge/librevenge.h>
+#include "VSDTypes.h"
+
+namespace libvisio
+{
+
+/* Decides which pages the parsers process when only some pages of
+ * a document were requested.
+ *
+ * Foreground pages are selected by their 0-based position among the
+ * foreground pages or by their name. During the first pass all background
+ * pages are parsed too, because only then it is known which of them the
+ * selected pages use. The second pass processes just the selected pages and
+ * the background pages they reference; the latter are drawn as backgrounds
+ * only, not as pages of their own.
+ */
+class VSDPageSelection
+{
+public:
+  VSDPageSelection();
+
+  void addPageIndex(unsigned index);
+  void addPageName(const librevenge::RVNGString &name);
+  bool empty() const;
+
+  bool startPage(unsigned pageId, bool isBackgroundPage, const VSDName &pageName);
+  void collectBackgroundPage(unsigned backgroundPageId);
+  void endFirstPass(std::vector<std::map<unsigned, XForm> > &groupXFormsSequence,
+                    std::vector<std::map<unsigned, unsigned> > &groupMembershipsSequence,
+                    std::vector<std::list<unsigned> > &documentPageShapeOrders);
+  bool hasSelectedPages() const;
+  const std::set<unsigned> &getHiddenPages() const
+  {
+    return m_hiddenPages;
+  }
+
+private:
+  struct Page
+  {
+    Page(unsigned id, bool isBackground, bool isSelected, bool isParsed)
+      : m_id(id), m_backgroundPageId(MINUS_ONE), m_isBackground(isBackground),
+        m_isSelected(isSelected), m_isParsed(isParsed), m_isNeeded(isSelected) {}
+    unsigned m_id;
+    unsigned m_backgroundPageId;
+    bool m_isBackground;
+    bool m_isSelected;
+    bool m_isParsed;
+    bool m_isNeeded;
+  };
+
+  std::set<unsigned> m_indexes;
+  std::set<std::string> m_names;
+  std::vector<Page> m_pages;
+  std::set<unsigned> m_hiddenPages;
+  unsigned m_foregroundCount;
+  unsigned m_pageCount;
+  bool m_isFirstPass;
+};
+
+} // namespace libvisio
+
+#endif // __VSDPAGESELECTION_H__
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -9,6 +9,7 @@
 
 #include "VSDPages.h"
 
+#include <utility>
 #include "libvisio_utils.h"
 
 libvisio::VSDPage::VSDPage()
@@ -25,6 +26,13 @@ libvisio::VSDPage::VSDPage(const libvisio::VSDPage &page)
 {
 }
 
+libvisio::VSDPage::VSDPage(libvisio::VSDPage &&page)
+  : m_pageWidth(page.m_pageWidth), m_pageHeight(page.m_pageHeight), m_pageName(page.m_pageName),
+    m_currentPageID(page.m_currentPageID), m_backgroundPageID(page.m_backgroundPageID),
+    m_pageElements(std::move(page.m_pageElements))
+{
+}
+
 libvisio::VSDPage::~VSDPage()
 {
 }
@@ -43,11 +51,30 @@ libvisio::VSDPage &libvisio::VSDPage::operator=(const libvisio::VSDPage &page)
   return *this;
 }
 
+libvisio::VSDPage &libvisio::VSDPage::operator=(libvisio::VSDPage &&page)
+{
+  if (this != &page)
+  {
+    m_pageWidth = page.m_pageWidth;
+    m_pageHeight = page.m_pageHeight;
+    m_pageName = page.m_pageName;
+    m_currentPageID = page.m_currentPageID;
+    m_backgroundPageID = page.m_backgroundPageID;
+    m_pageElements = std::move(page.m_pageElements);
+  }
+  return *this;
+}
+
 void libvisio::VSDPage::append(const libvisio::VSDOutputElementList &outputElements)
 {
   m_pageElements.append(outputElements);
 }
 
+void libvisio::VSDPage::append(libvisio::VSDOutputElementList &&outputElements)
+{
+  m_pageElements.append(std::move(outputElements));
+}
+
 void libvisio::VSDPage::draw(librevenge::RVNGDrawingInterface *painter) const
 {
   if (painter)
@@ -55,7 +82,7 @@ void libvisio::VSDPage::draw(librevenge::RVNGDrawingInterface *painter) const
 }
 
 libvisio::VSDPages::VSDPages()
-  : m_pages(), m_backgroundPages(), m_metaData()
+  : m_pages(), m_backgroundPages(), m_hiddenBackgroundPages(), m_metaData()
 {
 }
 
@@ -64,11 +91,27 @@ void libvisio::VSDPages::addPage(const libvisio::VSDPage &page)
   m_pages.push_back(page);
 }
 
+void libvisio::VSDPages::addPage(libvisio::VSDPage &&page)
+{
+  m_pages.push_back(std::move(page));
+}
+
 void libvisio::VSDPages::addBackgroundPage(const libvisio::VSDPage &page)
 {
   m_backgroundPages[page.m_currentPageID] = page;
 }
 
+void libvisio::VSDPages::addBackgroundPage(libvisio::VSDPage &&page)
+{
+  const unsigned pageId = page.m_currentPageID;
+  m_backgroundPages[pageId] = std::move(page);
+}
+
+void libvisio::VSDPages::hideBackgroundPages(const std::set<unsigned> &pageIds)
+{
+  m_hiddenBackgroundPages = pageIds;
+}
+
 void libvisio::VSDPages::setMetaData(const librevenge::RVNGPropertyList &metaData)
 {
   m_metaData = metaData;
@@ -99,6 +142,9 @@ void libvisio::VSDPages::draw(librevenge::RVNGDrawingInterface *painter)
   for (std::map<unsigned, libvisio::VSDPage>::const_iterator iter = m_backgroundPages.begin();
        iter != m_backgroundPages.end(); ++iter)
   {
+    // only drawn as background of other pages
+    if (m_hiddenBackgroundPages.count(iter->first))
+      continue;
     librevenge::RVNGPropertyList pageProps;
     pageProps.insert("svg:width", iter->second.m_pageWidth);
     pageProps.insert("svg:height", iter->second.m_pageHeight);
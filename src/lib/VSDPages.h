@@ -10,6 +10,7 @@
 #ifndef __VSDPAGES_H__
 #define __VSDPAGES_H__
 
+#include <set>
 #include "VSDOutputElementList.h"
 #include "VSDTypes.h"
 
@@ -21,9 +22,12 @@ class VSDPage
 public:
   VSDPage();
   VSDPage(const VSDPage &page);
+  VSDPage(VSDPage &&page);
   ~VSDPage();
   VSDPage &operator=(const VSDPage &page);
+  VSDPage &operator=(VSDPage &&page);
   void append(const VSDOutputElementList &outputElements);
+  void append(VSDOutputElementList &&outputElements);
   void draw(librevenge::RVNGDrawingInterface *painter) const;
   double m_pageWidth, m_pageHeight;
   librevenge::RVNGString m_pageName;
@@ -37,13 +41,17 @@ public:
   VSDPages();
   ~VSDPages();
   void addPage(const VSDPage &page);
+  void addPage(VSDPage &&page);
   void addBackgroundPage(const VSDPage &page);
+  void addBackgroundPage(VSDPage &&page);
+  void hideBackgroundPages(const std::set<unsigned> &pageIds);
   void draw(librevenge::RVNGDrawingInterface *painter);
   void setMetaData(const librevenge::RVNGPropertyList &metaData);
 private:
   void _drawWithBackground(librevenge::RVNGDrawingInterface *painter, const VSDPage &page);
   std::vector<VSDPage> m_pages;
   std::map<unsigned, VSDPage> m_backgroundPages;
+  std::set<unsigned> m_hiddenBackgroundPages;
   librevenge::RVNGPropertyList m_metaData;
 };
 
@@ -30,16 +30,7 @@ public:
 class VSDParaIX : public VSDParagraphListElement
 {
 public:
-  VSDParaIX(unsigned id, unsigned level, unsigned charCount, const boost::optional<double> &indFirst,
-            const boost::optional<double> &indLeft, const boost::optional<double> &indRight,
-            const boost::optional<double> &spLine, const boost::optional<double> &spBefore,
-            const boost::optional<double> &spAfter, const boost::optional<unsigned char> &align,
-            const boost::optional<unsigned char> &bullet, const boost::optional<VSDName> &bulletStr,
-            const boost::optional<VSDName> &bulletFont, const boost::optional<double> &bulletFontSize,
-            const boost::optional<double> &textPosAfterBullet, const boost::optional<unsigned> &flags) :
-    VSDParagraphListElement(id, level),
-    m_style(charCount, indFirst, indLeft, indRight, spLine, spBefore, spAfter,
-            align, bullet, bulletStr, bulletFont, bulletFontSize, textPosAfterBullet, flags) {}
+  VSDParaIX(unsigned id, unsigned level, const VSDOptionalParaStyle &style) : VSDParagraphListElement(id, level), m_style(style) {}
   ~VSDParaIX() override {}
   void handle(VSDCollector *collector) const override;
   VSDParagraphListElement *clone() override;
@@ -59,18 +50,15 @@ public:
 
 void libvisio::VSDParaIX::handle(VSDCollector *collector) const
 {
-  collector->collectParaIX(m_id, m_level, m_style.charCount, m_style.indFirst, m_style.indLeft,
-                           m_style.indRight, m_style.spLine, m_style.spBefore, m_style.spAfter,
-                           m_style.align, m_style.bullet, m_style.bulletStr, m_style.bulletFont,
-                           m_style.bulletFontSize, m_style.textPosAfterBullet, m_style.flags);
+  collector->collectParaIX(m_id, m_level, m_style.charCount, m_style.indFirst(), m_style.indLeft(),
+                           m_style.indRight(), m_style.spLine(), m_style.spBefore(), m_style.spAfter(),
+                           m_style.align(), m_style.bullet(), m_style.bulletStr(), m_style.bulletFont(),
+                           m_style.bulletFontSize(), m_style.textPosAfterBullet(), m_style.flags());
 }
 
 libvisio::VSDParagraphListElement *libvisio::VSDParaIX::clone()
 {
-  return new VSDParaIX(m_id, m_level, m_style.charCount, m_style.indFirst, m_style.indLeft,
-                       m_style.indRight, m_style.spLine, m_style.spBefore, m_style.spAfter,
-                       m_style.align, m_style.bullet, m_style.bulletStr, m_style.bulletFont,
-                       m_style.bulletFontSize, m_style.textPosAfterBullet, m_style.flags);
+  return new VSDParaIX(m_id, m_level, m_style);
 }
 
 
@@ -81,20 +69,16 @@ libvisio::VSDParagraphList::VSDParagraphList() :
 }
 
 libvisio::VSDParagraphList::VSDParagraphList(const libvisio::VSDParagraphList &paraList) :
-  m_elements(),
+  m_elements(paraList.m_elements),
   m_elementsOrder(paraList.m_elementsOrder)
 {
-  for (auto iter = paraList.m_elements.begin(); iter != paraList.m_elements.end(); ++iter)
-    m_elements[iter->first] = clone(iter->second);
 }
 
 libvisio::VSDParagraphList &libvisio::VSDParagraphList::operator=(const libvisio::VSDParagraphList &paraList)
 {
   if (this != &paraList)
   {
-    clear();
-    for (auto iter = paraList.m_elements.begin(); iter != paraList.m_elements.end(); ++iter)
-      m_elements[iter->first] = clone(iter->second);
+    m_elements = paraList.m_elements;
     m_elementsOrder = paraList.m_elementsOrder;
   }
   return *this;
@@ -112,23 +96,17 @@ void libvisio::VSDParagraphList::addParaIX(unsigned id, unsigned level, unsigned
                                            const boost::optional<VSDName> &bulletFont, const boost::optional<double> &bulletFontSize,
                                            const boost::optional<double> &textPosAfterBullet, const boost::optional<unsigned> &flags)
 {
-  auto *tmpElement = dynamic_cast<VSDParaIX *>(m_elements[id].get());
-  if (!tmpElement)
-    m_elements[id] = make_unique<VSDParaIX>(id, level, charCount, indFirst, indLeft, indRight, spLine, spBefore,
-                                            spAfter, align, bullet, bulletStr, bulletFont, bulletFontSize,
-                                            textPosAfterBullet, flags);
-  else
-    tmpElement->m_style.override(VSDOptionalParaStyle(charCount, indFirst, indLeft, indRight, spLine, spBefore,
-                                                      spAfter, align, bullet, bulletStr, bulletFont, bulletFontSize,
-                                                      textPosAfterBullet, flags));
+  addParaIX(id, level, VSDOptionalParaStyle(charCount, indFirst, indLeft, indRight, spLine, spBefore, spAfter,
+                                            align, bullet, bulletStr, bulletFont, bulletFontSize, textPosAfterBullet, flags));
 }
 
 void libvisio::VSDParagraphList::addParaIX(unsigned id, unsigned level, const VSDOptionalParaStyle &style)
 {
-  addParaIX(id, level, style.charCount, style.indFirst, style.indLeft, style.indRight,
-            style.spLine, style.spBefore, style.spAfter, style.align,
-            style.bullet, style.bulletStr, style.bulletFont, style.bulletFontSize,
-            style.textPosAfterBullet, style.flags);
+  auto *tmpElement = dynamic_cast<VSDParaIX *>(detach(m_elements[id]));
+  if (!tmpElement)
+    m_elements[id] = make_unique<VSDParaIX>(id, level, style);
+  else
+    tmpElement->m_style.override(style);
 }
 
 unsigned libvisio::VSDParagraphList::getCharCount(unsigned id) const
@@ -144,13 +122,16 @@ void libvisio::VSDParagraphList::setCharCount(unsigned id, unsigned charCount)
 {
   auto iter = m_elements.find(id);
   if (iter != m_elements.end() && iter->second)
-    iter->second->setCharCount(charCount);
+    detach(iter->second)->setCharCount(charCount);
 }
 
 void libvisio::VSDParagraphList::resetCharCount()
 {
   for (auto &element : m_elements)
-    element.second->setCharCount(0);
+  {
+    if (element.second && element.second->getCharCount())
+      detach(element.second)->setCharCount(0);
+  }
 }
 
 unsigned libvisio::VSDParagraphList::getLevel() const
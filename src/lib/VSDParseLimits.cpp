@@ -0,0 +1,112 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "VSDParseLimits.h"
+
+#include <algorithm>
+
+#include "libvisio_utils.h"
+
+// Enough for the mime type detection of placeholders, which looks for the EMF signature at 0x28
+#define VSD_IMAGE_PLACEHOLDER_LENGTH 0x2CUL
+
+// Flatness of curves painted as polylines, in inches
+#define VSD_DEFAULT_CURVE_TOLERANCE 0.001
+
+libvisio::VSDParseLimits::VSDParseLimits()
+  : m_options(), m_decompressedBytes(0), m_start(std::chrono::steady_clock::now())
+{
+}
+
+libvisio::VSDParseLimits::VSDParseLimits(const VisioParseOptions &options)
+  : m_options(options), m_decompressedBytes(0), m_start(std::chrono::steady_clock::now())
+{
+}
+
+/* Returns how many bytes the next stream may decompress to, 0 meaning no
+ * limit. That is one byte more than what is left, so that a stream going
+ * over the limit is noticed by collectDecompressedBytes.
+ */
+unsigned long libvisio::VSDParseLimits::getDecompressionBudget() const
+{
+  if (!m_options.maxDecompressedBytes)
+    return 0;
+  if (m_decompressedBytes >= m_options.maxDecompressedBytes)
+    return 1;
+  return m_options.maxDecompressedBytes - m_decompressedBytes + 1;
+}
+
+void libvisio::VSDParseLimits::collectDecompressedBytes(unsigned long bytes)
+{
+  m_decompressedBytes += bytes;
+  if (m_options.maxDecompressedBytes && m_decompressedBytes > m_options.maxDecompressedBytes)
+  {
+    VSD_DEBUG_MSG(("VSDParseLimits: decompressed size limit exceeded\n"));
+    throw ParseLimitException();
+  }
+}
+
+void libvisio::VSDParseLimits::checkTime() const
+{
+  if (!m_options.maxParseTime)
+    return;
+  const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_start);
+  if ((unsigned long)elapsed.count() > m_options.maxParseTime)
+  {
+    VSD_DEBUG_MSG(("VSDParseLimits: parse time limit exceeded\n"));
+    throw ParseLimitException();
+  }
+}
+
+bool libvisio::VSDParseLimits::isTooDeep(unsigned long depth) const
+{
+  return m_options.maxNestingDepth && depth > m_options.maxNestingDepth;
+}
+
+unsigned libvisio::VSDParseLimits::getMaxNestingDepth() const
+{
+  return m_options.maxNestingDepth;
+}
+
+bool libvisio::VSDParseLimits::isPageFull(unsigned long elements) const
+{
+  return m_options.maxElementsPerPage && elements >= m_options.maxElementsPerPage;
+}
+
+bool libvisio::VSDParseLimits::isPathFull(unsigned long points) const
+{
+  return m_options.maxPathPoints && points >= m_options.maxPathPoints;
+}
+
+double libvisio::VSDParseLimits::getCurveTolerance() const
+{
+  return m_options.curveTolerance > 0.0 ? m_options.curveTolerance : VSD_DEFAULT_CURVE_TOLERANCE;
+}
+
+/// Returns how many of the size bytes of an embedded image should be read.
+unsigned long libvisio::VSDParseLimits::getImageReadLength(unsigned long size) const
+{
+  switch (m_options.imageHandling)
+  {
+  case VISIO_IMAGES_SKIP:
+    return 0;
+  case VISIO_IMAGES_PLACEHOLDER:
+    return std::min(size, VSD_IMAGE_PLACEHOLDER_LENGTH);
+  case VISIO_IMAGES_EMBED:
+  default:
+    return size;
+  }
+}
+
+bool libvisio::VSDParseLimits::isImageEmbedded() const
+{
+  return VISIO_IMAGES_EMBED == m_options.imageHandling;
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,56 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __VSDPARSELIMITS_H__
+#define __VSDPARSELIMITS_H__
+
+#include <chrono>
+#include <libvisio/VisioDocument.h>
+
+namespace libvisio
+{
+
+/* Enforces the resource limits of VisioParseOptions during one parse.
+ *
+ * Exceeding the decompressed size or the parse time aborts the parse by
+ * throwing ParseLimitException. The other limits only truncate: shapes
+ * past the per-page budget and path points past the per-shape budget are
+ * dropped, and streams or shapes nested too deep are skipped. Embedded
+ * images are read in full, partially or not at all, depending on the
+ * image handling option.
+ */
+class VSDParseLimits
+{
+public:
+  VSDParseLimits();
+  explicit VSDParseLimits(const VisioParseOptions &options);
+
+  unsigned long getDecompressionBudget() const;
+  void collectDecompressedBytes(unsigned long bytes);
+  void checkTime() const;
+
+  bool isTooDeep(unsigned long depth) const;
+  unsigned getMaxNestingDepth() const;
+  bool isPageFull(unsigned long elements) const;
+  bool isPathFull(unsigned long points) const;
+  double getCurveTolerance() const;
+
+  unsigned long getImageReadLength(unsigned long size) const;
+  bool isImageEmbedded() const;
+
+private:
+  VisioParseOptions m_options;
+  unsigned long m_decompressedBytes;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+} // namespace libvisio
+
+#endif // __VSDPARSELIMITS_H__
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
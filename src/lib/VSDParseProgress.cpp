@@ -0,0 +1,47 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "VSDParseProgress.h"
+
+#include "libvisio_utils.h"
+
+libvisio::VSDParseProgress::VSDParseProgress()
+  : m_callback(nullptr), m_pages(0), m_bytes(0)
+{
+}
+
+libvisio::VSDParseProgress::VSDParseProgress(VisioParseCallback *callback)
+  : m_callback(callback), m_pages(0), m_bytes(0)
+{
+}
+
+void libvisio::VSDParseProgress::collectBytes(unsigned long bytes)
+{
+  m_bytes += bytes;
+}
+
+void libvisio::VSDParseProgress::collectPage()
+{
+  m_pages++;
+  check();
+}
+
+/* pendingBytes are the bytes consumed so far of an input that is being read
+ * and that is not collected yet.
+ */
+void libvisio::VSDParseProgress::check(unsigned long pendingBytes) const
+{
+  if (m_callback && !m_callback->progress(m_pages, m_bytes + pendingBytes))
+  {
+    VSD_DEBUG_MSG(("VSDParseProgress: parsing cancelled\n"));
+    throw ParseCancelledException();
+  }
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,44 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __VSDPARSEPROGRESS_H__
+#define __VSDPARSEPROGRESS_H__
+
+#include <libvisio/VisioDocument.h>
+
+namespace libvisio
+{
+
+/* Reports the progress of a parse to the VisioParseCallback of the caller,
+ * if there is one, and cancels the parse by throwing ParseCancelledException
+ * when the callback asks for that.
+ *
+ * The parser and its collector share one instance: the parser counts the
+ * bytes of input it has consumed, the content collector the finished pages.
+ */
+class VSDParseProgress
+{
+public:
+  VSDParseProgress();
+  explicit VSDParseProgress(VisioParseCallback *callback);
+
+  void collectBytes(unsigned long bytes);
+  void collectPage();
+  void check(unsigned long pendingBytes = 0) const;
+
+private:
+  VisioParseCallback *m_callback;
+  unsigned m_pages;
+  unsigned long m_bytes;
+};
+
+} // namespace libvisio
+
+#endif // __VSDPARSEPROGRESS_H__
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,107 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "VSDParseStats.h"
+
+namespace
+{
+
+double getElapsedTime(const libvisio::VSDParseStats::TimePoint &start)
+{
+  return std::chrono::duration<double>(libvisio::VSDParseStats::now() - start).count();
+}
+
+} // anonymous namespace
+
+libvisio::VSDParseStats::VSDParseStats()
+  : m_decompressedBytes(0), m_decompressionTime(0.0), m_stylesPassTime(0.0), m_contentPassTime(0.0),
+    m_chunks(), m_xmlNodes(0), m_shapes(0), m_paths(0), m_NURBSPoints(0), m_masterCacheHits(0),
+    m_drawTime(0.0)
+{
+}
+
+libvisio::VSDParseStats::TimePoint libvisio::VSDParseStats::now()
+{
+  return std::chrono::steady_clock::now();
+}
+
+void libvisio::VSDParseStats::collectDecompression(unsigned long bytes, const TimePoint &start)
+{
+  m_decompressedBytes += bytes;
+  m_decompressionTime += getElapsedTime(start);
+}
+
+void libvisio::VSDParseStats::collectStylesPass(const TimePoint &start)
+{
+  m_stylesPassTime += getElapsedTime(start);
+}
+
+void libvisio::VSDParseStats::collectContentPass(const TimePoint &start)
+{
+  m_contentPassTime += getElapsedTime(start);
+}
+
+void libvisio::VSDParseStats::collectChunk(unsigned chunkType)
+{
+  m_chunks[chunkType]++;
+}
+
+void libvisio::VSDParseStats::collectXmlNode()
+{
+  m_xmlNodes++;
+}
+
+void libvisio::VSDParseStats::collectShape(unsigned paths)
+{
+  m_shapes++;
+  m_paths += paths;
+}
+
+void libvisio::VSDParseStats::collectNURBSPoints(unsigned long points)
+{
+  m_NURBSPoints += points;
+}
+
+void libvisio::VSDParseStats::collectMasterCacheHit()
+{
+  m_masterCacheHits++;
+}
+
+void libvisio::VSDParseStats::collectDraw(const TimePoint &start)
+{
+  m_drawTime += getElapsedTime(start);
+}
+
+void libvisio::VSDParseStats::getStats(librevenge::RVNGPropertyList &stats) const
+{
+  stats.insert("libvisio:decompressed-bytes", (double)m_decompressedBytes, librevenge::RVNG_GENERIC);
+  stats.insert("libvisio:decompression-time", m_decompressionTime, librevenge::RVNG_GENERIC);
+  stats.insert("libvisio:styles-pass-time", m_stylesPassTime, librevenge::RVNG_GENERIC);
+  stats.insert("libvisio:content-pass-time", m_contentPassTime, librevenge::RVNG_GENERIC);
+  stats.insert("libvisio:draw-time", m_drawTime, librevenge::RVNG_GENERIC);
+  stats.insert("libvisio:xml-nodes", (int)m_xmlNodes);
+  stats.insert("libvisio:shapes", (int)m_shapes);
+  stats.insert("libvisio:paths", (int)m_paths);
+  stats.insert("libvisio:nurbs-points", (int)m_NURBSPoints);
+  stats.insert("libvisio:master-cache-hits", (int)m_masterCacheHits);
+
+  if (m_chunks.empty())
+    return;
+  librevenge::RVNGPropertyListVector chunks;
+  for (const auto &chunk : m_chunks)
+  {
+    librevenge::RVNGPropertyList chunkStats;
+    chunkStats.insert("libvisio:chunk-type", (int)chunk.first);
+    chunkStats.insert("libvisio:count", (int)chunk.second);
+    chunks.append(chunkStats);
+  }
+  stats.insert("libvisio:chunks", chunks);
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,64 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __VSDPARSESTATS_H__
+#define __VSDPARSESTATS_H__
+
+#include <chrono>
+#include <map>
+#include <librevenge/librevenge.h>
+
+namespace libvisio
+{
+
+/* Counts where a parse spends its time, for VisioParseOptions::stats.
+ *
+ * It only exists when the caller asked for the statistics, so the parsers
+ * and the collectors check for a null pointer before counting anything.
+ * The times are taken from the start time points given by the callers.
+ */
+class VSDParseStats
+{
+public:
+  typedef std::chrono::steady_clock::time_point TimePoint;
+
+  VSDParseStats();
+
+  static TimePoint now();
+
+  void collectDecompression(unsigned long bytes, const TimePoint &start);
+  void collectStylesPass(const TimePoint &start);
+  void collectContentPass(const TimePoint &start);
+  void collectChunk(unsigned chunkType);
+  void collectXmlNode();
+  void collectShape(unsigned paths);
+  void collectNURBSPoints(unsigned long points);
+  void collectMasterCacheHit();
+  void collectDraw(const TimePoint &start);
+
+  void getStats(librevenge::RVNGPropertyList &stats) const;
+
+private:
+  unsigned long m_decompressedBytes;
+  double m_decompressionTime;
+  double m_stylesPassTime;
+  double m_contentPassTime;
+  std::map<unsigned, unsigned long> m_chunks;
+  unsigned long m_xmlNodes;
+  unsigned long m_shapes;
+  unsigned long m_paths;
+  unsigned long m_NURBSPoints;
+  unsigned long m_masterCacheHits;
+  double m_drawTime;
+};
+
+} // namespace libvisio
+
+#endif // __VSDPARSESTATS_H__
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
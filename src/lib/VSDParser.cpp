@@ -20,16 +20,19 @@
 #include "VSDInternalStream.h"
 #include "VSDDocumentStructure.h"
 #include "VSDContentCollector.h"
+#include "VSDInfoCollector.h"
 #include "VSDStylesCollector.h"
+#include "VSDTextCollector.h"
 #include "VSDMetaData.h"
 
 libvisio::VSDParser::VSDParser(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, librevenge::RVNGInputStream *container)
   : m_input(input), m_painter(painter), m_container(container), m_header(), m_collector(nullptr), m_shapeList(), m_currentLevel(0),
     m_stencils(), m_currentStencil(nullptr), m_shape(), m_isStencilStarted(false), m_isInStyles(false),
-    m_currentShapeLevel(0), m_currentShapeID(MINUS_ONE), m_currentLayerListLevel(0), m_extractStencils(false), m_colours(),
+    m_currentShapeLevel(0), m_currentShapeID(MINUS_ONE), m_currentLayerListLevel(0), m_extractStencils(false),
+    m_extractText(false), m_skipPages(false), m_infoCollector(nullptr), m_colours(),
     m_isBackgroundPage(false), m_isShapeStarted(false), m_shadowOffsetX(0.0), m_shadowOffsetY(0.0),
     m_currentGeometryList(nullptr), m_currentGeomListCount(0), m_fonts(), m_names(), m_namesMapMap(),
-    m_currentPageName(), m_currentTabSet()
+    m_currentPageName(), m_currentTabSet(), m_pageSelection(), m_limits(), m_progress(), m_stats()
 {}
 
 libvisio::VSDParser::~VSDParser()
@@ -121,7 +124,39 @@ bool libvisio::VSDParser::parseMain()
     shift = 4;
 
   m_input->seek(trailerPointer.Offset, librevenge::RVNG_SEEK_SET);
-  VSDInternalStream trailerStream(m_input, trailerPointer.Length, compressed);
+  VSDInternalStream trailerStream(m_input, trailerPointer.Length, compressed, m_limits.getDecompressionBudget());
+  m_limits.collectDecompressedBytes(trailerStream.getSize());
+
+  if (m_infoCollector)
+  {
+    m_collector = m_infoCollector;
+    if (m_container)
+      parseMetaData();
+    VSD_DEBUG_MSG(("VSDParser::parseMain probe pass\n"));
+    return parseDocument(&trailerStream, shift);
+  }
+
+  if (m_extractText)
+  {
+    VSDTextCollector textCollector(m_painter, m_stencils);
+    textCollector.setParseLimits(m_limits);
+    textCollector.setParseProgress(&m_progress);
+    m_collector = &textCollector;
+    if (m_container)
+      parseMetaData();
+
+    // Read the masters and the style sheets ahead of the pages that refer to them
+    VSD_DEBUG_MSG(("VSDParser::parseMain masters pass\n"));
+    m_skipPages = true;
+    const bool mastersParsed = parseDocument(&trailerStream, shift);
+    m_skipPages = false;
+    if (!mastersParsed)
+      return false;
+    _handleLevelChange(0);
+
+    VSD_DEBUG_MSG(("VSDParser::parseMain text pass\n"));
+    return parseDocument(&trailerStream, shift);
+  }
 
   std::vector<std::map<unsigned, XForm> > groupXFormsSequence;
   std::vector<std::map<unsigned, unsigned> > groupMembershipsSequence;
@@ -130,21 +165,35 @@ bool libvisio::VSDParser::parseMain()
   VSDStylesCollector stylesCollector(groupXFormsSequence, groupMembershipsSequence, documentPageShapeOrders);
   m_collector = &stylesCollector;
   VSD_DEBUG_MSG(("VSDParser::parseMain 1st pass\n"));
+  VSDParseStats::TimePoint passStart = VSDParseStats::now();
   if (!parseDocument(&trailerStream, shift))
     return false;
+  if (m_stats)
+    m_stats->collectStylesPass(passStart);
 
   _handleLevelChange(0);
 
+  if (!m_pageSelection.hasSelectedPages())
+    return false;
+  m_pageSelection.endFirstPass(groupXFormsSequence, groupMembershipsSequence, documentPageShapeOrders);
+
   VSDStyles styles = stylesCollector.getStyleSheets();
 
   VSDContentCollector contentCollector(m_painter, groupXFormsSequence, groupMembershipsSequence, documentPageShapeOrders, styles, m_stencils);
+  contentCollector.hideBackgroundPages(m_pageSelection.getHiddenPages());
+  contentCollector.setParseLimits(m_limits);
+  contentCollector.setParseProgress(&m_progress);
+  contentCollector.setParseStats(m_stats.get());
   m_collector = &contentCollector;
   if (m_container)
     parseMetaData();
 
   VSD_DEBUG_MSG(("VSDParser::parseMain 2nd pass\n"));
+  passStart = VSDParseStats::now();
   if (!parseDocument(&trailerStream, shift))
     return false;
+  if (m_stats)
+    m_stats->collectContentPass(passStart);
 
   return true;
 }
@@ -197,6 +246,41 @@ bool libvisio::VSDParser::extractStencils()
   return parseMain();
 }
 
+bool libvisio::VSDParser::extractText()
+{
+  m_extractText = true;
+  return parseMain();
+}
+
+bool libvisio::VSDParser::probe(librevenge::RVNGPropertyList &info)
+{
+  VSDInfoCollector infoCollector;
+  m_infoCollector = &infoCollector;
+  const bool retVal = parseMain();
+  m_infoCollector = nullptr;
+  if (retVal)
+    infoCollector.getInfo(info);
+  return retVal;
+}
+
+void libvisio::VSDParser::setPageSelection(const VSDPageSelection &pageSelection)
+{
+  m_pageSelection = pageSelection;
+}
+
+void libvisio::VSDParser::setParseOptions(const VisioParseOptions &options)
+{
+  m_limits = VSDParseLimits(options);
+  m_progress = VSDParseProgress(options.callback);
+  m_stats.reset(options.stats ? new VSDParseStats() : nullptr);
+}
+
+void libvisio::VSDParser::getStats(librevenge::RVNGPropertyList &stats) const
+{
+  if (m_stats)
+    m_stats->getStats(stats);
+}
+
 void libvisio::VSDParser::readPointer(librevenge::RVNGInputStream *input, Pointer &ptr)
 {
   ptr.Type = readU32(input);
@@ -291,23 +375,23 @@ void libvisio::VSDParser::handleStreams(librevenge::RVNGInputStream *input, unsi
 void libvisio::VSDParser::handleStream(const Pointer &ptr, unsigned idx, unsigned level, std::set<unsigned> &visited)
 {
   VSD_DEBUG_MSG(("VSDParser::HandleStream %u type 0x%x\n", idx, ptr.Type));
+  m_limits.checkTime();
+  m_progress.check();
   m_header.level = level;
   m_header.id = idx;
   m_header.chunkType = ptr.Type;
   _handleLevelChange(level);
   VSDStencil tmpStencil;
-  bool compressed = ((ptr.Format & 2) == 2);
-  m_input->seek(ptr.Offset, librevenge::RVNG_SEEK_SET);
-  VSDInternalStream tmpInput(m_input, ptr.Length, compressed);
-  m_header.dataLength = tmpInput.getSize();
-  unsigned shift = compressed ? 4 : 0;
   switch (ptr.Type)
   {
   case VSD_STYLES:
+    // text extraction reads the style sheets once, with the masters, for their fonts
+    if (m_infoCollector || (m_extractText && !m_skipPages))
+      return;
     m_isInStyles = true;
     break;
   case VSD_PAGES:
-    if (m_extractStencils)
+    if (m_extractStencils || m_skipPages)
       return;
     break;
   case VSD_PAGE:
@@ -318,6 +402,9 @@ void libvisio::VSDParser::handleStream(const Pointer &ptr, unsigned idx, unsigne
     else
       m_isBackgroundPage = false;
     _nameFromId(m_currentPageName, idx, level+1);
+    // unselected pages are not even decompressed
+    if (!m_pageSelection.startPage(idx, m_isBackgroundPage, m_currentPageName))
+      return;
     m_collector->startPage(idx);
     break;
   case VSD_STENCILS:
@@ -336,25 +423,57 @@ void libvisio::VSDParser::handleStream(const Pointer &ptr, unsigned idx, unsigne
     }
     else
       m_currentStencil = &tmpStencil;
+    if (m_infoCollector)
+      m_infoCollector->collectMaster();
     break;
   case VSD_SHAPE_GROUP:
   case VSD_SHAPE_SHAPE:
   case VSD_SHAPE_FOREIGN:
+    // shapes are not even decompressed when probing, so only the images
+    // that are not in a group are counted
+    if (m_infoCollector)
+    {
+      if (VSD_SHAPE_FOREIGN == ptr.Type)
+        m_infoCollector->collectImage();
+      return;
+    }
     m_currentShapeID = idx;
     break;
+  case VSD_SHAPE_GUIDE:
+    if (m_infoCollector)
+      return;
+    break;
   case VSD_OLE_LIST:
     if (!m_shape.m_foreign)
       m_shape.m_foreign = make_unique<ForeignData>();
     m_shape.m_foreign->dataId = idx;
     break;
+  case VSD_FOREIGN_DATA:
+  case VSD_OLE_DATA:
+    // embedded objects are not even decompressed when extracting text
+    if (m_extractText || m_infoCollector)
+      return;
+    break;
   default:
     break;
   }
 
+  bool compressed = ((ptr.Format & 2) == 2);
+  m_input->seek(ptr.Offset, librevenge::RVNG_SEEK_SET);
+  const VSDParseStats::TimePoint decompressionStart = m_stats ? VSDParseStats::now() : VSDParseStats::TimePoint();
+  VSDInternalStream tmpInput(m_input, ptr.Length, compressed, m_limits.getDecompressionBudget());
+  m_limits.collectDecompressedBytes(tmpInput.getSize());
+  if (m_stats && compressed)
+    m_stats->collectDecompression(tmpInput.getSize(), decompressionStart);
+  m_progress.collectBytes(ptr.Length);
+  m_header.dataLength = tmpInput.getSize();
+  unsigned shift = compressed ? 4 : 0;
+
   if ((ptr.Format >> 4) == 0x4 || (ptr.Format >> 4) == 0x5 || (ptr.Format >> 4) == 0x0)
   {
     handleBlob(&tmpInput, shift, level+1);
-    if ((ptr.Format >> 4) == 0x5 && ptr.Type != VSD_COLORS)
+    // visited holds the streams being handled, so its size is the nesting depth
+    if ((ptr.Format >> 4) == 0x5 && ptr.Type != VSD_COLORS && !m_limits.isTooDeep(visited.size() + 1))
     {
       const auto it = visited.insert(ptr.Offset);
       if (it.second)
@@ -458,6 +577,34 @@ void libvisio::VSDParser::handleChunks(librevenge::RVNGInputStream *input, unsig
 
 void libvisio::VSDParser::handleChunk(librevenge::RVNGInputStream *input)
 {
+  if (m_stats)
+    m_stats->collectChunk(m_header.chunkType);
+  if (m_extractText)
+  {
+    // Text extraction needs neither the geometry nor the embedded objects
+    switch (m_header.chunkType)
+    {
+    case VSD_GEOM_LIST:
+    case VSD_GEOMETRY:
+    case VSD_MOVE_TO:
+    case VSD_LINE_TO:
+    case VSD_ARC_TO:
+    case VSD_ELLIPSE:
+    case VSD_ELLIPTICAL_ARC_TO:
+    case VSD_NURBS_TO:
+    case VSD_POLYLINE_TO:
+    case VSD_INFINITE_LINE:
+    case VSD_SHAPE_DATA:
+    case VSD_SPLINE_START:
+    case VSD_SPLINE_KNOT:
+    case VSD_FOREIGN_DATA:
+    case VSD_OLE_DATA:
+      return;
+    default:
+      break;
+    }
+  }
+
   switch (m_header.chunkType)
   {
   case VSD_SHAPE_GROUP:
@@ -650,19 +797,19 @@ void libvisio::VSDParser::_flushShape()
   if (m_shape.m_txtxform)
     m_collector->collectTxtXForm(m_currentShapeLevel+2, *(m_shape.m_txtxform));
 
-  m_collector->collectLine(m_currentShapeLevel+2, m_shape.m_lineStyle.width, m_shape.m_lineStyle.colour, m_shape.m_lineStyle.pattern,
-                           m_shape.m_lineStyle.startMarker, m_shape.m_lineStyle.endMarker, m_shape.m_lineStyle.cap, m_shape.m_lineStyle.rounding,
-                           m_shape.m_lineStyle.qsLineColour, m_shape.m_lineStyle.qsLineMatrix);
+  m_collector->collectLine(m_currentShapeLevel+2, m_shape.m_lineStyle.width(), m_shape.m_lineStyle.colour(), m_shape.m_lineStyle.pattern(),
+                           m_shape.m_lineStyle.startMarker(), m_shape.m_lineStyle.endMarker(), m_shape.m_lineStyle.cap(), m_shape.m_lineStyle.rounding(),
+                           m_shape.m_lineStyle.qsLineColour(), m_shape.m_lineStyle.qsLineMatrix());
 
-  m_collector->collectFillAndShadow(m_currentShapeLevel+2, m_shape.m_fillStyle.fgColour, m_shape.m_fillStyle.bgColour, m_shape.m_fillStyle.pattern,
-                                    m_shape.m_fillStyle.fgTransparency, m_shape.m_fillStyle.bgTransparency, m_shape.m_fillStyle.shadowPattern,
-                                    m_shape.m_fillStyle.shadowFgColour, m_shape.m_fillStyle.shadowOffsetX, m_shape.m_fillStyle.shadowOffsetY,
-                                    m_shape.m_fillStyle.qsFillColour, m_shape.m_fillStyle.qsShadowColour, m_shape.m_fillStyle.qsFillMatrix);
+  m_collector->collectFillAndShadow(m_currentShapeLevel+2, m_shape.m_fillStyle.fgColour(), m_shape.m_fillStyle.bgColour(), m_shape.m_fillStyle.pattern(),
+                                    m_shape.m_fillStyle.fgTransparency(), m_shape.m_fillStyle.bgTransparency(), m_shape.m_fillStyle.shadowPattern(),
+                                    m_shape.m_fillStyle.shadowFgColour(), m_shape.m_fillStyle.shadowOffsetX(), m_shape.m_fillStyle.shadowOffsetY(),
+                                    m_shape.m_fillStyle.qsFillColour(), m_shape.m_fillStyle.qsShadowColour(), m_shape.m_fillStyle.qsFillMatrix());
 
-  m_collector->collectTextBlock(m_currentShapeLevel+2, m_shape.m_textBlockStyle.leftMargin, m_shape.m_textBlockStyle.rightMargin,
-                                m_shape.m_textBlockStyle.topMargin, m_shape.m_textBlockStyle.bottomMargin, m_shape.m_textBlockStyle.verticalAlign,
-                                m_shape.m_textBlockStyle.isTextBkgndFilled, m_shape.m_textBlockStyle.textBkgndColour,
-                                m_shape.m_textBlockStyle.defaultTabStop, m_shape.m_textBlockStyle.textDirection);
+  m_collector->collectTextBlock(m_currentShapeLevel+2, m_shape.m_textBlockStyle.leftMargin(), m_shape.m_textBlockStyle.rightMargin(),
+                                m_shape.m_textBlockStyle.topMargin(), m_shape.m_textBlockStyle.bottomMargin(), m_shape.m_textBlockStyle.verticalAlign(),
+                                m_shape.m_textBlockStyle.isTextBkgndFilled(), m_shape.m_textBlockStyle.textBkgndColour(),
+                                m_shape.m_textBlockStyle.defaultTabStop(), m_shape.m_textBlockStyle.textDirection());
 
   if (m_shape.m_foreign)
     m_collector->collectForeignDataType(m_currentShapeLevel+2, m_shape.m_foreign->type, m_shape.m_foreign->format,
@@ -694,19 +841,19 @@ void libvisio::VSDParser::_flushShape()
   for (std::map<unsigned, VSDGeometryList>::const_iterator iterGeom = m_shape.m_geometries.begin(); iterGeom != m_shape.m_geometries.end(); ++iterGeom)
     iterGeom->second.handle(m_collector);
 
-  m_collector->collectDefaultCharStyle(m_shape.m_charStyle.charCount, m_shape.m_charStyle.font, m_shape.m_charStyle.colour,
-                                       m_shape.m_charStyle.size, m_shape.m_charStyle.bold, m_shape.m_charStyle.italic, m_shape.m_charStyle.underline,
-                                       m_shape.m_charStyle.doubleunderline, m_shape.m_charStyle.strikeout, m_shape.m_charStyle.doublestrikeout,
-                                       m_shape.m_charStyle.allcaps, m_shape.m_charStyle.initcaps, m_shape.m_charStyle.smallcaps,
-                                       m_shape.m_charStyle.superscript, m_shape.m_charStyle.subscript, m_shape.m_charStyle.scaleWidth);
+  m_collector->collectDefaultCharStyle(m_shape.m_charStyle.charCount, m_shape.m_charStyle.font(), m_shape.m_charStyle.colour(),
+                                       m_shape.m_charStyle.size(), m_shape.m_charStyle.bold(), m_shape.m_charStyle.italic(), m_shape.m_charStyle.underline(),
+                                       m_shape.m_charStyle.doubleunderline(), m_shape.m_charStyle.strikeout(), m_shape.m_charStyle.doublestrikeout(),
+                                       m_shape.m_charStyle.allcaps(), m_shape.m_charStyle.initcaps(), m_shape.m_charStyle.smallcaps(),
+                                       m_shape.m_charStyle.superscript(), m_shape.m_charStyle.subscript(), m_shape.m_charStyle.scaleWidth());
 
   m_shape.m_charList.handle(m_collector);
 
-  m_collector->collectDefaultParaStyle(m_shape.m_paraStyle.charCount, m_shape.m_paraStyle.indFirst, m_shape.m_paraStyle.indLeft,
-                                       m_shape.m_paraStyle.indRight, m_shape.m_paraStyle.spLine, m_shape.m_paraStyle.spBefore,
-                                       m_shape.m_paraStyle.spAfter, m_shape.m_paraStyle.align, m_shape.m_paraStyle.bullet,
-                                       m_shape.m_paraStyle.bulletStr, m_shape.m_paraStyle.bulletFont, m_shape.m_paraStyle.bulletFontSize,
-                                       m_shape.m_paraStyle.textPosAfterBullet, m_shape.m_paraStyle.flags);
+  m_collector->collectDefaultParaStyle(m_shape.m_paraStyle.charCount, m_shape.m_paraStyle.indFirst(), m_shape.m_paraStyle.indLeft(),
+                                       m_shape.m_paraStyle.indRight(), m_shape.m_paraStyle.spLine(), m_shape.m_paraStyle.spBefore(),
+                                       m_shape.m_paraStyle.spAfter(), m_shape.m_paraStyle.align(), m_shape.m_paraStyle.bullet(),
+                                       m_shape.m_paraStyle.bulletStr(), m_shape.m_paraStyle.bulletFont(), m_shape.m_paraStyle.bulletFontSize(),
+                                       m_shape.m_paraStyle.textPosAfterBullet(), m_shape.m_paraStyle.flags());
 
   m_shape.m_paraList.handle(m_collector);
 }
@@ -764,9 +911,13 @@ void libvisio::VSDParser::readEllipticalArcTo(librevenge::RVNGInputStream *input
 
 void libvisio::VSDParser::readForeignData(librevenge::RVNGInputStream *input)
 {
+  // The rest of the chunk is skipped by the caller
+  const unsigned long length = m_limits.getImageReadLength(m_header.dataLength);
+  if (!length)
+    return;
   unsigned long tmpBytesRead = 0;
-  const unsigned char *buffer = input->read(m_header.dataLength, tmpBytesRead);
-  if (m_header.dataLength != tmpBytesRead)
+  const unsigned char *buffer = input->read(length, tmpBytesRead);
+  if (length != tmpBytesRead)
     return;
   librevenge::RVNGBinaryData binaryData(buffer, tmpBytesRead);
 
@@ -782,16 +933,25 @@ void libvisio::VSDParser::readOLEList(librevenge::RVNGInputStream * /* input */)
 
 void libvisio::VSDParser::readOLEData(librevenge::RVNGInputStream *input)
 {
+  // Unless the object is embedded, the start of its first stream is all that is needed
+  if (!m_limits.isImageEmbedded() && m_shape.m_foreign && !m_shape.m_foreign->data.empty())
+    return;
+  const unsigned long length = m_limits.getImageReadLength(m_header.dataLength);
+  if (!length)
+    return;
   unsigned long tmpBytesRead = 0;
-  const unsigned char *buffer = input->read(m_header.dataLength, tmpBytesRead);
-  if (m_header.dataLength != tmpBytesRead)
+  const unsigned char *buffer = input->read(length, tmpBytesRead);
+  if (length != tmpBytesRead)
     return;
   librevenge::RVNGBinaryData oleData(buffer, tmpBytesRead);
 
   if (!m_shape.m_foreign)
     m_shape.m_foreign = make_unique<ForeignData>();
   // Append data instead of setting it - allows multi-stream OLE objects
-  m_shape.m_foreign->data.append(oleData);
+  if (m_shape.m_foreign->data.empty())
+    m_shape.m_foreign->data = oleData;
+  else
+    m_shape.m_foreign->data.append(oleData);
 
 }
 
@@ -1083,6 +1243,7 @@ void libvisio::VSDParser::readPage(librevenge::RVNGInputStream *input)
 {
   input->seek(8, librevenge::RVNG_SEEK_CUR); //sub header length and children list length
   unsigned backgroundPageID = readU32(input);
+  m_pageSelection.collectBackgroundPage(backgroundPageID);
   m_collector->collectPage(m_header.id, m_header.level, backgroundPageID, m_isBackgroundPage, m_currentPageName);
 }
 
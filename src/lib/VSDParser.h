@@ -15,6 +15,7 @@
 #include <vector>
 #include <stack>
 #include <map>
+#include <memory>
 #include <set>
 #include <librevenge/librevenge.h>
 #include "VSDTypes.h"
@@ -25,11 +26,16 @@
 #include "VSDShapeList.h"
 #include "VSDLayerList.h"
 #include "VSDStencils.h"
+#include "VSDPageSelection.h"
+#include "VSDParseLimits.h"
+#include "VSDParseProgress.h"
+#include "VSDParseStats.h"
 
 namespace libvisio
 {
 
 class VSDCollector;
+class VSDInfoCollector;
 
 struct Pointer
 {
@@ -51,6 +57,11 @@ public:
   virtual ~VSDParser();
   bool parseMain();
   bool extractStencils();
+  bool extractText();
+  bool probe(librevenge::RVNGPropertyList &info);
+  void setPageSelection(const VSDPageSelection &pageSelection);
+  void setParseOptions(const VisioParseOptions &options);
+  void getStats(librevenge::RVNGPropertyList &stats) const;
 
 protected:
   // reader functions
@@ -161,6 +172,9 @@ protected:
   unsigned m_currentLayerListLevel;
 
   bool m_extractStencils;
+  bool m_extractText;
+  bool m_skipPages;
+  VSDInfoCollector *m_infoCollector;
   std::vector<Colour> m_colours;
 
   bool m_isBackgroundPage;
@@ -179,6 +193,11 @@ protected:
 
   std::map<unsigned, VSDTabStop> *m_currentTabSet;
 
+  VSDPageSelection m_pageSelection;
+  VSDParseLimits m_limits;
+  VSDParseProgress m_progress;
+  std::unique_ptr<VSDParseStats> m_stats;
+
 private:
   VSDParser();
   VSDParser(const VSDParser &);
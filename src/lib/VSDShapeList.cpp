@@ -67,19 +67,18 @@ const std::vector<unsigned> &libvisio::VSDShapeList::getShapesOrder()
   if (!m_shapesOrder.empty())
     return m_shapesOrder;
 
-  std::map<unsigned, unsigned>::const_iterator iter;
   if (!m_elementsOrder.empty())
   {
     for (unsigned int i : m_elementsOrder)
     {
-      iter = m_elements.find(i);
+      auto iter = m_elements.find(i);
       if (iter != m_elements.end())
         m_shapesOrder.push_back(iter->second);
     }
   }
   else
   {
-    for (iter = m_elements.begin(); iter != m_elements.end(); ++iter)
+    for (auto iter = m_elements.begin(); iter != m_elements.end(); ++iter)
       m_shapesOrder.push_back(iter->second);
   }
   return m_shapesOrder;
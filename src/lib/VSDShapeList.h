@@ -11,7 +11,7 @@
 #define __VSDSHAPELIST_H__
 
 #include <vector>
-#include <map>
+#include "VSDIdMap.h"
 
 namespace libvisio
 {
@@ -33,7 +33,7 @@ public:
   }
   const std::vector<unsigned> &getShapesOrder();
 private:
-  std::map<unsigned, unsigned> m_elements;
+  VSDIdMap<unsigned> m_elements;
   std::vector<unsigned> m_elementsOrder;
   std::vector<unsigned> m_shapesOrder;
 };
@@ -126,6 +126,15 @@ void libvisio::VSDStencil::addStencilShape(unsigned id, const VSDShape &shape)
   m_shapes[id] = shape;
 }
 
+// Adds the shapes of stencil as if they had been parsed after the shapes of this one
+void libvisio::VSDStencil::addStencilShapes(const VSDStencil &stencil)
+{
+  for (const auto &shape : stencil.m_shapes)
+    m_shapes[shape.first] = shape.second;
+  if (stencil.m_firstShapeId != MINUS_ONE)
+    setFirstShape(stencil.m_firstShapeId);
+}
+
 void libvisio::VSDStencil::setFirstShape(unsigned id)
 {
   if (m_firstShapeId == MINUS_ONE)
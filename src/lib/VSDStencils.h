@@ -67,6 +67,7 @@ public:
   ~VSDStencil();
   VSDStencil &operator=(const VSDStencil &stencil) = default;
   void addStencilShape(unsigned id, const VSDShape &shape);
+  void addStencilShapes(const VSDStencil &stencil);
   void setFirstShape(unsigned id);
   const VSDShape *getStencilShape(unsigned id) const;
   std::map<unsigned, VSDShape> m_shapes;
@@ -11,6 +11,7 @@
 #define __VSDSTYLES_H__
 
 #include <map>
+#include <tuple>
 #include <vector>
 #include <boost/optional.hpp>
 #include "VSDTypes.h"
@@ -20,43 +21,89 @@
 namespace libvisio
 {
 
+/* The optional styles store their fields as plain values, tightly packed,
+ * and record which of them are set in a bitmask. Each style lists its
+ * fields once, largest first, in a macro from which the members, the
+ * accessors and override() are generated. For a field name:
+ *   name() returns the value, or none if it is not set
+ *   name(value) sets it; an empty optional leaves the field as it is
+ */
+#define VSD_STYLE_FIELD_INDEX(type, name) name##Index,
+#define VSD_STYLE_FIELD_INIT(type, name) m_##name(),
+#define VSD_STYLE_FIELD_MEMBER(type, name) type m_##name;
+#define VSD_STYLE_FIELD_ACCESSORS(type, name) \
+  boost::optional<type> name() const \
+  { \
+    return isSet(name##Index) ? boost::optional<type>(m_##name) : boost::none; \
+  } \
+  void name(const type &value) \
+  { \
+    m_##name = value; \
+    m_mask |= 1u << name##Index; \
+  } \
+  void name(const boost::optional<type> &value) \
+  { \
+    if (!!value) \
+      name(value.get()); \
+  }
+#define VSD_STYLE_FIELD_OVERRIDE(type, name) \
+  if (style.isSet(name##Index)) \
+    m_##name = style.m_##name;
+
+#define VSD_OPTIONAL_STYLE_BODY(Style, FIELDS) \
+public: \
+  Style(const Style &style) = default; \
+  ~Style() {} \
+  Style &operator=(const Style &style) = default; \
+  void override(const Style &style) \
+  { \
+    FIELDS(VSD_STYLE_FIELD_OVERRIDE) \
+    m_mask |= style.m_mask; \
+  } \
+  FIELDS(VSD_STYLE_FIELD_ACCESSORS) \
+private: \
+  enum { FIELDS(VSD_STYLE_FIELD_INDEX) }; \
+  bool isSet(unsigned index) const \
+  { \
+    return m_mask & (1u << index); \
+  } \
+  FIELDS(VSD_STYLE_FIELD_MEMBER) \
+  unsigned m_mask;
+
+#define VSD_LINE_STYLE_FIELDS(F) \
+  F(double, width) \
+  F(double, rounding) \
+  F(long, qsLineColour) \
+  F(long, qsLineMatrix) \
+  F(Colour, colour) \
+  F(unsigned char, pattern) \
+  F(unsigned char, startMarker) \
+  F(unsigned char, endMarker) \
+  F(unsigned char, cap)
+
 struct VSDOptionalLineStyle
 {
   VSDOptionalLineStyle() :
-    width(), colour(), pattern(), startMarker(), endMarker(), cap(), rounding(),
-    qsLineColour(), qsLineMatrix() {}
+    VSD_LINE_STYLE_FIELDS(VSD_STYLE_FIELD_INIT) m_mask(0) {}
   VSDOptionalLineStyle(const boost::optional<double> &w, const boost::optional<Colour> &col,
                        const boost::optional<unsigned char> &p, const boost::optional<unsigned char> &sm,
                        const boost::optional<unsigned char> &em, const boost::optional<unsigned char> &c,
                        const boost::optional<double> &r, const boost::optional<long> &qlc,
                        const boost::optional<long> &qlm) :
-    width(w), colour(col), pattern(p), startMarker(sm), endMarker(em), cap(c), rounding(r),
-    qsLineColour(qlc), qsLineMatrix(qlm) {}
-  VSDOptionalLineStyle(const VSDOptionalLineStyle &style) = default;
-  ~VSDOptionalLineStyle() {}
-  VSDOptionalLineStyle &operator=(const VSDOptionalLineStyle &style) = default;
-  void override(const VSDOptionalLineStyle &style)
+    VSD_LINE_STYLE_FIELDS(VSD_STYLE_FIELD_INIT) m_mask(0)
   {
-    ASSIGN_OPTIONAL(style.width, width);
-    ASSIGN_OPTIONAL(style.colour, colour);
-    ASSIGN_OPTIONAL(style.pattern, pattern);
-    ASSIGN_OPTIONAL(style.startMarker, startMarker);
-    ASSIGN_OPTIONAL(style.endMarker, endMarker);
-    ASSIGN_OPTIONAL(style.cap, cap);
-    ASSIGN_OPTIONAL(style.rounding, rounding);
-    ASSIGN_OPTIONAL(style.qsLineColour, qsLineColour);
-    ASSIGN_OPTIONAL(style.qsLineMatrix, qsLineMatrix);
+    width(w);
+    colour(col);
+    pattern(p);
+    startMarker(sm);
+    endMarker(em);
+    cap(c);
+    rounding(r);
+    qsLineColour(qlc);
+    qsLineMatrix(qlm);
   }
 
-  boost::optional<double> width;
-  boost::optional<Colour> colour;
-  boost::optional<unsigned char> pattern;
-  boost::optional<unsigned char> startMarker;
-  boost::optional<unsigned char> endMarker;
-  boost::optional<unsigned char> cap;
-  boost::optional<double> rounding;
-  boost::optional<long> qsLineColour;
-  boost::optional<long> qsLineMatrix;
+  VSD_OPTIONAL_STYLE_BODY(VSDOptionalLineStyle, VSD_LINE_STYLE_FIELDS)
 };
 
 struct VSDLineStyle
@@ -73,20 +120,20 @@ struct VSDLineStyle
   VSDLineStyle &operator=(const VSDLineStyle &style) = default;
   void override(const VSDOptionalLineStyle &style, const VSDXTheme *theme)
   {
-    ASSIGN_OPTIONAL(style.width, width);
-    ASSIGN_OPTIONAL(style.pattern, pattern);
-    ASSIGN_OPTIONAL(style.startMarker, startMarker);
-    ASSIGN_OPTIONAL(style.endMarker, endMarker);
-    ASSIGN_OPTIONAL(style.cap, cap);
-    ASSIGN_OPTIONAL(style.rounding, rounding);
-    ASSIGN_OPTIONAL(style.qsLineColour, qsLineColour);
-    ASSIGN_OPTIONAL(style.qsLineMatrix, qsLineMatrix);
+    ASSIGN_OPTIONAL(style.width(), width);
+    ASSIGN_OPTIONAL(style.pattern(), pattern);
+    ASSIGN_OPTIONAL(style.startMarker(), startMarker);
+    ASSIGN_OPTIONAL(style.endMarker(), endMarker);
+    ASSIGN_OPTIONAL(style.cap(), cap);
+    ASSIGN_OPTIONAL(style.rounding(), rounding);
+    ASSIGN_OPTIONAL(style.qsLineColour(), qsLineColour);
+    ASSIGN_OPTIONAL(style.qsLineMatrix(), qsLineMatrix);
     if (theme)
     {
-      if (!!style.qsLineColour && style.qsLineColour.get() >= 0)
-        ASSIGN_OPTIONAL(theme->getThemeColour(style.qsLineColour.get()), colour);
+      if (!!style.qsLineColour() && style.qsLineColour().get() >= 0)
+        ASSIGN_OPTIONAL(theme->getThemeColour(style.qsLineColour().get()), colour);
     }
-    ASSIGN_OPTIONAL(style.colour, colour);
+    ASSIGN_OPTIONAL(style.colour(), colour);
   }
 
   double width;
@@ -100,52 +147,47 @@ struct VSDLineStyle
   long qsLineMatrix;
 };
 
+#define VSD_FILL_STYLE_FIELDS(F) \
+  F(double, fgTransparency) \
+  F(double, bgTransparency) \
+  F(double, shadowOffsetX) \
+  F(double, shadowOffsetY) \
+  F(long, qsFillColour) \
+  F(long, qsShadowColour) \
+  F(long, qsFillMatrix) \
+  F(Colour, fgColour) \
+  F(Colour, bgColour) \
+  F(Colour, shadowFgColour) \
+  F(unsigned char, pattern) \
+  F(unsigned char, shadowPattern)
+
 struct VSDOptionalFillStyle
 {
   VSDOptionalFillStyle() :
-    fgColour(), bgColour(), pattern(), fgTransparency(), bgTransparency(), shadowFgColour(),
-    shadowPattern(), shadowOffsetX(), shadowOffsetY(), qsFillColour(), qsShadowColour(),
-    qsFillMatrix() {}
+    VSD_FILL_STYLE_FIELDS(VSD_STYLE_FIELD_INIT) m_mask(0) {}
   VSDOptionalFillStyle(const boost::optional<Colour> &fgc, const boost::optional<Colour> &bgc,
                        const boost::optional<unsigned char> &p, const boost::optional<double> &fga,
                        const boost::optional<double> &bga, const boost::optional<Colour> &sfgc,
                        const boost::optional<unsigned char> &shp, const boost::optional<double> &shX,
                        const boost::optional<double> &shY, const boost::optional<long> &qsFc,
                        const boost::optional<long> &qsSc, const boost::optional<long> &qsFm) :
-    fgColour(fgc), bgColour(bgc), pattern(p), fgTransparency(fga), bgTransparency(bga),
-    shadowFgColour(sfgc), shadowPattern(shp), shadowOffsetX(shX), shadowOffsetY(shY),
-    qsFillColour(qsFc), qsShadowColour(qsSc), qsFillMatrix(qsFm) {}
-  VSDOptionalFillStyle(const VSDOptionalFillStyle &style) = default;
-  ~VSDOptionalFillStyle() {}
-  VSDOptionalFillStyle &operator=(const VSDOptionalFillStyle &style) = default;
-  void override(const VSDOptionalFillStyle &style)
+    VSD_FILL_STYLE_FIELDS(VSD_STYLE_FIELD_INIT) m_mask(0)
   {
-    ASSIGN_OPTIONAL(style.pattern, pattern);
-    ASSIGN_OPTIONAL(style.fgTransparency, fgTransparency);
-    ASSIGN_OPTIONAL(style.bgTransparency, bgTransparency);
-    ASSIGN_OPTIONAL(style.shadowPattern, shadowPattern);
-    ASSIGN_OPTIONAL(style.shadowOffsetX, shadowOffsetX);
-    ASSIGN_OPTIONAL(style.shadowOffsetY, shadowOffsetY);
-    ASSIGN_OPTIONAL(style.qsFillColour, qsFillColour);
-    ASSIGN_OPTIONAL(style.qsShadowColour, qsShadowColour);
-    ASSIGN_OPTIONAL(style.qsFillMatrix, qsFillMatrix);
-    ASSIGN_OPTIONAL(style.fgColour, fgColour);
-    ASSIGN_OPTIONAL(style.bgColour, bgColour);
-    ASSIGN_OPTIONAL(style.shadowFgColour, shadowFgColour);
+    fgColour(fgc);
+    bgColour(bgc);
+    pattern(p);
+    fgTransparency(fga);
+    bgTransparency(bga);
+    shadowFgColour(sfgc);
+    shadowPattern(shp);
+    shadowOffsetX(shX);
+    shadowOffsetY(shY);
+    qsFillColour(qsFc);
+    qsShadowColour(qsSc);
+    qsFillMatrix(qsFm);
   }
 
-  boost::optional<Colour> fgColour;
-  boost::optional<Colour> bgColour;
-  boost::optional<unsigned char> pattern;
-  boost::optional<double> fgTransparency;
-  boost::optional<double> bgTransparency;
-  boost::optional<Colour> shadowFgColour;
-  boost::optional<unsigned char> shadowPattern;
-  boost::optional<double> shadowOffsetX;
-  boost::optional<double> shadowOffsetY;
-  boost::optional<long> qsFillColour;
-  boost::optional<long> qsShadowColour;
-  boost::optional<long> qsFillMatrix;
+  VSD_OPTIONAL_STYLE_BODY(VSDOptionalFillStyle, VSD_FILL_STYLE_FIELDS)
 };
 
 struct VSDFillStyle
@@ -165,30 +207,30 @@ struct VSDFillStyle
   VSDFillStyle &operator=(const VSDFillStyle &style) = default;
   void override(const VSDOptionalFillStyle &style, const VSDXTheme *theme)
   {
-    ASSIGN_OPTIONAL(style.pattern, pattern);
-    ASSIGN_OPTIONAL(style.fgTransparency, fgTransparency);
-    ASSIGN_OPTIONAL(style.bgTransparency, bgTransparency);
-    ASSIGN_OPTIONAL(style.shadowPattern, shadowPattern);
-    ASSIGN_OPTIONAL(style.shadowOffsetX, shadowOffsetX);
-    ASSIGN_OPTIONAL(style.shadowOffsetY, shadowOffsetY);
-    ASSIGN_OPTIONAL(style.shadowOffsetY, shadowOffsetY);
-    ASSIGN_OPTIONAL(style.qsFillColour, qsFillColour);
-    ASSIGN_OPTIONAL(style.qsShadowColour, qsShadowColour);
-    ASSIGN_OPTIONAL(style.qsFillMatrix, qsFillMatrix);
+    ASSIGN_OPTIONAL(style.pattern(), pattern);
+    ASSIGN_OPTIONAL(style.fgTransparency(), fgTransparency);
+    ASSIGN_OPTIONAL(style.bgTransparency(), bgTransparency);
+    ASSIGN_OPTIONAL(style.shadowPattern(), shadowPattern);
+    ASSIGN_OPTIONAL(style.shadowOffsetX(), shadowOffsetX);
+    ASSIGN_OPTIONAL(style.shadowOffsetY(), shadowOffsetY);
+    ASSIGN_OPTIONAL(style.shadowOffsetY(), shadowOffsetY);
+    ASSIGN_OPTIONAL(style.qsFillColour(), qsFillColour);
+    ASSIGN_OPTIONAL(style.qsShadowColour(), qsShadowColour);
+    ASSIGN_OPTIONAL(style.qsFillMatrix(), qsFillMatrix);
     if (theme)
     {
-      if (!!style.qsFillColour && style.qsFillColour.get() >= 0)
-        ASSIGN_OPTIONAL(theme->getThemeColour(style.qsFillColour.get()), fgColour);
+      if (!!style.qsFillColour() && style.qsFillColour().get() >= 0)
+        ASSIGN_OPTIONAL(theme->getThemeColour(style.qsFillColour().get()), fgColour);
 
-      if (!!style.qsFillColour && style.qsFillColour.get() >= 0)
-        ASSIGN_OPTIONAL(theme->getThemeColour(style.qsFillColour.get()), bgColour);
+      if (!!style.qsFillColour() && style.qsFillColour().get() >= 0)
+        ASSIGN_OPTIONAL(theme->getThemeColour(style.qsFillColour().get()), bgColour);
 
-      if (!!style.qsShadowColour && style.qsShadowColour.get() >= 0)
-        ASSIGN_OPTIONAL(theme->getThemeColour(style.qsShadowColour.get()), shadowFgColour);
+      if (!!style.qsShadowColour() && style.qsShadowColour().get() >= 0)
+        ASSIGN_OPTIONAL(theme->getThemeColour(style.qsShadowColour().get()), shadowFgColour);
     }
-    ASSIGN_OPTIONAL(style.fgColour, fgColour);
-    ASSIGN_OPTIONAL(style.bgColour, bgColour);
-    ASSIGN_OPTIONAL(style.shadowFgColour, shadowFgColour);
+    ASSIGN_OPTIONAL(style.fgColour(), fgColour);
+    ASSIGN_OPTIONAL(style.bgColour(), bgColour);
+    ASSIGN_OPTIONAL(style.shadowFgColour(), shadowFgColour);
   }
 
   Colour fgColour;
@@ -205,13 +247,27 @@ struct VSDFillStyle
   long qsFillMatrix;
 };
 
+#define VSD_CHAR_STYLE_FIELDS(F) \
+  F(VSDName, font) \
+  F(double, size) \
+  F(double, scaleWidth) \
+  F(Colour, colour) \
+  F(bool, bold) \
+  F(bool, italic) \
+  F(bool, underline) \
+  F(bool, doubleunderline) \
+  F(bool, strikeout) \
+  F(bool, doublestrikeout) \
+  F(bool, allcaps) \
+  F(bool, initcaps) \
+  F(bool, smallcaps) \
+  F(bool, superscript) \
+  F(bool, subscript)
+
 struct VSDOptionalCharStyle
 {
   VSDOptionalCharStyle()
-    : charCount(0), font(), colour(), size(), bold(), italic(),
-      underline(), doubleunderline(), strikeout(), doublestrikeout(),
-      allcaps(), initcaps(), smallcaps(), superscript(), subscript(),
-      scaleWidth() {}
+    : charCount(0), VSD_CHAR_STYLE_FIELDS(VSD_STYLE_FIELD_INIT) m_mask(0) {}
   VSDOptionalCharStyle(unsigned cc, const boost::optional<VSDName> &ft,
                        const boost::optional<Colour> &c, const boost::optional<double> &s,
                        const boost::optional<bool> &b, const boost::optional<bool> &i,
@@ -220,48 +276,28 @@ struct VSDOptionalCharStyle
                        const boost::optional<bool> &ac, const boost::optional<bool> &ic,
                        const boost::optional<bool> &sc, const boost::optional<bool> &super,
                        const boost::optional<bool> &sub, const boost::optional<double> &sw) :
-    charCount(cc), font(ft), colour(c), size(s), bold(b), italic(i),
-    underline(u), doubleunderline(du), strikeout(so), doublestrikeout(dso),
-    allcaps(ac), initcaps(ic), smallcaps(sc), superscript(super),
-    subscript(sub), scaleWidth(sw) {}
-  VSDOptionalCharStyle(const VSDOptionalCharStyle &style) = default;
-  ~VSDOptionalCharStyle() {}
-  VSDOptionalCharStyle &operator=(const VSDOptionalCharStyle &style) = default;
-  void override(const VSDOptionalCharStyle &style)
+    charCount(cc), VSD_CHAR_STYLE_FIELDS(VSD_STYLE_FIELD_INIT) m_mask(0)
   {
-    ASSIGN_OPTIONAL(style.font, font);
-    ASSIGN_OPTIONAL(style.colour, colour);
-    ASSIGN_OPTIONAL(style.size, size);
-    ASSIGN_OPTIONAL(style.bold, bold);
-    ASSIGN_OPTIONAL(style.italic, italic);
-    ASSIGN_OPTIONAL(style.underline, underline);
-    ASSIGN_OPTIONAL(style.doubleunderline, doubleunderline);
-    ASSIGN_OPTIONAL(style.strikeout, strikeout);
-    ASSIGN_OPTIONAL(style.doublestrikeout, doublestrikeout);
-    ASSIGN_OPTIONAL(style.allcaps, allcaps);
-    ASSIGN_OPTIONAL(style.initcaps, initcaps);
-    ASSIGN_OPTIONAL(style.smallcaps, smallcaps);
-    ASSIGN_OPTIONAL(style.superscript, superscript);
-    ASSIGN_OPTIONAL(style.subscript, subscript);
-    ASSIGN_OPTIONAL(style.scaleWidth, scaleWidth);
+    font(ft);
+    colour(c);
+    size(s);
+    bold(b);
+    italic(i);
+    underline(u);
+    doubleunderline(du);
+    strikeout(so);
+    doublestrikeout(dso);
+    allcaps(ac);
+    initcaps(ic);
+    smallcaps(sc);
+    superscript(super);
+    subscript(sub);
+    scaleWidth(sw);
   }
 
   unsigned charCount;
-  boost::optional<VSDName> font;
-  boost::optional<Colour> colour;
-  boost::optional<double> size;
-  boost::optional<bool> bold;
-  boost::optional<bool> italic;
-  boost::optional<bool> underline;
-  boost::optional<bool> doubleunderline;
-  boost::optional<bool> strikeout;
-  boost::optional<bool> doublestrikeout;
-  boost::optional<bool> allcaps;
-  boost::optional<bool> initcaps;
-  boost::optional<bool> smallcaps;
-  boost::optional<bool> superscript;
-  boost::optional<bool> subscript;
-  boost::optional<double> scaleWidth;
+
+  VSD_OPTIONAL_STYLE_BODY(VSDOptionalCharStyle, VSD_CHAR_STYLE_FIELDS)
 };
 
 struct VSDCharStyle
@@ -284,21 +320,30 @@ struct VSDCharStyle
   VSDCharStyle &operator=(const VSDCharStyle &style) = default;
   void override(const VSDOptionalCharStyle &style, const VSDXTheme * /* theme */)
   {
-    ASSIGN_OPTIONAL(style.font, font);
-    ASSIGN_OPTIONAL(style.colour, colour);
-    ASSIGN_OPTIONAL(style.size, size);
-    ASSIGN_OPTIONAL(style.bold, bold);
-    ASSIGN_OPTIONAL(style.italic, italic);
-    ASSIGN_OPTIONAL(style.underline, underline);
-    ASSIGN_OPTIONAL(style.doubleunderline, doubleunderline);
-    ASSIGN_OPTIONAL(style.strikeout, strikeout);
-    ASSIGN_OPTIONAL(style.doublestrikeout, doublestrikeout);
-    ASSIGN_OPTIONAL(style.allcaps, allcaps);
-    ASSIGN_OPTIONAL(style.initcaps, initcaps);
-    ASSIGN_OPTIONAL(style.smallcaps, smallcaps);
-    ASSIGN_OPTIONAL(style.superscript, superscript);
-    ASSIGN_OPTIONAL(style.subscript, subscript);
-    ASSIGN_OPTIONAL(style.scaleWidth, scaleWidth);
+    ASSIGN_OPTIONAL(style.font(), font);
+    ASSIGN_OPTIONAL(style.colour(), colour);
+    ASSIGN_OPTIONAL(style.size(), size);
+    ASSIGN_OPTIONAL(style.bold(), bold);
+    ASSIGN_OPTIONAL(style.italic(), italic);
+    ASSIGN_OPTIONAL(style.underline(), underline);
+    ASSIGN_OPTIONAL(style.doubleunderline(), doubleunderline);
+    ASSIGN_OPTIONAL(style.strikeout(), strikeout);
+    ASSIGN_OPTIONAL(style.doublestrikeout(), doublestrikeout);
+    ASSIGN_OPTIONAL(style.allcaps(), allcaps);
+    ASSIGN_OPTIONAL(style.initcaps(), initcaps);
+    ASSIGN_OPTIONAL(style.smallcaps(), smallcaps);
+    ASSIGN_OPTIONAL(style.superscript(), superscript);
+    ASSIGN_OPTIONAL(style.subscript(), subscript);
+    ASSIGN_OPTIONAL(style.scaleWidth(), scaleWidth);
+  }
+  bool operator<(const VSDCharStyle &style) const
+  {
+    return std::tie(charCount, font, colour, size, bold, italic, underline, doubleunderline, strikeout,
+                    doublestrikeout, allcaps, initcaps, smallcaps, superscript, subscript, scaleWidth)
+           < std::tie(style.charCount, style.font, style.colour, style.size, style.bold, style.italic,
+                      style.underline, style.doubleunderline, style.strikeout, style.doublestrikeout,
+                      style.allcaps, style.initcaps, style.smallcaps, style.superscript, style.subscript,
+                      style.scaleWidth);
   }
 
   unsigned charCount;
@@ -319,11 +364,29 @@ struct VSDCharStyle
   double scaleWidth;
 };
 
+#define VSD_PARA_STYLE_FIELDS(F) \
+  F(VSDName, bulletStr) \
+  F(VSDName, bulletFont) \
+  F(double, indFirst) \
+  F(double, indLeft) \
+  F(double, indRight) \
+  F(double, spLine) \
+  F(double, spBefore) \
+  F(double, spAfter) \
+  F(double, bulletFontSize) \
+  F(double, textPosAfterBullet) \
+  F(unsigned, flags) \
+  F(unsigned char, align) \
+  F(unsigned char, bullet)
+
 struct VSDOptionalParaStyle
 {
   VSDOptionalParaStyle() :
-    charCount(0), indFirst(), indLeft(), indRight(), spLine(), spBefore(), spAfter(), align(), bullet(),
-    bulletStr(), bulletFont(), bulletFontSize(0.0), textPosAfterBullet(0.0), flags() {}
+    charCount(0), VSD_PARA_STYLE_FIELDS(VSD_STYLE_FIELD_INIT) m_mask(0)
+  {
+    bulletFontSize(0.0);
+    textPosAfterBullet(0.0);
+  }
   VSDOptionalParaStyle(unsigned cc, const boost::optional<double> &ifst, const boost::optional<double> &il,
                        const boost::optional<double> &ir, const boost::optional<double> &sl,
                        const boost::optional<double> &sb, const boost::optional<double> &sa,
@@ -331,43 +394,26 @@ struct VSDOptionalParaStyle
                        const boost::optional<VSDName> &bs, const boost::optional<VSDName> &bf,
                        const boost::optional<double> bfs, const boost::optional<double> &tpab,
                        const boost::optional<unsigned> &f) :
-    charCount(cc), indFirst(ifst), indLeft(il), indRight(ir), spLine(sl), spBefore(sb), spAfter(sa),
-    align(a), bullet(b), bulletStr(bs), bulletFont(bf), bulletFontSize(bfs),
-    textPosAfterBullet(tpab), flags(f) {}
-  VSDOptionalParaStyle(const VSDOptionalParaStyle &style) = default;
-  ~VSDOptionalParaStyle() {}
-  VSDOptionalParaStyle &operator=(const VSDOptionalParaStyle &style) = default;
-  void override(const VSDOptionalParaStyle &style)
+    charCount(cc), VSD_PARA_STYLE_FIELDS(VSD_STYLE_FIELD_INIT) m_mask(0)
   {
-    ASSIGN_OPTIONAL(style.indFirst, indFirst);
-    ASSIGN_OPTIONAL(style.indLeft, indLeft);
-    ASSIGN_OPTIONAL(style.indRight,indRight);
-    ASSIGN_OPTIONAL(style.spLine, spLine);
-    ASSIGN_OPTIONAL(style.spBefore, spBefore);
-    ASSIGN_OPTIONAL(style.spAfter, spAfter);
-    ASSIGN_OPTIONAL(style.align, align);
-    ASSIGN_OPTIONAL(style.bullet, bullet);
-    ASSIGN_OPTIONAL(style.bulletStr, bulletStr);
-    ASSIGN_OPTIONAL(style.bulletFont, bulletFont);
-    ASSIGN_OPTIONAL(style.bulletFontSize, bulletFontSize);
-    ASSIGN_OPTIONAL(style.textPosAfterBullet, textPosAfterBullet);
-    ASSIGN_OPTIONAL(style.flags, flags);
+    indFirst(ifst);
+    indLeft(il);
+    indRight(ir);
+    spLine(sl);
+    spBefore(sb);
+    spAfter(sa);
+    align(a);
+    bullet(b);
+    bulletStr(bs);
+    bulletFont(bf);
+    bulletFontSize(bfs);
+    textPosAfterBullet(tpab);
+    flags(f);
   }
 
   unsigned charCount;
-  boost::optional<double> indFirst;
-  boost::optional<double> indLeft;
-  boost::optional<double> indRight;
-  boost::optional<double> spLine;
-  boost::optional<double> spBefore;
-  boost::optional<double> spAfter;
-  boost::optional<unsigned char> align;
-  boost::optional<unsigned char> bullet;
-  boost::optional<VSDName> bulletStr;
-  boost::optional<VSDName> bulletFont;
-  boost::optional<double> bulletFontSize;
-  boost::optional<double> textPosAfterBullet;
-  boost::optional<unsigned> flags;
+
+  VSD_OPTIONAL_STYLE_BODY(VSDOptionalParaStyle, VSD_PARA_STYLE_FIELDS)
 };
 
 struct VSDParaStyle
@@ -385,19 +431,27 @@ struct VSDParaStyle
   VSDParaStyle &operator=(const VSDParaStyle &style) = default;
   void override(const VSDOptionalParaStyle &style, const VSDXTheme * /* theme */)
   {
-    ASSIGN_OPTIONAL(style.indFirst, indFirst);
-    ASSIGN_OPTIONAL(style.indLeft, indLeft);
-    ASSIGN_OPTIONAL(style.indRight,indRight);
-    ASSIGN_OPTIONAL(style.spLine, spLine);
-    ASSIGN_OPTIONAL(style.spBefore, spBefore);
-    ASSIGN_OPTIONAL(style.spAfter, spAfter);
-    ASSIGN_OPTIONAL(style.align, align);
-    ASSIGN_OPTIONAL(style.bullet, bullet);
-    ASSIGN_OPTIONAL(style.bulletStr, bulletStr);
-    ASSIGN_OPTIONAL(style.bulletFont, bulletFont);
-    ASSIGN_OPTIONAL(style.bulletFontSize, bulletFontSize);
-    ASSIGN_OPTIONAL(style.textPosAfterBullet, textPosAfterBullet);
-    ASSIGN_OPTIONAL(style.flags, flags);
+    ASSIGN_OPTIONAL(style.indFirst(), indFirst);
+    ASSIGN_OPTIONAL(style.indLeft(), indLeft);
+    ASSIGN_OPTIONAL(style.indRight(), indRight);
+    ASSIGN_OPTIONAL(style.spLine(), spLine);
+    ASSIGN_OPTIONAL(style.spBefore(), spBefore);
+    ASSIGN_OPTIONAL(style.spAfter(), spAfter);
+    ASSIGN_OPTIONAL(style.align(), align);
+    ASSIGN_OPTIONAL(style.bullet(), bullet);
+    ASSIGN_OPTIONAL(style.bulletStr(), bulletStr);
+    ASSIGN_OPTIONAL(style.bulletFont(), bulletFont);
+    ASSIGN_OPTIONAL(style.bulletFontSize(), bulletFontSize);
+    ASSIGN_OPTIONAL(style.textPosAfterBullet(), textPosAfterBullet);
+    ASSIGN_OPTIONAL(style.flags(), flags);
+  }
+  bool operator<(const VSDParaStyle &style) const
+  {
+    return std::tie(charCount, indFirst, indLeft, indRight, spLine, spBefore, spAfter, align, bullet,
+                    bulletStr, bulletFont, bulletFontSize, textPosAfterBullet, flags)
+           < std::tie(style.charCount, style.indFirst, style.indLeft, style.indRight, style.spLine,
+                      style.spBefore, style.spAfter, style.align, style.bullet, style.bulletStr,
+                      style.bulletFont, style.bulletFontSize, style.textPosAfterBullet, style.flags);
   }
 
   unsigned charCount;
@@ -416,43 +470,40 @@ struct VSDParaStyle
   unsigned flags;
 };
 
+#define VSD_TEXT_BLOCK_STYLE_FIELDS(F) \
+  F(double, leftMargin) \
+  F(double, rightMargin) \
+  F(double, topMargin) \
+  F(double, bottomMargin) \
+  F(double, defaultTabStop) \
+  F(Colour, textBkgndColour) \
+  F(unsigned char, verticalAlign) \
+  F(unsigned char, textDirection) \
+  F(bool, isTextBkgndFilled)
+
 struct VSDOptionalTextBlockStyle
 {
   VSDOptionalTextBlockStyle() :
-    leftMargin(), rightMargin(), topMargin(), bottomMargin(), verticalAlign(), isTextBkgndFilled(),
-    textBkgndColour(), defaultTabStop(), textDirection() {}
+    VSD_TEXT_BLOCK_STYLE_FIELDS(VSD_STYLE_FIELD_INIT) m_mask(0) {}
   VSDOptionalTextBlockStyle(const boost::optional<double> &lm, const boost::optional<double> &rm,
                             const boost::optional<double> &tm, const boost::optional<double> &bm,
                             const boost::optional<unsigned char> &va, const boost::optional<bool> &isBgFilled,
                             const boost::optional<Colour> &bgClr, const boost::optional<double> &defTab,
                             const boost::optional<unsigned char> &td) :
-    leftMargin(lm), rightMargin(rm), topMargin(tm), bottomMargin(bm), verticalAlign(va),
-    isTextBkgndFilled(isBgFilled), textBkgndColour(bgClr), defaultTabStop(defTab), textDirection(td) {}
-  VSDOptionalTextBlockStyle(const VSDOptionalTextBlockStyle &style) = default;
-  ~VSDOptionalTextBlockStyle() {}
-  VSDOptionalTextBlockStyle &operator=(const VSDOptionalTextBlockStyle &style) = default;
-  void override(const VSDOptionalTextBlockStyle &style)
+    VSD_TEXT_BLOCK_STYLE_FIELDS(VSD_STYLE_FIELD_INIT) m_mask(0)
   {
-    ASSIGN_OPTIONAL(style.leftMargin, leftMargin);
-    ASSIGN_OPTIONAL(style.rightMargin, rightMargin);
-    ASSIGN_OPTIONAL(style.topMargin, topMargin);
-    ASSIGN_OPTIONAL(style.bottomMargin, bottomMargin);
-    ASSIGN_OPTIONAL(style.verticalAlign, verticalAlign);
-    ASSIGN_OPTIONAL(style.isTextBkgndFilled, isTextBkgndFilled);
-    ASSIGN_OPTIONAL(style.textBkgndColour, textBkgndColour);
-    ASSIGN_OPTIONAL(style.defaultTabStop, defaultTabStop);
-    ASSIGN_OPTIONAL(style.textDirection, textDirection);
+    leftMargin(lm);
+    rightMargin(rm);
+    topMargin(tm);
+    bottomMargin(bm);
+    verticalAlign(va);
+    isTextBkgndFilled(isBgFilled);
+    textBkgndColour(bgClr);
+    defaultTabStop(defTab);
+    textDirection(td);
   }
 
-  boost::optional<double> leftMargin;
-  boost::optional<double> rightMargin;
-  boost::optional<double> topMargin;
-  boost::optional<double> bottomMargin;
-  boost::optional<unsigned char> verticalAlign;
-  boost::optional<bool> isTextBkgndFilled;
-  boost::optional<Colour> textBkgndColour;
-  boost::optional<double> defaultTabStop;
-  boost::optional<unsigned char> textDirection;
+  VSD_OPTIONAL_STYLE_BODY(VSDOptionalTextBlockStyle, VSD_TEXT_BLOCK_STYLE_FIELDS)
 };
 
 struct VSDTextBlockStyle
@@ -469,15 +520,15 @@ struct VSDTextBlockStyle
   VSDTextBlockStyle &operator=(const VSDTextBlockStyle &style) = default;
   void override(const VSDOptionalTextBlockStyle &style, const VSDXTheme * /* theme */)
   {
-    ASSIGN_OPTIONAL(style.leftMargin, leftMargin);
-    ASSIGN_OPTIONAL(style.rightMargin, rightMargin);
-    ASSIGN_OPTIONAL(style.topMargin, topMargin);
-    ASSIGN_OPTIONAL(style.bottomMargin, bottomMargin);
-    ASSIGN_OPTIONAL(style.verticalAlign, verticalAlign);
-    ASSIGN_OPTIONAL(style.isTextBkgndFilled, isTextBkgndFilled);
-    ASSIGN_OPTIONAL(style.textBkgndColour, textBkgndColour);
-    ASSIGN_OPTIONAL(style.defaultTabStop, defaultTabStop);
-    ASSIGN_OPTIONAL(style.textDirection, textDirection);
+    ASSIGN_OPTIONAL(style.leftMargin(), leftMargin);
+    ASSIGN_OPTIONAL(style.rightMargin(), rightMargin);
+    ASSIGN_OPTIONAL(style.topMargin(), topMargin);
+    ASSIGN_OPTIONAL(style.bottomMargin(), bottomMargin);
+    ASSIGN_OPTIONAL(style.verticalAlign(), verticalAlign);
+    ASSIGN_OPTIONAL(style.isTextBkgndFilled(), isTextBkgndFilled);
+    ASSIGN_OPTIONAL(style.textBkgndColour(), textBkgndColour);
+    ASSIGN_OPTIONAL(style.defaultTabStop(), defaultTabStop);
+    ASSIGN_OPTIONAL(style.textDirection(), textDirection);
   }
 
   double leftMargin;
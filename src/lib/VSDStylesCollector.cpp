@@ -9,6 +9,7 @@
 
 #include "VSDStylesCollector.h"
 
+#include <iterator>
 #include <vector>
 #include <map>
 
@@ -427,19 +428,17 @@ void libvisio::VSDStylesCollector::endPage()
   m_groupXFormsSequence.push_back(m_groupXForms);
   m_groupMembershipsSequence.push_back(m_groupMemberships);
 
-  bool changed = true;
-  while (!m_groupShapeOrder.empty() && changed)
+  /* Flatten the group hierarchy in one pre-order pass: the members of a
+   * group are spliced right after it and are visited next. Every group is
+   * expanded only once, which also breaks cycles in broken files.
+   */
+  for (auto j = m_pageShapeOrder.begin(); j != m_pageShapeOrder.end() && !m_groupShapeOrder.empty(); ++j)
   {
-    changed = false;
-    for (auto j = m_pageShapeOrder.begin(); j != m_pageShapeOrder.end();)
+    auto iter = m_groupShapeOrder.find(*j);
+    if (m_groupShapeOrder.end() != iter)
     {
-      auto iter = m_groupShapeOrder.find(*j++);
-      if (m_groupShapeOrder.end() != iter)
-      {
-        m_pageShapeOrder.splice(j, iter->second, iter->second.begin(), iter->second.end());
-        m_groupShapeOrder.erase(iter);
-        changed = true;
-      }
+      m_pageShapeOrder.splice(std::next(j), iter->second);
+      m_groupShapeOrder.erase(iter);
     }
   }
   m_documentPageShapeOrders.push_back(m_pageShapeOrder);
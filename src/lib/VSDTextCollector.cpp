@@ -0,0 +1,716 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "VSDTextCollector.h"
+
+#include <string.h> // for memcpy
+#include <iterator>
+#include <memory>
+#include "libvisio_utils.h"
+
+namespace
+{
+
+void appendRun(librevenge::RVNGString &text, std::vector<unsigned char> &characters, libvisio::TextFormat format)
+{
+  if (characters.empty())
+    return;
+  libvisio::appendCharacters(text, characters, format);
+  characters.clear();
+}
+
+} // anonymous namespace
+
+libvisio::VSDTextCollector::VSDTextCollector(librevenge::RVNGDrawingInterface *painter, const VSDStencils &stencils) :
+  m_painter(painter), m_stencils(stencils), m_currentLevel(0), m_currentShapeLevel(0),
+  m_isShapeStarted(false), m_isPageStarted(false), m_isBackgroundPage(false),
+  m_currentText(), m_hideText(false), m_charFormats(), m_defaultCharFormat(VSD_TEXT_ANSI),
+  m_names(), m_stencilNames(), m_fields(), m_stencilFields(nullptr), m_fieldIndex(0),
+  m_currentStyleSheet(0), m_styles(),
+  m_currentPage(), m_pageElementCount(0), m_pages(), m_limits(), m_progress(nullptr)
+{
+}
+
+void libvisio::VSDTextCollector::collectEllipticalArcTo(unsigned /* id */, unsigned level, double /* x3 */, double /* y3 */,
+                                                        double /* x2 */, double /* y2 */, double /* angle */, double /* ecc */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectForeignData(unsigned level, const librevenge::RVNGBinaryData & /* binaryData */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectOLEData(unsigned /* id */, unsigned level, const librevenge::RVNGBinaryData & /* oleData */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectEllipse(unsigned /* id */, unsigned level, double /* cx */, double /* cy */,
+                                                double /* xleft */, double /* yleft */, double /* xtop */, double /* ytop */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectLine(unsigned level, const boost::optional<double> & /* strokeWidth */,
+                                             const boost::optional<Colour> & /* c */, const boost::optional<unsigned char> & /* linePattern */,
+                                             const boost::optional<unsigned char> & /* startMarker */, const boost::optional<unsigned char> & /* endMarker */,
+                                             const boost::optional<unsigned char> & /* lineCap */, const boost::optional<double> & /* rounding */,
+                                             const boost::optional<long> & /* qsLineColour */, const boost::optional<long> & /* qsLineMatrix */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectFillAndShadow(unsigned level, const boost::optional<Colour> & /* colourFG */, const boost::optional<Colour> & /* colourBG */,
+                                                      const boost::optional<unsigned char> & /* fillPattern */, const boost::optional<double> & /* fillFGTransparency */,
+                                                      const boost::optional<double> & /* fillBGTransparency */, const boost::optional<unsigned char> & /* shadowPattern */,
+                                                      const boost::optional<Colour> & /* shfgc */, const boost::optional<double> & /* shadowOffsetX */,
+                                                      const boost::optional<double> & /* shadowOffsetY */, const boost::optional<long> & /* qsFillColour */,
+                                                      const boost::optional<long> & /* qsShadowColour */, const boost::optional<long> & /* qsFillMatrix */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectFillAndShadow(unsigned level, const boost::optional<Colour> & /* colourFG */, const boost::optional<Colour> & /* colourBG */,
+                                                      const boost::optional<unsigned char> & /* fillPattern */, const boost::optional<double> & /* fillFGTransparency */,
+                                                      const boost::optional<double> & /* fillBGTransparency */, const boost::optional<unsigned char> & /* shadowPattern */,
+                                                      const boost::optional<Colour> & /* shfgc */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectGeometry(unsigned /* id */, unsigned level, bool /* noFill */, bool /* noLine */, bool /* noShow */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectMoveTo(unsigned /* id */, unsigned level, double /* x */, double /* y */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectLineTo(unsigned /* id */, unsigned level, double /* x */, double /* y */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectArcTo(unsigned /* id */, unsigned level, double /* x2 */, double /* y2 */, double /* bow */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectNURBSTo(unsigned /* id */, unsigned level, double /* x2 */, double /* y2 */,
+                                                unsigned char /* xType */, unsigned char /* yType */, unsigned /* degree */, const std::vector<std::pair<double, double> > & /* ctrlPts */,
+                                                const std::vector<double> & /* kntVec */, const std::vector<double> & /* weights */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectNURBSTo(unsigned /* id */, unsigned level, double /* x2 */, double /* y2 */, double /* knot */,
+                                                double /* knotPrev */, double /* weight */, double /* weightPrev */, unsigned /* dataID */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectNURBSTo(unsigned /* id */, unsigned level, double /* x2 */, double /* y2 */, double /* knot */,
+                                                double /* knotPrev */, double /* weight */, double /* weightPrev */, const NURBSData & /* data */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectPolylineTo(unsigned /* id */, unsigned level, double /* x */, double /* y */,
+                                                   unsigned char /* xType */, unsigned char /* yType */,
+                                                   const std::vector<std::pair<double, double> > & /* points */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectPolylineTo(unsigned /* id */, unsigned level, double /* x */, double /* y */, unsigned /* dataID */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectPolylineTo(unsigned /* id */, unsigned level, double /* x */, double /* y */, const PolylineData & /* data */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectSplineStart(unsigned /* id */, unsigned level, double /* x */, double /* y */,
+                                                    double /* secondKnot */, double /* firstKnot */, double /* lastKnot */, unsigned /* degree */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectSplineKnot(unsigned /* id */, unsigned level, double /* x */, double /* y */, double /* knot */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectSplineEnd()
+{
+}
+
+void libvisio::VSDTextCollector::collectInfiniteLine(unsigned /* id */, unsigned level, double /* x1 */, double /* y1 */, double /* x2 */, double /* y2 */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectRelCubBezTo(unsigned /* id */, unsigned level, double /* x */, double /* y */, double /* a */, double /* b */, double /* c */, double /* d */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectRelEllipticalArcTo(unsigned /* id */, unsigned level, double /* x */, double /* y */, double /* a */, double /* b */, double /* c */, double /* d */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectRelLineTo(unsigned /* id */, unsigned level, double /* x */, double /* y */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectRelMoveTo(unsigned /* id */, unsigned level, double /* x */, double /* y */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectRelQuadBezTo(unsigned /* id */, unsigned level, double /* x */, double /* y */, double /* a */, double /* b */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectShapeData(unsigned /* id */, unsigned level, unsigned char /* xType */, unsigned char /* yType */,
+                                                  unsigned /* degree */, double /*lastKnot*/, std::vector<std::pair<double, double> > /* controlPoints */,
+                                                  std::vector<double> /* knotVector */, std::vector<double> /* weights */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectShapeData(unsigned /* id */, unsigned level, unsigned char /* xType */, unsigned char /* yType */,
+                                                  std::vector<std::pair<double, double> > /* points */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectXFormData(unsigned level, const XForm & /* xform */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectTxtXForm(unsigned level, const XForm & /* txtxform */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectShapesOrder(unsigned /* id */, unsigned level, const std::vector<unsigned> & /* shapeIds */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectForeignDataType(unsigned level, unsigned /* foreignType */, unsigned /* foreignFormat */,
+                                                        double /* offsetX */, double /* offsetY */, double /* width */, double /* height */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectPageProps(unsigned /* id */, unsigned level, double pageWidth, double pageHeight,
+                                                  double /* shadowOffsetX */, double /* shadowOffsetY */, double scale)
+{
+  _handleLevelChange(level);
+  m_currentPage.m_pageWidth = scale*pageWidth;
+  m_currentPage.m_pageHeight = scale*pageHeight;
+}
+
+void libvisio::VSDTextCollector::collectPage(unsigned /* id */, unsigned level, unsigned backgroundPageID, bool isBackgroundPage, const VSDName &pageName)
+{
+  _handleLevelChange(level);
+  m_currentPage.m_backgroundPageID = backgroundPageID;
+  m_currentPage.m_pageName.clear();
+  if (!pageName.empty())
+    _convertDataToString(m_currentPage.m_pageName, pageName.m_data, pageName.m_format);
+  m_isBackgroundPage = isBackgroundPage;
+}
+
+void libvisio::VSDTextCollector::collectShape(unsigned /* id */, unsigned level, unsigned /* parent */, unsigned masterPage, unsigned masterShape,
+                                              unsigned /* lineStyle */, unsigned /* fillStyle */, unsigned textStyle)
+{
+  _handleLevelChange(level);
+  m_currentShapeLevel = level;
+  m_isShapeStarted = true;
+
+  m_currentText.clear();
+  m_hideText = false;
+  m_charFormats.clear();
+  m_defaultCharFormat = VSD_TEXT_ANSI;
+  m_names.clear();
+  m_stencilNames.clear();
+  m_fields.clear();
+  m_stencilFields = nullptr;
+  m_fieldIndex = 0;
+
+  const VSDShape *stencilShape = m_stencils.getStencilShape(masterPage, masterShape);
+  if (stencilShape)
+  {
+    for (const auto &name : stencilShape->m_names)
+    {
+      librevenge::RVNGString nameString;
+      _convertDataToString(nameString, name.second.m_data, name.second.m_format);
+      m_stencilNames[name.first] = nameString;
+    }
+
+    m_stencilFields = &stencilShape->m_fields;
+    for (size_t i = 0; i < m_stencilFields->size(); i++)
+    {
+      VSDFieldListElement *elem = m_stencilFields->getElement(i);
+      if (elem)
+        m_fields.push_back(elem->getString(m_stencilNames));
+      else
+        m_fields.push_back(librevenge::RVNGString());
+    }
+
+    if (stencilShape->m_textStyleId != MINUS_ONE)
+      _overrideDefaultCharFormat(m_styles.getOptionalCharStyle(stencilShape->m_textStyleId));
+    _overrideDefaultCharFormat(stencilShape->m_charStyle);
+  }
+
+  if (textStyle != MINUS_ONE)
+    _overrideDefaultCharFormat(m_styles.getOptionalCharStyle(textStyle));
+}
+
+void libvisio::VSDTextCollector::_overrideDefaultCharFormat(const VSDOptionalCharStyle &charStyle)
+{
+  if (charStyle.font())
+    m_defaultCharFormat = charStyle.font()->m_format;
+}
+
+void libvisio::VSDTextCollector::collectMisc(unsigned level, const VSDMisc &misc)
+{
+  _handleLevelChange(level);
+  m_hideText = misc.m_hideText;
+}
+
+void libvisio::VSDTextCollector::collectLayerMem(unsigned level, const VSDName & /* layerMem */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectLayer(unsigned /* id */, unsigned level, const VSDLayer & /* layer */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectUnhandledChunk(unsigned /* id */, unsigned level)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectText(unsigned level, const librevenge::RVNGBinaryData &textStream, TextFormat format)
+{
+  _handleLevelChange(level);
+
+  m_currentText.clear();
+  if (!textStream.empty())
+    m_currentText = libvisio::VSDName(textStream, format);
+}
+
+void libvisio::VSDTextCollector::collectParaIX(unsigned /* id */, unsigned level, unsigned /* charCount */,
+                                               const boost::optional<double> & /* indFirst */, const boost::optional<double> & /* indLeft */,
+                                               const boost::optional<double> & /* indRight */, const boost::optional<double> & /* spLine */,
+                                               const boost::optional<double> & /* spBefore */, const boost::optional<double> & /* spAfter */,
+                                               const boost::optional<unsigned char> & /* align */, const boost::optional<unsigned char> & /* bullet */,
+                                               const boost::optional<VSDName> & /* bulletStr */, const boost::optional<VSDName> & /* bulletFont */,
+                                               const boost::optional<double> & /* bulletFontSize */, const boost::optional<double> & /* textPosAfterBullet */,
+                                               const boost::optional<unsigned> & /* flags */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectDefaultParaStyle(unsigned /* charCount */, const boost::optional<double> & /* indFirst */,
+                                                         const boost::optional<double> & /* indLeft */, const boost::optional<double> & /* indRight */,
+                                                         const boost::optional<double> & /* spLine */, const boost::optional<double> & /* spBefore */,
+                                                         const boost::optional<double> & /* spAfter */, const boost::optional<unsigned char> & /* align */,
+                                                         const boost::optional<unsigned char> & /* bullet */, const boost::optional<VSDName> & /* bulletStr */,
+                                                         const boost::optional<VSDName> & /* bulletFont */, const boost::optional<double> & /* bulletFontSize */,
+                                                         const boost::optional<double> & /* textPosAfterBullet */, const boost::optional<unsigned> & /* flags */)
+{
+}
+
+void libvisio::VSDTextCollector::collectCharIX(unsigned /* id */, unsigned level, unsigned charCount,
+                                               const boost::optional<VSDName> &font, const boost::optional<Colour> & /* fontColour */, const boost::optional<double> & /* fontSize */,
+                                               const boost::optional<bool> & /* bold */, const boost::optional<bool> & /* italic */, const boost::optional<bool> & /* underline */,
+                                               const boost::optional<bool> & /* doubleunderline */, const boost::optional<bool> & /* strikeout */, const boost::optional<bool> & /* doublestrikeout */,
+                                               const boost::optional<bool> & /* allcaps */, const boost::optional<bool> & /* initcaps */, const boost::optional<bool> & /* smallcaps */,
+                                               const boost::optional<bool> & /* superscript */, const boost::optional<bool> & /* subscript */, const boost::optional<double> & /* scaleWidth */)
+{
+  _handleLevelChange(level);
+  m_charFormats.push_back(std::make_pair(charCount, font ? font->m_format : m_defaultCharFormat));
+}
+
+void libvisio::VSDTextCollector::collectTabsDataList(unsigned level, const std::map<unsigned, VSDTabSet> & /* tabSets */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectDefaultCharStyle(unsigned /* charCount */,
+                                                         const boost::optional<VSDName> &font, const boost::optional<Colour> & /* fontColour */, const boost::optional<double> & /* fontSize */,
+                                                         const boost::optional<bool> & /* bold */, const boost::optional<bool> & /* italic */, const boost::optional<bool> & /* underline */,
+                                                         const boost::optional<bool> & /* doubleunderline */, const boost::optional<bool> & /* strikeout */, const boost::optional<bool> & /* doublestrikeout */,
+                                                         const boost::optional<bool> & /* allcaps */, const boost::optional<bool> & /* initcaps */, const boost::optional<bool> & /* smallcaps */,
+                                                         const boost::optional<bool> & /* superscript */, const boost::optional<bool> & /* subscript */, const boost::optional<double> & /* scaleWidth */)
+{
+  if (font)
+    m_defaultCharFormat = font->m_format;
+}
+
+void libvisio::VSDTextCollector::collectTextBlock(unsigned level, const boost::optional<double> & /* leftMargin */,
+                                                  const boost::optional<double> & /* rightMargin */, const boost::optional<double> & /* topMargin */, const boost::optional<double> & /* bottomMargin */,
+                                                  const boost::optional<unsigned char> & /* verticalAlign */, const boost::optional<bool> & /* isBgFilled */, const boost::optional<Colour> & /* bgColour */,
+                                                  const boost::optional<double> & /* defaultTabStop */, const boost::optional<unsigned char> & /* textDirection */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectNameList(unsigned /* id */, unsigned level)
+{
+  _handleLevelChange(level);
+  m_names.clear();
+}
+
+void libvisio::VSDTextCollector::collectName(unsigned id, unsigned level, const librevenge::RVNGBinaryData &name, TextFormat format)
+{
+  _handleLevelChange(level);
+
+  librevenge::RVNGString nameString;
+  _convertDataToString(nameString, name, format);
+  m_names[id] = nameString;
+}
+
+void libvisio::VSDTextCollector::collectPageSheet(unsigned /* id */, unsigned level)
+{
+  _handleLevelChange(level);
+  m_currentShapeLevel = level;
+}
+
+void libvisio::VSDTextCollector::collectStyleSheet(unsigned id, unsigned level, unsigned /* parentLineStyle */, unsigned /* parentFillStyle */, unsigned parentTextStyle)
+{
+  _handleLevelChange(level);
+  m_currentStyleSheet = id;
+  m_styles.addTextStyleMaster(m_currentStyleSheet, parentTextStyle);
+}
+
+void libvisio::VSDTextCollector::collectLineStyle(unsigned level, const boost::optional<double> & /* strokeWidth */, const boost::optional<Colour> & /* c */,
+                                                  const boost::optional<unsigned char> & /* linePattern */, const boost::optional<unsigned char> & /* startMarker */,
+                                                  const boost::optional<unsigned char> & /* endMarker */, const boost::optional<unsigned char> & /* lineCap */,
+                                                  const boost::optional<double> & /* rounding */, const boost::optional<long> & /* qsLineColour */,
+                                                  const boost::optional<long> & /* qsLineMatrix */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectFillStyle(unsigned level, const boost::optional<Colour> & /* colourFG */, const boost::optional<Colour> & /* colourBG */,
+                                                  const boost::optional<unsigned char> & /* fillPattern */, const boost::optional<double> & /* fillFGTransparency */,
+                                                  const boost::optional<double> & /* fillBGTransparency */, const boost::optional<unsigned char> & /* shadowPattern */,
+                                                  const boost::optional<Colour> & /* shfgc */, const boost::optional<double> & /* shadowOffsetX */,
+                                                  const boost::optional<double> & /* shadowOffsetY */, const boost::optional<long> & /* qsFillColour */,
+                                                  const boost::optional<long> & /* qsShadowColour */, const boost::optional<long> & /* qsFillMatrix */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectFillStyle(unsigned level, const boost::optional<Colour> & /* colourFG */, const boost::optional<Colour> & /* colourBG */,
+                                                  const boost::optional<unsigned char> & /* fillPattern */, const boost::optional<double> & /* fillFGTransparency */,
+                                                  const boost::optional<double> & /* fillBGTransparency */, const boost::optional<unsigned char> & /* shadowPattern */,
+                                                  const boost::optional<Colour> & /* shfgc */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectCharIXStyle(unsigned /* id */, unsigned level, unsigned charCount, const boost::optional<VSDName> &font,
+                                                    const boost::optional<Colour> &fontColour, const boost::optional<double> &fontSize,
+                                                    const boost::optional<bool> &bold, const boost::optional<bool> &italic,
+                                                    const boost::optional<bool> &underline, const boost::optional<bool> &doubleunderline,
+                                                    const boost::optional<bool> &strikeout, const boost::optional<bool> &doublestrikeout,
+                                                    const boost::optional<bool> &allcaps, const boost::optional<bool> &initcaps,
+                                                    const boost::optional<bool> &smallcaps, const boost::optional<bool> &superscript,
+                                                    const boost::optional<bool> &subscript, const boost::optional<double> &scaleWidth)
+{
+  _handleLevelChange(level);
+  // The font of a style sheet decides the encoding of 8-bit text in the shapes using it
+  VSDOptionalCharStyle charStyle(charCount, font, fontColour, fontSize, bold, italic, underline, doubleunderline, strikeout, doublestrikeout,
+                                 allcaps, initcaps, smallcaps, superscript, subscript, scaleWidth);
+  m_styles.addCharStyle(m_currentStyleSheet, charStyle);
+}
+
+void libvisio::VSDTextCollector::collectParaIXStyle(unsigned /* id */, unsigned level, unsigned /* charCount */, const boost::optional<double> & /* indFirst */,
+                                                    const boost::optional<double> & /* indLeft */, const boost::optional<double> & /* indRight */,
+                                                    const boost::optional<double> & /* spLine */, const boost::optional<double> & /* spBefore */,
+                                                    const boost::optional<double> & /* spAfter */, const boost::optional<unsigned char> & /* align */,
+                                                    const boost::optional<unsigned char> & /* bullet */, const boost::optional<VSDName> & /* bulletStr */,
+                                                    const boost::optional<VSDName> & /* bulletFont */, const boost::optional<double> & /* bulletFontSize */,
+                                                    const boost::optional<double> & /* textPosAfterBullet */, const boost::optional<unsigned> & /* flags */)
+{
+  _handleLevelChange(level);
+}
+
+
+void libvisio::VSDTextCollector::collectTextBlockStyle(unsigned level, const boost::optional<double> & /* leftMargin */, const boost::optional<double> & /* rightMargin */,
+                                                       const boost::optional<double> & /* topMargin */, const boost::optional<double> & /* bottomMargin */,
+                                                       const boost::optional<unsigned char> & /* verticalAlign */, const boost::optional<bool> & /* isBgFilled */,
+                                                       const boost::optional<Colour> & /* bgColour */, const boost::optional<double> & /* defaultTabStop */,
+                                                       const boost::optional<unsigned char> & /* textDirection */)
+{
+  _handleLevelChange(level);
+}
+
+void libvisio::VSDTextCollector::collectFieldList(unsigned /* id */, unsigned level)
+{
+  _handleLevelChange(level);
+  m_fields.clear();
+}
+
+void libvisio::VSDTextCollector::collectTextField(unsigned id, unsigned level, int nameId, int formatStringId)
+{
+  _handleLevelChange(level);
+  VSDFieldListElement *element = m_stencilFields ? m_stencilFields->getElement(m_fields.size()) : nullptr;
+  if (element)
+  {
+    if (nameId == -2)
+      m_fields.push_back(element->getString(m_stencilNames));
+    else if (nameId >= 0)
+      m_fields.push_back(m_names[nameId]);
+    else
+      m_fields.push_back(librevenge::RVNGString());
+  }
+  else
+  {
+    VSDTextField tmpField(id, level, nameId, formatStringId);
+    m_fields.push_back(tmpField.getString(m_names));
+  }
+}
+
+void libvisio::VSDTextCollector::collectNumericField(unsigned id, unsigned level, unsigned short format, unsigned short cellType, double number, int formatStringId)
+{
+  _handleLevelChange(level);
+  VSDFieldListElement *pElement = m_stencilFields ? m_stencilFields->getElement(m_fields.size()) : nullptr;
+  if (pElement)
+  {
+    std::unique_ptr<VSDFieldListElement> element{pElement->clone()};
+    element->setValue(number);
+    element->setCellType(cellType);
+    if (format == VSD_FIELD_FORMAT_Unknown)
+    {
+      std::map<unsigned, librevenge::RVNGString>::const_iterator iter = m_names.find(formatStringId);
+      if (iter != m_names.end())
+        parseFormatId(iter->second.cstr(), format);
+    }
+    if (format != VSD_FIELD_FORMAT_Unknown)
+      element->setFormat(format);
+
+    m_fields.push_back(element->getString(m_names));
+  }
+  else
+  {
+    VSDNumericField tmpField(id, level, format, cellType, number, formatStringId);
+    m_fields.push_back(tmpField.getString(m_names));
+  }
+}
+
+void libvisio::VSDTextCollector::collectMetaData(const librevenge::RVNGPropertyList &metaData)
+{
+  m_pages.setMetaData(metaData);
+}
+
+void libvisio::VSDTextCollector::startPage(unsigned pageId)
+{
+  _handleLevelChange(0);
+  m_currentPage = libvisio::VSDPage();
+  m_currentPage.m_currentPageID = pageId;
+  m_pageElementCount = 0;
+  m_isPageStarted = true;
+}
+
+void libvisio::VSDTextCollector::endPage()
+{
+  if (m_isPageStarted)
+  {
+    _handleLevelChange(0);
+    if (m_currentPage.m_backgroundPageID == m_currentPage.m_currentPageID)
+      m_currentPage.m_backgroundPageID = MINUS_ONE;
+    if (m_isBackgroundPage)
+      m_pages.addBackgroundPage(std::move(m_currentPage));
+    else
+      m_pages.addPage(std::move(m_currentPage));
+    m_currentPage = libvisio::VSDPage();
+    m_isPageStarted = false;
+    m_isBackgroundPage = false;
+    if (m_progress)
+      m_progress->collectPage();
+  }
+}
+
+void libvisio::VSDTextCollector::endPages()
+{
+  m_pages.draw(m_painter);
+}
+
+void libvisio::VSDTextCollector::setParseLimits(const VSDParseLimits &limits)
+{
+  m_limits = limits;
+}
+
+void libvisio::VSDTextCollector::setParseProgress(VSDParseProgress *progress)
+{
+  m_progress = progress;
+}
+
+void libvisio::VSDTextCollector::_handleLevelChange(unsigned level)
+{
+  if (m_currentLevel == level)
+    return;
+  if (level <= m_currentShapeLevel)
+  {
+    if (m_isShapeStarted)
+    {
+      _flushText();
+      m_isShapeStarted = false;
+    }
+  }
+
+  m_currentLevel = level;
+}
+
+void libvisio::VSDTextCollector::_flushText()
+{
+  if (m_currentText.empty() || m_hideText || m_limits.isPageFull(m_pageElementCount))
+    return;
+
+  librevenge::RVNGString text;
+  if (m_currentText.m_format == VSD_TEXT_UTF8 || m_currentText.m_format == VSD_TEXT_UTF16)
+    _convertDataToString(text, m_currentText.m_data, m_currentText.m_format);
+  else
+  {
+    /* 8-bit text is converted run by run, because every character run can
+     * use a font with a different encoding. The control characters are
+     * recognized before the conversion, like in the full import. */
+    const unsigned char *buffer = m_currentText.m_data.getDataBuffer();
+    unsigned long bufferLength = m_currentText.m_data.size();
+    while (bufferLength > 1 && !buffer[bufferLength-1])
+      --bufferLength;
+
+    auto run = m_charFormats.begin();
+    TextFormat format = m_charFormats.end() != run ? run->second : m_defaultCharFormat;
+    unsigned charNumRemaining = m_charFormats.end() != run ? run->first : 0;
+    std::vector<unsigned char> characters;
+    for (unsigned long i = 0; i < bufferLength; ++i)
+    {
+      if (buffer[i] == (unsigned char)'\n' || buffer[i] == 0x0d || buffer[i] == 0x0e)
+      {
+        appendRun(text, characters, format);
+        text.append("\n");
+      }
+      else if (buffer[i] == (unsigned char)'\t')
+      {
+        appendRun(text, characters, format);
+        text.append("\t");
+      }
+      else if (buffer[i] == 0x1e)
+      {
+        appendRun(text, characters, format);
+        appendUCS4(text, 0xfffc);
+      }
+      else
+        characters.push_back(buffer[i]);
+
+      if (charNumRemaining)
+        charNumRemaining--;
+      if (!charNumRemaining && m_charFormats.end() != run && m_charFormats.end() != std::next(run))
+      {
+        appendRun(text, characters, format);
+        ++run;
+        format = run->second;
+        charNumRemaining = run->first;
+      }
+    }
+    appendRun(text, characters, format);
+  }
+
+  if (text.empty())
+    return;
+
+  VSDOutputElementList &output = m_currentPage.m_pageElements;
+  output.addStartTextObject(librevenge::RVNGPropertyList());
+  m_pageElementCount++;
+
+  bool isParagraphOpened = false;
+  librevenge::RVNGString paragraphText;
+  librevenge::RVNGString::Iter textIt(text);
+  for (textIt.rewind(); textIt.next();)
+  {
+    if (!isParagraphOpened)
+    {
+      output.addOpenParagraph(librevenge::RVNGPropertyList());
+      output.addOpenSpan(librevenge::RVNGPropertyList());
+      isParagraphOpened = true;
+    }
+
+    if (*(textIt()) == '\n' || *(textIt()) == '\t')
+    {
+      if (!paragraphText.empty())
+        output.addInsertText(paragraphText);
+      paragraphText.clear();
+      if (*(textIt()) == '\t')
+        output.addInsertTab();
+      else
+      {
+        output.addCloseSpan();
+        output.addCloseParagraph();
+        isParagraphOpened = false;
+      }
+    }
+    // U+FFFC is the placeholder of a field
+    else if (strlen(textIt()) == 3 &&
+             textIt()[0] == '\xef' &&
+             textIt()[1] == '\xbf' &&
+             textIt()[2] == '\xbc')
+      _appendField(paragraphText);
+    else
+      paragraphText.append(textIt());
+  }
+
+  if (isParagraphOpened)
+  {
+    if (!paragraphText.empty())
+      output.addInsertText(paragraphText);
+    output.addCloseSpan();
+    output.addCloseParagraph();
+  }
+  output.addEndTextObject();
+  m_currentText.clear();
+}
+
+void libvisio::VSDTextCollector::_convertDataToString(librevenge::RVNGString &result, const librevenge::RVNGBinaryData &data, TextFormat format)
+{
+  if (!data.size())
+    return;
+  std::vector<unsigned char> tmpData(data.size());
+  memcpy(&tmpData[0], data.getDataBuffer(), data.size());
+  appendCharacters(result, tmpData, format);
+}
+
+void libvisio::VSDTextCollector::_appendField(librevenge::RVNGString &text)
+{
+  if (m_fieldIndex < m_fields.size())
+    text.append(m_fields[m_fieldIndex++].cstr());
+  else
+    m_fieldIndex++;
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -10,8 +10,10 @@
 #ifndef VSDTYPES_H
 #define VSDTYPES_H
 
+#include <cstring>
 #include <vector>
 #include <map>
+#include <tuple>
 #include <librevenge/librevenge.h>
 
 #define ASSIGN_OPTIONAL(t, u) if(!!t) u = t.get()
@@ -80,6 +82,10 @@ struct Colour
   {
     return !operator==(col);
   }
+  inline bool operator<(const Colour &col) const
+  {
+    return std::tie(r, g, b, a) < std::tie(col.r, col.g, col.b, col.a);
+  }
   inline bool operator!() const
   {
     return (!r && !g && !b && !a);
@@ -108,7 +114,9 @@ struct NURBSData
       weights(),
       points() {}
   NURBSData(const NURBSData &data) = default;
+  NURBSData(NURBSData &&data) = default;
   NURBSData &operator=(const NURBSData &data) = default;
+  NURBSData &operator=(NURBSData &&data) = default;
 };
 
 struct PolylineData
@@ -185,6 +193,14 @@ public:
     m_data.clear();
     m_format = VSD_TEXT_ANSI;
   }
+  bool operator<(const VSDName &name) const
+  {
+    if (m_format != name.m_format)
+      return m_format < name.m_format;
+    if (m_data.size() != name.m_data.size())
+      return m_data.size() < name.m_data.size();
+    return m_data.size() && std::memcmp(m_data.getDataBuffer(), name.m_data.getDataBuffer(), m_data.size()) < 0;
+  }
   librevenge::RVNGBinaryData m_data;
   TextFormat m_format;
 };
@@ -217,6 +233,11 @@ struct VSDTabStop
   VSDTabStop(const VSDTabStop &tabStop) :
     m_position(tabStop.m_position), m_alignment(tabStop.m_alignment),
     m_leader(tabStop.m_leader) {}
+  VSDTabStop &operator=(const VSDTabStop &tabStop) = default;
+  bool operator<(const VSDTabStop &tabStop) const
+  {
+    return std::tie(m_position, m_alignment, m_leader) < std::tie(tabStop.m_position, tabStop.m_alignment, tabStop.m_leader);
+  }
 };
 
 struct VSDTabSet
@@ -226,6 +247,11 @@ struct VSDTabSet
   VSDTabSet() : m_numChars(0), m_tabStops() {}
   VSDTabSet(const VSDTabSet &tabSet) :
     m_numChars(tabSet.m_numChars), m_tabStops(tabSet.m_tabStops) {}
+  VSDTabSet &operator=(const VSDTabSet &tabSet) = default;
+  bool operator<(const VSDTabSet &tabSet) const
+  {
+    return std::tie(m_numChars, m_tabStops) < std::tie(tabSet.m_numChars, tabSet.m_tabStops);
+  }
 };
 
 struct VSDBullet
@@ -163,4 +163,15 @@ const libvisio::VSDXRelationship *libvisio::VSDXRelationships::getRelationshipBy
   return nullptr;
 }
 
+void libvisio::VSDXRelationships::getRelationshipsByType(const char *type, std::vector<const VSDXRelationship *> &rels) const
+{
+  if (!type)
+    return;
+  for (const auto &rel : m_relsById)
+  {
+    if (rel.second.getType() == type)
+      rels.push_back(&rel.second);
+  }
+}
+
 /* vim:set shiftwidth=2 softtabstop=2 expandtab: */
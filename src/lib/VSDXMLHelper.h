@@ -13,6 +13,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <librevenge-stream/librevenge-stream.h>
 #include <libxml/xmlreader.h>
@@ -63,6 +64,7 @@ public:
 
   const VSDXRelationship *getRelationshipByType(const char *type) const;
   const VSDXRelationship *getRelationshipById(const char *id) const;
+  void getRelationshipsByType(const char *type, std::vector<const VSDXRelationship *> &rels) const;
 
   bool empty() const
   {
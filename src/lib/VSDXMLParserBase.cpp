@@ -14,12 +14,13 @@
 #include <libxml/xmlstring.h>
 #include <librevenge-stream/librevenge-stream.h>
 
-#include <boost/phoenix.hpp>
 #include <boost/spirit/include/qi.hpp>
 
 #include "libvisio_utils.h"
 #include "libvisio_xml.h"
 #include "VSDContentCollector.h"
+#include "VSDGeometryFormula.h"
+#include "VSDInfoCollector.h"
 #include "VSDStylesCollector.h"
 #include "VSDXMLHelper.h"
 #include "VSDXMLTokenMap.h"
@@ -28,13 +29,15 @@ using std::shared_ptr;
 
 libvisio::VSDXMLParserBase::VSDXMLParserBase()
   : m_collector(), m_stencils(), m_currentStencil(), m_shape(),
-    m_isStencilStarted(false), m_currentStencilID(MINUS_ONE),
-    m_extractStencils(false), m_isInStyles(false), m_currentLevel(0),
+    m_isStencilStarted(false), m_currentStencilID(MINUS_ONE), m_currentStencilUniqueID(),
+    m_isStencilSelfContained(true),
+    m_extractStencils(false), m_extractText(false), m_infoCollector(nullptr), m_isInStyles(false), m_currentLevel(0),
     m_currentShapeLevel(0), m_colours(), m_fieldList(), m_shapeList(),
     m_currentBinaryData(), m_shapeStack(), m_shapeLevelStack(),
     m_isShapeStarted(false), m_isPageStarted(false), m_currentGeometryList(nullptr),
     m_currentGeometryListIndex(MINUS_ONE), m_fonts(), m_currentTabSet(nullptr),
-    m_watcher(nullptr)
+    m_watcher(nullptr), m_pageSelection(), m_limits(), m_progress(), m_stats(),
+    m_masterCache(nullptr)
 {
   initColours();
 }
@@ -43,6 +46,25 @@ libvisio::VSDXMLParserBase::~VSDXMLParserBase()
 {
 }
 
+void libvisio::VSDXMLParserBase::setPageSelection(const VSDPageSelection &pageSelection)
+{
+  m_pageSelection = pageSelection;
+}
+
+void libvisio::VSDXMLParserBase::setParseOptions(const VisioParseOptions &options)
+{
+  m_limits = VSDParseLimits(options);
+  m_progress = VSDParseProgress(options.callback);
+  m_stats.reset(options.stats ? new VSDParseStats() : nullptr);
+  m_masterCache = options.masterCache ? getMasterCacheImpl(*options.masterCache) : nullptr;
+}
+
+void libvisio::VSDXMLParserBase::getStats(librevenge::RVNGPropertyList &stats) const
+{
+  if (m_stats)
+    m_stats->getStats(stats);
+}
+
 // Common functions
 
 void libvisio::VSDXMLParserBase::readGeometry(xmlTextReaderPtr reader)
@@ -929,6 +951,9 @@ void libvisio::VSDXMLParserBase::readRelQuadBezTo(xmlTextReaderPtr reader)
 
 void libvisio::VSDXMLParserBase::readShape(xmlTextReaderPtr reader)
 {
+  m_limits.checkTime();
+  const long bytesConsumed = xmlTextReaderByteConsumed(reader);
+  m_progress.check(bytesConsumed > 0 ? (unsigned long)bytesConsumed : 0);
   m_isShapeStarted = true;
   m_currentShapeLevel = getElementDepth(reader);
 
@@ -956,7 +981,12 @@ void libvisio::VSDXMLParserBase::readShape(xmlTextReaderPtr reader)
   m_shape.m_textFormat = VSD_TEXT_UTF8;
 
   if (m_isStencilStarted && m_currentStencil)
+  {
     m_currentStencil->setFirstShape(id);
+    // The shape gets defaults from another master of the document
+    if (masterPage != MINUS_ONE)
+      m_isStencilSelfContained = false;
+  }
 
   const VSDStencil *tmpStencil = m_stencils.getStencil(masterPage);
   if (tmpStencil)
@@ -1071,6 +1101,7 @@ void libvisio::VSDXMLParserBase::readPage(xmlTextReaderPtr reader)
     auto nId = (unsigned)xmlStringToLong(id);
     auto backgroundPageID = (unsigned)(bgndPage ? xmlStringToLong(bgndPage) : -1);
     bool isBackgroundPage = background ? xmlStringToBool(background) : false;
+    m_pageSelection.collectBackgroundPage(backgroundPageID);
     m_isPageStarted = true;
     m_collector->startPage(nId);
     m_collector->collectPage(nId, (unsigned)getElementDepth(reader), backgroundPageID, isBackgroundPage, pageName ? VSDName(librevenge::RVNGBinaryData(pageName.get(), xmlStrlen(pageName.get())), VSD_TEXT_UTF8) : VSDName());
@@ -1220,6 +1251,7 @@ void libvisio::VSDXMLParserBase::readCharIX(xmlTextReaderPtr reader)
           try
           {
             auto fontIndex = (unsigned)xmlStringToLong(stringValue);
+            _markDocumentTableUsed();
             std::map<unsigned, VSDName>::const_iterator iter = m_fonts.find(fontIndex);
             if (iter != m_fonts.end())
               font = iter->second;
@@ -1503,6 +1535,7 @@ void libvisio::VSDXMLParserBase::readParaIX(xmlTextReaderPtr reader)
             auto fontIndex = (unsigned)xmlStringToLong(stringValue);
             if (fontIndex)
             {
+              _markDocumentTableUsed();
               std::map<unsigned, VSDName>::const_iterator iter = m_fonts.find(fontIndex);
               if (iter != m_fonts.end())
                 bulletFont = iter->second;
@@ -1701,6 +1734,13 @@ void libvisio::VSDXMLParserBase::readStencil(xmlTextReaderPtr reader)
   }
   else
     m_currentStencilID = MINUS_ONE;
+  const shared_ptr<xmlChar> baseId(xmlTextReaderGetAttribute(reader, BAD_CAST("BaseID")), xmlFree);
+  const shared_ptr<xmlChar> uniqueId(xmlTextReaderGetAttribute(reader, BAD_CAST("UniqueID")), xmlFree);
+  m_currentStencilUniqueID.clear();
+  if (baseId)
+    m_currentStencilUniqueID.append((const char *)baseId.get());
+  if (uniqueId)
+    m_currentStencilUniqueID.append((const char *)uniqueId.get());
   m_currentStencil.reset(new VSDStencil());
 }
 
@@ -1760,19 +1800,19 @@ void libvisio::VSDXMLParserBase::_flushShape()
   if (m_shape.m_txtxform)
     m_collector->collectTxtXForm(m_currentShapeLevel+2, *(m_shape.m_txtxform));
 
-  m_collector->collectLine(m_currentShapeLevel+2, m_shape.m_lineStyle.width, m_shape.m_lineStyle.colour, m_shape.m_lineStyle.pattern,
-                           m_shape.m_lineStyle.startMarker, m_shape.m_lineStyle.endMarker, m_shape.m_lineStyle.cap, m_shape.m_lineStyle.rounding,
-                           m_shape.m_lineStyle.qsLineColour, m_shape.m_lineStyle.qsLineMatrix);
+  m_collector->collectLine(m_currentShapeLevel+2, m_shape.m_lineStyle.width(), m_shape.m_lineStyle.colour(), m_shape.m_lineStyle.pattern(),
+                           m_shape.m_lineStyle.startMarker(), m_shape.m_lineStyle.endMarker(), m_shape.m_lineStyle.cap(), m_shape.m_lineStyle.rounding(),
+                           m_shape.m_lineStyle.qsLineColour(), m_shape.m_lineStyle.qsLineMatrix());
 
-  m_collector->collectFillAndShadow(m_currentShapeLevel+2, m_shape.m_fillStyle.fgColour, m_shape.m_fillStyle.bgColour, m_shape.m_fillStyle.pattern,
-                                    m_shape.m_fillStyle.fgTransparency, m_shape.m_fillStyle.bgTransparency, m_shape.m_fillStyle.shadowPattern,
-                                    m_shape.m_fillStyle.shadowFgColour, m_shape.m_fillStyle.shadowOffsetX, m_shape.m_fillStyle.shadowOffsetY,
-                                    m_shape.m_fillStyle.qsFillColour, m_shape.m_fillStyle.qsShadowColour, m_shape.m_fillStyle.qsFillMatrix);
+  m_collector->collectFillAndShadow(m_currentShapeLevel+2, m_shape.m_fillStyle.fgColour(), m_shape.m_fillStyle.bgColour(), m_shape.m_fillStyle.pattern(),
+                                    m_shape.m_fillStyle.fgTransparency(), m_shape.m_fillStyle.bgTransparency(), m_shape.m_fillStyle.shadowPattern(),
+                                    m_shape.m_fillStyle.shadowFgColour(), m_shape.m_fillStyle.shadowOffsetX(), m_shape.m_fillStyle.shadowOffsetY(),
+                                    m_shape.m_fillStyle.qsFillColour(), m_shape.m_fillStyle.qsShadowColour(), m_shape.m_fillStyle.qsFillMatrix());
 
-  m_collector->collectTextBlock(m_currentShapeLevel+2, m_shape.m_textBlockStyle.leftMargin, m_shape.m_textBlockStyle.rightMargin,
-                                m_shape.m_textBlockStyle.topMargin, m_shape.m_textBlockStyle.bottomMargin, m_shape.m_textBlockStyle.verticalAlign,
-                                m_shape.m_textBlockStyle.isTextBkgndFilled, m_shape.m_textBlockStyle.textBkgndColour,
-                                m_shape.m_textBlockStyle.defaultTabStop, m_shape.m_textBlockStyle.textDirection);
+  m_collector->collectTextBlock(m_currentShapeLevel+2, m_shape.m_textBlockStyle.leftMargin(), m_shape.m_textBlockStyle.rightMargin(),
+                                m_shape.m_textBlockStyle.topMargin(), m_shape.m_textBlockStyle.bottomMargin(), m_shape.m_textBlockStyle.verticalAlign(),
+                                m_shape.m_textBlockStyle.isTextBkgndFilled(), m_shape.m_textBlockStyle.textBkgndColour(),
+                                m_shape.m_textBlockStyle.defaultTabStop(), m_shape.m_textBlockStyle.textDirection());
 
   if (m_shape.m_foreign)
     m_collector->collectForeignDataType(m_currentShapeLevel+2, m_shape.m_foreign->type, m_shape.m_foreign->format,
@@ -1820,25 +1860,59 @@ void libvisio::VSDXMLParserBase::_flushShape()
   if (m_shape.m_text.size())
     m_collector->collectText(m_currentShapeLevel+1, m_shape.m_text, m_shape.m_textFormat);
 
-  m_collector->collectDefaultCharStyle(m_shape.m_charStyle.charCount, m_shape.m_charStyle.font, m_shape.m_charStyle.colour,
-                                       m_shape.m_charStyle.size, m_shape.m_charStyle.bold, m_shape.m_charStyle.italic, m_shape.m_charStyle.underline,
-                                       m_shape.m_charStyle.doubleunderline, m_shape.m_charStyle.strikeout, m_shape.m_charStyle.doublestrikeout,
-                                       m_shape.m_charStyle.allcaps, m_shape.m_charStyle.initcaps, m_shape.m_charStyle.smallcaps,
-                                       m_shape.m_charStyle.superscript, m_shape.m_charStyle.subscript, m_shape.m_charStyle.scaleWidth);
+  m_collector->collectDefaultCharStyle(m_shape.m_charStyle.charCount, m_shape.m_charStyle.font(), m_shape.m_charStyle.colour(),
+                                       m_shape.m_charStyle.size(), m_shape.m_charStyle.bold(), m_shape.m_charStyle.italic(), m_shape.m_charStyle.underline(),
+                                       m_shape.m_charStyle.doubleunderline(), m_shape.m_charStyle.strikeout(), m_shape.m_charStyle.doublestrikeout(),
+                                       m_shape.m_charStyle.allcaps(), m_shape.m_charStyle.initcaps(), m_shape.m_charStyle.smallcaps(),
+                                       m_shape.m_charStyle.superscript(), m_shape.m_charStyle.subscript(), m_shape.m_charStyle.scaleWidth());
 
   m_shape.m_charList.handle(m_collector);
 
-  m_collector->collectDefaultParaStyle(m_shape.m_paraStyle.charCount, m_shape.m_paraStyle.indFirst, m_shape.m_paraStyle.indLeft,
-                                       m_shape.m_paraStyle.indRight, m_shape.m_paraStyle.spLine, m_shape.m_paraStyle.spBefore,
-                                       m_shape.m_paraStyle.spAfter, m_shape.m_paraStyle.align, m_shape.m_paraStyle.bullet,
-                                       m_shape.m_paraStyle.bulletStr, m_shape.m_paraStyle.bulletFont, m_shape.m_paraStyle.bulletFontSize,
-                                       m_shape.m_paraStyle.textPosAfterBullet, m_shape.m_paraStyle.flags);
+  m_collector->collectDefaultParaStyle(m_shape.m_paraStyle.charCount, m_shape.m_paraStyle.indFirst(), m_shape.m_paraStyle.indLeft(),
+                                       m_shape.m_paraStyle.indRight(), m_shape.m_paraStyle.spLine(), m_shape.m_paraStyle.spBefore(),
+                                       m_shape.m_paraStyle.spAfter(), m_shape.m_paraStyle.align(), m_shape.m_paraStyle.bullet(),
+                                       m_shape.m_paraStyle.bulletStr(), m_shape.m_paraStyle.bulletFont(), m_shape.m_paraStyle.bulletFontSize(),
+                                       m_shape.m_paraStyle.textPosAfterBullet(), m_shape.m_paraStyle.flags());
 
   m_shape.m_paraList.handle(m_collector);
 
   m_collector->collectUnhandledChunk(0, m_currentShapeLevel);
 }
 
+void libvisio::VSDXMLParserBase::_addStencilShape()
+{
+  if (!m_currentStencil)
+    return;
+  // Instances share the master's geometry elements. Give them the level
+  // _flushShape would, so that instances do not have to clone them.
+  for (auto &geometry : m_shape.m_geometries)
+    geometry.second.resetLevel(m_currentShapeLevel+2);
+  m_currentStencil->addStencilShape(m_shape.m_shapeId, m_shape);
+}
+
+/* A master whose cells refer to the font or colour table of the document
+ * depends on more than its own XML, so it must not be cached.
+ */
+void libvisio::VSDXMLParserBase::_markDocumentTableUsed()
+{
+  if (m_isStencilStarted)
+    m_isStencilSelfContained = false;
+}
+
+bool libvisio::VSDXMLParserBase::_isPageSelected(xmlTextReaderPtr reader)
+{
+  if (m_pageSelection.empty())
+    return true;
+  const shared_ptr<xmlChar> id(xmlTextReaderGetAttribute(reader, BAD_CAST("ID")), xmlFree);
+  const shared_ptr<xmlChar> background(xmlTextReaderGetAttribute(reader, BAD_CAST("Background")), xmlFree);
+  shared_ptr<xmlChar> pageName(xmlTextReaderGetAttribute(reader, BAD_CAST("Name")), xmlFree);
+  if (!pageName.get())
+    pageName.reset(xmlTextReaderGetAttribute(reader, BAD_CAST("NameU")), xmlFree);
+  return m_pageSelection.startPage(id ? (unsigned)xmlStringToLong(id) : MINUS_ONE,
+                                   background ? xmlStringToBool(background) : false,
+                                   pageName ? VSDName(librevenge::RVNGBinaryData(pageName.get(), xmlStrlen(pageName.get())), VSD_TEXT_UTF8) : VSDName());
+}
+
 void libvisio::VSDXMLParserBase::_handleLevelChange(unsigned level)
 {
   m_currentLevel = level;
@@ -1863,8 +1937,12 @@ void libvisio::VSDXMLParserBase::handlePagesEnd(xmlTextReaderPtr /* reader */)
 void libvisio::VSDXMLParserBase::handlePageStart(xmlTextReaderPtr reader)
 {
   m_isShapeStarted = false;
-  if (!m_extractStencils)
+  if (m_extractStencils)
+    return;
+  if (_isPageSelected(reader))
     readPage(reader);
+  else
+    skipPage(reader);
 }
 
 void libvisio::VSDXMLParserBase::handlePageEnd(xmlTextReaderPtr /* reader */)
@@ -1906,6 +1984,8 @@ void libvisio::VSDXMLParserBase::handleMastersEnd(xmlTextReaderPtr /* reader */)
 void libvisio::VSDXMLParserBase::handleMasterStart(xmlTextReaderPtr reader)
 {
   m_isShapeStarted = false;
+  if (m_infoCollector)
+    m_infoCollector->collectMaster();
   if (m_extractStencils)
     readPage(reader);
   else
@@ -1947,6 +2027,22 @@ void libvisio::VSDXMLParserBase::skipMasters(xmlTextReaderPtr reader)
   while ((XML_MASTERS != tokenId || XML_READER_TYPE_END_ELEMENT != tokenType) && 1 == ret);
 }
 
+void libvisio::VSDXMLParserBase::skipPage(xmlTextReaderPtr reader)
+{
+  if (xmlTextReaderIsEmptyElement(reader))
+    return;
+  int ret = 1;
+  int tokenId = XML_TOKEN_INVALID;
+  int tokenType = -1;
+  do
+  {
+    ret = xmlTextReaderRead(reader);
+    tokenId = getElementToken(reader);
+    tokenType = xmlTextReaderNodeType(reader);
+  }
+  while ((XML_PAGE != tokenId || XML_READER_TYPE_END_ELEMENT != tokenType) && 1 == ret);
+}
+
 void libvisio::VSDXMLParserBase::skipPages(xmlTextReaderPtr reader)
 {
   int ret = 1;
@@ -1961,99 +2057,36 @@ void libvisio::VSDXMLParserBase::skipPages(xmlTextReaderPtr reader)
   while ((XML_PAGES != tokenId || XML_READER_TYPE_END_ELEMENT != tokenType) && 1 == ret);
 }
 
+void libvisio::VSDXMLParserBase::skipElement(xmlTextReaderPtr reader)
+{
+  if (xmlTextReaderIsEmptyElement(reader))
+    return;
+  const int depth = xmlTextReaderDepth(reader);
+  int ret = 1;
+  do
+  {
+    ret = xmlTextReaderRead(reader);
+  }
+  while ((XML_READER_TYPE_END_ELEMENT != xmlTextReaderNodeType(reader) || depth != xmlTextReaderDepth(reader)) && 1 == ret);
+}
+
 int libvisio::VSDXMLParserBase::readNURBSData(boost::optional<NURBSData> &data, xmlTextReaderPtr reader)
 {
   NURBSData tmpData;
-
-  bool bRes = false;
   const shared_ptr<xmlChar> formula(readStringData(reader), xmlFree);
-
-  if (formula)
-  {
-    std::pair<double, double> point;
-
-    using namespace boost::spirit::qi;
-    namespace phx = boost::phoenix;
-    using phx::push_back;
-    using phx::ref;
-
-    auto first = reinterpret_cast<const char *>(formula.get());
-    const auto last = first + strlen(first);
-    bRes = phrase_parse(first, last,
-                        //  Begin grammar
-                        (
-                          lit("NURBS")
-                          >> '('
-                          >> double_[ref(tmpData.lastKnot) = _1] >> -lit(',')
-                          >> int_[ref(tmpData.degree) = _1] >> -lit(',')
-                          >> int_[ref(tmpData.xType) = _1] >> -lit(',')
-                          >> int_[ref(tmpData.yType) = _1] >> -lit(',')
-                          >> // array of points, weights and knots
-                          (
-                            (
-                              (double_[ref(point.first) = _1] >> -lit(',') >>
-                               double_[ref(point.second) = _1]
-                              )[push_back(phx::ref(tmpData.points), phx::cref(point))]
-                              >> -lit(',') >>
-                              double_[push_back(phx::ref(tmpData.knots),
-                                                _1)] >> -lit(',') >>
-                              double_[push_back(phx::ref(tmpData.weights), _1)]
-                            )
-                            % -lit(',')
-                          )
-                          >> ')'
-                        ),
-                        //  End grammar
-                        space)
-           && first == last;
-  }
-
-  if (!bRes)
+  if (!formula || !parseNURBSFormula(reinterpret_cast<const char *>(formula.get()), tmpData))
     return -1;
-  data = tmpData;
+  data = std::move(tmpData);
   return 1;
 }
 
 int libvisio::VSDXMLParserBase::readPolylineData(boost::optional<PolylineData> &data, xmlTextReaderPtr reader)
 {
   PolylineData tmpData;
-
-  bool bRes = false;
   const shared_ptr<xmlChar> formula(readStringData(reader), xmlFree);
-
-  if (formula)
-  {
-    std::pair<double, double> point;
-
-    using namespace boost::spirit::qi;
-    namespace phx = boost::phoenix;
-    using phx::push_back;
-    using phx::ref;
-
-    auto first = reinterpret_cast<const char *>(formula.get());
-    const auto last = first + strlen(first);
-    bRes = phrase_parse(first, last,
-                        (
-                          lit("POLYLINE")
-                          >> '('
-                          >> int_[ref(tmpData.xType) = _1] >> -lit(',')
-                          >> int_[ref(tmpData.yType) = _1] >> -lit(',')
-                          >> // array of points
-                          (
-                            (
-                              double_[ref(point.first) = _1] >> -lit(',')
-                              >> double_[ref(point.second) = _1]
-                            )[push_back(phx::ref(tmpData.points), phx::cref(point))] % -lit(',')
-                          )
-                          >> ')'
-                        ),
-                        space)
-           && first == last;
-  }
-
-  if (!bRes)
+  if (!formula || !parsePolylineFormula(reinterpret_cast<const char *>(formula.get()), tmpData))
     return -1;
-  data = tmpData;
+  data = std::move(tmpData);
   return 1;
 }
 
@@ -2196,6 +2229,7 @@ int libvisio::VSDXMLParserBase::readExtendedColourData(Colour &value, long &idx,
       }
       if (idx >= 0)
       {
+        _markDocumentTableUsed();
         std::map<unsigned, Colour>::const_iterator iter = m_colours.find((unsigned)idx);
         if (iter != m_colours.end())
           value = iter->second;
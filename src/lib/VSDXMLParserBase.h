@@ -20,11 +20,17 @@
 #include "VSDParagraphList.h"
 #include "VSDShapeList.h"
 #include "VSDStencils.h"
+#include "VSDPageSelection.h"
+#include "VSDParseLimits.h"
+#include "VSDParseProgress.h"
+#include "VSDParseStats.h"
 
 namespace libvisio
 {
 
 class VSDCollector;
+class VSDInfoCollector;
+class VSDMasterCache;
 class XMLErrorWatcher;
 
 class VSDXMLParserBase
@@ -34,6 +40,11 @@ public:
   virtual ~VSDXMLParserBase();
   virtual bool parseMain() = 0;
   virtual bool extractStencils() = 0;
+  virtual bool extractText() = 0;
+  virtual bool probe(librevenge::RVNGPropertyList &info) = 0;
+  void setPageSelection(const VSDPageSelection &pageSelection);
+  void setParseOptions(const VisioParseOptions &options);
+  void getStats(librevenge::RVNGPropertyList &stats) const;
 
 protected:
   // Protected data
@@ -43,8 +54,13 @@ protected:
   VSDShape m_shape;
   bool m_isStencilStarted;
   unsigned m_currentStencilID;
+  std::string m_currentStencilUniqueID;
+  // false once the current stencil depends on more than the XML of its master part
+  bool m_isStencilSelfContained;
 
   bool m_extractStencils;
+  bool m_extractText;
+  VSDInfoCollector *m_infoCollector;
   bool m_isInStyles;
   unsigned m_currentLevel;
   unsigned m_currentShapeLevel;
@@ -65,6 +81,12 @@ protected:
 
   XMLErrorWatcher *m_watcher;
 
+  VSDPageSelection m_pageSelection;
+  VSDParseLimits m_limits;
+  VSDParseProgress m_progress;
+  std::unique_ptr<VSDParseStats> m_stats;
+  VSDMasterCache *m_masterCache;
+
   // Helper functions
 
   int readByteData(unsigned char &value, xmlTextReaderPtr reader);
@@ -88,6 +110,9 @@ protected:
   unsigned getIX(xmlTextReaderPtr reader);
   virtual void _handleLevelChange(unsigned level);
   void _flushShape();
+  void _addStencilShape();
+  void _markDocumentTableUsed();
+  bool _isPageSelected(xmlTextReaderPtr reader);
 
   virtual int getElementToken(xmlTextReaderPtr reader) = 0;
   virtual int getElementDepth(xmlTextReaderPtr reader) = 0;
@@ -135,8 +160,10 @@ protected:
   void handleMastersEnd(xmlTextReaderPtr reader);
   void handleMasterStart(xmlTextReaderPtr reader);
   void handleMasterEnd(xmlTextReaderPtr reader);
+  void skipPage(xmlTextReaderPtr reader);
   void skipPages(xmlTextReaderPtr reader);
   void skipMasters(xmlTextReaderPtr reader);
+  void skipElement(xmlTextReaderPtr reader);
 
 private:
   VSDXMLParserBase(const VSDXMLParserBase &);
@@ -9,6 +9,7 @@
 
 #include "VSDXParser.h"
 
+#include <algorithm>
 #include <memory>
 #include <string.h>
 #include <libxml/xmlIO.h>
@@ -17,7 +18,10 @@
 #include "libvisio_utils.h"
 #include "libvisio_xml.h"
 #include "VSDContentCollector.h"
+#include "VSDInfoCollector.h"
+#include "VSDMasterCache.h"
 #include "VSDStylesCollector.h"
+#include "VSDTextCollector.h"
 #include "VSDXMLHelper.h"
 #include "VSDXMLTokenMap.h"
 #include "VSDXMetaData.h"
@@ -54,7 +58,8 @@ libvisio::VSDXParser::VSDXParser(librevenge::RVNGInputStream *input, librevenge:
     m_painter(painter),
     m_currentDepth(0),
     m_rels(nullptr),
-    m_currentTheme()
+    m_currentTheme(),
+    m_imageNames()
 {
 }
 
@@ -79,23 +84,55 @@ bool libvisio::VSDXParser::parseMain() try
   if (!rel)
     return false;
 
+  if (m_infoCollector)
+  {
+    m_collector = m_infoCollector;
+    parseMetaData(m_input, rootRels);
+    return parseDocument(m_input, rel->getTarget().c_str());
+  }
+
+  if (m_extractText)
+  {
+    // The masters are parsed before the pages, so one pass is enough
+    VSDTextCollector textCollector(m_painter, m_stencils);
+    textCollector.setParseLimits(m_limits);
+    textCollector.setParseProgress(&m_progress);
+    m_collector = &textCollector;
+    parseMetaData(m_input, rootRels);
+    return parseDocument(m_input, rel->getTarget().c_str());
+  }
+
   std::vector<std::map<unsigned, XForm> > groupXFormsSequence;
   std::vector<std::map<unsigned, unsigned> > groupMembershipsSequence;
   std::vector<std::list<unsigned> > documentPageShapeOrders;
 
   VSDStylesCollector stylesCollector(groupXFormsSequence, groupMembershipsSequence, documentPageShapeOrders);
   m_collector = &stylesCollector;
+  VSDParseStats::TimePoint passStart = VSDParseStats::now();
   if (!parseDocument(m_input, rel->getTarget().c_str()))
     return false;
+  if (m_stats)
+    m_stats->collectStylesPass(passStart);
+
+  if (!m_pageSelection.hasSelectedPages())
+    return false;
+  m_pageSelection.endFirstPass(groupXFormsSequence, groupMembershipsSequence, documentPageShapeOrders);
 
   VSDStyles styles = stylesCollector.getStyleSheets();
 
   VSDContentCollector contentCollector(m_painter, groupXFormsSequence, groupMembershipsSequence, documentPageShapeOrders, styles, m_stencils);
+  contentCollector.hideBackgroundPages(m_pageSelection.getHiddenPages());
+  contentCollector.setParseLimits(m_limits);
+  contentCollector.setParseProgress(&m_progress);
+  contentCollector.setParseStats(m_stats.get());
   m_collector = &contentCollector;
   parseMetaData(m_input, rootRels);
 
+  passStart = VSDParseStats::now();
   if (!parseDocument(m_input, rel->getTarget().c_str()))
     return false;
+  if (m_stats)
+    m_stats->collectContentPass(passStart);
 
   return true;
 }
@@ -110,6 +147,23 @@ bool libvisio::VSDXParser::extractStencils()
   return parseMain();
 }
 
+bool libvisio::VSDXParser::extractText()
+{
+  m_extractText = true;
+  return parseMain();
+}
+
+bool libvisio::VSDXParser::probe(librevenge::RVNGPropertyList &info)
+{
+  VSDInfoCollector infoCollector;
+  m_infoCollector = &infoCollector;
+  const bool retVal = parseMain();
+  m_infoCollector = nullptr;
+  if (retVal)
+    infoCollector.getInfo(info);
+  return retVal;
+}
+
 bool libvisio::VSDXParser::parseDocument(librevenge::RVNGInputStream *input, const char *name)
 {
   if (!input)
@@ -127,7 +181,7 @@ bool libvisio::VSDXParser::parseDocument(librevenge::RVNGInputStream *input, con
   rels.rebaseTargets(getTargetBaseDirectory(name).c_str());
 
   const VSDXRelationship *rel = rels.getRelationshipByType("http://schemas.openxmlformats.org/officeDocument/2006/relationships/theme");
-  if (rel)
+  if (rel && !m_extractText && !m_infoCollector)
   {
     if (!parseTheme(input, rel->getTarget().c_str()))
     {
@@ -199,11 +253,62 @@ bool libvisio::VSDXParser::parseMaster(librevenge::RVNGInputStream *input, const
   VSDXRelationships rels(relStream.get());
   rels.rebaseTargets(getTargetBaseDirectory(name).c_str());
 
-  processXmlDocument(stream.get(), rels);
+  // The parts related to the master, like images, are not part of the cache key
+  if (m_masterCache && m_isStencilStarted && m_currentStencil && rels.empty())
+    parseCachedMaster(stream.get(), rels);
+  else
+    processXmlDocument(stream.get(), rels);
 
   return true;
 }
 
+/* Parses the master part read from input into the current stencil, or
+ * copies the shapes of the same master from the master cache. The part is
+ * parsed into a stencil of its own, so that it can be cached, unless its
+ * shapes turn out to depend on other masters of the document.
+ */
+void libvisio::VSDXParser::parseCachedMaster(librevenge::RVNGInputStream *input, VSDXRelationships &rels)
+{
+  const unsigned long length = getRemainingLength(input);
+  unsigned long numBytesRead = 0;
+  const unsigned char *const buffer = input->read(length, numBytesRead);
+  input->seek(0, librevenge::RVNG_SEEK_SET);
+  if (!buffer || numBytesRead != length)
+  {
+    processXmlDocument(input, rels);
+    return;
+  }
+  const librevenge::RVNGBinaryData content(buffer, numBytesRead);
+
+  VSDMasterCacheKey key;
+  key.masterId = m_currentStencilUniqueID;
+  key.level = m_currentDepth;
+  key.isTextOnly = m_extractText;
+  key.maxNestingDepth = m_limits.getMaxNestingDepth();
+
+  VSDStencil stencil;
+  if (m_masterCache->find(key, content, stencil))
+  {
+    m_currentStencil->addStencilShapes(stencil);
+    if (m_stats)
+      m_stats->collectMasterCacheHit();
+    return;
+  }
+
+  std::unique_ptr<VSDStencil> currentStencil(std::move(m_currentStencil));
+  m_currentStencil.reset(new VSDStencil());
+  m_currentStencil->m_shadowOffsetX = currentStencil->m_shadowOffsetX;
+  m_currentStencil->m_shadowOffsetY = currentStencil->m_shadowOffsetY;
+  m_isStencilSelfContained = true;
+  if (processXmlDocument(input, rels) && m_isStencilSelfContained)
+    m_masterCache->insert(key, content, *m_currentStencil);
+
+  currentStencil->addStencilShapes(*m_currentStencil);
+  currentStencil->m_shadowOffsetX = m_currentStencil->m_shadowOffsetX;
+  currentStencil->m_shadowOffsetY = m_currentStencil->m_shadowOffsetY;
+  m_currentStencil = std::move(currentStencil);
+}
+
 bool libvisio::VSDXParser::parsePages(librevenge::RVNGInputStream *input, const char *name)
 {
   if (!input)
@@ -295,10 +400,31 @@ catch (...)
   // Ignore any exceptions in metadata. They are not important enough to stop parsing.
 }
 
-void libvisio::VSDXParser::processXmlDocument(librevenge::RVNGInputStream *input, VSDXRelationships &rels)
+void libvisio::VSDXParser::collectImages(librevenge::RVNGInputStream *input, const char *name)
 {
-  if (!input)
+  input->seek(0, librevenge::RVNG_SEEK_SET);
+  const RVNGInputStreamPtr_t relStream(input->getSubStreamByName(getRelationshipsForTarget(name).c_str()));
+  input->seek(0, librevenge::RVNG_SEEK_SET);
+  if (!relStream)
     return;
+  VSDXRelationships rels(relStream.get());
+  rels.rebaseTargets(getTargetBaseDirectory(name).c_str());
+
+  std::vector<const VSDXRelationship *> images;
+  rels.getRelationshipsByType("http://schemas.openxmlformats.org/officeDocument/2006/relationships/image", images);
+  for (const auto *image : images)
+  {
+    // The masters and the pages can share an image
+    if (m_imageNames.insert(image->getTarget()).second)
+      m_infoCollector->collectImage();
+  }
+}
+
+/// Returns false if input could not be read to its end.
+bool libvisio::VSDXParser::processXmlDocument(librevenge::RVNGInputStream *input, VSDXRelationships &rels)
+{
+  if (!input)
+    return false;
 
   m_rels = &rels;
 
@@ -306,8 +432,9 @@ void libvisio::VSDXParser::processXmlDocument(librevenge::RVNGInputStream *input
 
   auto reader = xmlReaderForStream(input, &watcher, false);
   if (!reader)
-    return;
+    return false;
 
+  bool isComplete = false;
   XMLErrorWatcher *oldWatcher = m_watcher;
   try
   {
@@ -331,7 +458,13 @@ void libvisio::VSDXParser::processXmlDocument(librevenge::RVNGInputStream *input
             if (rel)
             {
               std::string type = rel->getType();
-              if (type == "http://schemas.microsoft.com/visio/2010/relationships/master")
+              if (m_infoCollector && (type == "http://schemas.microsoft.com/visio/2010/relationships/master"
+                                      || type == "http://schemas.microsoft.com/visio/2010/relationships/page"))
+              {
+                // The contents of the masters and pages are just their shapes
+                collectImages(m_input, rel->getTarget().c_str());
+              }
+              else if (type == "http://schemas.microsoft.com/visio/2010/relationships/master")
               {
                 m_currentDepth += xmlTextReaderDepth(reader.get());
                 parseMaster(m_input, rel->getTarget().c_str());
@@ -359,7 +492,12 @@ void libvisio::VSDXParser::processXmlDocument(librevenge::RVNGInputStream *input
       }
       ret = xmlTextReaderRead(reader.get());
     }
+    isComplete = 0 == ret && !watcher.isError();
 
+    const long bytesConsumed = xmlTextReaderByteConsumed(reader.get());
+    if (bytesConsumed > 0)
+      m_progress.collectBytes((unsigned long)bytesConsumed);
+    m_progress.check();
     m_watcher = oldWatcher;
   }
   catch (...)
@@ -367,6 +505,7 @@ void libvisio::VSDXParser::processXmlDocument(librevenge::RVNGInputStream *input
     m_watcher = oldWatcher;
     throw;
   }
+  return isComplete;
 }
 
 void libvisio::VSDXParser::processXmlNode(xmlTextReaderPtr reader)
@@ -425,7 +564,9 @@ void libvisio::VSDXParser::processXmlNode(xmlTextReaderPtr reader)
     }
     break;
   case XML_STYLESHEETS:
-    if (XML_READER_TYPE_ELEMENT == tokenType)
+    if (XML_READER_TYPE_ELEMENT == tokenType && (m_extractText || m_infoCollector))
+      skipElement(reader);
+    else if (XML_READER_TYPE_ELEMENT == tokenType)
       m_isInStyles = true;
     else if (XML_READER_TYPE_END_ELEMENT == tokenType)
     {
@@ -442,7 +583,7 @@ void libvisio::VSDXParser::processXmlNode(xmlTextReaderPtr reader)
       else
       {
         if (m_isStencilStarted && m_currentStencil)
-          m_currentStencil->addStencilShape(m_shape.m_shapeId, m_shape);
+          _addStencilShape();
         else
           _flushShape();
         m_shape.clear();
@@ -453,7 +594,7 @@ void libvisio::VSDXParser::processXmlNode(xmlTextReaderPtr reader)
     else if (XML_READER_TYPE_END_ELEMENT == tokenType)
     {
       if (m_isStencilStarted && m_currentStencil)
-        m_currentStencil->addStencilShape(m_shape.m_shapeId, m_shape);
+        _addStencilShape();
       else
       {
         _flushShape();
@@ -464,7 +605,10 @@ void libvisio::VSDXParser::processXmlNode(xmlTextReaderPtr reader)
     }
     break;
   case XML_SHAPES:
-    if (XML_READER_TYPE_ELEMENT == tokenType)
+    // groups nested too deep are skipped with all their shapes
+    if (XML_READER_TYPE_ELEMENT == tokenType && m_isShapeStarted && m_limits.isTooDeep(m_shapeStack.size() + 1))
+      skipElement(reader);
+    else if (XML_READER_TYPE_ELEMENT == tokenType)
     {
       if (m_isShapeStarted)
       {
@@ -533,16 +677,21 @@ void libvisio::VSDXParser::extractBinaryData(librevenge::RVNGInputStream *input,
   m_currentBinaryData.clear();
   if (!input || !input->isStructured())
     return;
+  // Without a limit on the size, the whole part is read
+  unsigned long length = m_limits.getImageReadLength((unsigned long)-1);
+  if (!length)
+    return;
   input->seek(0, librevenge::RVNG_SEEK_SET);
   const RVNGInputStreamPtr_t stream(input->getSubStreamByName(name));
   if (!stream)
     return;
-  while (true)
+  while (length)
   {
     unsigned long numBytesRead;
-    const unsigned char *buffer = stream->read(VSDX_DATA_READ_SIZE, numBytesRead);
+    const unsigned char *buffer = stream->read(std::min(length, VSDX_DATA_READ_SIZE), numBytesRead);
     if (numBytesRead)
       m_currentBinaryData.append(buffer, numBytesRead);
+    length -= numBytesRead;
     if (stream->isEnd())
       break;
   }
@@ -562,6 +711,8 @@ xmlChar *libvisio::VSDXParser::readStringData(xmlTextReaderPtr reader)
 
 int libvisio::VSDXParser::getElementToken(xmlTextReaderPtr reader)
 {
+  if (m_stats)
+    m_stats->collectXmlNode();
   int tokenId = VSDXMLTokenMap::getTokenId(xmlTextReaderConstName(reader));
   if (XML_READER_TYPE_END_ELEMENT == xmlTextReaderNodeType(reader))
     return tokenId;
@@ -664,6 +815,7 @@ void libvisio::VSDXParser::readPageSheetProperties(xmlTextReaderPtr reader)
   {
     m_currentStencil->m_shadowOffsetX = shadowOffsetX;
     m_currentStencil->m_shadowOffsetY = shadowOffsetY;
+    m_isStencilSelfContained = false;
   }
   else if (m_isPageStarted)
   {
@@ -1126,90 +1278,170 @@ void libvisio::VSDXParser::readShapeProperties(xmlTextReaderPtr reader)
       }
       break;
     case XML_FOREIGNDATA:
-      if (XML_READER_TYPE_ELEMENT == tokenType)
+      if (XML_READER_TYPE_ELEMENT == tokenType && !m_extractText)
         readForeignData(reader);
       break;
     case XML_LINEWEIGHT:
       if (XML_READER_TYPE_ELEMENT == tokenType)
-        ret = readDoubleData(m_shape.m_lineStyle.width, reader);
+      {
+        boost::optional<double> width;
+        ret = readDoubleData(width, reader);
+        m_shape.m_lineStyle.width(width);
+      }
       break;
     case XML_LINECOLOR:
       if (XML_READER_TYPE_ELEMENT == tokenType)
-        ret = readExtendedColourData(m_shape.m_lineStyle.colour, reader);
+      {
+        boost::optional<Colour> colour;
+        ret = readExtendedColourData(colour, reader);
+        m_shape.m_lineStyle.colour(colour);
+      }
       break;
     case XML_LINEPATTERN:
       if (XML_READER_TYPE_ELEMENT == tokenType)
-        ret = readByteData(m_shape.m_lineStyle.pattern, reader);
+      {
+        boost::optional<unsigned char> pattern;
+        ret = readByteData(pattern, reader);
+        m_shape.m_lineStyle.pattern(pattern);
+      }
       break;
     case XML_BEGINARROW:
       if (XML_READER_TYPE_ELEMENT == tokenType)
-        ret = readByteData(m_shape.m_lineStyle.startMarker, reader);
+      {
+        boost::optional<unsigned char> startMarker;
+        ret = readByteData(startMarker, reader);
+        m_shape.m_lineStyle.startMarker(startMarker);
+      }
       break;
     case XML_ENDARROW:
       if (XML_READER_TYPE_ELEMENT == tokenType)
-        ret = readByteData(m_shape.m_lineStyle.endMarker, reader);
+      {
+        boost::optional<unsigned char> endMarker;
+        ret = readByteData(endMarker, reader);
+        m_shape.m_lineStyle.endMarker(endMarker);
+      }
       break;
     case XML_LINECAP:
       if (XML_READER_TYPE_ELEMENT == tokenType)
-        ret = readByteData(m_shape.m_lineStyle.cap, reader);
+      {
+        boost::optional<unsigned char> cap;
+        ret = readByteData(cap, reader);
+        m_shape.m_lineStyle.cap(cap);
+      }
       break;
     case XML_FILLFOREGND:
       if (XML_READER_TYPE_ELEMENT == tokenType)
-        ret = readExtendedColourData(m_shape.m_fillStyle.fgColour, reader);
+      {
+        boost::optional<Colour> fgColour;
+        ret = readExtendedColourData(fgColour, reader);
+        m_shape.m_fillStyle.fgColour(fgColour);
+      }
       break;
     case XML_FILLBKGND:
       if (XML_READER_TYPE_ELEMENT == tokenType)
-        ret = readExtendedColourData(m_shape.m_fillStyle.bgColour, reader);
+      {
+        boost::optional<Colour> bgColour;
+        ret = readExtendedColourData(bgColour, reader);
+        m_shape.m_fillStyle.bgColour(bgColour);
+      }
       break;
     case XML_FILLPATTERN:
       if (XML_READER_TYPE_ELEMENT == tokenType)
-        ret = readByteData(m_shape.m_fillStyle.pattern, reader);
+      {
+        boost::optional<unsigned char> pattern;
+        ret = readByteData(pattern, reader);
+        m_shape.m_fillStyle.pattern(pattern);
+      }
       break;
     case XML_SHDWFOREGND:
       if (XML_READER_TYPE_ELEMENT == tokenType)
-        ret = readExtendedColourData(m_shape.m_fillStyle.shadowFgColour, reader);
+      {
+        boost::optional<Colour> shadowFgColour;
+        ret = readExtendedColourData(shadowFgColour, reader);
+        m_shape.m_fillStyle.shadowFgColour(shadowFgColour);
+      }
       break;
     case XML_SHDWBKGND: /* unsupported */
       break;
     case XML_SHDWPATTERN:
       if (XML_READER_TYPE_ELEMENT == tokenType)
-        ret = readByteData(m_shape.m_fillStyle.shadowPattern, reader);
+      {
+        boost::optional<unsigned char> shadowPattern;
+        ret = readByteData(shadowPattern, reader);
+        m_shape.m_fillStyle.shadowPattern(shadowPattern);
+      }
       break;
     case XML_FILLFOREGNDTRANS:
       if (XML_READER_TYPE_ELEMENT == tokenType)
-        ret = readDoubleData(m_shape.m_fillStyle.fgTransparency, reader);
+      {
+        boost::optional<double> fgTransparency;
+        ret = readDoubleData(fgTransparency, reader);
+        m_shape.m_fillStyle.fgTransparency(fgTransparency);
+      }
       break;
     case XML_FILLBKGNDTRANS:
       if (XML_READER_TYPE_ELEMENT == tokenType)
-        ret = readDoubleData(m_shape.m_fillStyle.bgTransparency, reader);
+      {
+        boost::optional<double> bgTransparency;
+        ret = readDoubleData(bgTransparency, reader);
+        m_shape.m_fillStyle.bgTransparency(bgTransparency);
+      }
       break;
     case XML_SHAPESHDWOFFSETX:
       if (XML_READER_TYPE_ELEMENT == tokenType)
-        ret = readDoubleData(m_shape.m_fillStyle.shadowOffsetX, reader);
+      {
+        boost::optional<double> shadowOffsetX;
+        ret = readDoubleData(shadowOffsetX, reader);
+        m_shape.m_fillStyle.shadowOffsetX(shadowOffsetX);
+      }
       break;
     case XML_SHAPESHDWOFFSETY:
       if (XML_READER_TYPE_ELEMENT == tokenType)
-        ret = readDoubleData(m_shape.m_fillStyle.shadowOffsetY, reader);
+      {
+        boost::optional<double> shadowOffsetY;
+        ret = readDoubleData(shadowOffsetY, reader);
+        m_shape.m_fillStyle.shadowOffsetY(shadowOffsetY);
+      }
       break;
     case XML_LEFTMARGIN:
       if (XML_READER_TYPE_ELEMENT == tokenType)
-        ret = readDoubleData(m_shape.m_textBlockStyle.leftMargin, reader);
+      {
+        boost::optional<double> leftMargin;
+        ret = readDoubleData(leftMargin, reader);
+        m_shape.m_textBlockStyle.leftMargin(leftMargin);
+      }
       break;
     case XML_RIGHTMARGIN:
       if (XML_READER_TYPE_ELEMENT == tokenType)
-        ret = readDoubleData(m_shape.m_textBlockStyle.rightMargin, reader);
+      {
+        boost::optional<double> rightMargin;
+        ret = readDoubleData(rightMargin, reader);
+        m_shape.m_textBlockStyle.rightMargin(rightMargin);
+      }
       break;
     case XML_TOPMARGIN:
       if (XML_READER_TYPE_ELEMENT == tokenType)
-        ret = readDoubleData(m_shape.m_textBlockStyle.topMargin, reader);
+      {
+        boost::optional<double> topMargin;
+        ret = readDoubleData(topMargin, reader);
+        m_shape.m_textBlockStyle.topMargin(topMargin);
+      }
       break;
     case XML_BOTTOMMARGIN:
       if (XML_READER_TYPE_ELEMENT == tokenType)
-        ret = readDoubleData(m_shape.m_textBlockStyle.bottomMargin, reader);
+      {
+        boost::optional<double> bottomMargin;
+        ret = readDoubleData(bottomMargin, reader);
+        m_shape.m_textBlockStyle.bottomMargin(bottomMargin);
+      }
       break;
     case XML_VERTICALALIGN:
       if (XML_READER_TYPE_ELEMENT == tokenType)
-        ret = readByteData(m_shape.m_textBlockStyle.verticalAlign, reader);
+      {
+        boost::optional<unsigned char> verticalAlign;
+        ret = readByteData(verticalAlign, reader);
+        m_shape.m_textBlockStyle.verticalAlign(verticalAlign);
+      }
       break;
     case XML_TEXTBKGND:
       if (XML_READER_TYPE_ELEMENT == tokenType)
@@ -1219,23 +1451,32 @@ void libvisio::VSDXParser::readShapeProperties(xmlTextReaderPtr reader)
         if (bgClrId < 0) bgClrId = 0;
         if (bgClrId)
         {
+          _markDocumentTableUsed();
           std::map<unsigned, Colour>::const_iterator iter = m_colours.find(bgClrId-1);
           if (iter != m_colours.end())
             textBkgndColour = iter->second;
           else
             textBkgndColour = Colour(0xff, 0xff, 0xff, 0);
         }
-        m_shape.m_textBlockStyle.textBkgndColour = textBkgndColour;
-        m_shape.m_textBlockStyle.isTextBkgndFilled = true;
+        m_shape.m_textBlockStyle.textBkgndColour(textBkgndColour);
+        m_shape.m_textBlockStyle.isTextBkgndFilled(true);
       }
       break;
     case XML_DEFAULTTABSTOP:
       if (XML_READER_TYPE_ELEMENT == tokenType)
-        ret = readDoubleData(m_shape.m_textBlockStyle.defaultTabStop, reader);
+      {
+        boost::optional<double> defaultTabStop;
+        ret = readDoubleData(defaultTabStop, reader);
+        m_shape.m_textBlockStyle.defaultTabStop(defaultTabStop);
+      }
       break;
     case XML_TEXTDIRECTION:
       if (XML_READER_TYPE_ELEMENT == tokenType)
-        ret = readByteData(m_shape.m_textBlockStyle.textDirection, reader);
+      {
+        boost::optional<unsigned char> textDirection;
+        ret = readByteData(textDirection, reader);
+        m_shape.m_textBlockStyle.textDirection(textDirection);
+      }
       break;
     case XML_PARAGRAPH:
       if (XML_READER_TYPE_ELEMENT == tokenType)
@@ -1247,7 +1488,9 @@ void libvisio::VSDXParser::readShapeProperties(xmlTextReaderPtr reader)
       break;
     case XML_GEOM:
     case XML_GEOMETRY:
-      if (XML_READER_TYPE_ELEMENT == tokenType)
+      if (XML_READER_TYPE_ELEMENT == tokenType && m_extractText)
+        skipElement(reader);
+      else if (XML_READER_TYPE_ELEMENT == tokenType)
         readGeometry(reader);
       break;
     case XML_TEXT:
@@ -1260,23 +1503,43 @@ void libvisio::VSDXParser::readShapeProperties(xmlTextReaderPtr reader)
       break;
     case XML_QUICKSTYLELINECOLOR:
       if (XML_READER_TYPE_ELEMENT == tokenType)
-        ret = readLongData(m_shape.m_lineStyle.qsLineColour, reader);
+      {
+        boost::optional<long> qsLineColour;
+        ret = readLongData(qsLineColour, reader);
+        m_shape.m_lineStyle.qsLineColour(qsLineColour);
+      }
       break;
     case XML_QUICKSTYLELINEMATRIX:
       if (XML_READER_TYPE_ELEMENT == tokenType)
-        ret = readLongData(m_shape.m_lineStyle.qsLineMatrix, reader);
+      {
+        boost::optional<long> qsLineMatrix;
+        ret = readLongData(qsLineMatrix, reader);
+        m_shape.m_lineStyle.qsLineMatrix(qsLineMatrix);
+      }
       break;
     case XML_QUICKSTYLEFILLCOLOR:
       if (XML_READER_TYPE_ELEMENT == tokenType)
-        ret = readLongData(m_shape.m_fillStyle.qsFillColour, reader);
+      {
+        boost::optional<long> qsFillColour;
+        ret = readLongData(qsFillColour, reader);
+        m_shape.m_fillStyle.qsFillColour(qsFillColour);
+      }
       break;
     case XML_QUICKSTYLESHADOWCOLOR:
       if (XML_READER_TYPE_ELEMENT == tokenType)
-        ret = readLongData(m_shape.m_fillStyle.qsShadowColour, reader);
+      {
+        boost::optional<long> qsShadowColour;
+        ret = readLongData(qsShadowColour, reader);
+        m_shape.m_fillStyle.qsShadowColour(qsShadowColour);
+      }
       break;
     case XML_QUICKSTYLEFILLMATRIX:
       if (XML_READER_TYPE_ELEMENT == tokenType)
-        ret = readLongData(m_shape.m_fillStyle.qsFillMatrix, reader);
+      {
+        boost::optional<long> qsFillMatrix;
+        ret = readLongData(qsFillMatrix, reader);
+        m_shape.m_fillStyle.qsFillMatrix(qsFillMatrix);
+      }
       break;
     case XML_LAYERMEMBER:
       if (XML_READER_TYPE_ELEMENT == tokenType)
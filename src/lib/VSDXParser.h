@@ -10,6 +10,8 @@
 #ifndef __VSDXPARSER_H__
 #define __VSDXPARSER_H__
 
+#include <set>
+#include <string>
 #include <librevenge/librevenge.h>
 #include "VSDXTheme.h"
 #include "VSDXMLParserBase.h"
@@ -33,6 +35,8 @@ public:
   ~VSDXParser() override;
   bool parseMain() override;
   bool extractStencils() override;
+  bool extractText() override;
+  bool probe(librevenge::RVNGPropertyList &info) override;
 
 private:
   VSDXParser();
@@ -53,11 +57,13 @@ private:
   bool parseDocument(librevenge::RVNGInputStream *input, const char *name);
   bool parseMasters(librevenge::RVNGInputStream *input, const char *name);
   bool parseMaster(librevenge::RVNGInputStream *input, const char *name);
+  void parseCachedMaster(librevenge::RVNGInputStream *input, VSDXRelationships &rels);
   bool parsePages(librevenge::RVNGInputStream *input, const char *name);
   bool parsePage(librevenge::RVNGInputStream *input, const char *name);
   bool parseTheme(librevenge::RVNGInputStream *input, const char *name);
   void parseMetaData(librevenge::RVNGInputStream *input, VSDXRelationships &rels);
-  void processXmlDocument(librevenge::RVNGInputStream *input, VSDXRelationships &rels);
+  void collectImages(librevenge::RVNGInputStream *input, const char *name);
+  bool processXmlDocument(librevenge::RVNGInputStream *input, VSDXRelationships &rels);
   void processXmlNode(xmlTextReaderPtr reader);
 
   // Functions reading the Visio 2013 OPC document content
@@ -86,6 +92,7 @@ private:
   int m_currentDepth;
   VSDXRelationships *m_rels;
   VSDXTheme m_currentTheme;
+  std::set<std::string> m_imageNames;
 };
 
 } // namespace libvisio
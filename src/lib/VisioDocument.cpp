@@ -21,11 +21,50 @@
 #include "VSDXParser.h"
 #include "VSD5Parser.h"
 #include "VSD6Parser.h"
+#include "VSDMasterCache.h"
+#include "VSDPageSelection.h"
 #include "VSDXMLHelper.h"
 
 namespace
 {
 
+enum ParsingMode
+{
+  PARSING_MODE_DRAWING,
+  PARSING_MODE_STENCILS,
+  PARSING_MODE_TEXT
+};
+
+/* Writes the statistics of a parser when the parsing is left, also if it
+ * is left by an exception, as they are wanted even if the parsing failed.
+ */
+template<typename Parser>
+class ParseStatsWriter
+{
+public:
+  ParseStatsWriter(const Parser &parser, librevenge::RVNGPropertyList *stats)
+    : m_parser(parser), m_stats(stats) {}
+  ~ParseStatsWriter()
+  {
+    if (!m_stats)
+      return;
+    try
+    {
+      m_parser.getStats(*m_stats);
+    }
+    catch (...)
+    {
+    }
+  }
+
+private:
+  ParseStatsWriter(const ParseStatsWriter &);
+  ParseStatsWriter &operator=(const ParseStatsWriter &);
+
+  const Parser &m_parser;
+  librevenge::RVNGPropertyList *const m_stats;
+};
+
 static bool checkVisioMagic(librevenge::RVNGInputStream *input)
 {
   const unsigned char magic[] =
@@ -74,21 +113,21 @@ catch (...)
   return false;
 }
 
-static bool parseBinaryVisioDocument(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, bool isStencilExtraction) try
+static std::shared_ptr<librevenge::RVNGInputStream> getBinaryDocumentStream(librevenge::RVNGInputStream *input)
 {
-  VSD_DEBUG_MSG(("Parsing Binary Visio Document\n"));
   input->seek(0, librevenge::RVNG_SEEK_SET);
   std::shared_ptr<librevenge::RVNGInputStream> docStream;
   if (input->isStructured())
     docStream.reset(input->getSubStreamByName("VisioDocument"));
   if (!docStream)
     docStream.reset(input, libvisio::VSDDummyDeleter());
+  return docStream;
+}
 
-  docStream->seek(0x1A, librevenge::RVNG_SEEK_SET);
-
+static std::unique_ptr<libvisio::VSDParser> createBinaryParser(librevenge::RVNGInputStream *input, librevenge::RVNGInputStream *docStream,
+                                                               librevenge::RVNGDrawingInterface *painter, unsigned char version)
+{
   std::unique_ptr<libvisio::VSDParser> parser;
-
-  unsigned char version = libvisio::readU8(docStream.get());
   switch (version)
   {
   case 1:
@@ -96,22 +135,67 @@ static bool parseBinaryVisioDocument(librevenge::RVNGInputStream *input, libreve
   case 3:
   case 4:
   case 5:
-    parser.reset(new libvisio::VSD5Parser(docStream.get(), painter));
+    parser.reset(new libvisio::VSD5Parser(docStream, painter));
     break;
   case 6:
-    parser.reset(new libvisio::VSD6Parser(docStream.get(), painter));
+    parser.reset(new libvisio::VSD6Parser(docStream, painter));
     break;
   case 11:
-    parser.reset(new libvisio::VSDParser(docStream.get(), painter, input));
+    parser.reset(new libvisio::VSDParser(docStream, painter, input));
     break;
   default:
     break;
   }
+  return parser;
+}
 
-  if (isStencilExtraction)
+static bool parseBinaryVisioDocument(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, ParsingMode mode,
+                                     const libvisio::VSDPageSelection &pageSelection,
+                                     const libvisio::VisioParseOptions &options = libvisio::VisioParseOptions()) try
+{
+  VSD_DEBUG_MSG(("Parsing Binary Visio Document\n"));
+  const std::shared_ptr<librevenge::RVNGInputStream> docStream = getBinaryDocumentStream(input);
+  docStream->seek(0x1A, librevenge::RVNG_SEEK_SET);
+  unsigned char version = libvisio::readU8(docStream.get());
+
+  std::unique_ptr<libvisio::VSDParser> parser = createBinaryParser(input, docStream.get(), painter, version);
+  if (!parser)
+    return false;
+  parser->setPageSelection(pageSelection);
+  parser->setParseOptions(options);
+  const ParseStatsWriter<libvisio::VSDParser> statsWriter(*parser, options.stats);
+  switch (mode)
+  {
+  case PARSING_MODE_STENCILS:
     return parser->extractStencils();
-  else
+  case PARSING_MODE_TEXT:
+    return parser->extractText();
+  default:
     return parser->parseMain();
+  }
+}
+catch (...)
+{
+  return false;
+}
+
+static bool probeBinaryVisioDocument(librevenge::RVNGInputStream *input, librevenge::RVNGPropertyList &info,
+                                     const libvisio::VisioParseOptions &options) try
+{
+  VSD_DEBUG_MSG(("Probing Binary Visio Document\n"));
+  const std::shared_ptr<librevenge::RVNGInputStream> docStream = getBinaryDocumentStream(input);
+  docStream->seek(0x1A, librevenge::RVNG_SEEK_SET);
+  unsigned char version = libvisio::readU8(docStream.get());
+
+  std::unique_ptr<libvisio::VSDParser> parser = createBinaryParser(input, docStream.get(), nullptr, version);
+  if (!parser)
+    return false;
+  parser->setParseOptions(options);
+  if (!parser->probe(info))
+    return false;
+  info.insert("libvisio:format", "vsd");
+  info.insert("libvisio:version", (int)version);
+  return true;
 }
 catch (...)
 {
@@ -144,17 +228,43 @@ catch (...)
   return false;
 }
 
-static bool parseOpcVisioDocument(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, bool isStencilExtraction) try
+static bool parseOpcVisioDocument(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, ParsingMode mode,
+                                  const libvisio::VSDPageSelection &pageSelection,
+                                  const libvisio::VisioParseOptions &options = libvisio::VisioParseOptions()) try
 {
   VSD_DEBUG_MSG(("Parsing Visio Document based on Open Packaging Convention\n"));
   input->seek(0, librevenge::RVNG_SEEK_SET);
   libvisio::VSDXParser parser(input, painter);
-  if (isStencilExtraction && parser.extractStencils())
-    return true;
-  else if (!isStencilExtraction && parser.parseMain())
-    return true;
+  parser.setPageSelection(pageSelection);
+  parser.setParseOptions(options);
+  const ParseStatsWriter<libvisio::VSDXParser> statsWriter(parser, options.stats);
+  switch (mode)
+  {
+  case PARSING_MODE_STENCILS:
+    return parser.extractStencils();
+  case PARSING_MODE_TEXT:
+    return parser.extractText();
+  default:
+    return parser.parseMain();
+  }
+}
+catch (...)
+{
   return false;
 }
+
+static bool probeOpcVisioDocument(librevenge::RVNGInputStream *input, librevenge::RVNGPropertyList &info,
+                                  const libvisio::VisioParseOptions &options) try
+{
+  VSD_DEBUG_MSG(("Probing Visio Document based on Open Packaging Convention\n"));
+  input->seek(0, librevenge::RVNG_SEEK_SET);
+  libvisio::VSDXParser parser(input, nullptr);
+  parser.setParseOptions(options);
+  if (!parser.probe(info))
+    return false;
+  info.insert("libvisio:format", "vsdx");
+  return true;
+}
 catch (...)
 {
   return false;
@@ -189,22 +299,76 @@ catch (...)
   return false;
 }
 
-static bool parseXmlVisioDocument(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, bool isStencilExtraction) try
+static bool parseXmlVisioDocument(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, ParsingMode mode,
+                                  const libvisio::VSDPageSelection &pageSelection,
+                                  const libvisio::VisioParseOptions &options = libvisio::VisioParseOptions()) try
 {
   VSD_DEBUG_MSG(("Parsing Visio DrawingML Document\n"));
   input->seek(0, librevenge::RVNG_SEEK_SET);
   libvisio::VDXParser parser(input, painter);
-  if (isStencilExtraction && parser.extractStencils())
-    return true;
-  else if (!isStencilExtraction && parser.parseMain())
-    return true;
+  parser.setPageSelection(pageSelection);
+  parser.setParseOptions(options);
+  const ParseStatsWriter<libvisio::VDXParser> statsWriter(parser, options.stats);
+  switch (mode)
+  {
+  case PARSING_MODE_STENCILS:
+    return parser.extractStencils();
+  case PARSING_MODE_TEXT:
+    return parser.extractText();
+  default:
+    return parser.parseMain();
+  }
+}
+catch (...)
+{
   return false;
 }
+
+static bool probeXmlVisioDocument(librevenge::RVNGInputStream *input, librevenge::RVNGPropertyList &info,
+                                  const libvisio::VisioParseOptions &options) try
+{
+  VSD_DEBUG_MSG(("Probing Visio DrawingML Document\n"));
+  input->seek(0, librevenge::RVNG_SEEK_SET);
+  libvisio::VDXParser parser(input, nullptr);
+  parser.setParseOptions(options);
+  if (!parser.probe(info))
+    return false;
+  info.insert("libvisio:format", "vdx");
+  return true;
+}
 catch (...)
 {
   return false;
 }
 
+static bool parseDocument(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, ParsingMode mode,
+                          const libvisio::VSDPageSelection &pageSelection,
+                          const libvisio::VisioParseOptions &options = libvisio::VisioParseOptions())
+{
+  if (!input || !painter)
+    return false;
+
+  if (isBinaryVisioDocument(input))
+  {
+    if (parseBinaryVisioDocument(input, painter, mode, pageSelection, options))
+      return true;
+    return false;
+  }
+  if (isOpcVisioDocument(input))
+  {
+    if (parseOpcVisioDocument(input, painter, mode, pageSelection, options))
+      return true;
+    return false;
+  }
+  if (isXmlVisioDocument(input))
+  {
+    if (parseXmlVisioDocument(input, painter, mode, pageSelection, options))
+      return true;
+    return false;
+  }
+  return false;
+}
+
 } // anonymous namespace
 
 
@@ -238,27 +402,204 @@ librevenge::RVNGDrawingInterface class implementation when needed. This is often
 */
 VSDAPI bool libvisio::VisioDocument::parse(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter)
 {
-  if (!input || !painter)
+  return parseDocument(input, painter, PARSING_MODE_DRAWING, VSDPageSelection());
+}
+
+/**
+Parses the input stream content like parse(), but within resource limits and with progress
+reports. This is meant for documents that come from untrusted sources, which can be crafted to
+need huge amounts of memory or time. A limit of 0 means that there is no limit. Exceeding one of these limits aborts the
+parsing:
+- maxDecompressedBytes: the total size of the decompressed streams of binary documents. The
+streams are counted every time that they are read, and the document is read twice.
+- maxParseTime: the time spent parsing, in milliseconds. It is checked between shapes and streams.
+Exceeding one of these just truncates the output:
+- maxElementsPerPage: the number of drawing and text elements of a page. Further shapes of the page
+are dropped.
+- maxPathPoints: the number of points of the path of a shape generated from NURBS and polylines
+- maxNestingDepth: the nesting depth of the groups of XML based documents, or of the streams of
+binary ones. Deeper ones are skipped.
+imageHandling tells what to do with the embedded bitmaps, metafiles and OLE objects: paint them
+with their data (VISIO_IMAGES_EMBED, the default), drop them without reading their data
+(VISIO_IMAGES_SKIP), or paint them with their position, size and mime type but without
+office:binary-data (VISIO_IMAGES_PLACEHOLDER).
+curveTolerance is the largest distance, in inches, that curves which are painted as polylines
+may be from the real curve. It is 0.001 if it is not set.
+If a masterCache is given, the masters of VSDX documents are taken from it when it has them, and
+are added to it otherwise. Masters that depend on other parts of their document, like images or
+other masters, are not cached, and neither are the masters of binary and VDX documents.
+If a callback is given, it is told the progress of the parsing between streams, shapes and pages:
+the number of pages done and of bytes of input consumed. These are the compressed bytes of the
+streams of binary documents and the bytes of the XML of the other ones. As the document is read
+twice, the bytes consumed end up about twice its size. The parsing is cancelled if the callback
+returns false.
+If stats is given, it receives statistics of where the parsing spent its time, even if it failed:
+- libvisio:decompressed-bytes, libvisio:decompression-time: the size of the decompressed streams of
+binary documents and the time spent decompressing them
+- libvisio:styles-pass-time, libvisio:content-pass-time: the time spent in the two passes over the
+document
+- libvisio:draw-time: the time spent painting the pages
+- libvisio:chunks: for binary documents, a vector with the libvisio:chunk-type and the
+libvisio:count of the chunks, one property list per chunk type
+- libvisio:xml-nodes: the number of XML nodes read by XML based documents
+- libvisio:shapes, libvisio:paths: the numbers of shapes and paths output
+- libvisio:nurbs-points: the number of points generated from NURBS curves
+- libvisio:master-cache-hits: the number of masters taken from the master cache
+All the times are in seconds.
+\param input The input stream
+\param painter A WPGPainterInterface implementation
+\param options The limits, the image handling, the master cache, the progress callback and the
+statistics
+\return A value that indicates whether the parsing was successful. It is false if a limit that
+aborts the parsing was exceeded or if the parsing was cancelled
+*/
+VSDAPI bool libvisio::VisioDocument::parse(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, const VisioParseOptions &options)
+{
+  return parseDocument(input, painter, PARSING_MODE_DRAWING, VSDPageSelection(), options);
+}
+
+/**
+Parses only one foreground page of the input stream content, together with the background
+pages it uses. These are not output as pages of their own. It will make callbacks to the
+functions provided by a librevenge::RVNGDrawingInterface class implementation when needed.
+\param input The input stream
+\param painter A WPGPainterInterface implementation
+\param pageIndex The 0-based index of the page among the foreground pages of the document
+\return A value that indicates whether the parsing was successful. It is false if the document
+has no such page
+*/
+VSDAPI bool libvisio::VisioDocument::parsePage(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, unsigned pageIndex)
+{
+  return parsePage(input, painter, pageIndex, VisioParseOptions());
+}
+
+/**
+Parses only one foreground page of the input stream content like parsePage(), with the options
+of parse().
+\param input The input stream
+\param painter A WPGPainterInterface implementation
+\param pageIndex The 0-based index of the page among the foreground pages of the document
+\param options The limits, the image handling, the master cache, the progress callback and the
+statistics
+\return A value that indicates whether the parsing was successful
+*/
+VSDAPI bool libvisio::VisioDocument::parsePage(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, unsigned pageIndex,
+                                               const VisioParseOptions &options)
+{
+  VSDPageSelection pageSelection;
+  pageSelection.addPageIndex(pageIndex);
+  return parseDocument(input, painter, PARSING_MODE_DRAWING, pageSelection, options);
+}
+
+/**
+Parses only the foreground pages of the input stream content that have one of the given names,
+together with the background pages they use. These are not output as pages of their own. It will
+make callbacks to the functions provided by a librevenge::RVNGDrawingInterface class implementation
+when needed.
+\param input The input stream
+\param painter A WPGPainterInterface implementation
+\param pageNames The names of the pages to parse
+\return A value that indicates whether the parsing was successful. It is false if none of the
+pages exists in the document
+*/
+VSDAPI bool libvisio::VisioDocument::parsePages(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, const librevenge::RVNGStringVector &pageNames)
+{
+  return parsePages(input, painter, pageNames, VisioParseOptions());
+}
+
+/**
+Parses only the foreground pages of the input stream content that have one of the given names
+like parsePages(), with the options of parse().
+\param input The input stream
+\param painter A WPGPainterInterface implementation
+\param pageNames The names of the pages to parse
+\param options The limits, the image handling, the master cache, the progress callback and the
+statistics
+\return A value that indicates whether the parsing was successful
+*/
+VSDAPI bool libvisio::VisioDocument::parsePages(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, const librevenge::RVNGStringVector &pageNames,
+                                                const VisioParseOptions &options)
+{
+  if (pageNames.empty())
     return false;
+  VSDPageSelection pageSelection;
+  for (unsigned i = 0; i < pageNames.size(); ++i)
+    pageSelection.addPageName(pageNames[i]);
+  return parseDocument(input, painter, PARSING_MODE_DRAWING, pageSelection, options);
+}
 
-  if (isBinaryVisioDocument(input))
-  {
-    if (parseBinaryVisioDocument(input, painter, false))
-      return true;
+/**
+Parses only the text of the input stream content: the text of the shapes, with their fields,
+and the pages and metadata of the document. The geometry, the styles and the embedded objects
+are neither read nor output, so this is much faster than parse() when just the text is needed,
+like for indexing. The texts are output in the order in which they are stored in the document.
+It will make callbacks to the functions provided by a librevenge::RVNGDrawingInterface class
+implementation when needed.
+\param input The input stream
+\param painter A WPGPainterInterface implementation
+\return A value that indicates whether the parsing was successful
+*/
+VSDAPI bool libvisio::VisioDocument::parseText(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter)
+{
+  return parseDocument(input, painter, PARSING_MODE_TEXT, VSDPageSelection());
+}
+
+/**
+Parses only the text of the input stream content like parseText(), with the options of parse().
+As no shapes are drawn, the limits on the elements of a page and on the points of a path, the
+image handling and the curve tolerance do not apply.
+\param input The input stream
+\param painter A WPGPainterInterface implementation
+\param options The limits, the master cache, the progress callback and the statistics
+\return A value that indicates whether the parsing was successful
+*/
+VSDAPI bool libvisio::VisioDocument::parseText(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *painter, const VisioParseOptions &options)
+{
+  return parseDocument(input, painter, PARSING_MODE_TEXT, VSDPageSelection(), options);
+}
+
+/**
+Reads a summary of the input stream content without parsing it: the metadata of the document,
+the names and sizes of its pages and the numbers of its masters and embedded images. No shapes
+are read, so this is cheap even for large documents. The summary is put into info:
+- the metadata, with the same keys as in setDocumentMetaData()
+- libvisio:format: "vsd" for binary documents, "vsdx" or "vdx" for the XML based ones
+- libvisio:version: the file format version of binary documents, like 11 for Visio 2003-2010
+- libvisio:pages: a vector with one property list per page, in document order, with svg:width and
+svg:height in inches, draw:name if the page has a name, and libvisio:background
+- libvisio:masters: the number of masters
+- libvisio:images: the number of embedded images and other foreign objects. In binary documents,
+the ones inside groups are not counted, because that would need reading the shapes.
+\param input The input stream
+\param info The property list that receives the summary
+\return A value that indicates whether the content from the input stream is a Visio Document
+that could be probed
+*/
+VSDAPI bool libvisio::VisioDocument::probe(librevenge::RVNGInputStream *input, librevenge::RVNGPropertyList &info)
+{
+  return probe(input, info, VisioParseOptions());
+}
+
+/**
+Reads a summary of the input stream content like probe(), within the limits of the decompressed
+size, the nesting depth and the time of parse(), and with its progress callback.
+\param input The input stream
+\param info The property list that receives the summary
+\param options The limits and the progress callback; the other options are not used
+\return A value that indicates whether the content from the input stream is a Visio Document
+that could be probed
+*/
+VSDAPI bool libvisio::VisioDocument::probe(librevenge::RVNGInputStream *input, librevenge::RVNGPropertyList &info, const VisioParseOptions &options)
+{
+  if (!input)
     return false;
-  }
+
+  if (isBinaryVisioDocument(input))
+    return probeBinaryVisioDocument(input, info, options);
   if (isOpcVisioDocument(input))
-  {
-    if (parseOpcVisioDocument(input, painter, false))
-      return true;
-    return false;
-  }
+    return probeOpcVisioDocument(input, info, options);
   if (isXmlVisioDocument(input))
-  {
-    if (parseXmlVisioDocument(input, painter, false))
-      return true;
-    return false;
-  }
+    return probeXmlVisioDocument(input, info, options);
   return false;
 }
 
@@ -277,22 +618,43 @@ VSDAPI bool libvisio::VisioDocument::parseStencils(librevenge::RVNGInputStream *
 
   if (isBinaryVisioDocument(input))
   {
-    if (parseBinaryVisioDocument(input, painter, true))
+    if (parseBinaryVisioDocument(input, painter, PARSING_MODE_STENCILS, VSDPageSelection()))
       return true;
     return false;
   }
   if (isOpcVisioDocument(input))
   {
-    if (parseOpcVisioDocument(input, painter, true))
+    if (parseOpcVisioDocument(input, painter, PARSING_MODE_STENCILS, VSDPageSelection()))
       return true;
     return false;
   }
   if (isXmlVisioDocument(input))
   {
-    if (parseXmlVisioDocument(input, painter, true))
+    if (parseXmlVisioDocument(input, painter, PARSING_MODE_STENCILS, VSDPageSelection()))
       return true;
     return false;
   }
   return false;
 }
+
+/**
+Creates an empty cache of masters, which can be given to parse() in VisioParseOptions::masterCache.
+\param maxBytes The total size of the XML of the masters that the cache may hold
+*/
+VSDAPI libvisio::VisioMasterCache::VisioMasterCache(unsigned long maxBytes)
+  : m_impl(new VSDMasterCache(maxBytes))
+{
+}
+
+VSDAPI libvisio::VisioMasterCache::~VisioMasterCache()
+{
+}
+
+/**
+Drops all the masters of the cache.
+*/
+VSDAPI void libvisio::VisioMasterCache::clear()
+{
+  m_impl->clear();
+}
 /* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -11,8 +11,23 @@
 
 #include <cstdarg>
 #include <cstdio>
+#include <map>
+#include <string>
 #include "VSDInternalStream.h"
 
+namespace
+{
+
+struct ConverterDeleter
+{
+  void operator()(UConverter *conv)
+  {
+    ucnv_close(conv);
+  }
+};
+
+} // anonymous namespace
+
 uint8_t libvisio::readU8(librevenge::RVNGInputStream *input)
 {
   if (!input || input->isEnd())
@@ -143,6 +158,213 @@ void libvisio::appendUCS4(librevenge::RVNGString &text, UChar32 ucs4Character)
   text.append((char *)outbuf);
 }
 
+void libvisio::appendUCS4(std::string &text, UChar32 ucs4Character)
+{
+  // Convert carriage returns to new line characters
+  if (ucs4Character == (UChar32) 0x0d || ucs4Character == (UChar32) 0x0e)
+    ucs4Character = (UChar32) '\n';
+
+  unsigned char outbuf[U8_MAX_LENGTH];
+  int i = 0;
+  U8_APPEND_UNSAFE(&outbuf[0], i, ucs4Character);
+  text.append((const char *)outbuf, i);
+}
+
+void libvisio::appendCharacters(librevenge::RVNGString &text, const std::vector<unsigned char> &characters, TextFormat format)
+{
+  if (format == VSD_TEXT_UTF16)
+    return appendCharacters(text, characters);
+  if (format == VSD_TEXT_UTF8)
+  {
+    // TODO: revisit for librevenge 0.1
+    std::vector<unsigned char> buf;
+    buf.reserve(characters.size() + 1);
+    buf.assign(characters.begin(), characters.end());
+    buf.push_back(0);
+    text.append(reinterpret_cast<const char *>(buf.data()));
+    return;
+  }
+
+  static const UChar32 symbolmap [] =
+  {
+    0x0020, 0x0021, 0x2200, 0x0023, 0x2203, 0x0025, 0x0026, 0x220D, // 0x20 ..
+    0x0028, 0x0029, 0x2217, 0x002B, 0x002C, 0x2212, 0x002E, 0x002F,
+    0x0030, 0x0031, 0x0032, 0x0033, 0x0034, 0x0035, 0x0036, 0x0037,
+    0x0038, 0x0039, 0x003A, 0x003B, 0x003C, 0x003D, 0x003E, 0x003F,
+    0x2245, 0x0391, 0x0392, 0x03A7, 0x0394, 0x0395, 0x03A6, 0x0393,
+    0x0397, 0x0399, 0x03D1, 0x039A, 0x039B, 0x039C, 0x039D, 0x039F,
+    0x03A0, 0x0398, 0x03A1, 0x03A3, 0x03A4, 0x03A5, 0x03C2, 0x03A9,
+    0x039E, 0x03A8, 0x0396, 0x005B, 0x2234, 0x005D, 0x22A5, 0x005F,
+    0xF8E5, 0x03B1, 0x03B2, 0x03C7, 0x03B4, 0x03B5, 0x03C6, 0x03B3,
+    0x03B7, 0x03B9, 0x03D5, 0x03BA, 0x03BB, 0x03BC, 0x03BD, 0x03BF,
+    0x03C0, 0x03B8, 0x03C1, 0x03C3, 0x03C4, 0x03C5, 0x03D6, 0x03C9,
+    0x03BE, 0x03C8, 0x03B6, 0x007B, 0x007C, 0x007D, 0x223C, 0x0020, // .. 0x7F
+    0x0080, 0x0081, 0x0082, 0x0083, 0x0084, 0x0085, 0x0086, 0x0087,
+    0x0088, 0x0089, 0x008a, 0x008b, 0x008c, 0x008d, 0x008e, 0x008f,
+    0x0090, 0x0091, 0x0092, 0x0093, 0x0094, 0x0095, 0x0096, 0x0097,
+    0x0098, 0x0099, 0x009a, 0x009b, 0x009c, 0x009d, 0x009E, 0x009f,
+    0x20AC, 0x03D2, 0x2032, 0x2264, 0x2044, 0x221E, 0x0192, 0x2663, // 0xA0 ..
+    0x2666, 0x2665, 0x2660, 0x2194, 0x2190, 0x2191, 0x2192, 0x2193,
+    0x00B0, 0x00B1, 0x2033, 0x2265, 0x00D7, 0x221D, 0x2202, 0x2022,
+    0x00F7, 0x2260, 0x2261, 0x2248, 0x2026, 0x23D0, 0x23AF, 0x21B5,
+    0x2135, 0x2111, 0x211C, 0x2118, 0x2297, 0x2295, 0x2205, 0x2229,
+    0x222A, 0x2283, 0x2287, 0x2284, 0x2282, 0x2286, 0x2208, 0x2209,
+    0x2220, 0x2207, 0x00AE, 0x00A9, 0x2122, 0x220F, 0x221A, 0x22C5,
+    0x00AC, 0x2227, 0x2228, 0x21D4, 0x21D0, 0x21D1, 0x21D2, 0x21D3,
+    0x25CA, 0x3008, 0x00AE, 0x00A9, 0x2122, 0x2211, 0x239B, 0x239C,
+    0x239D, 0x23A1, 0x23A2, 0x23A3, 0x23A7, 0x23A8, 0x23A9, 0x23AA,
+    0xF8FF, 0x3009, 0x222B, 0x2320, 0x23AE, 0x2321, 0x239E, 0x239F,
+    0x23A0, 0x23A4, 0x23A5, 0x23A6, 0x23AB, 0x23AC, 0x23AD, 0x0020  // .. 0xFE
+  };
+
+  UChar32  ucs4Character = 0;
+  if (format == VSD_TEXT_SYMBOL) // SYMBOL
+  {
+    for (unsigned char character : characters)
+    {
+      if (0x1e == ucs4Character)
+        ucs4Character = 0xfffc;
+      else if (character < 0x20)
+        ucs4Character = 0x20;
+      else
+        ucs4Character = symbolmap[character - 0x20];
+      appendUCS4(text, ucs4Character);
+    }
+  }
+  else
+  {
+    const char *charset = nullptr;
+    switch (format)
+    {
+    case VSD_TEXT_JAPANESE:
+      charset = "windows-932";
+      break;
+    case VSD_TEXT_KOREAN:
+      charset = "windows-949";
+      break;
+    case VSD_TEXT_CHINESE_SIMPLIFIED:
+      charset = "windows-936";
+      break;
+    case VSD_TEXT_CHINESE_TRADITIONAL:
+      charset = "windows-950";
+      break;
+    case VSD_TEXT_GREEK:
+      charset = "windows-1253";
+      break;
+    case VSD_TEXT_TURKISH:
+      charset = "windows-1254";
+      break;
+    case VSD_TEXT_VIETNAMESE:
+      charset = "windows-1258";
+      break;
+    case VSD_TEXT_HEBREW:
+      charset = "windows-1255";
+      break;
+    case VSD_TEXT_ARABIC:
+      charset = "windows-1256";
+      break;
+    case VSD_TEXT_BALTIC:
+      charset = "windows-1257";
+      break;
+    case VSD_TEXT_RUSSIAN:
+      charset = "windows-1251";
+      break;
+    case VSD_TEXT_THAI:
+      charset = "windows-874";
+      break;
+    case VSD_TEXT_CENTRAL_EUROPE:
+      charset = "windows-1250";
+      break;
+    default:
+      charset = "windows-1252";
+      break;
+    }
+    UErrorCode status = U_ZERO_ERROR;
+    UConverter *const conv = getConverter(charset);
+    if (conv)
+    {
+      const auto *src = (const char *)&characters[0];
+      const char *srcLimit = (const char *)src + characters.size();
+      while (src < srcLimit)
+      {
+        ucs4Character = ucnv_getNextUChar(conv, &src, srcLimit, &status);
+        if (U_SUCCESS(status) && U_IS_UNICODE_CHAR(ucs4Character))
+        {
+          if (0x1e == ucs4Character)
+            appendUCS4(text, 0xfffc);
+          else
+            appendUCS4(text, ucs4Character);
+        }
+      }
+    }
+  }
+}
+
+void libvisio::appendCharacters(librevenge::RVNGString &text, const std::vector<unsigned char> &characters)
+{
+  UErrorCode status = U_ZERO_ERROR;
+  UConverter *const conv = getConverter("UTF-16LE");
+
+  if (conv)
+  {
+    const auto *src = (const char *)&characters[0];
+    const char *srcLimit = (const char *)src + characters.size();
+    while (src < srcLimit)
+    {
+      UChar32 ucs4Character = ucnv_getNextUChar(conv, &src, srcLimit, &status);
+      if (U_SUCCESS(status) && U_IS_UNICODE_CHAR(ucs4Character))
+        appendUCS4(text, ucs4Character);
+    }
+  }
+}
+
+void libvisio::appendUTF16Characters(std::string &text, const unsigned char *characters, unsigned long size)
+{
+  UErrorCode status = U_ZERO_ERROR;
+  UConverter *const conv = getConverter("UTF-16LE");
+
+  if (conv && characters)
+  {
+    const auto *src = (const char *)characters;
+    const char *srcLimit = src + size;
+    while (src < srcLimit)
+    {
+      UChar32 ucs4Character = ucnv_getNextUChar(conv, &src, srcLimit, &status);
+      if (U_SUCCESS(status) && U_IS_UNICODE_CHAR(ucs4Character))
+        appendUCS4(text, ucs4Character);
+    }
+  }
+}
+
+UConverter *libvisio::getConverter(const char *charset)
+{
+  // opening a converter is not cheap, and one must not be used by two threads at once
+  thread_local std::map<std::string, std::unique_ptr<UConverter, ConverterDeleter> > converters;
+
+  std::unique_ptr<UConverter, ConverterDeleter> &conv = converters[charset];
+  if (conv)
+  {
+    ucnv_reset(conv.get());
+  }
+  else
+  {
+    UErrorCode status = U_ZERO_ERROR;
+    conv.reset(ucnv_open(charset, &status));
+    if (U_FAILURE(status))
+      conv.reset();
+  }
+  return conv.get();
+}
+
+bool libvisio::getUTCTime(time_t timer, struct tm &result)
+{
+#ifdef _WIN32
+  return !gmtime_s(&result, &timer);
+#else
+  return gmtime_r(&timer, &result);
+#endif
+}
+
 void libvisio::debugPrint(const char *format, ...)
 {
   va_list args;
@@ -14,7 +14,10 @@
 #include "config.h"
 #endif
 
+#include <ctime>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <boost/cstdint.hpp>
 
@@ -27,6 +30,7 @@
 #include <librevenge/librevenge.h>
 #include <librevenge-stream/librevenge-stream.h>
 #include <unicode/utypes.h>
+#include <unicode/ucnv.h>
 
 #if defined(HAVE_FUNC_ATTRIBUTE_FORMAT)
 #define VSD_ATTRIBUTE_PRINTF(fmt, arg) __attribute__((format(printf, fmt, arg)))
@@ -67,6 +71,16 @@ std::unique_ptr<T> clone(const std::unique_ptr<T> &other)
   return std::unique_ptr<T>(other->clone());
 }
 
+// Elements shared between a master shape and its instances are cloned
+// only when an instance is about to modify them.
+template<typename T>
+T *detach(std::shared_ptr<T> &element)
+{
+  if (element && element.use_count() > 1)
+    element.reset(element->clone());
+  return element.get();
+}
+
 uint8_t readU8(librevenge::RVNGInputStream *input);
 uint16_t readU16(librevenge::RVNGInputStream *input);
 int16_t readS16(librevenge::RVNGInputStream *input);
@@ -81,6 +95,20 @@ const librevenge::RVNGString getColourString(const Colour &c);
 unsigned long getRemainingLength(librevenge::RVNGInputStream *input);
 
 void appendUCS4(librevenge::RVNGString &text, UChar32 ucs4Character);
+void appendUCS4(std::string &text, UChar32 ucs4Character);
+
+void appendCharacters(librevenge::RVNGString &text, const std::vector<unsigned char> &characters, TextFormat format);
+void appendCharacters(librevenge::RVNGString &text, const std::vector<unsigned char> &characters);
+// Like appendCharacters() for UTF-16, but into a buffer that can be reused
+void appendUTF16Characters(std::string &text, const unsigned char *characters, unsigned long size);
+
+/* Returns a converter for the given charset, owned by the calling
+ * thread and reset to its initial state, or nullptr if there is none.
+ */
+UConverter *getConverter(const char *charset);
+
+// reentrant replacement of gmtime
+bool getUTCTime(time_t timer, struct tm &result);
 
 void debugPrint(const char *format, ...) VSD_ATTRIBUTE_PRINTF(1, 2);
 
@@ -96,6 +124,14 @@ class GenericException
 {
 };
 
+class ParseLimitException
+{
+};
+
+class ParseCancelledException
+{
+};
+
 } // namespace libvisio
 
 #endif // __LIBVISIO_UTILS_H__
@@ -14,6 +14,8 @@
 #endif
 #include <boost/lexical_cast.hpp>
 
+#include <mutex>
+
 #include "VSDTypes.h"
 #include "libvisio_utils.h"
 
@@ -99,6 +101,10 @@ void XMLErrorWatcher::setError()
 std::unique_ptr<xmlTextReader, void (*)(xmlTextReaderPtr)>
 xmlReaderForStream(librevenge::RVNGInputStream *input, XMLErrorWatcher *const watcher, bool recover)
 {
+  // libxml2 sets up its global state on first use, which is not safe from several threads at once
+  static std::once_flag xmlInitialized;
+  std::call_once(xmlInitialized, xmlInitParser);
+
   int options = XML_PARSE_NOBLANKS | XML_PARSE_NONET;
   if (recover)
     options |= XML_PARSE_RECOVER;
@@ -0,0 +1,117 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <string>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "VSDGeometryFormula.h"
+
+namespace test
+{
+
+using libvisio::NURBSData;
+using libvisio::PolylineData;
+
+class VSDGeometryFormulaTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp();
+  virtual void tearDown();
+
+private:
+  CPPUNIT_TEST_SUITE(VSDGeometryFormulaTest);
+  CPPUNIT_TEST(testNURBS);
+  CPPUNIT_TEST(testPolyline);
+  CPPUNIT_TEST(testSeparators);
+  CPPUNIT_TEST(testInvalid);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testNURBS();
+  void testPolyline();
+  void testSeparators();
+  void testInvalid();
+};
+
+void VSDGeometryFormulaTest::setUp()
+{
+}
+
+void VSDGeometryFormulaTest::tearDown()
+{
+}
+
+void VSDGeometryFormulaTest::testNURBS()
+{
+  NURBSData data;
+  CPPUNIT_ASSERT(libvisio::parseNURBSFormula("NURBS(2, 3, 0, 1, 0.5, 1e-1, 0, 1, -1, 2.5, 1, 0.75)", data));
+  CPPUNIT_ASSERT_EQUAL(2.0, data.lastKnot);
+  CPPUNIT_ASSERT_EQUAL(3u, data.degree);
+  CPPUNIT_ASSERT_EQUAL((unsigned char)0, data.xType);
+  CPPUNIT_ASSERT_EQUAL((unsigned char)1, data.yType);
+  CPPUNIT_ASSERT_EQUAL(size_t(2), data.points.size());
+  CPPUNIT_ASSERT_EQUAL(0.5, data.points[0].first);
+  CPPUNIT_ASSERT_EQUAL(0.1, data.points[0].second);
+  CPPUNIT_ASSERT_EQUAL(-1.0, data.points[1].first);
+  CPPUNIT_ASSERT_EQUAL(2.5, data.points[1].second);
+  CPPUNIT_ASSERT_EQUAL(size_t(2), data.knots.size());
+  CPPUNIT_ASSERT_EQUAL(1.0, data.knots[1]);
+  CPPUNIT_ASSERT_EQUAL(size_t(2), data.weights.size());
+  CPPUNIT_ASSERT_EQUAL(0.75, data.weights[1]);
+}
+
+void VSDGeometryFormulaTest::testPolyline()
+{
+  PolylineData data;
+  std::string formula("POLYLINE(0, 0");
+  for (unsigned i = 0; i < 1000; ++i)
+    formula.append(", ").append(std::to_string(i)).append(", 0.5");
+  formula.append(")");
+  CPPUNIT_ASSERT(libvisio::parsePolylineFormula(formula.c_str(), data));
+  CPPUNIT_ASSERT_EQUAL(size_t(1000), data.points.size());
+  CPPUNIT_ASSERT_EQUAL(size_t(1000), data.points.capacity());
+  CPPUNIT_ASSERT_EQUAL(999.0, data.points.back().first);
+  CPPUNIT_ASSERT_EQUAL(0.5, data.points.back().second);
+}
+
+void VSDGeometryFormulaTest::testSeparators()
+{
+  PolylineData data;
+  CPPUNIT_ASSERT(libvisio::parsePolylineFormula("  POLYLINE ( 1 1 ,2 3,4 , 5 ) ", data));
+  CPPUNIT_ASSERT_EQUAL((unsigned char)1, data.xType);
+  CPPUNIT_ASSERT_EQUAL(size_t(2), data.points.size());
+  CPPUNIT_ASSERT_EQUAL(4.0, data.points[1].first);
+  CPPUNIT_ASSERT_EQUAL(5.0, data.points[1].second);
+}
+
+void VSDGeometryFormulaTest::testInvalid()
+{
+  PolylineData polyline;
+  CPPUNIT_ASSERT(!libvisio::parsePolylineFormula("", polyline));
+  CPPUNIT_ASSERT(!libvisio::parsePolylineFormula("POLYLINE(0, 0)", polyline));
+  CPPUNIT_ASSERT(!libvisio::parsePolylineFormula("POLYLINE(0, 0, 1)", polyline));
+  CPPUNIT_ASSERT(!libvisio::parsePolylineFormula("POLYLINE(0, 0, 1, 2,)", polyline));
+  CPPUNIT_ASSERT(!libvisio::parsePolylineFormula("POLYLINE(, 0, 0, 1, 2)", polyline));
+  CPPUNIT_ASSERT(!libvisio::parsePolylineFormula("POLYLINE(0, 0, 1, 2", polyline));
+  CPPUNIT_ASSERT(!libvisio::parsePolylineFormula("POLYLINE(0, 0, 1, 2) x", polyline));
+  CPPUNIT_ASSERT(!libvisio::parsePolylineFormula("POLYLINE(0.5, 0, 1, 2)", polyline));
+
+  NURBSData nurbs;
+  CPPUNIT_ASSERT(!libvisio::parseNURBSFormula("POLYLINE(0, 0, 1, 2)", nurbs));
+  CPPUNIT_ASSERT(!libvisio::parseNURBSFormula("NURBS(1, 3, 0, 0, 0, 0, 0)", nurbs));
+  CPPUNIT_ASSERT(!libvisio::parseNURBSFormula("NURBS(1, 3, 0, 0, 0, 0, 0, 1, 2)", nurbs));
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(VSDGeometryFormulaTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
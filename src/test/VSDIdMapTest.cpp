@@ -0,0 +1,149 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <memory>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "VSDIdMap.h"
+
+namespace test
+{
+
+using libvisio::VSDIdMap;
+
+class VSDIdMapTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp();
+  virtual void tearDown();
+
+private:
+  CPPUNIT_TEST_SUITE(VSDIdMapTest);
+  CPPUNIT_TEST(testDense);
+  CPPUNIT_TEST(testSparse);
+  CPPUNIT_TEST(testMoveOnly);
+  CPPUNIT_TEST(testOutOfOrder);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testDense();
+  void testSparse();
+  void testMoveOnly();
+  void testOutOfOrder();
+};
+
+void VSDIdMapTest::setUp()
+{
+}
+
+void VSDIdMapTest::tearDown()
+{
+}
+
+void VSDIdMapTest::testDense()
+{
+  VSDIdMap<unsigned> map;
+  CPPUNIT_ASSERT(map.empty());
+  CPPUNIT_ASSERT(map.find(0) == map.end());
+
+  for (unsigned i = 1; i <= 10; ++i)
+    map[i] = 100 + i;
+  CPPUNIT_ASSERT_EQUAL(size_t(10), map.size());
+  for (unsigned i = 1; i <= 10; ++i)
+  {
+    CPPUNIT_ASSERT(map.find(i) != map.end());
+    CPPUNIT_ASSERT_EQUAL(100 + i, map.find(i)->second);
+  }
+  CPPUNIT_ASSERT(map.find(0) == map.end());
+  CPPUNIT_ASSERT(map.find(11) == map.end());
+
+  // an existing id is not inserted again
+  map[5] = 5;
+  CPPUNIT_ASSERT_EQUAL(size_t(10), map.size());
+  CPPUNIT_ASSERT_EQUAL(5u, map.find(5)->second);
+
+  map.clear();
+  CPPUNIT_ASSERT(map.empty());
+  CPPUNIT_ASSERT(map.find(5) == map.end());
+}
+
+void VSDIdMapTest::testSparse()
+{
+  VSDIdMap<unsigned> map;
+  const unsigned ids[] = { 40, 3, 17, 1000, 4, 0, 39 };
+  for (unsigned id : ids)
+    map[id] = id * 2;
+  CPPUNIT_ASSERT_EQUAL(size_t(7), map.size());
+
+  // iteration is in the order of the ids
+  unsigned previous = 0;
+  for (auto iter = map.begin(); iter != map.end(); ++iter)
+  {
+    CPPUNIT_ASSERT(iter == map.begin() || iter->first > previous);
+    CPPUNIT_ASSERT_EQUAL(iter->first * 2, iter->second);
+    previous = iter->first;
+  }
+  CPPUNIT_ASSERT_EQUAL(0u, map.begin()->first);
+
+  for (unsigned id : ids)
+    CPPUNIT_ASSERT(map.find(id) != map.end());
+  CPPUNIT_ASSERT(map.find(5) == map.end());
+  CPPUNIT_ASSERT(map.find(41) == map.end());
+  CPPUNIT_ASSERT(map.find(2000) == map.end());
+}
+
+void VSDIdMapTest::testMoveOnly()
+{
+  VSDIdMap<std::unique_ptr<int>> map;
+  map[2].reset(new int(2));
+  map[0].reset(new int(0));
+  map[1].reset(new int(1));
+  for (unsigned i = 0; i < 3; ++i)
+    CPPUNIT_ASSERT_EQUAL(int(i), *map.find(i)->second);
+}
+
+void VSDIdMapTest::testOutOfOrder()
+{
+  VSDIdMap<unsigned> map;
+  // descending ids, which took quadratic time when inserted into the vector
+  for (unsigned id = 100000; id > 0; --id)
+    map[id] = id;
+  // an id inserted out of order is found again before the map is read
+  map[50000] += 1;
+  map[200000] = 200000;
+  map[0] = 0;
+  CPPUNIT_ASSERT_EQUAL(size_t(100002), map.size());
+
+  unsigned expected = 0;
+  for (auto iter = map.begin(); iter != map.end(); ++iter, ++expected)
+  {
+    if (expected == 100001)
+      expected = 200000;
+    CPPUNIT_ASSERT_EQUAL(expected, iter->first);
+    CPPUNIT_ASSERT_EQUAL(expected == 50000 ? 50001u : expected, iter->second);
+  }
+  CPPUNIT_ASSERT_EQUAL(200001u, expected);
+
+  // both in order and out of order after the first read
+  map[300000] = 1;
+  map[150000] = 2;
+  const VSDIdMap<unsigned> &constMap = map;
+  CPPUNIT_ASSERT_EQUAL(2u, constMap.find(150000)->second);
+  CPPUNIT_ASSERT_EQUAL(1u, constMap.find(300000)->second);
+  CPPUNIT_ASSERT(constMap.find(150001) == constMap.end());
+  CPPUNIT_ASSERT_EQUAL(size_t(100004), constMap.size());
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(VSDIdMapTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -29,11 +29,13 @@ private:
   CPPUNIT_TEST_SUITE(VSDInternalStreamTest);
   CPPUNIT_TEST(testRead);
   CPPUNIT_TEST(testSeek);
+  CPPUNIT_TEST(testMaxSize);
   CPPUNIT_TEST_SUITE_END();
 
 private:
   void testRead();
   void testSeek();
+  void testMaxSize();
 };
 
 void VSDInternalStreamTest::setUp()
@@ -99,6 +101,29 @@ void VSDInternalStreamTest::testSeek()
   CPPUNIT_ASSERT((sizeof(data) - 1) == strm.tell());
 }
 
+void VSDInternalStreamTest::testMaxSize()
+{
+  // a literal 'a' followed by three back-references that repeat it 18 times each
+  const unsigned char data[] = { 0x01, 'a', 0xee, 0xff, 0xee, 0xff, 0xee, 0xff };
+  librevenge::RVNGBinaryData binData(data, sizeof(data));
+
+  VSDInternalStream strm(binData.getDataStream(), binData.size(), true);
+  CPPUNIT_ASSERT_EQUAL(55ul, strm.getSize());
+
+  VSDInternalStream limitedStrm(binData.getDataStream(), binData.size(), true, 10);
+  CPPUNIT_ASSERT_EQUAL(10ul, limitedStrm.getSize());
+  unsigned long readBytes = 0;
+  const unsigned char *s = limitedStrm.read(10, readBytes);
+  CPPUNIT_ASSERT_EQUAL(10ul, readBytes);
+  CPPUNIT_ASSERT(std::all_of(s, s + readBytes, [](unsigned char c)
+  {
+    return c == 'a';
+  }));
+
+  VSDInternalStream uncompressedStrm(binData.getDataStream(), binData.size(), false, 4);
+  CPPUNIT_ASSERT_EQUAL(4ul, uncompressedStrm.getSize());
+}
+
 CPPUNIT_TEST_SUITE_REGISTRATION(VSDInternalStreamTest);
 
 }
@@ -0,0 +1,160 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <cstring>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <librevenge/librevenge.h>
+
+#include "VSDMasterCache.h"
+
+namespace test
+{
+
+using libvisio::VSDMasterCache;
+using libvisio::VSDMasterCacheKey;
+using libvisio::VSDShape;
+using libvisio::VSDStencil;
+
+namespace
+{
+
+librevenge::RVNGBinaryData makeContent(const char *xml)
+{
+  return librevenge::RVNGBinaryData(reinterpret_cast<const unsigned char *>(xml), std::strlen(xml));
+}
+
+VSDStencil makeStencil(unsigned shapeId)
+{
+  VSDShape shape;
+  shape.m_shapeId = shapeId;
+  VSDStencil stencil;
+  stencil.setFirstShape(shapeId);
+  stencil.addStencilShape(shapeId, shape);
+  return stencil;
+}
+
+VSDMasterCacheKey makeKey(const char *masterId)
+{
+  VSDMasterCacheKey key;
+  key.masterId = masterId;
+  key.level = 2;
+  return key;
+}
+
+}
+
+class VSDMasterCacheTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp();
+  virtual void tearDown();
+
+private:
+  CPPUNIT_TEST_SUITE(VSDMasterCacheTest);
+  CPPUNIT_TEST(testFind);
+  CPPUNIT_TEST(testDifferentContent);
+  CPPUNIT_TEST(testDifferentKey);
+  CPPUNIT_TEST(testEviction);
+  CPPUNIT_TEST(testAddStencilShapes);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testFind();
+  void testDifferentContent();
+  void testDifferentKey();
+  void testEviction();
+  void testAddStencilShapes();
+};
+
+void VSDMasterCacheTest::setUp()
+{
+}
+
+void VSDMasterCacheTest::tearDown()
+{
+}
+
+void VSDMasterCacheTest::testFind()
+{
+  VSDMasterCache cache(1024);
+  VSDStencil stencil;
+  CPPUNIT_ASSERT(!cache.find(makeKey("a"), makeContent("<MasterContents/>"), stencil));
+
+  cache.insert(makeKey("a"), makeContent("<MasterContents/>"), makeStencil(5));
+  CPPUNIT_ASSERT(cache.find(makeKey("a"), makeContent("<MasterContents/>"), stencil));
+  CPPUNIT_ASSERT_EQUAL(5u, stencil.m_firstShapeId);
+  CPPUNIT_ASSERT(stencil.getStencilShape(5));
+
+  cache.clear();
+  CPPUNIT_ASSERT(!cache.find(makeKey("a"), makeContent("<MasterContents/>"), stencil));
+}
+
+void VSDMasterCacheTest::testDifferentContent()
+{
+  VSDMasterCache cache(1024);
+  cache.insert(makeKey("a"), makeContent("<MasterContents/>"), makeStencil(5));
+  VSDStencil stencil;
+  CPPUNIT_ASSERT(!cache.find(makeKey("a"), makeContent("<MasterContents />"), stencil));
+  CPPUNIT_ASSERT(stencil.m_shapes.empty());
+}
+
+void VSDMasterCacheTest::testDifferentKey()
+{
+  VSDMasterCache cache(1024);
+  cache.insert(makeKey("a"), makeContent("<MasterContents/>"), makeStencil(5));
+  VSDStencil stencil;
+  CPPUNIT_ASSERT(!cache.find(makeKey("b"), makeContent("<MasterContents/>"), stencil));
+  VSDMasterCacheKey key = makeKey("a");
+  key.isTextOnly = true;
+  CPPUNIT_ASSERT(!cache.find(key, makeContent("<MasterContents/>"), stencil));
+  key = makeKey("a");
+  key.level = 3;
+  CPPUNIT_ASSERT(!cache.find(key, makeContent("<MasterContents/>"), stencil));
+}
+
+void VSDMasterCacheTest::testEviction()
+{
+  // room for two of the 17 bytes long parts
+  VSDMasterCache cache(40);
+  cache.insert(makeKey("a"), makeContent("<MasterContents/>"), makeStencil(1));
+  cache.insert(makeKey("b"), makeContent("<MasterContents/>"), makeStencil(2));
+  VSDStencil stencil;
+  // a becomes the most recently used
+  CPPUNIT_ASSERT(cache.find(makeKey("a"), makeContent("<MasterContents/>"), stencil));
+  cache.insert(makeKey("c"), makeContent("<MasterContents/>"), makeStencil(3));
+  CPPUNIT_ASSERT(cache.find(makeKey("a"), makeContent("<MasterContents/>"), stencil));
+  CPPUNIT_ASSERT(!cache.find(makeKey("b"), makeContent("<MasterContents/>"), stencil));
+  CPPUNIT_ASSERT(cache.find(makeKey("c"), makeContent("<MasterContents/>"), stencil));
+
+  // too big to be cached at all
+  VSDMasterCache small(16);
+  small.insert(makeKey("a"), makeContent("<MasterContents/>"), makeStencil(1));
+  CPPUNIT_ASSERT(!small.find(makeKey("a"), makeContent("<MasterContents/>"), stencil));
+}
+
+void VSDMasterCacheTest::testAddStencilShapes()
+{
+  VSDStencil stencil;
+  stencil.addStencilShapes(VSDStencil());
+  CPPUNIT_ASSERT_EQUAL(MINUS_ONE, stencil.m_firstShapeId);
+
+  stencil.addStencilShapes(makeStencil(7));
+  stencil.addStencilShapes(makeStencil(8));
+  CPPUNIT_ASSERT_EQUAL(7u, stencil.m_firstShapeId);
+  CPPUNIT_ASSERT_EQUAL(size_t(2), stencil.m_shapes.size());
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(VSDMasterCacheTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,201 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "VSDNURBS.h"
+
+namespace test
+{
+
+using libvisio::NURBSEvaluator;
+using libvisio::NURBSSegment;
+using libvisio::VSDParseLimits;
+
+namespace
+{
+
+typedef std::pair<double, double> Point;
+
+// A quarter of the unit circle, as a rational quadratic curve
+struct QuarterCircle
+{
+  QuarterCircle()
+    : controlPoints(), knotVector(), weights()
+  {
+    controlPoints.push_back(Point(1.0, 0.0));
+    controlPoints.push_back(Point(1.0, 1.0));
+    controlPoints.push_back(Point(0.0, 1.0));
+    knotVector.assign(3, 0.0);
+    knotVector.resize(6, 1.0);
+    weights.push_back(1.0);
+    weights.push_back(std::sqrt(0.5));
+    weights.push_back(1.0);
+  }
+
+  std::vector<Point> controlPoints;
+  std::vector<double> knotVector;
+  std::vector<double> weights;
+};
+
+std::vector<NURBSSegment> tessellate(const QuarterCircle &curve, double tolerance, const VSDParseLimits &limits = VSDParseLimits())
+{
+  std::vector<NURBSSegment> segments;
+  libvisio::tessellateNURBS(2, curve.controlPoints, curve.knotVector, curve.weights, tolerance, limits, segments);
+  return segments;
+}
+
+}
+
+class VSDNURBSTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp();
+  virtual void tearDown();
+
+private:
+  CPPUNIT_TEST_SUITE(VSDNURBSTest);
+  CPPUNIT_TEST(testFindSpan);
+  CPPUNIT_TEST(testBasis);
+  CPPUNIT_TEST(testEvaluate);
+  CPPUNIT_TEST(testTessellate);
+  CPPUNIT_TEST(testTessellateLimit);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testFindSpan();
+  void testBasis();
+  void testEvaluate();
+  void testTessellate();
+  void testTessellateLimit();
+};
+
+void VSDNURBSTest::setUp()
+{
+}
+
+void VSDNURBSTest::tearDown()
+{
+}
+
+void VSDNURBSTest::testFindSpan()
+{
+  // Cubic curve with 6 control points; the knot at 0.5 is double
+  const double knots[] = { 0.0, 0.0, 0.0, 0.0, 0.5, 0.5, 1.0, 1.0, 1.0, 1.0 };
+  const std::vector<double> knotVector(knots, knots + 10);
+  CPPUNIT_ASSERT_EQUAL(3u, libvisio::findNURBSSpan(5, 3, 0.0, knotVector));
+  CPPUNIT_ASSERT_EQUAL(3u, libvisio::findNURBSSpan(5, 3, 0.25, knotVector));
+  // The empty span [0.5, 0.5) is skipped
+  CPPUNIT_ASSERT_EQUAL(5u, libvisio::findNURBSSpan(5, 3, 0.5, knotVector));
+  CPPUNIT_ASSERT_EQUAL(5u, libvisio::findNURBSSpan(5, 3, 0.75, knotVector));
+  // The end of the domain belongs to the last span
+  CPPUNIT_ASSERT_EQUAL(5u, libvisio::findNURBSSpan(5, 3, 1.0, knotVector));
+}
+
+void VSDNURBSTest::testBasis()
+{
+  const double knots[] = { 0.0, 0.0, 0.0, 0.0, 0.3, 0.5, 0.5, 1.0, 1.0, 1.0, 1.0 };
+  const std::vector<double> knotVector(knots, knots + 11);
+  std::vector<double> basis(4);
+  std::vector<double> left(4);
+  std::vector<double> right(4);
+  for (unsigned i = 0; i <= 20; ++i)
+  {
+    const double u = i / 20.0;
+    const unsigned span = libvisio::findNURBSSpan(6, 3, u, knotVector);
+    libvisio::computeNURBSBasis(span, 3, u, knotVector, basis, left, right);
+    double sum = 0.0;
+    for (double value : basis)
+    {
+      CPPUNIT_ASSERT(value >= -1e-12);
+      sum += value;
+    }
+    // Partition of unity
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, sum, 1e-12);
+  }
+
+  // The curve interpolates its end points
+  libvisio::computeNURBSBasis(3, 3, 0.0, knotVector, basis, left, right);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, basis[0], 1e-12);
+}
+
+void VSDNURBSTest::testEvaluate()
+{
+  const QuarterCircle curve;
+  NURBSEvaluator evaluator(2, curve.controlPoints, curve.knotVector, curve.weights);
+  for (unsigned i = 0; i <= 10; ++i)
+  {
+    const Point point = evaluator.evaluate(i / 10.0);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, std::hypot(point.first, point.second), 1e-12);
+  }
+  const Point end = evaluator.evaluate(1.0);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, end.first, 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, end.second, 1e-12);
+}
+
+void VSDNURBSTest::testTessellate()
+{
+  const QuarterCircle curve;
+  const double tolerances[] = { 0.01, 0.001, 0.0001 };
+  size_t previousCount = 0;
+  for (double tolerance : tolerances)
+  {
+    const std::vector<NURBSSegment> segments = tessellate(curve, tolerance);
+    CPPUNIT_ASSERT(segments.size() > previousCount);
+    previousCount = segments.size();
+
+    Point start = curve.controlPoints.front();
+    for (const NURBSSegment &segment : segments)
+    {
+      CPPUNIT_ASSERT_EQUAL(1u, segment.degree);
+      const Point &end = segment.points[0];
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, std::hypot(end.first, end.second), 1e-12);
+      // The middle of a chord of the unit circle is the farthest point from the arc
+      const double middle = std::hypot((start.first + end.first) / 2.0, (start.second + end.second) / 2.0);
+      CPPUNIT_ASSERT(1.0 - middle <= tolerance);
+      start = end;
+    }
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, start.first, 1e-12);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, start.second, 1e-12);
+  }
+}
+
+void VSDNURBSTest::testTessellateLimit()
+{
+  // Every knot span is tessellated until the path is full
+  QuarterCircle curve;
+  curve.controlPoints.push_back(Point(-1.0, 1.0));
+  curve.controlPoints.push_back(Point(-1.0, 0.0));
+  curve.weights.push_back(std::sqrt(0.5));
+  curve.weights.push_back(1.0);
+  const double knots[] = { 0.0, 0.0, 0.0, 0.5, 0.5, 1.0, 1.0, 1.0 };
+  curve.knotVector.assign(knots, knots + 8);
+
+  const std::vector<NURBSSegment> all = tessellate(curve, 0.001);
+  const Point &end = all.back().points[0];
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(-1.0, end.first, 1e-12);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, end.second, 1e-12);
+
+  libvisio::VisioParseOptions options;
+  options.maxPathPoints = 1;
+  const std::vector<NURBSSegment> limited = tessellate(curve, 0.001, VSDParseLimits(options));
+  CPPUNIT_ASSERT(!limited.empty());
+  CPPUNIT_ASSERT(limited.size() < all.size());
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(VSDNURBSTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,159 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <memory>
+#include <string>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <librevenge/librevenge.h>
+
+#include "VSDOutputElementList.h"
+
+namespace test
+{
+
+using libvisio::VSDOutputElementArena;
+using libvisio::VSDOutputElementList;
+
+class VSDOutputElementListTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp();
+  virtual void tearDown();
+
+private:
+  CPPUNIT_TEST_SUITE(VSDOutputElementListTest);
+  CPPUNIT_TEST(testInternEqual);
+  CPPUNIT_TEST(testInternDifferent);
+  CPPUNIT_TEST(testInternChild);
+  CPPUNIT_TEST(testInternText);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testInternEqual();
+  void testInternDifferent();
+  void testInternChild();
+  void testInternText();
+};
+
+void VSDOutputElementListTest::setUp()
+{
+}
+
+void VSDOutputElementListTest::tearDown()
+{
+}
+
+void VSDOutputElementListTest::testInternEqual()
+{
+  VSDOutputElementArena arena;
+  librevenge::RVNGPropertyList style;
+  style.insert("draw:fill", "solid");
+  style.insert("draw:fill-color", "#ff0000");
+  style.insert("svg:stroke-width", 0.01);
+
+  const librevenge::RVNGPropertyList *const interned = arena.intern(style);
+  CPPUNIT_ASSERT(interned);
+  CPPUNIT_ASSERT(interned != &style);
+  CPPUNIT_ASSERT_EQUAL(interned, arena.intern(librevenge::RVNGPropertyList(style)));
+  CPPUNIT_ASSERT_EQUAL(std::string("#ff0000"), std::string((*interned)["draw:fill-color"]->getStr().cstr()));
+
+  // changing the original does not change the interned copy
+  style.insert("draw:fill-color", "#00ff00");
+  CPPUNIT_ASSERT(interned != arena.intern(style));
+  CPPUNIT_ASSERT_EQUAL(std::string("#ff0000"), std::string((*interned)["draw:fill-color"]->getStr().cstr()));
+
+  CPPUNIT_ASSERT_EQUAL(arena.intern(librevenge::RVNGPropertyList()), arena.intern(librevenge::RVNGPropertyList()));
+}
+
+void VSDOutputElementListTest::testInternDifferent()
+{
+  VSDOutputElementArena arena;
+  librevenge::RVNGPropertyList style;
+  style.insert("svg:stroke-width", 0.0100001);
+  librevenge::RVNGPropertyList other;
+  other.insert("svg:stroke-width", 0.0100002);
+  CPPUNIT_ASSERT(arena.intern(style) != arena.intern(other));
+
+  librevenge::RVNGPropertyList inches;
+  inches.insert("svg:stroke-width", 0.5);
+  librevenge::RVNGPropertyList percents;
+  percents.insert("svg:stroke-width", 0.5, librevenge::RVNG_PERCENT);
+  CPPUNIT_ASSERT(arena.intern(inches) != arena.intern(percents));
+
+  // numbers without a unit are not confused with each other or with strings
+  librevenge::RVNGPropertyList one;
+  one.insert("draw:angle", 1);
+  librevenge::RVNGPropertyList two;
+  two.insert("draw:angle", 2);
+  librevenge::RVNGPropertyList text;
+  text.insert("draw:angle", "1");
+  CPPUNIT_ASSERT(arena.intern(one) != arena.intern(two));
+  CPPUNIT_ASSERT(arena.intern(one) != arena.intern(text));
+  CPPUNIT_ASSERT_EQUAL(arena.intern(one), arena.intern(librevenge::RVNGPropertyList(one)));
+
+  // the separation of keys and values is kept
+  librevenge::RVNGPropertyList first;
+  first.insert("a", "bc");
+  librevenge::RVNGPropertyList second;
+  second.insert("ab", "c");
+  CPPUNIT_ASSERT(arena.intern(first) != arena.intern(second));
+}
+
+void VSDOutputElementListTest::testInternChild()
+{
+  VSDOutputElementArena arena;
+  librevenge::RVNGPropertyList stop;
+  stop.insert("svg:offset", 0.5, librevenge::RVNG_PERCENT);
+  librevenge::RVNGPropertyListVector stops;
+  stops.append(stop);
+  librevenge::RVNGPropertyList style;
+  style.insert("draw:fill", "gradient");
+  style.insert("svg:linearGradient", stops);
+
+  const librevenge::RVNGPropertyList *const stored = arena.intern(style);
+  CPPUNIT_ASSERT(stored);
+  CPPUNIT_ASSERT(stored != arena.intern(style));
+  CPPUNIT_ASSERT(stored->child("svg:linearGradient"));
+}
+
+void VSDOutputElementListTest::testInternText()
+{
+  const std::shared_ptr<VSDOutputElementArena> arena = std::make_shared<VSDOutputElementArena>();
+  VSDOutputElementList elements(arena);
+  librevenge::RVNGPropertyList paragraph;
+  paragraph.insert("fo:text-align", "center");
+  librevenge::RVNGPropertyList span;
+  span.insert("style:font-name", "Arial");
+  span.insert("fo:font-size", 12.0, librevenge::RVNG_POINT);
+
+  for (unsigned i = 0; i < 3; ++i)
+  {
+    elements.addOpenParagraph(paragraph);
+    elements.addOpenSpan(span);
+    elements.addInsertText("text");
+    elements.addCloseSpan();
+    elements.addOpenSpan(librevenge::RVNGPropertyList(span));
+    elements.addCloseSpan();
+    elements.addCloseParagraph();
+  }
+  CPPUNIT_ASSERT_EQUAL(size_t(2), arena->propListCount());
+
+  span.insert("fo:font-weight", "bold");
+  elements.addOpenSpan(span);
+  CPPUNIT_ASSERT_EQUAL(size_t(3), arena->propListCount());
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(VSDOutputElementListTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,160 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <list>
+#include <map>
+#include <vector>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "VSDStylesCollector.h"
+
+namespace test
+{
+
+using libvisio::VSDStylesCollector;
+using libvisio::XForm;
+
+namespace
+{
+
+/* Drives a styles collector through one page whose top-level shapes are
+ * pageShapes, and whose groups have the members given by groups.
+ */
+std::list<unsigned> flattenPage(const std::vector<unsigned> &pageShapes,
+                                const std::vector<std::pair<unsigned, std::vector<unsigned> > > &groups)
+{
+  std::vector<std::map<unsigned, XForm> > groupXFormsSequence;
+  std::vector<std::map<unsigned, unsigned> > groupMembershipsSequence;
+  std::vector<std::list<unsigned> > documentPageShapeOrders;
+  VSDStylesCollector collector(groupXFormsSequence, groupMembershipsSequence, documentPageShapeOrders);
+
+  collector.startPage(0);
+  collector.collectShapesOrder(0, 1, pageShapes);
+  for (const auto &group : groups)
+  {
+    collector.collectShape(group.first, 2, 0, MINUS_ONE, MINUS_ONE, MINUS_ONE, MINUS_ONE, MINUS_ONE);
+    collector.collectShapesOrder(group.first, 3, group.second);
+  }
+  collector.endPage();
+
+  CPPUNIT_ASSERT_EQUAL(size_t(1), documentPageShapeOrders.size());
+  return documentPageShapeOrders.front();
+}
+
+std::vector<unsigned> toVector(const std::list<unsigned> &shapes)
+{
+  return std::vector<unsigned>(shapes.begin(), shapes.end());
+}
+
+}
+
+class VSDStylesCollectorTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp();
+  virtual void tearDown();
+
+private:
+  CPPUNIT_TEST_SUITE(VSDStylesCollectorTest);
+  CPPUNIT_TEST(testFlattenGroups);
+  CPPUNIT_TEST(testFlattenCycle);
+  CPPUNIT_TEST(testFlattenDeepNesting);
+  CPPUNIT_TEST(testFlattenManyGroups);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testFlattenGroups();
+  void testFlattenCycle();
+  void testFlattenDeepNesting();
+  void testFlattenManyGroups();
+};
+
+void VSDStylesCollectorTest::setUp()
+{
+}
+
+void VSDStylesCollectorTest::tearDown()
+{
+}
+
+void VSDStylesCollectorTest::testFlattenGroups()
+{
+  std::vector<std::pair<unsigned, std::vector<unsigned> > > groups;
+  groups.push_back(std::make_pair(1u, std::vector<unsigned>({2, 3})));
+  groups.push_back(std::make_pair(3u, std::vector<unsigned>({4})));
+  groups.push_back(std::make_pair(5u, std::vector<unsigned>({6, 7})));
+
+  const std::vector<unsigned> expected({1, 2, 3, 4, 5, 6, 7, 8});
+  CPPUNIT_ASSERT(expected == toVector(flattenPage(std::vector<unsigned>({1, 5, 8}), groups)));
+}
+
+void VSDStylesCollectorTest::testFlattenCycle()
+{
+  std::vector<std::pair<unsigned, std::vector<unsigned> > > groups;
+  groups.push_back(std::make_pair(1u, std::vector<unsigned>({2})));
+  groups.push_back(std::make_pair(2u, std::vector<unsigned>({1})));
+
+  const std::vector<unsigned> expected({1, 2, 1});
+  CPPUNIT_ASSERT(expected == toVector(flattenPage(std::vector<unsigned>({1}), groups)));
+}
+
+void VSDStylesCollectorTest::testFlattenDeepNesting()
+{
+  // a chain of 20000 groups, each one containing the next one
+  const unsigned depth = 20000;
+  std::vector<std::pair<unsigned, std::vector<unsigned> > > groups;
+  for (unsigned i = 1; i < depth; ++i)
+    groups.push_back(std::make_pair(i, std::vector<unsigned>(1, i + 1)));
+
+  const std::list<unsigned> shapes = flattenPage(std::vector<unsigned>(1, 1), groups);
+  CPPUNIT_ASSERT_EQUAL(size_t(depth), shapes.size());
+  unsigned expected = 1;
+  for (unsigned shape : shapes)
+    CPPUNIT_ASSERT_EQUAL(expected++, shape);
+}
+
+void VSDStylesCollectorTest::testFlattenManyGroups()
+{
+  // 1000 top-level groups of 10 shapes each, every shape being a group of 2 more
+  std::vector<unsigned> pageShapes;
+  std::vector<std::pair<unsigned, std::vector<unsigned> > > groups;
+  unsigned nextId = 1;
+  std::vector<unsigned> expected;
+  for (unsigned i = 0; i < 1000; ++i)
+  {
+    const unsigned groupId = nextId++;
+    pageShapes.push_back(groupId);
+    expected.push_back(groupId);
+    std::vector<unsigned> members;
+    for (unsigned j = 0; j < 10; ++j)
+    {
+      const unsigned memberId = nextId++;
+      members.push_back(memberId);
+      expected.push_back(memberId);
+      std::vector<unsigned> subMembers;
+      for (unsigned k = 0; k < 2; ++k)
+      {
+        subMembers.push_back(nextId);
+        expected.push_back(nextId++);
+      }
+      groups.push_back(std::make_pair(memberId, subMembers));
+    }
+    groups.push_back(std::make_pair(groupId, members));
+  }
+
+  CPPUNIT_ASSERT(expected == toVector(flattenPage(pageShapes, groups)));
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(VSDStylesCollectorTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,159 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "VSDStyles.h"
+
+namespace test
+{
+
+using libvisio::Colour;
+using libvisio::VSDOptionalCharStyle;
+using libvisio::VSDOptionalLineStyle;
+using libvisio::VSDOptionalParaStyle;
+using libvisio::VSDCharStyle;
+using libvisio::VSDName;
+using libvisio::VSDParaStyle;
+
+class VSDStylesTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp();
+  virtual void tearDown();
+
+private:
+  CPPUNIT_TEST_SUITE(VSDStylesTest);
+  CPPUNIT_TEST(testEmpty);
+  CPPUNIT_TEST(testSet);
+  CPPUNIT_TEST(testOverride);
+  CPPUNIT_TEST(testParaStyleDefaults);
+  CPPUNIT_TEST(testOrdering);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testEmpty();
+  void testSet();
+  void testOverride();
+  void testParaStyleDefaults();
+  void testOrdering();
+};
+
+void VSDStylesTest::setUp()
+{
+}
+
+void VSDStylesTest::tearDown()
+{
+}
+
+void VSDStylesTest::testEmpty()
+{
+  const VSDOptionalLineStyle style;
+  CPPUNIT_ASSERT(!style.width());
+  CPPUNIT_ASSERT(!style.colour());
+  CPPUNIT_ASSERT(!style.pattern());
+  CPPUNIT_ASSERT(!style.qsLineMatrix());
+
+  const VSDOptionalLineStyle fromNone(boost::none, boost::none, boost::none, boost::none, boost::none,
+                                      boost::none, boost::none, boost::none, boost::none);
+  CPPUNIT_ASSERT(!fromNone.width());
+  CPPUNIT_ASSERT(!fromNone.cap());
+}
+
+void VSDStylesTest::testSet()
+{
+  VSDOptionalLineStyle style(0.5, boost::none, (unsigned char)2, boost::none, boost::none,
+                             boost::none, boost::none, -1L, boost::none);
+  CPPUNIT_ASSERT(bool(style.width()));
+  CPPUNIT_ASSERT_EQUAL(0.5, style.width().get());
+  CPPUNIT_ASSERT(!style.colour());
+  CPPUNIT_ASSERT_EQUAL((unsigned char)2, style.pattern().get());
+  CPPUNIT_ASSERT_EQUAL(-1L, style.qsLineColour().get());
+  CPPUNIT_ASSERT(!style.qsLineMatrix());
+
+  style.colour(Colour(1, 2, 3, 4));
+  CPPUNIT_ASSERT(Colour(1, 2, 3, 4) == style.colour().get());
+
+  // an empty optional leaves the field as it is
+  style.width(boost::optional<double>());
+  CPPUNIT_ASSERT_EQUAL(0.5, style.width().get());
+  style.width(boost::optional<double>(0.25));
+  CPPUNIT_ASSERT_EQUAL(0.25, style.width().get());
+}
+
+void VSDStylesTest::testOverride()
+{
+  VSDOptionalCharStyle style(3, boost::none, Colour(1, 1, 1, 0), 12.0, true, boost::none, false,
+                             boost::none, boost::none, boost::none, boost::none, boost::none,
+                             boost::none, boost::none, boost::none, boost::none);
+  const VSDOptionalCharStyle other(7, boost::none, boost::none, 10.0, boost::none, true, true,
+                                   boost::none, boost::none, boost::none, boost::none, boost::none,
+                                   boost::none, boost::none, boost::none, 0.5);
+  style.override(other);
+
+  CPPUNIT_ASSERT_EQUAL(3u, style.charCount);
+  CPPUNIT_ASSERT(!style.font());
+  CPPUNIT_ASSERT(Colour(1, 1, 1, 0) == style.colour().get());
+  CPPUNIT_ASSERT_EQUAL(10.0, style.size().get());
+  CPPUNIT_ASSERT_EQUAL(true, style.bold().get());
+  CPPUNIT_ASSERT_EQUAL(true, style.italic().get());
+  CPPUNIT_ASSERT_EQUAL(true, style.underline().get());
+  CPPUNIT_ASSERT(!style.strikeout());
+  CPPUNIT_ASSERT_EQUAL(0.5, style.scaleWidth().get());
+
+  // overriding by an empty style changes nothing
+  style.override(VSDOptionalCharStyle());
+  CPPUNIT_ASSERT_EQUAL(10.0, style.size().get());
+  CPPUNIT_ASSERT(!style.subscript());
+}
+
+void VSDStylesTest::testParaStyleDefaults()
+{
+  const VSDOptionalParaStyle style;
+  CPPUNIT_ASSERT_EQUAL(0.0, style.bulletFontSize().get());
+  CPPUNIT_ASSERT_EQUAL(0.0, style.textPosAfterBullet().get());
+  CPPUNIT_ASSERT(!style.indFirst());
+  CPPUNIT_ASSERT(!style.bulletStr());
+}
+
+void VSDStylesTest::testOrdering()
+{
+  const unsigned char arial[] = "Arial";
+  const unsigned char arimo[] = "Arimo";
+  const VSDName arialName(librevenge::RVNGBinaryData(arial, 5), libvisio::VSD_TEXT_ANSI);
+  const VSDName arimoName(librevenge::RVNGBinaryData(arimo, 5), libvisio::VSD_TEXT_ANSI);
+  CPPUNIT_ASSERT(arialName < arimoName);
+  CPPUNIT_ASSERT(!(arimoName < arialName));
+  CPPUNIT_ASSERT(!(arialName < VSDName(arialName)));
+  CPPUNIT_ASSERT(VSDName() < arialName);
+
+  VSDCharStyle style;
+  style.font = arialName;
+  VSDCharStyle same(style);
+  CPPUNIT_ASSERT(!(style < same) && !(same < style));
+  same.font = arimoName;
+  CPPUNIT_ASSERT(style < same);
+  same.font = arialName;
+  same.bold = true;
+  CPPUNIT_ASSERT(style < same || same < style);
+
+  VSDParaStyle para;
+  VSDParaStyle otherPara(para);
+  CPPUNIT_ASSERT(!(para < otherPara) && !(otherPara < para));
+  otherPara.indLeft = 0.5;
+  CPPUNIT_ASSERT(para < otherPara);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(VSDStylesTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,721 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef HAVE_SYS_RESOURCE_H
+#include <sys/resource.h>
+#endif
+
+#include <librevenge-generators/RVNGDummyDrawingGenerator.h>
+#include <librevenge-stream/librevenge-stream.h>
+#include <librevenge/librevenge.h>
+#include <libvisio/libvisio.h>
+
+#include "VSDCharacterList.h"
+#include "VSDContentCollector.h"
+#include "VSDGeometryList.h"
+#include "VSDInternalStream.h"
+#include "VSDParagraphList.h"
+#include "VSDStencils.h"
+#include "VSDStyles.h"
+#include "libvisio_xml.h"
+
+#include "documentgenerator.h"
+
+#ifndef TDOC
+#define TDOC "data"
+#endif
+
+namespace
+{
+
+// all allocations of the program so far, counted by operator new below
+std::atomic<unsigned long> g_allocations(0);
+
+} // anonymous namespace
+
+void *operator new(size_t size)
+{
+  ++g_allocations;
+  if (void *const p = malloc(size ? size : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+  free(p);
+}
+
+namespace
+{
+
+typedef std::chrono::steady_clock Clock;
+
+/* The state of one run of a benchmark, in the manner of Google Benchmark:
+ * only the loop driven by keepRunning() is timed.
+ */
+class BenchmarkState
+{
+public:
+  explicit BenchmarkState(unsigned long iterations)
+    : m_iterations(iterations), m_done(0), m_start(), m_elapsed(0.0),
+      m_allocations(0), m_bytes(0.0), m_items(0.0), m_error() {}
+
+  bool keepRunning()
+  {
+    if (!m_done)
+    {
+      m_allocations = g_allocations;
+      m_start = Clock::now();
+    }
+    if (m_done < m_iterations && m_error.empty())
+    {
+      ++m_done;
+      return true;
+    }
+    m_elapsed = std::chrono::duration<double>(Clock::now() - m_start).count();
+    m_allocations = g_allocations - m_allocations;
+    return false;
+  }
+  unsigned long iterations() const
+  {
+    return m_iterations;
+  }
+  double elapsed() const
+  {
+    return m_elapsed;
+  }
+  unsigned long allocations() const
+  {
+    return m_allocations;
+  }
+  void setBytesProcessed(double bytes)
+  {
+    m_bytes = bytes;
+  }
+  double bytesProcessed() const
+  {
+    return m_bytes;
+  }
+  void setItemsProcessed(double items)
+  {
+    m_items = items;
+  }
+  double itemsProcessed() const
+  {
+    return m_items;
+  }
+  void skipWithError(const std::string &error)
+  {
+    m_error = error;
+  }
+  const std::string &error() const
+  {
+    return m_error;
+  }
+
+private:
+  const unsigned long m_iterations;
+  unsigned long m_done;
+  Clock::time_point m_start;
+  double m_elapsed;
+  unsigned long m_allocations;
+  double m_bytes;
+  double m_items;
+  std::string m_error;
+};
+
+typedef std::function<void(BenchmarkState &)> BenchmarkFunction;
+
+struct Benchmark
+{
+  Benchmark(const std::string &n, const BenchmarkFunction &f)
+    : name(n), function(f) {}
+  std::string name;
+  BenchmarkFunction function;
+};
+
+struct BenchmarkResult
+{
+  BenchmarkResult()
+    : name(), iterations(0), nsPerIteration(0.0), bytesPerSecond(0.0),
+      itemsPerSecond(0.0), allocationsPerItem(0.0), peakRSS(0), error() {}
+  std::string name;
+  unsigned long iterations;
+  double nsPerIteration;
+  double bytesPerSecond;
+  double itemsPerSecond;
+  // per iteration for benchmarks without items
+  double allocationsPerItem;
+  long peakRSS;
+  std::string error;
+};
+
+// keeps the compiler from optimizing benchmarked computations away
+volatile double g_sink = 0.0;
+
+// in KiB, or -1 where it cannot be determined
+long getPeakRSS()
+{
+#ifdef HAVE_SYS_RESOURCE_H
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage))
+    return -1;
+#ifdef __APPLE__
+  return long(usage.ru_maxrss / 1024);
+#else
+  return long(usage.ru_maxrss);
+#endif
+#else
+  return -1;
+#endif
+}
+
+/* Repeats a benchmark with more and more iterations until one run takes
+ * at least minTime seconds.
+ */
+BenchmarkResult runBenchmark(const Benchmark &benchmark, double minTime)
+{
+  BenchmarkResult result;
+  result.name = benchmark.name;
+
+  unsigned long iterations = 1;
+  while (true)
+  {
+    BenchmarkState state(iterations);
+    benchmark.function(state);
+    if (!state.error().empty())
+    {
+      result.error = state.error();
+      break;
+    }
+    const double elapsed = state.elapsed();
+    if (elapsed >= minTime || iterations >= 1000000000)
+    {
+      result.iterations = iterations;
+      result.nsPerIteration = 1e9 * elapsed / double(iterations);
+      if (elapsed > 0.0)
+      {
+        result.bytesPerSecond = state.bytesProcessed() / elapsed;
+        result.itemsPerSecond = state.itemsProcessed() / elapsed;
+      }
+      const double items = state.itemsProcessed() > 0.0 ? state.itemsProcessed() : double(iterations);
+      result.allocationsPerItem = double(state.allocations()) / items;
+      break;
+    }
+    // aim a bit beyond minTime, but grow by at most 100 times per round
+    double next = elapsed > 0.0 ? 1.4 * minTime * double(iterations) / elapsed : 100.0 * double(iterations);
+    if (next > 100.0 * double(iterations))
+      next = 100.0 * double(iterations);
+    iterations = next > double(iterations + 1) ? (unsigned long)next : iterations + 1;
+  }
+
+  result.peakRSS = getPeakRSS();
+  return result;
+}
+
+// Micro benchmarks
+
+/* Builds a stream in the LZ77 variant of compressed VSD streams, made of
+ * groups of four literals and four back references each.
+ */
+std::vector<unsigned char> makeCompressedData(unsigned long groups)
+{
+  std::vector<unsigned char> data;
+  data.reserve(groups * 13);
+  unsigned seed = 12345;
+  for (unsigned long i = 0; i < groups; ++i)
+  {
+    data.push_back(0x55);
+    for (unsigned j = 0; j < 4; ++j)
+    {
+      seed = seed * 1103515245 + 12345;
+      data.push_back((unsigned char)(seed >> 16));
+      data.push_back((unsigned char)(seed >> 8));
+      data.push_back((unsigned char)((seed >> 24) & 0xf0) | (unsigned char)(seed & 0x0f));
+    }
+  }
+  return data;
+}
+
+void benchmarkDecompression(BenchmarkState &state)
+{
+  const std::vector<unsigned char> data = makeCompressedData(64 * 1024);
+  librevenge::RVNGStringStream input(&data[0], (unsigned)data.size());
+  unsigned long decompressedSize = 0;
+  while (state.keepRunning())
+  {
+    input.seek(0, librevenge::RVNG_SEEK_SET);
+    VSDInternalStream stream(&input, data.size(), true);
+    stream.seek(0, librevenge::RVNG_SEEK_END);
+    decompressedSize = (unsigned long)stream.tell();
+  }
+  state.setBytesProcessed(double(state.iterations()) * double(decompressedSize));
+}
+
+const char *const DOUBLE_STRINGS[] =
+{
+  "0.7480314960629917", "6.535433070866141", "0.3149606299212601", "0.15748031496063",
+  "-0.1181102362204724", "11.69291338582677", "0.01041666666666667", "1", "0", "8.26771653543307"
+};
+
+const char *const LONG_STRINGS[] =
+{
+  "0", "1", "7", "33", "201", "205", "-1", "65535", "1024", "12"
+};
+
+const char *const COLOUR_STRINGS[] =
+{
+  "#547495", "#4d4d4d", "#feffff", "#507e32", "#000000", "#ffffff", "#c05046", "#96afcf", "#386389", "#bb8c00"
+};
+
+template<typename T, size_t N>
+size_t countOf(const T (&)[N])
+{
+  return N;
+}
+
+void benchmarkXmlStringToDouble(BenchmarkState &state)
+{
+  double sum = 0.0;
+  while (state.keepRunning())
+  {
+    for (const char *str : DOUBLE_STRINGS)
+      sum += libvisio::xmlStringToDouble(BAD_CAST(str));
+  }
+  g_sink = sum;
+  state.setItemsProcessed(double(state.iterations()) * double(countOf(DOUBLE_STRINGS)));
+}
+
+void benchmarkXmlStringToLong(BenchmarkState &state)
+{
+  long sum = 0;
+  while (state.keepRunning())
+  {
+    for (const char *str : LONG_STRINGS)
+      sum += libvisio::xmlStringToLong(BAD_CAST(str));
+  }
+  g_sink = double(sum);
+  state.setItemsProcessed(double(state.iterations()) * double(countOf(LONG_STRINGS)));
+}
+
+void benchmarkXmlStringToColour(BenchmarkState &state)
+{
+  unsigned sum = 0;
+  while (state.keepRunning())
+  {
+    for (const char *str : COLOUR_STRINGS)
+      sum += libvisio::xmlStringToColour(BAD_CAST(str)).r;
+  }
+  g_sink = double(sum);
+  state.setItemsProcessed(double(state.iterations()) * double(countOf(COLOUR_STRINGS)));
+}
+
+/* Resolves styles that inherit from chains of depth masters, each
+ * master setting some of the properties.
+ */
+void benchmarkStyleResolution(BenchmarkState &state, unsigned depth)
+{
+  const unsigned styleCount = 100;
+  libvisio::VSDStyles styles;
+  for (unsigned i = 0; i < styleCount; ++i)
+  {
+    libvisio::VSDOptionalLineStyle lineStyle;
+    libvisio::VSDOptionalFillStyle fillStyle;
+    libvisio::VSDOptionalCharStyle charStyle;
+    libvisio::VSDOptionalParaStyle paraStyle;
+    if (i % 2)
+    {
+      lineStyle.width(0.01 * i);
+      fillStyle.fgColour(libvisio::Colour((unsigned char)i, 0, 0, 0));
+      charStyle.size(12.0 / 72.0);
+    }
+    else
+    {
+      lineStyle.pattern((unsigned char)(i % 24));
+      fillStyle.pattern((unsigned char)1);
+      paraStyle.indFirst(0.1 * i);
+    }
+    styles.addLineStyle(i, lineStyle);
+    styles.addFillStyle(i, fillStyle);
+    styles.addCharStyle(i, charStyle);
+    styles.addParaStyle(i, paraStyle);
+    if (i % depth)
+    {
+      styles.addLineStyleMaster(i, i - 1);
+      styles.addFillStyleMaster(i, i - 1);
+      styles.addTextStyleMaster(i, i - 1);
+    }
+  }
+
+  double sum = 0.0;
+  while (state.keepRunning())
+  {
+    for (unsigned i = 0; i < styleCount; ++i)
+    {
+      const libvisio::VSDOptionalLineStyle lineStyle = styles.getOptionalLineStyle(i);
+      const libvisio::VSDFillStyle fillStyle = styles.getFillStyle(i, nullptr);
+      const libvisio::VSDOptionalCharStyle charStyle = styles.getOptionalCharStyle(i);
+      const libvisio::VSDOptionalParaStyle paraStyle = styles.getOptionalParaStyle(i);
+      sum += lineStyle.width().get_value_or(0.0) + fillStyle.pattern
+             + charStyle.size().get_value_or(0.0) + paraStyle.indFirst().get_value_or(0.0);
+    }
+  }
+  g_sink = sum;
+  state.setItemsProcessed(double(state.iterations()) * styleCount * 4.0);
+}
+
+/* Tessellates pages of NURBS curves through a content collector. Uniform
+ * weights take the Bezier conversion, others the adaptive subdivision.
+ */
+void benchmarkNURBS(BenchmarkState &state, bool rational)
+{
+  const unsigned curvesPerPage = 100;
+  const unsigned degree = 3;
+  std::vector<std::pair<double, double> > controlPoints;
+  for (unsigned i = 0; i < 8; ++i)
+    controlPoints.push_back(std::make_pair(0.5 * (i + 1), 2.0 * std::sin(double(i))));
+  const unsigned pointCount = unsigned(controlPoints.size()) + 2;
+  std::vector<double> knots;
+  for (unsigned i = 0; i < pointCount + degree + 1; ++i)
+  {
+    if (i <= degree)
+      knots.push_back(0.0);
+    else if (i >= pointCount)
+      knots.push_back(double(pointCount - degree));
+    else
+      knots.push_back(double(i - degree));
+  }
+  std::vector<double> weights;
+  for (unsigned i = 0; i < pointCount; ++i)
+    weights.push_back(rational ? 1.0 + (i % 2) : 1.0);
+
+  while (state.keepRunning())
+  {
+    librevenge::RVNGDummyDrawingGenerator painter;
+    std::vector<std::map<unsigned, libvisio::XForm> > groupXFormsSequence;
+    std::vector<std::map<unsigned, unsigned> > groupMembershipsSequence;
+    std::vector<std::list<unsigned> > documentPageShapeOrders;
+    libvisio::VSDStyles styles;
+    libvisio::VSDStencils stencils;
+    libvisio::VSDContentCollector collector(&painter, groupXFormsSequence, groupMembershipsSequence,
+                                            documentPageShapeOrders, styles, stencils);
+    collector.startPage(0);
+    for (unsigned i = 0; i < curvesPerPage; ++i)
+    {
+      collector.collectShape(i + 1, 1, 0, MINUS_ONE, MINUS_ONE, MINUS_ONE, MINUS_ONE, MINUS_ONE);
+      collector.collectGeometry(1, 2, false, false, false);
+      collector.collectMoveTo(2, 2, 0.0, 0.0);
+      collector.collectNURBSTo(3, 2, 5.0, 0.0, 1, 1, degree, controlPoints, knots, weights);
+    }
+    collector.endPage();
+    collector.endPages();
+  }
+  state.setItemsProcessed(double(state.iterations()) * curvesPerPage);
+}
+
+/* Fills the geometry, character and paragraph lists of shapes, then
+ * overrides a row in a copy, as for an instance of a master shape.
+ */
+void benchmarkShapeLists(BenchmarkState &state)
+{
+  const unsigned shapeCount = 100;
+  const std::vector<unsigned> order = { 0, 1, 2, 3, 4, 5 };
+  unsigned sum = 0;
+  while (state.keepRunning())
+  {
+    for (unsigned i = 0; i < shapeCount; ++i)
+    {
+      libvisio::VSDGeometryList geometry;
+      geometry.addGeometry(0, 1, false, false, false);
+      geometry.addMoveTo(1, 1, 0.0, 0.0);
+      geometry.addLineTo(2, 1, 1.0, 0.0);
+      geometry.addLineTo(3, 1, 1.0, 1.0);
+      geometry.addLineTo(4, 1, 0.0, 1.0);
+      geometry.addLineTo(5, 1, 0.0, 0.0);
+      geometry.setElementsOrder(order);
+      libvisio::VSDCharacterList characters;
+      characters.addCharIX(0, 1, libvisio::VSDOptionalCharStyle());
+      characters.addCharIX(1, 1, libvisio::VSDOptionalCharStyle());
+      libvisio::VSDParagraphList paragraphs;
+      paragraphs.addParaIX(0, 1, libvisio::VSDOptionalParaStyle());
+
+      libvisio::VSDGeometryList instance(geometry);
+      instance.addLineTo(3, 2, 2.0, 2.0);
+      for (unsigned j = 0; j < instance.count(); ++j)
+        sum += instance.getElement(j) ? 1 : 0;
+      sum += characters.getCharCount(1) + paragraphs.getLevel();
+    }
+  }
+  g_sink = double(sum);
+  state.setItemsProcessed(double(state.iterations()) * shapeCount);
+}
+
+// Macro benchmarks
+
+void benchmarkParse(BenchmarkState &state, const std::string &data, unsigned shapes)
+{
+  while (state.keepRunning())
+  {
+    librevenge::RVNGStringStream input(reinterpret_cast<const unsigned char *>(data.data()), (unsigned)data.size());
+    librevenge::RVNGDummyDrawingGenerator painter;
+    if (!libvisio::VisioDocument::parse(&input, &painter))
+      state.skipWithError("parsing failed");
+  }
+  state.setBytesProcessed(double(state.iterations()) * double(data.size()));
+  state.setItemsProcessed(double(state.iterations()) * shapes);
+}
+
+bool readFile(const std::string &path, std::string &data)
+{
+  FILE *file = fopen(path.c_str(), "rb");
+  if (!file)
+    return false;
+  char buffer[65536];
+  size_t read = 0;
+  while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    data.append(buffer, read);
+  fclose(file);
+  return !data.empty();
+}
+
+/* Synthetic documents are generated once, on the first run of their
+ * benchmark, and kept for the following ones.
+ */
+BenchmarkFunction makeSyntheticParseBenchmark(bool vsdx, const libvisio::DocumentGeneratorOptions &options)
+{
+  std::shared_ptr<std::string> data = std::make_shared<std::string>();
+  return [data, vsdx, options](BenchmarkState &state)
+  {
+    if (data->empty())
+    {
+      const libvisio::DocumentGenerator generator(options);
+      *data = vsdx ? generator.generateVSDX() : generator.generateVDX();
+    }
+    benchmarkParse(state, *data, options.pages * options.shapesPerPage);
+  };
+}
+
+BenchmarkFunction makeFileParseBenchmark(const std::string &path)
+{
+  std::shared_ptr<std::string> data = std::make_shared<std::string>();
+  return [data, path](BenchmarkState &state)
+  {
+    if (data->empty() && !readFile(path, *data))
+    {
+      state.skipWithError("cannot read " + path);
+      return;
+    }
+    benchmarkParse(state, *data, 0);
+  };
+}
+
+std::string formatSize(unsigned pages, unsigned shapesPerPage)
+{
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%ux%u", pages, shapesPerPage);
+  return buffer;
+}
+
+std::vector<Benchmark> getBenchmarks(unsigned scale)
+{
+  using namespace std::placeholders;
+
+  std::vector<Benchmark> benchmarks;
+  benchmarks.push_back(Benchmark("decompress", benchmarkDecompression));
+  benchmarks.push_back(Benchmark("xml/double", benchmarkXmlStringToDouble));
+  benchmarks.push_back(Benchmark("xml/long", benchmarkXmlStringToLong));
+  benchmarks.push_back(Benchmark("xml/colour", benchmarkXmlStringToColour));
+  benchmarks.push_back(Benchmark("styles/depth-1", std::bind(benchmarkStyleResolution, _1, 1)));
+  benchmarks.push_back(Benchmark("styles/depth-10", std::bind(benchmarkStyleResolution, _1, 10)));
+  benchmarks.push_back(Benchmark("nurbs/bezier", std::bind(benchmarkNURBS, _1, false)));
+  benchmarks.push_back(Benchmark("nurbs/rational", std::bind(benchmarkNURBS, _1, true)));
+  benchmarks.push_back(Benchmark("lists/shape", benchmarkShapeLists));
+
+  const std::pair<unsigned, unsigned> sizes[] =
+  {
+    std::make_pair(1u, 1000u), std::make_pair(10u, 1000u), std::make_pair(1u, 10000u)
+  };
+  for (const auto &size : sizes)
+  {
+    libvisio::DocumentGeneratorOptions options;
+    options.pages = size.first;
+    options.shapesPerPage = size.second * scale;
+    const std::string name = formatSize(options.pages, options.shapesPerPage);
+    benchmarks.push_back(Benchmark("parse/vdx/" + name, makeSyntheticParseBenchmark(false, options)));
+    benchmarks.push_back(Benchmark("parse/vsdx/" + name, makeSyntheticParseBenchmark(true, options)));
+  }
+
+  // one dimension of the document at a time grows, against parse/*/1x1000
+  libvisio::DocumentGeneratorOptions base;
+  base.shapesPerPage = 1000 * scale;
+  std::vector<std::pair<std::string, libvisio::DocumentGeneratorOptions> > variants(6, std::make_pair(std::string(), base));
+  variants[0].first = "groups-5";
+  variants[0].second.groupDepth = 5;
+  variants[1].first = "masters-10";
+  variants[1].second.masters = 10;
+  variants[2].first = "text-100";
+  variants[2].second.textLength = 100;
+  variants[3].first = "nurbs-20";
+  variants[3].second.nurbsPoints = 20;
+  variants[4].first = "polyline-50";
+  variants[4].second.polylinePoints = 50;
+  variants[5].first = "images-10";
+  variants[5].second.images = 10;
+  for (const auto &variant : variants)
+  {
+    const std::string name = formatSize(base.pages, base.shapesPerPage) + "/" + variant.first;
+    benchmarks.push_back(Benchmark("parse/vdx/" + name, makeSyntheticParseBenchmark(false, variant.second)));
+    benchmarks.push_back(Benchmark("parse/vsdx/" + name, makeSyntheticParseBenchmark(true, variant.second)));
+  }
+
+  // there is no writer for the binary format, so take the largest samples
+  const char *const vsdFiles[] = { "bitmaps.vsd", "dwg.vsd", "no-bgcolor.vsd", "Visio11FormatLine.vsd" };
+  for (const char *file : vsdFiles)
+    benchmarks.push_back(Benchmark(std::string("parse/vsd/") + file, makeFileParseBenchmark(std::string(TDOC "/") + file)));
+
+  return benchmarks;
+}
+
+/* Reads results written with --csv, for comparison with a new run.
+ */
+bool readBaseline(const char *path, std::map<std::string, double> &baseline)
+{
+  FILE *file = fopen(path, "r");
+  if (!file)
+    return false;
+  char line[1024];
+  while (fgets(line, sizeof(line), file))
+  {
+    const char *const comma = strchr(line, ',');
+    if (!comma || !strncmp(line, "name,", 5))
+      continue;
+    const char *const time = strchr(comma + 1, ',');
+    if (time)
+      baseline[std::string(line, size_t(comma - line))] = atof(time + 1);
+  }
+  fclose(file);
+  return true;
+}
+
+int printUsage()
+{
+  printf("`benchmark' measures the performance of libvisio.\n");
+  printf("\n");
+  printf("Usage: benchmark [OPTION]...\n");
+  printf("\n");
+  printf("Options:\n");
+  printf("\t--baseline FILE       compare the results with ones saved with --csv\n");
+  printf("\t--csv                 print the results as comma separated values\n");
+  printf("\t--filter TEXT         run only the benchmarks whose names contain TEXT\n");
+  printf("\t--help                show this help message\n");
+  printf("\t--min-time SECONDS    run every benchmark for at least SECONDS (default 0.5)\n");
+  printf("\t--scale N             multiply the shape counts of synthetic documents by N\n");
+  printf("\t--tolerance PERCENT   allowed slowdown against the baseline (default 10)\n");
+  printf("\n");
+  printf("The peak resident set size is that of the whole process so far.\n");
+  return -1;
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[])
+{
+  const char *filter = nullptr;
+  const char *baselineFile = nullptr;
+  bool csv = false;
+  double minTime = 0.5;
+  double tolerance = 10.0;
+  unsigned scale = 1;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (!strcmp(argv[i], "--csv"))
+      csv = true;
+    else if (!strcmp(argv[i], "--filter") && i + 1 < argc)
+      filter = argv[++i];
+    else if (!strcmp(argv[i], "--baseline") && i + 1 < argc)
+      baselineFile = argv[++i];
+    else if (!strcmp(argv[i], "--min-time") && i + 1 < argc)
+      minTime = atof(argv[++i]);
+    else if (!strcmp(argv[i], "--tolerance") && i + 1 < argc)
+      tolerance = atof(argv[++i]);
+    else if (!strcmp(argv[i], "--scale") && i + 1 < argc && atoi(argv[i + 1]) > 0)
+      scale = unsigned(atoi(argv[++i]));
+    else
+      return printUsage();
+  }
+
+  std::map<std::string, double> baseline;
+  if (baselineFile && !readBaseline(baselineFile, baseline))
+  {
+    fprintf(stderr, "Cannot read baseline %s\n", baselineFile);
+    return 1;
+  }
+
+  if (csv)
+    printf("name,iterations,ns_per_iteration,bytes_per_second,items_per_second,peak_rss_kib,allocations_per_item\n");
+  else
+    printf("%-32s %12s %16s %10s %14s %14s %12s\n", "Benchmark", "Iterations", "ns/iteration", "MB/s", "items/s", "peak RSS KiB",
+           "allocs/item");
+
+  int ret = 0;
+  for (const auto &benchmark : getBenchmarks(scale))
+  {
+    if (filter && benchmark.name.find(filter) == std::string::npos)
+      continue;
+
+    const BenchmarkResult result = runBenchmark(benchmark, minTime);
+    if (!result.error.empty())
+    {
+      fprintf(stderr, "%s: %s\n", result.name.c_str(), result.error.c_str());
+      ret = 1;
+      continue;
+    }
+
+    if (csv)
+      printf("%s,%lu,%.1f,%.0f,%.0f,%ld,%.1f\n", result.name.c_str(), result.iterations, result.nsPerIteration,
+             result.bytesPerSecond, result.itemsPerSecond, result.peakRSS, result.allocationsPerItem);
+    else
+      printf("%-32s %12lu %16.1f %10.2f %14.0f %14ld %12.1f\n", result.name.c_str(), result.iterations, result.nsPerIteration,
+             result.bytesPerSecond / 1e6, result.itemsPerSecond, result.peakRSS, result.allocationsPerItem);
+    fflush(stdout);
+
+    auto iter = baseline.find(result.name);
+    if (iter != baseline.end() && iter->second > 0.0 && result.nsPerIteration > iter->second * (1.0 + tolerance / 100.0))
+    {
+      fprintf(stderr, "%s: regression, %.1f ns/iteration against %.1f in the baseline\n",
+              result.name.c_str(), result.nsPerIteration, iter->second);
+      ret = 1;
+    }
+  }
+
+  return ret;
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,825 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "documentgenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace libvisio
+{
+
+namespace
+{
+
+const double PAGE_WIDTH = 8.5;
+const double PAGE_HEIGHT = 11.0;
+
+// number of shapes in every innermost group
+const unsigned GROUP_SIZE = 10;
+
+// width and height of the embedded bitmaps in pixels
+const unsigned BITMAP_SIZE = 32;
+
+const char *const COLOURS[] = { "#4f81bd", "#c0504d", "#9bbb59", "#8064a2", "#4bacc6", "#f79646" };
+
+const char *const WORDS[] =
+{
+  "lorem", "ipsum", "dolor", "sit", "amet", "consectetur", "adipiscing", "elit",
+  "sed", "do", "eiusmod", "tempor", "incididunt", "ut", "labore", "et", "dolore", "magna"
+};
+
+std::string formatDouble(double value)
+{
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.6g", value);
+  return buffer;
+}
+
+std::string formatUnsigned(unsigned value)
+{
+  char buffer[16];
+  snprintf(buffer, sizeof(buffer), "%u", value);
+  return buffer;
+}
+
+const char *getColour(unsigned index)
+{
+  return COLOURS[index % (sizeof(COLOURS) / sizeof(COLOURS[0]))];
+}
+
+// of the smallest square grid with room for count cells
+unsigned getColumns(unsigned count)
+{
+  const auto columns = unsigned(std::ceil(std::sqrt(double(count))));
+  return columns ? columns : 1;
+}
+
+std::string makeText(unsigned length)
+{
+  std::string text;
+  text.reserve(length + 16);
+  for (unsigned i = 0; text.size() < length; ++i)
+  {
+    if (!text.empty())
+      text += ' ';
+    text += WORDS[i % (sizeof(WORDS) / sizeof(WORDS[0]))];
+  }
+  text.resize(length);
+  return text;
+}
+
+void appendU16(std::string &output, unsigned value)
+{
+  output += char(value & 0xff);
+  output += char((value >> 8) & 0xff);
+}
+
+void appendU32(std::string &output, uint32_t value)
+{
+  appendU16(output, value & 0xffff);
+  appendU16(output, value >> 16);
+}
+
+// a complete 24 bit BMP file, with a gradient that differs for every index
+std::string makeBitmap(unsigned index)
+{
+  const unsigned stride = (BITMAP_SIZE * 3 + 3) & ~3u;
+  const unsigned dataSize = stride * BITMAP_SIZE;
+
+  std::string bitmap("BM");
+  appendU32(bitmap, 54 + dataSize);
+  appendU32(bitmap, 0);
+  appendU32(bitmap, 54);
+  appendU32(bitmap, 40);
+  appendU32(bitmap, BITMAP_SIZE);
+  appendU32(bitmap, BITMAP_SIZE);
+  appendU16(bitmap, 1);
+  appendU16(bitmap, 24);
+  appendU32(bitmap, 0);
+  appendU32(bitmap, dataSize);
+  appendU32(bitmap, 2835);
+  appendU32(bitmap, 2835);
+  appendU32(bitmap, 0);
+  appendU32(bitmap, 0);
+  for (unsigned y = 0; y < BITMAP_SIZE; ++y)
+  {
+    for (unsigned x = 0; x < BITMAP_SIZE; ++x)
+    {
+      bitmap += char((x * 8 + index) & 0xff);
+      bitmap += char((y * 8) & 0xff);
+      bitmap += char((index * 37) & 0xff);
+    }
+    bitmap.append(stride - BITMAP_SIZE * 3, '\0');
+  }
+  return bitmap;
+}
+
+std::string encodeBase64(const std::string &data)
+{
+  static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string output;
+  output.reserve((data.size() + 2) / 3 * 4);
+  for (size_t i = 0; i < data.size(); i += 3)
+  {
+    uint32_t group = uint32_t((unsigned char)data[i]) << 16;
+    if (i + 1 < data.size())
+      group |= uint32_t((unsigned char)data[i + 1]) << 8;
+    if (i + 2 < data.size())
+      group |= uint32_t((unsigned char)data[i + 2]);
+    output += alphabet[(group >> 18) & 0x3f];
+    output += alphabet[(group >> 12) & 0x3f];
+    output += i + 1 < data.size() ? alphabet[(group >> 6) & 0x3f] : '=';
+    output += i + 2 < data.size() ? alphabet[group & 0x3f] : '=';
+  }
+  return output;
+}
+
+/* Hides the differences between the markup of VDX and VSDX shapes.
+ *
+ * VDX groups the cells of a shape sheet into named elements and stores
+ * every cell as an element of its own; VSDX stores all cells as Cell
+ * elements and only uses sections for the geometry. VDX embeds images,
+ * while VSDX keeps them in parts of their own.
+ */
+class ShapeWriter
+{
+public:
+  explicit ShapeWriter(std::string &output)
+    : m_output(output) {}
+  virtual ~ShapeWriter() {}
+
+  // master is the ID of a master, or 0 for none
+  void startShape(unsigned id, const char *type, unsigned master)
+  {
+    m_output += "<Shape ID='" + formatUnsigned(id) + "' Type='" + type + "'";
+    if (master)
+      m_output += " Master='" + formatUnsigned(master) + "'";
+    m_output += ">";
+  }
+  void endShape()
+  {
+    m_output += "</Shape>";
+  }
+  void startShapes()
+  {
+    m_output += "<Shapes>";
+  }
+  void endShapes()
+  {
+    m_output += "</Shapes>";
+  }
+  void writeText(const std::string &text)
+  {
+    m_output += "<Text>" + text + "</Text>";
+  }
+
+  virtual void startSection(const char *name) = 0;
+  virtual void endSection(const char *name) = 0;
+  virtual void writeCell(const char *name, const std::string &value) = 0;
+  virtual void startGeometry(unsigned ix) = 0;
+  virtual void endGeometry() = 0;
+  virtual void startRow(const char *type, unsigned ix) = 0;
+  virtual void endRow(const char *type) = 0;
+  virtual void writeBitmap(const std::string &bitmap) = 0;
+
+protected:
+  std::string &m_output;
+
+private:
+  ShapeWriter(const ShapeWriter &);
+  ShapeWriter &operator=(const ShapeWriter &);
+};
+
+class VDXShapeWriter : public ShapeWriter
+{
+public:
+  explicit VDXShapeWriter(std::string &output)
+    : ShapeWriter(output) {}
+
+  void startSection(const char *name) override
+  {
+    m_output += std::string("<") + name + ">";
+  }
+  void endSection(const char *name) override
+  {
+    m_output += std::string("</") + name + ">";
+  }
+  void writeCell(const char *name, const std::string &value) override
+  {
+    m_output += std::string("<") + name + ">" + value + "</" + name + ">";
+  }
+  void startGeometry(unsigned ix) override
+  {
+    m_output += "<Geom IX='" + formatUnsigned(ix) + "'>";
+  }
+  void endGeometry() override
+  {
+    m_output += "</Geom>";
+  }
+  void startRow(const char *type, unsigned ix) override
+  {
+    m_output += std::string("<") + type + " IX='" + formatUnsigned(ix) + "'>";
+  }
+  void endRow(const char *type) override
+  {
+    m_output += std::string("</") + type + ">";
+  }
+  void writeBitmap(const std::string &bitmap) override
+  {
+    m_output += "<ForeignData ForeignType='Bitmap'>" + encodeBase64(bitmap) + "</ForeignData>";
+  }
+};
+
+/* The bitmaps are collected for the caller, who stores each one in a part
+ * of its own, referenced by the relationship rId<n> of the shape's part.
+ */
+class VSDXShapeWriter : public ShapeWriter
+{
+public:
+  explicit VSDXShapeWriter(std::string &output)
+    : ShapeWriter(output), m_bitmaps() {}
+
+  void startSection(const char *) override {}
+  void endSection(const char *) override {}
+  void writeCell(const char *name, const std::string &value) override
+  {
+    m_output += std::string("<Cell N='") + name + "' V='" + value + "'/>";
+  }
+  void startGeometry(unsigned ix) override
+  {
+    m_output += "<Section N='Geometry' IX='" + formatUnsigned(ix) + "'>";
+  }
+  void endGeometry() override
+  {
+    m_output += "</Section>";
+  }
+  void startRow(const char *type, unsigned ix) override
+  {
+    m_output += std::string("<Row T='") + type + "' IX='" + formatUnsigned(ix) + "'>";
+  }
+  void endRow(const char *) override
+  {
+    m_output += "</Row>";
+  }
+  void writeBitmap(const std::string &bitmap) override
+  {
+    m_bitmaps.push_back(bitmap);
+    m_output += "<ForeignData ForeignType='Bitmap'><Rel r:id='rId" + formatUnsigned(unsigned(m_bitmaps.size())) + "'/></ForeignData>";
+  }
+
+  const std::vector<std::string> &getBitmaps() const
+  {
+    return m_bitmaps;
+  }
+
+private:
+  std::vector<std::string> m_bitmaps;
+};
+
+void writePageProps(ShapeWriter &writer)
+{
+  writer.startSection("PageProps");
+  writer.writeCell("PageWidth", formatDouble(PAGE_WIDTH));
+  writer.writeCell("PageHeight", formatDouble(PAGE_HEIGHT));
+  writer.writeCell("PageScale", "1");
+  writer.writeCell("DrawingScale", "1");
+  writer.endSection("PageProps");
+}
+
+void writeXForm(ShapeWriter &writer, double pinX, double pinY, double width, double height)
+{
+  writer.startSection("XForm");
+  writer.writeCell("PinX", formatDouble(pinX));
+  writer.writeCell("PinY", formatDouble(pinY));
+  writer.writeCell("Width", formatDouble(width));
+  writer.writeCell("Height", formatDouble(height));
+  writer.writeCell("LocPinX", formatDouble(width / 2.0));
+  writer.writeCell("LocPinY", formatDouble(height / 2.0));
+  writer.writeCell("Angle", "0");
+  writer.endSection("XForm");
+}
+
+void writePoint(ShapeWriter &writer, const char *type, unsigned ix, double x, double y)
+{
+  writer.startRow(type, ix);
+  writer.writeCell("X", formatDouble(x));
+  writer.writeCell("Y", formatDouble(y));
+  writer.endRow(type);
+}
+
+void startOpenGeometry(ShapeWriter &writer, unsigned ix)
+{
+  writer.startGeometry(ix);
+  writer.writeCell("NoFill", "1");
+  writer.writeCell("NoLine", "0");
+  writer.writeCell("NoShow", "0");
+}
+
+// the line, fill and outline of a filled rectangle
+void writeBox(ShapeWriter &writer, unsigned colour, double width, double height)
+{
+  writer.startSection("Line");
+  writer.writeCell("LineWeight", "0.01");
+  writer.writeCell("LineColor", "#000000");
+  writer.writeCell("LinePattern", "1");
+  writer.endSection("Line");
+
+  writer.startSection("Fill");
+  writer.writeCell("FillForegnd", getColour(colour));
+  writer.writeCell("FillPattern", "1");
+  writer.endSection("Fill");
+
+  writer.startGeometry(0);
+  writer.writeCell("NoFill", "0");
+  writer.writeCell("NoLine", "0");
+  writer.writeCell("NoShow", "0");
+  writePoint(writer, "MoveTo", 1, 0.0, 0.0);
+  writePoint(writer, "LineTo", 2, width, 0.0);
+  writePoint(writer, "LineTo", 3, width, height);
+  writePoint(writer, "LineTo", 4, 0.0, height);
+  writePoint(writer, "LineTo", 5, 0.0, 0.0);
+  writer.endGeometry();
+}
+
+/* A clamped cubic NURBS curve across the middle of the shape, with the
+ * given number of control points between its ends and alternating weights.
+ */
+void writeNURBS(ShapeWriter &writer, double width, double height, unsigned points)
+{
+  points = std::max(points, 3u);
+  std::string formula = "NURBS(" + formatUnsigned(points - 1) + ", 3, 0, 0";
+  for (unsigned i = 0; i < points; ++i)
+  {
+    formula += ", " + formatDouble(double(i + 1) / double(points + 1));
+    formula += ", " + formatDouble(0.5 + 0.4 * std::sin(double(i)));
+    formula += ", " + formatUnsigned(i < 3 ? 0 : i - 2);
+    formula += i % 2 ? ", 0.5" : ", 1";
+  }
+  formula += ")";
+
+  startOpenGeometry(writer, 1);
+  writePoint(writer, "MoveTo", 1, 0.0, height / 2.0);
+  writer.startRow("NURBSTo", 2);
+  writer.writeCell("X", formatDouble(width));
+  writer.writeCell("Y", formatDouble(height / 2.0));
+  writer.writeCell("A", formatUnsigned(points - 2));
+  writer.writeCell("B", "1");
+  writer.writeCell("C", "0");
+  writer.writeCell("D", "1");
+  writer.writeCell("E", formula);
+  writer.endRow("NURBSTo");
+  writer.endGeometry();
+}
+
+void writePolyline(ShapeWriter &writer, double width, double height, unsigned points)
+{
+  std::string formula = "POLYLINE(0, 0";
+  for (unsigned i = 0; i < points; ++i)
+  {
+    formula += ", " + formatDouble(double(i + 1) / double(points + 1));
+    formula += ", " + formatDouble(0.25 + 0.2 * std::cos(double(i)));
+  }
+  formula += ")";
+
+  startOpenGeometry(writer, 2);
+  writePoint(writer, "MoveTo", 1, 0.0, height / 4.0);
+  writer.startRow("PolylineTo", 2);
+  writer.writeCell("X", formatDouble(width));
+  writer.writeCell("Y", formatDouble(height / 4.0));
+  writer.writeCell("A", formula);
+  writer.endRow("PolylineTo");
+  writer.endGeometry();
+}
+
+/* Lays out the contents of one page: the shapes, in batches of GROUP_SIZE
+ * when they are grouped, and the images share one grid.
+ */
+class PageWriter
+{
+public:
+  PageWriter(ShapeWriter &writer, const DocumentGeneratorOptions &options, unsigned firstImage);
+
+  void write();
+
+  static void getShapeSize(const DocumentGeneratorOptions &options, double &width, double &height);
+
+private:
+  unsigned getUnitCount() const;
+  void writeGroup(unsigned depth, double pinX, double pinY, double width, double height, unsigned shapes);
+  void writeShape(double pinX, double pinY);
+  void writeImage(double pinX, double pinY, double width, double height);
+
+  ShapeWriter &m_writer;
+  const DocumentGeneratorOptions &m_options;
+  const std::string m_text;
+  unsigned m_nextId;
+  unsigned m_nextImage;
+  double m_shapeWidth;
+  double m_shapeHeight;
+};
+
+PageWriter::PageWriter(ShapeWriter &writer, const DocumentGeneratorOptions &options, unsigned firstImage)
+  : m_writer(writer), m_options(options), m_text(makeText(options.textLength)),
+    m_nextId(1), m_nextImage(firstImage), m_shapeWidth(0.0), m_shapeHeight(0.0)
+{
+  getShapeSize(options, m_shapeWidth, m_shapeHeight);
+}
+
+unsigned PageWriter::getUnitCount() const
+{
+  if (!m_options.groupDepth)
+    return m_options.shapesPerPage;
+  return (m_options.shapesPerPage + GROUP_SIZE - 1) / GROUP_SIZE;
+}
+
+void PageWriter::getShapeSize(const DocumentGeneratorOptions &options, double &width, double &height)
+{
+  unsigned units = options.shapesPerPage;
+  if (options.groupDepth)
+    units = (units + GROUP_SIZE - 1) / GROUP_SIZE;
+  const unsigned columns = getColumns(units + options.images);
+  width = PAGE_WIDTH / columns;
+  height = PAGE_HEIGHT / columns;
+  if (options.groupDepth)
+  {
+    width = 0.9 * width / getColumns(GROUP_SIZE);
+    height = 0.9 * height / getColumns(GROUP_SIZE);
+  }
+  width *= 0.8;
+  height *= 0.8;
+}
+
+void PageWriter::write()
+{
+  const unsigned units = getUnitCount();
+  const unsigned columns = getColumns(units + m_options.images);
+  const double cellWidth = PAGE_WIDTH / columns;
+  const double cellHeight = PAGE_HEIGHT / columns;
+
+  m_writer.startShapes();
+  for (unsigned i = 0; i < units + m_options.images; ++i)
+  {
+    const double pinX = (double(i % columns) + 0.5) * cellWidth;
+    const double pinY = PAGE_HEIGHT - (double(i / columns) + 0.5) * cellHeight;
+    if (i >= units)
+      writeImage(pinX, pinY, 0.8 * cellWidth, 0.8 * cellHeight);
+    else if (m_options.groupDepth)
+      writeGroup(m_options.groupDepth, pinX, pinY, 0.9 * cellWidth, 0.9 * cellHeight,
+                 std::min(GROUP_SIZE, m_options.shapesPerPage - i * GROUP_SIZE));
+    else
+      writeShape(pinX, pinY);
+  }
+  m_writer.endShapes();
+}
+
+// every nested group covers its parent
+void PageWriter::writeGroup(unsigned depth, double pinX, double pinY, double width, double height, unsigned shapes)
+{
+  m_writer.startShape(m_nextId++, "Group", 0);
+  writeXForm(m_writer, pinX, pinY, width, height);
+  m_writer.startShapes();
+  if (depth > 1)
+    writeGroup(depth - 1, width / 2.0, height / 2.0, width, height, shapes);
+  else
+  {
+    const unsigned columns = getColumns(GROUP_SIZE);
+    for (unsigned i = 0; i < shapes; ++i)
+      writeShape((double(i % columns) + 0.5) * width / columns, height - (double(i / columns) + 0.5) * height / columns);
+  }
+  m_writer.endShapes();
+  m_writer.endShape();
+}
+
+// instances of masters take the box from the master
+void PageWriter::writeShape(double pinX, double pinY)
+{
+  const unsigned id = m_nextId++;
+  const unsigned master = m_options.masters ? 1 + id % m_options.masters : 0;
+  m_writer.startShape(id, "Shape", master);
+  writeXForm(m_writer, pinX, pinY, m_shapeWidth, m_shapeHeight);
+  if (!master)
+    writeBox(m_writer, id, m_shapeWidth, m_shapeHeight);
+  if (m_options.nurbsPoints)
+    writeNURBS(m_writer, m_shapeWidth, m_shapeHeight, m_options.nurbsPoints);
+  if (m_options.polylinePoints)
+    writePolyline(m_writer, m_shapeWidth, m_shapeHeight, m_options.polylinePoints);
+  if (!m_text.empty())
+    m_writer.writeText(m_text);
+  m_writer.endShape();
+}
+
+void PageWriter::writeImage(double pinX, double pinY, double width, double height)
+{
+  m_writer.startShape(m_nextId++, "Foreign", 0);
+  writeXForm(m_writer, pinX, pinY, width, height);
+  m_writer.startSection("Foreign");
+  m_writer.writeCell("ImgOffsetX", "0");
+  m_writer.writeCell("ImgOffsetY", "0");
+  m_writer.writeCell("ImgWidth", formatDouble(width));
+  m_writer.writeCell("ImgHeight", formatDouble(height));
+  m_writer.endSection("Foreign");
+  m_writer.writeBitmap(makeBitmap(m_nextImage++));
+  m_writer.endShape();
+}
+
+void writeMasterShape(ShapeWriter &writer, unsigned master, const DocumentGeneratorOptions &options)
+{
+  double width = 0.0;
+  double height = 0.0;
+  PageWriter::getShapeSize(options, width, height);
+  writer.startShapes();
+  writer.startShape(1, "Shape", 0);
+  writeXForm(writer, width / 2.0, height / 2.0, width, height);
+  writeBox(writer, master, width, height);
+  writer.endShape();
+  writer.endShapes();
+}
+
+std::string getName(const char *prefix, unsigned index)
+{
+  return prefix + formatUnsigned(index + 1);
+}
+
+/* Writes a ZIP archive whose entries are stored uncompressed, which is
+ * all an OPC package needs.
+ */
+class ZipWriter
+{
+public:
+  ZipWriter()
+    : m_output(), m_directory(), m_count(0) {}
+
+  void add(const std::string &name, const std::string &data);
+  std::string finish();
+
+private:
+  static uint32_t crc32(const std::string &data);
+
+  std::string m_output;
+  std::string m_directory;
+  unsigned m_count;
+};
+
+uint32_t ZipWriter::crc32(const std::string &data)
+{
+  static uint32_t table[256] = { 0 };
+  if (!table[1])
+  {
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+      uint32_t c = i;
+      for (unsigned k = 0; k < 8; ++k)
+        c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+      table[i] = c;
+    }
+  }
+  uint32_t crc = 0xffffffff;
+  for (char c : data)
+    crc = table[(crc ^ (unsigned char)c) & 0xff] ^ (crc >> 8);
+  return crc ^ 0xffffffff;
+}
+
+void ZipWriter::add(const std::string &name, const std::string &data)
+{
+  const uint32_t crc = crc32(data);
+  const auto offset = uint32_t(m_output.size());
+
+  // local file header: version 2.0, no flags, stored, 1980-01-01 00:00
+  appendU32(m_output, 0x04034b50);
+  appendU16(m_output, 20);
+  appendU16(m_output, 0);
+  appendU16(m_output, 0);
+  appendU16(m_output, 0);
+  appendU16(m_output, 0x21);
+  appendU32(m_output, crc);
+  appendU32(m_output, uint32_t(data.size()));
+  appendU32(m_output, uint32_t(data.size()));
+  appendU16(m_output, unsigned(name.size()));
+  appendU16(m_output, 0);
+  m_output += name;
+  m_output += data;
+
+  appendU32(m_directory, 0x02014b50);
+  appendU16(m_directory, 20);
+  appendU16(m_directory, 20);
+  appendU16(m_directory, 0);
+  appendU16(m_directory, 0);
+  appendU16(m_directory, 0);
+  appendU16(m_directory, 0x21);
+  appendU32(m_directory, crc);
+  appendU32(m_directory, uint32_t(data.size()));
+  appendU32(m_directory, uint32_t(data.size()));
+  appendU16(m_directory, unsigned(name.size()));
+  appendU16(m_directory, 0);
+  appendU16(m_directory, 0);
+  appendU16(m_directory, 0);
+  appendU16(m_directory, 0);
+  appendU32(m_directory, 0);
+  appendU32(m_directory, offset);
+  m_directory += name;
+
+  ++m_count;
+}
+
+std::string ZipWriter::finish()
+{
+  const auto directoryOffset = uint32_t(m_output.size());
+  m_output += m_directory;
+
+  appendU32(m_output, 0x06054b50);
+  appendU16(m_output, 0);
+  appendU16(m_output, 0);
+  appendU16(m_output, m_count);
+  appendU16(m_output, m_count);
+  appendU32(m_output, uint32_t(m_directory.size()));
+  appendU32(m_output, directoryOffset);
+  appendU16(m_output, 0);
+
+  std::string output;
+  output.swap(m_output);
+  m_directory.clear();
+  m_count = 0;
+  return output;
+}
+
+const char XML_DECLARATION[] = "<?xml version='1.0' encoding='utf-8' ?>\n";
+const char VSDX_NAMESPACES[] =
+  " xmlns='http://schemas.microsoft.com/office/visio/2012/main'"
+  " xmlns:r='http://schemas.openxmlformats.org/officeDocument/2006/relationships'"
+  " xml:space='preserve'";
+const char RELATIONSHIPS_START[] =
+  "<Relationships xmlns='http://schemas.openxmlformats.org/package/2006/relationships'>";
+const char RELATIONSHIPS_END[] = "</Relationships>";
+
+std::string getRelationship(const std::string &id, const char *type, const std::string &target)
+{
+  return "<Relationship Id='" + id + "' Type='" + type + "' Target='" + target + "'/>";
+}
+
+std::string getOverride(const std::string &part, const char *contentType)
+{
+  return "<Override PartName='/" + part + "' ContentType='" + contentType + "'/>";
+}
+
+} // anonymous namespace
+
+DocumentGenerator::DocumentGenerator(const DocumentGeneratorOptions &options)
+  : m_options(options)
+{
+}
+
+std::string DocumentGenerator::generateVDX() const
+{
+  std::string output(XML_DECLARATION);
+  output += "<VisioDocument xmlns='http://schemas.microsoft.com/visio/2003/core' xml:space='preserve'>";
+  VDXShapeWriter writer(output);
+
+  if (m_options.masters)
+  {
+    output += "<Masters>";
+    for (unsigned master = 0; master < m_options.masters; ++master)
+    {
+      output += "<Master ID='" + formatUnsigned(master + 1) + "' NameU='" + getName("Master-", master)
+                + "' Name='" + getName("Master-", master) + "'>";
+      writeMasterShape(writer, master, m_options);
+      output += "</Master>";
+    }
+    output += "</Masters>";
+  }
+
+  output += "<Pages>";
+  for (unsigned page = 0; page < m_options.pages; ++page)
+  {
+    output += "<Page ID='" + formatUnsigned(page) + "' NameU='" + getName("Page-", page) + "' Name='" + getName("Page-", page) + "'>";
+    output += "<PageSheet>";
+    writePageProps(writer);
+    output += "</PageSheet>";
+    PageWriter(writer, m_options, page * m_options.images).write();
+    output += "</Page>";
+  }
+  output += "</Pages>";
+  output += "</VisioDocument>";
+  return output;
+}
+
+std::string DocumentGenerator::generateVSDX() const
+{
+  ZipWriter zip;
+
+  std::string contentTypes(XML_DECLARATION);
+  contentTypes += "<Types xmlns='http://schemas.openxmlformats.org/package/2006/content-types'>";
+  contentTypes += "<Default Extension='rels' ContentType='application/vnd.openxmlformats-package.relationships+xml'/>";
+  contentTypes += "<Default Extension='xml' ContentType='application/xml'/>";
+  if (m_options.images)
+    contentTypes += "<Default Extension='bmp' ContentType='image/bmp'/>";
+  contentTypes += getOverride("visio/document.xml", "application/vnd.ms-visio.drawing.main+xml");
+
+  zip.add("_rels/.rels", std::string(XML_DECLARATION) + RELATIONSHIPS_START
+          + getRelationship("rId1", "http://schemas.microsoft.com/visio/2010/relationships/document", "visio/document.xml")
+          + RELATIONSHIPS_END);
+  zip.add("visio/document.xml", std::string(XML_DECLARATION) + "<VisioDocument" + VSDX_NAMESPACES + "></VisioDocument>");
+
+  std::string documentRels(XML_DECLARATION);
+  documentRels += RELATIONSHIPS_START;
+  documentRels += getRelationship("rId1", "http://schemas.microsoft.com/visio/2010/relationships/pages", "pages/pages.xml");
+
+  if (m_options.masters)
+  {
+    documentRels += getRelationship("rId2", "http://schemas.microsoft.com/visio/2010/relationships/masters", "masters/masters.xml");
+    contentTypes += getOverride("visio/masters/masters.xml", "application/vnd.ms-visio.masters+xml");
+
+    std::string masters(XML_DECLARATION);
+    masters += std::string("<Masters") + VSDX_NAMESPACES + ">";
+    std::string mastersRels(XML_DECLARATION);
+    mastersRels += RELATIONSHIPS_START;
+    for (unsigned master = 0; master < m_options.masters; ++master)
+    {
+      const std::string relId = getName("rId", master);
+      const std::string partName = getName("master", master) + ".xml";
+      masters += "<Master ID='" + formatUnsigned(master + 1) + "' NameU='" + getName("Master-", master)
+                 + "' Name='" + getName("Master-", master) + "'><Rel r:id='" + relId + "'/></Master>";
+      mastersRels += getRelationship(relId, "http://schemas.microsoft.com/visio/2010/relationships/master", partName);
+      contentTypes += getOverride("visio/masters/" + partName, "application/vnd.ms-visio.master+xml");
+
+      std::string contents(XML_DECLARATION);
+      contents += std::string("<MasterContents") + VSDX_NAMESPACES + ">";
+      VSDXShapeWriter writer(contents);
+      writeMasterShape(writer, master, m_options);
+      contents += "</MasterContents>";
+      zip.add("visio/masters/" + partName, contents);
+    }
+    masters += "</Masters>";
+    mastersRels += RELATIONSHIPS_END;
+    zip.add("visio/masters/masters.xml", masters);
+    zip.add("visio/masters/_rels/masters.xml.rels", mastersRels);
+  }
+
+  documentRels += RELATIONSHIPS_END;
+  zip.add("visio/_rels/document.xml.rels", documentRels);
+
+  contentTypes += getOverride("visio/pages/pages.xml", "application/vnd.ms-visio.pages+xml");
+  std::string pages(XML_DECLARATION);
+  pages += std::string("<Pages") + VSDX_NAMESPACES + ">";
+  std::string pagesRels(XML_DECLARATION);
+  pagesRels += RELATIONSHIPS_START;
+  VSDXShapeWriter pagesWriter(pages);
+  for (unsigned page = 0; page < m_options.pages; ++page)
+  {
+    const std::string relId = getName("rId", page);
+    const std::string partName = getName("page", page) + ".xml";
+    pages += "<Page ID='" + formatUnsigned(page) + "' NameU='" + getName("Page-", page) + "' Name='" + getName("Page-", page) + "'>";
+    pages += "<PageSheet>";
+    writePageProps(pagesWriter);
+    pages += "</PageSheet>";
+    pages += "<Rel r:id='" + relId + "'/>";
+    pages += "</Page>";
+    pagesRels += getRelationship(relId, "http://schemas.microsoft.com/visio/2010/relationships/page", partName);
+    contentTypes += getOverride("visio/pages/" + partName, "application/vnd.ms-visio.page+xml");
+
+    std::string contents(XML_DECLARATION);
+    contents += std::string("<PageContents") + VSDX_NAMESPACES + ">";
+    VSDXShapeWriter writer(contents);
+    PageWriter(writer, m_options, page * m_options.images).write();
+    contents += "</PageContents>";
+    zip.add("visio/pages/" + partName, contents);
+
+    const std::vector<std::string> &bitmaps = writer.getBitmaps();
+    if (!bitmaps.empty())
+    {
+      std::string contentsRels(XML_DECLARATION);
+      contentsRels += RELATIONSHIPS_START;
+      for (size_t i = 0; i < bitmaps.size(); ++i)
+      {
+        const std::string mediaName = getName("image", unsigned(page * m_options.images + i)) + ".bmp";
+        contentsRels += getRelationship(getName("rId", unsigned(i)), "http://schemas.openxmlformats.org/officeDocument/2006/relationships/image",
+                                        "../media/" + mediaName);
+        zip.add("visio/media/" + mediaName, bitmaps[i]);
+      }
+      contentsRels += RELATIONSHIPS_END;
+      zip.add("visio/pages/_rels/" + partName + ".rels", contentsRels);
+    }
+  }
+  pages += "</Pages>";
+  pagesRels += RELATIONSHIPS_END;
+  zip.add("visio/pages/pages.xml", pages);
+  zip.add("visio/pages/_rels/pages.xml.rels", pagesRels);
+
+  contentTypes += "</Types>";
+  zip.add("[Content_Types].xml", contentTypes);
+
+  return zip.finish();
+}
+
+} // namespace libvisio
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
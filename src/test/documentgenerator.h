@@ -0,0 +1,60 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef __DOCUMENTGENERATOR_H__
+#define __DOCUMENTGENERATOR_H__
+
+#include <string>
+
+namespace libvisio
+{
+
+struct DocumentGeneratorOptions
+{
+  DocumentGeneratorOptions()
+    : pages(1), shapesPerPage(100), groupDepth(0), masters(0), textLength(0),
+      nurbsPoints(0), polylinePoints(0), images(0) {}
+  unsigned pages;
+  unsigned shapesPerPage;
+  // levels of groups around every batch of shapes, 0 for no groups
+  unsigned groupDepth;
+  // number of masters the shapes are instances of, 0 for no masters
+  unsigned masters;
+  // characters of text in every shape
+  unsigned textLength;
+  // control points of a NURBS curve in every shape, 0 for none
+  unsigned nurbsPoints;
+  // points of a polyline in every shape, 0 for none
+  unsigned polylinePoints;
+  // embedded bitmaps per page
+  unsigned images;
+};
+
+/* Writes synthetic Visio documents of a given size, so that the scaling
+ * of the parsers can be measured without large sample files.
+ *
+ * Every page is a grid of rectangles, optionally wrapped in nested groups,
+ * followed by the images.
+ */
+class DocumentGenerator
+{
+public:
+  explicit DocumentGenerator(const DocumentGeneratorOptions &options);
+
+  std::string generateVDX() const;
+  std::string generateVSDX() const;
+
+private:
+  const DocumentGeneratorOptions m_options;
+};
+
+} // namespace libvisio
+
+#endif // __DOCUMENTGENERATOR_H__
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,138 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "documentgenerator.h"
+
+namespace
+{
+
+int printUsage()
+{
+  printf("`generatedocument' writes synthetic Visio documents for scaling tests.\n");
+  printf("\n");
+  printf("Usage: generatedocument [OPTION]... OUTPUT\n");
+  printf("\n");
+  printf("The format is taken from the extension of OUTPUT, .vdx or .vsdx.\n");
+  printf("\n");
+  printf("Options:\n");
+  printf("\t--format FORMAT       write FORMAT, vdx or vsdx, whatever the extension\n");
+  printf("\t--group-depth N       wrap every 10 shapes in N nested groups (default 0)\n");
+  printf("\t--help                show this help message\n");
+  printf("\t--images N            embed N bitmaps in every page (default 0)\n");
+  printf("\t--masters N           make the shapes instances of N masters (default 0)\n");
+  printf("\t--nurbs-points N      add a NURBS curve with N control points to every shape\n");
+  printf("\t--pages N             write N pages (default 1)\n");
+  printf("\t--polyline-points N   add a polyline with N points to every shape\n");
+  printf("\t--shapes N            write N shapes in every page (default 100)\n");
+  printf("\t--text-length N       add N characters of text to every shape (default 0)\n");
+  return -1;
+}
+
+bool endsWith(const std::string &str, const char *suffix)
+{
+  const size_t length = strlen(suffix);
+  return str.size() >= length && !str.compare(str.size() - length, length, suffix);
+}
+
+bool parseUnsigned(const char *str, unsigned &value)
+{
+  char *end = nullptr;
+  const long parsed = strtol(str, &end, 10);
+  if (!*str || *end || parsed < 0)
+    return false;
+  value = unsigned(parsed);
+  return true;
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[])
+{
+  libvisio::DocumentGeneratorOptions options;
+  std::string format;
+  const char *output = nullptr;
+
+  struct
+  {
+    const char *name;
+    unsigned *value;
+  } const numericOptions[] =
+  {
+    { "--pages", &options.pages },
+    { "--shapes", &options.shapesPerPage },
+    { "--group-depth", &options.groupDepth },
+    { "--masters", &options.masters },
+    { "--text-length", &options.textLength },
+    { "--nurbs-points", &options.nurbsPoints },
+    { "--polyline-points", &options.polylinePoints },
+    { "--images", &options.images }
+  };
+
+  for (int i = 1; i < argc; i++)
+  {
+    bool handled = false;
+    for (const auto &option : numericOptions)
+    {
+      if (!strcmp(argv[i], option.name))
+      {
+        if (i + 1 >= argc || !parseUnsigned(argv[++i], *option.value))
+          return printUsage();
+        handled = true;
+        break;
+      }
+    }
+    if (handled)
+      continue;
+
+    if (!strcmp(argv[i], "--format") && i + 1 < argc)
+      format = argv[++i];
+    else if (!output && strncmp(argv[i], "--", 2))
+      output = argv[i];
+    else
+      return printUsage();
+  }
+
+  if (!output)
+    return printUsage();
+
+  if (format.empty())
+  {
+    if (endsWith(output, ".vdx"))
+      format = "vdx";
+    else if (endsWith(output, ".vsdx"))
+      format = "vsdx";
+  }
+  if (format != "vdx" && format != "vsdx")
+    return printUsage();
+
+  const libvisio::DocumentGenerator generator(options);
+  const std::string data = format == "vdx" ? generator.generateVDX() : generator.generateVSDX();
+
+  FILE *file = fopen(output, "wb");
+  if (!file)
+  {
+    fprintf(stderr, "ERROR: Cannot open %s for writing!\n", output);
+    return 1;
+  }
+  const bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+  if (fclose(file) || !written)
+  {
+    fprintf(stderr, "ERROR: Cannot write %s!\n", output);
+    return 1;
+  }
+
+  return 0;
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -7,8 +7,10 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 
+#include <cstring>
 #include <iostream>
 #include <memory>
+#include <string>
 
 #include <cppunit/extensions/HelperMacros.h>
 
@@ -166,8 +168,11 @@ void assertXPathContent(xmlDocPtr doc, const librevenge::RVNGString &xpath, cons
   CPPUNIT_ASSERT_EQUAL_MESSAGE(message.cstr(), content, getXPathContent(doc, xpath));
 }
 
-/// Paints an XML representation of filename into buffer, then returns the parsed buffer content.
-xmlDocPtr parse(const char *filename, xmlBufferPtr buffer)
+/**
+ * Paints an XML representation of filename into buffer, then returns the parsed buffer content.
+ * Only the foreground page with the 0-based index pageIndex is painted, unless it is negative.
+ */
+xmlDocPtr parse(const char *filename, xmlBufferPtr buffer, int pageIndex = -1)
 {
   librevenge::RVNGString path(TDOC "/");
   path.append(filename);
@@ -179,7 +184,10 @@ xmlDocPtr parse(const char *filename, xmlBufferPtr buffer)
   xmlTextWriterStartDocument(writer, 0, 0, 0);
   libvisio::XmlDrawingGenerator painter(writer);
 
-  CPPUNIT_ASSERT(libvisio::VisioDocument::parse(&input, &painter));
+  if (pageIndex < 0)
+    CPPUNIT_ASSERT(libvisio::VisioDocument::parse(&input, &painter));
+  else
+    CPPUNIT_ASSERT(libvisio::VisioDocument::parsePage(&input, &painter, unsigned(pageIndex)));
 
   xmlTextWriterEndDocument(writer);
   xmlFreeTextWriter(writer);
@@ -188,6 +196,68 @@ xmlDocPtr parse(const char *filename, xmlBufferPtr buffer)
   return xmlParseMemory((const char *)xmlBufferContent(buffer), xmlBufferLength(buffer));
 }
 
+/// Same as parse(), but only the text of filename is painted.
+xmlDocPtr parseText(const char *filename, xmlBufferPtr buffer)
+{
+  librevenge::RVNGString path(TDOC "/");
+  path.append(filename);
+  librevenge::RVNGFileStream input(path.cstr());
+
+  xmlTextWriterPtr writer = xmlNewTextWriterMemory(buffer, 0);
+  CPPUNIT_ASSERT(writer);
+  xmlTextWriterStartDocument(writer, 0, 0, 0);
+  libvisio::XmlDrawingGenerator painter(writer);
+  CPPUNIT_ASSERT(libvisio::VisioDocument::parseText(&input, &painter));
+  xmlTextWriterEndDocument(writer);
+  xmlFreeTextWriter(writer);
+
+  return xmlParseMemory((const char *)xmlBufferContent(buffer), xmlBufferLength(buffer));
+}
+
+/// Reads the summary of filename into info.
+void probe(const char *filename, librevenge::RVNGPropertyList &info)
+{
+  librevenge::RVNGString path(TDOC "/");
+  path.append(filename);
+  librevenge::RVNGFileStream input(path.cstr());
+  CPPUNIT_ASSERT(libvisio::VisioDocument::probe(&input, info));
+}
+
+/// Records the progress reports of a parse, and cancels it after maxCalls of them.
+class TestParseCallback : public libvisio::VisioParseCallback
+{
+public:
+  explicit TestParseCallback(unsigned maxCalls = unsigned(-1))
+    : m_maxCalls(maxCalls), m_calls(0), m_pagesDone(0), m_bytesConsumed(0) {}
+
+  bool progress(unsigned pagesDone, unsigned long bytesConsumed) override
+  {
+    CPPUNIT_ASSERT(pagesDone >= m_pagesDone);
+    CPPUNIT_ASSERT(bytesConsumed >= m_bytesConsumed);
+    m_pagesDone = pagesDone;
+    m_bytesConsumed = bytesConsumed;
+    return ++m_calls < m_maxCalls;
+  }
+
+  unsigned m_maxCalls;
+  unsigned m_calls;
+  unsigned m_pagesDone;
+  unsigned long m_bytesConsumed;
+};
+
+/// Assert that xpath does not match any node.
+void assertXPathMissing(xmlDocPtr doc, const librevenge::RVNGString &xpath)
+{
+  xmlXPathObjectPtr xpathobject = getXPathNode(doc, xpath);
+  CPPUNIT_ASSERT(xpathobject);
+  const int nodes = xpathobject->nodesetval ? xpathobject->nodesetval->nodeNr : 0;
+  xmlXPathFreeObject(xpathobject);
+  librevenge::RVNGString message("XPath '");
+  message.append(xpath);
+  message.append("' should not match");
+  CPPUNIT_ASSERT_EQUAL_MESSAGE(message.cstr(), 0, nodes);
+}
+
 }
 
 class ImportTest : public CPPUNIT_NS::TestFixture
@@ -214,6 +284,21 @@ class ImportTest : public CPPUNIT_NS::TestFixture
   CPPUNIT_TEST(testVsd11TextfieldsWithUnits);
   CPPUNIT_TEST(testBmpFileHeader);
   CPPUNIT_TEST(testBmpFileHeader2);
+  CPPUNIT_TEST(testVsdParseFirstPage);
+  CPPUNIT_TEST(testVsdxParseFirstPage);
+  CPPUNIT_TEST(testParseMissingPage);
+  CPPUNIT_TEST(testVsdParseText);
+  CPPUNIT_TEST(testVsdxParseText);
+  CPPUNIT_TEST(testVsdProbe);
+  CPPUNIT_TEST(testVsdxProbe);
+  CPPUNIT_TEST(testParseProgress);
+  CPPUNIT_TEST(testParseCancel);
+  CPPUNIT_TEST(testParseStats);
+  CPPUNIT_TEST(testParseStatsOnFailure);
+  CPPUNIT_TEST(testImageHandling);
+  CPPUNIT_TEST(testMasterCache);
+  CPPUNIT_TEST(testMasterCacheFaceNames);
+  CPPUNIT_TEST(testParseOptionsOverloads);
   CPPUNIT_TEST_SUITE_END();
 
   void testVsdxMetadataTitle();
@@ -231,6 +316,21 @@ class ImportTest : public CPPUNIT_NS::TestFixture
   void testVsd11TextfieldsWithUnits();
   void testBmpFileHeader();
   void testBmpFileHeader2();
+  void testVsdParseFirstPage();
+  void testVsdxParseFirstPage();
+  void testParseMissingPage();
+  void testVsdParseText();
+  void testVsdxParseText();
+  void testVsdProbe();
+  void testVsdxProbe();
+  void testParseProgress();
+  void testParseCancel();
+  void testParseStats();
+  void testParseStatsOnFailure();
+  void testImageHandling();
+  void testMasterCache();
+  void testMasterCacheFaceNames();
+  void testParseOptionsOverloads();
 
   xmlBufferPtr m_buffer;
   xmlDocPtr m_doc;
@@ -518,6 +618,321 @@ void ImportTest::testBmpFileHeader2()
   assertBmpDataOffset(m_doc, "/document/page/layer/drawGraphicObject[1]", 330);
 }
 
+void ImportTest::testVsdParseFirstPage()
+{
+  m_doc = parse("tdf76829-numeric-format.vsd", m_buffer, 0);
+  // Exactly one page is output, background pages are not shown on their own
+  getXPath(m_doc, "/document/page", "");
+  assertXPathContent(m_doc, "/document/page[1]/textObject[1]/paragraph[1]/span/insertText", "Number of lines, generic format: 1");
+}
+
+void ImportTest::testVsdxParseFirstPage()
+{
+  m_doc = parse("color-boxes.vsdx", m_buffer, 0);
+  getXPath(m_doc, "/document/page", "");
+  assertXPath(m_doc, "/document/page/layer[1]//setStyle[2]", "fill-color", "#759fcc");
+}
+
+void ImportTest::testParseMissingPage()
+{
+  const char *const filenames[] = { "no-bgcolor.vsd", "color-boxes.vsdx" };
+  for (const char *filename : filenames)
+  {
+    librevenge::RVNGString path(TDOC "/");
+    path.append(filename);
+    librevenge::RVNGFileStream input(path.cstr());
+
+    xmlTextWriterPtr writer = xmlNewTextWriterMemory(m_buffer, 0);
+    CPPUNIT_ASSERT(writer);
+    libvisio::XmlDrawingGenerator painter(writer);
+    CPPUNIT_ASSERT(!libvisio::VisioDocument::parsePage(&input, &painter, 1000));
+    xmlFreeTextWriter(writer);
+    // Nothing was painted
+    CPPUNIT_ASSERT_EQUAL(0, xmlBufferLength(m_buffer));
+  }
+}
+
+void ImportTest::testVsdParseText()
+{
+  m_doc = parseText("tdf76829-datetime-format.vsd", m_buffer);
+  // The fields are still resolved
+  assertXPathContent(m_doc, "/document/page/textObject/paragraph/span/insertText", "11/30/2005");
+  assertXPathMissing(m_doc, "/document/page/setStyle");
+}
+
+void ImportTest::testVsdxParseText()
+{
+  m_doc = parseText("fdo86664.vsdx", m_buffer);
+  assertXPath(m_doc, "/document/setDocumentMetaData", "title", "mytitle");
+  assertXPathMissing(m_doc, "/document/page//setStyle");
+}
+
+void ImportTest::testVsdProbe()
+{
+  librevenge::RVNGPropertyList info;
+  probe("fdo86729-utf8.vsd", info);
+  CPPUNIT_ASSERT_EQUAL(librevenge::RVNGString("vsd"), info["libvisio:format"]->getStr());
+  CPPUNIT_ASSERT_EQUAL(11, info["libvisio:version"]->getInt());
+  CPPUNIT_ASSERT(info["dc:title"]);
+  const librevenge::RVNGPropertyListVector *pages = info.child("libvisio:pages");
+  CPPUNIT_ASSERT(pages);
+  CPPUNIT_ASSERT(pages->count() > 0);
+  CPPUNIT_ASSERT((*pages)[0]["svg:width"]->getDouble() > 0.0);
+}
+
+void ImportTest::testVsdxProbe()
+{
+  librevenge::RVNGPropertyList info;
+  probe("fdo86664.vsdx", info);
+  CPPUNIT_ASSERT_EQUAL(librevenge::RVNGString("vsdx"), info["libvisio:format"]->getStr());
+  CPPUNIT_ASSERT_EQUAL(librevenge::RVNGString("mytitle"), info["dc:title"]->getStr());
+  CPPUNIT_ASSERT_EQUAL(3, info["libvisio:masters"]->getInt());
+  CPPUNIT_ASSERT_EQUAL(0, info["libvisio:images"]->getInt());
+  const librevenge::RVNGPropertyListVector *pages = info.child("libvisio:pages");
+  CPPUNIT_ASSERT(pages);
+  CPPUNIT_ASSERT_EQUAL(1UL, pages->count());
+  CPPUNIT_ASSERT_EQUAL(librevenge::RVNGString("Page-1"), (*pages)[0]["draw:name"]->getStr());
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(11.0, (*pages)[0]["svg:width"]->getDouble(), 1e-6);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(8.5, (*pages)[0]["svg:height"]->getDouble(), 1e-6);
+}
+
+void ImportTest::testParseProgress()
+{
+  const char *const filenames[] = { "no-bgcolor.vsd", "color-boxes.vsdx" };
+  for (const char *filename : filenames)
+  {
+    librevenge::RVNGString path(TDOC "/");
+    path.append(filename);
+    librevenge::RVNGFileStream input(path.cstr());
+
+    xmlTextWriterPtr writer = xmlNewTextWriterMemory(m_buffer, 0);
+    CPPUNIT_ASSERT(writer);
+    libvisio::XmlDrawingGenerator painter(writer);
+    TestParseCallback callback;
+    libvisio::VisioParseOptions options;
+    options.callback = &callback;
+    CPPUNIT_ASSERT(libvisio::VisioDocument::parse(&input, &painter, options));
+    xmlFreeTextWriter(writer);
+    CPPUNIT_ASSERT(callback.m_calls > 0);
+    CPPUNIT_ASSERT(callback.m_pagesDone > 0);
+    CPPUNIT_ASSERT(callback.m_bytesConsumed > 0);
+  }
+}
+
+void ImportTest::testParseCancel()
+{
+  const char *const filenames[] = { "no-bgcolor.vsd", "color-boxes.vsdx" };
+  for (const char *filename : filenames)
+  {
+    librevenge::RVNGString path(TDOC "/");
+    path.append(filename);
+    librevenge::RVNGFileStream input(path.cstr());
+
+    xmlTextWriterPtr writer = xmlNewTextWriterMemory(m_buffer, 0);
+    CPPUNIT_ASSERT(writer);
+    libvisio::XmlDrawingGenerator painter(writer);
+    TestParseCallback callback(1);
+    libvisio::VisioParseOptions options;
+    options.callback = &callback;
+    CPPUNIT_ASSERT(!libvisio::VisioDocument::parse(&input, &painter, options));
+    xmlFreeTextWriter(writer);
+    CPPUNIT_ASSERT_EQUAL(1U, callback.m_calls);
+    // Nothing was painted
+    CPPUNIT_ASSERT_EQUAL(0, xmlBufferLength(m_buffer));
+  }
+}
+
+void ImportTest::testParseStats()
+{
+  const char *const filenames[] = { "no-bgcolor.vsd", "color-boxes.vsdx" };
+  for (const char *filename : filenames)
+  {
+    librevenge::RVNGString path(TDOC "/");
+    path.append(filename);
+    librevenge::RVNGFileStream input(path.cstr());
+
+    xmlTextWriterPtr writer = xmlNewTextWriterMemory(m_buffer, 0);
+    CPPUNIT_ASSERT(writer);
+    libvisio::XmlDrawingGenerator painter(writer);
+    librevenge::RVNGPropertyList stats;
+    libvisio::VisioParseOptions options;
+    options.stats = &stats;
+    CPPUNIT_ASSERT(libvisio::VisioDocument::parse(&input, &painter, options));
+    xmlFreeTextWriter(writer);
+
+    CPPUNIT_ASSERT(stats["libvisio:shapes"]->getInt() > 0);
+    CPPUNIT_ASSERT(stats["libvisio:paths"]->getInt() > 0);
+    CPPUNIT_ASSERT(stats["libvisio:content-pass-time"]->getDouble() >= 0.0);
+    const librevenge::RVNGPropertyListVector *chunks = stats.child("libvisio:chunks");
+    if (!strcmp(filename, "no-bgcolor.vsd"))
+    {
+      CPPUNIT_ASSERT(stats["libvisio:decompressed-bytes"]->getDouble() > 0.0);
+      CPPUNIT_ASSERT(chunks);
+      CPPUNIT_ASSERT(chunks->count() > 0);
+      CPPUNIT_ASSERT_EQUAL(0, stats["libvisio:xml-nodes"]->getInt());
+    }
+    else
+    {
+      CPPUNIT_ASSERT(!chunks);
+      CPPUNIT_ASSERT(stats["libvisio:xml-nodes"]->getInt() > 0);
+    }
+  }
+}
+
+void ImportTest::testParseStatsOnFailure()
+{
+  librevenge::RVNGFileStream input(TDOC "/no-bgcolor.vsd");
+
+  xmlTextWriterPtr writer = xmlNewTextWriterMemory(m_buffer, 0);
+  CPPUNIT_ASSERT(writer);
+  libvisio::XmlDrawingGenerator painter(writer);
+  librevenge::RVNGPropertyList stats;
+  libvisio::VisioParseOptions options;
+  options.stats = &stats;
+  // Exceeded while the trailer stream is decompressed
+  options.maxDecompressedBytes = 1;
+  CPPUNIT_ASSERT(!libvisio::VisioDocument::parse(&input, &painter, options));
+  xmlFreeTextWriter(writer);
+
+  CPPUNIT_ASSERT(stats["libvisio:decompression-time"]);
+  CPPUNIT_ASSERT_EQUAL(0, stats["libvisio:shapes"]->getInt());
+}
+
+void ImportTest::testImageHandling()
+{
+  const libvisio::VisioImageHandling handlings[] = { libvisio::VISIO_IMAGES_SKIP, libvisio::VISIO_IMAGES_PLACEHOLDER };
+  for (libvisio::VisioImageHandling handling : handlings)
+  {
+    librevenge::RVNGString path(TDOC "/bitmaps.vsd");
+    librevenge::RVNGFileStream input(path.cstr());
+
+    xmlBufferEmpty(m_buffer);
+    xmlTextWriterPtr writer = xmlNewTextWriterMemory(m_buffer, 0);
+    CPPUNIT_ASSERT(writer);
+    xmlTextWriterStartDocument(writer, 0, 0, 0);
+    libvisio::XmlDrawingGenerator painter(writer);
+    libvisio::VisioParseOptions options;
+    options.imageHandling = handling;
+    CPPUNIT_ASSERT(libvisio::VisioDocument::parse(&input, &painter, options));
+    xmlTextWriterEndDocument(writer);
+    xmlFreeTextWriter(writer);
+
+    xmlFreeDoc(m_doc);
+    m_doc = xmlParseMemory((const char *)xmlBufferContent(m_buffer), xmlBufferLength(m_buffer));
+    if (libvisio::VISIO_IMAGES_SKIP == handling)
+    {
+      assertXPathMissing(m_doc, "/document/page/drawGraphicObject");
+    }
+    else
+    {
+      // The images keep their place and type, but lose their data
+      assertXPath(m_doc, "/document/page/drawGraphicObject[1]", "mime-type", "image/bmp");
+      assertXPathNoAttribute(m_doc, "/document/page/drawGraphicObject[1]", "binary-data");
+      assertXPath(m_doc, "/document/page/drawGraphicObject[20]", "mime-type", "image/bmp");
+      assertXPathNoAttribute(m_doc, "/document/page/drawGraphicObject[20]", "binary-data");
+    }
+  }
+}
+
+void ImportTest::testMasterCache()
+{
+  libvisio::VisioMasterCache cache(1024 * 1024);
+  std::string expected;
+  for (int i = 0; i < 3; ++i)
+  {
+    librevenge::RVNGFileStream input(TDOC "/color-boxes.vsdx");
+
+    xmlBufferEmpty(m_buffer);
+    xmlTextWriterPtr writer = xmlNewTextWriterMemory(m_buffer, 0);
+    CPPUNIT_ASSERT(writer);
+    libvisio::XmlDrawingGenerator painter(writer);
+    librevenge::RVNGPropertyList stats;
+    libvisio::VisioParseOptions options;
+    options.stats = &stats;
+    // The first parse is done without the cache, to compare with
+    if (i > 0)
+      options.masterCache = &cache;
+    CPPUNIT_ASSERT(libvisio::VisioDocument::parse(&input, &painter, options));
+    xmlFreeTextWriter(writer);
+
+    const std::string actual((const char *)xmlBufferContent(m_buffer), xmlBufferLength(m_buffer));
+    if (0 == i)
+    {
+      expected = actual;
+      CPPUNIT_ASSERT_EQUAL(0, stats["libvisio:master-cache-hits"]->getInt());
+    }
+    else
+    {
+      CPPUNIT_ASSERT_EQUAL(expected, actual);
+      if (1 == i)
+        CPPUNIT_ASSERT_EQUAL(0, stats["libvisio:master-cache-hits"]->getInt());
+      else
+        CPPUNIT_ASSERT(stats["libvisio:master-cache-hits"]->getInt() > 0);
+    }
+  }
+}
+
+void ImportTest::testMasterCacheFaceNames()
+{
+  // The documents differ only in the font that the master refers to by its index
+  libvisio::VisioMasterCache cache(1024 * 1024);
+  const char *const files[] = { TDOC "/facenames-1.vsdx", TDOC "/facenames-2.vsdx", TDOC "/facenames-1.vsdx" };
+  const char *const fonts[] = { "MasterFontOne", "MasterFontTwo", "MasterFontOne" };
+  for (int i = 0; i < 3; ++i)
+  {
+    librevenge::RVNGFileStream input(files[i]);
+
+    xmlBufferEmpty(m_buffer);
+    xmlTextWriterPtr writer = xmlNewTextWriterMemory(m_buffer, 0);
+    CPPUNIT_ASSERT(writer);
+    xmlTextWriterStartDocument(writer, 0, 0, 0);
+    libvisio::XmlDrawingGenerator painter(writer);
+    libvisio::VisioParseOptions options;
+    options.masterCache = &cache;
+    CPPUNIT_ASSERT(libvisio::VisioDocument::parse(&input, &painter, options));
+    xmlTextWriterEndDocument(writer);
+    xmlFreeTextWriter(writer);
+
+    xmlFreeDoc(m_doc);
+    m_doc = xmlParseMemory((const char *)xmlBufferContent(m_buffer), xmlBufferLength(m_buffer));
+    assertXPathContent(m_doc, "/document/page/textObject/paragraph/span/insertText", "Master text");
+    assertXPath(m_doc, "/document/page/textObject/paragraph/span", "font-name", fonts[i]);
+  }
+}
+
+void ImportTest::testParseOptionsOverloads()
+{
+  for (int i = 0; i < 2; ++i)
+  {
+    librevenge::RVNGFileStream input(TDOC "/color-boxes.vsdx");
+
+    xmlTextWriterPtr writer = xmlNewTextWriterMemory(m_buffer, 0);
+    CPPUNIT_ASSERT(writer);
+    libvisio::XmlDrawingGenerator painter(writer);
+    TestParseCallback callback(1);
+    libvisio::VisioParseOptions options;
+    options.callback = &callback;
+    if (0 == i)
+      CPPUNIT_ASSERT(!libvisio::VisioDocument::parsePage(&input, &painter, 0, options));
+    else
+      CPPUNIT_ASSERT(!libvisio::VisioDocument::parseText(&input, &painter, options));
+    xmlFreeTextWriter(writer);
+    CPPUNIT_ASSERT_EQUAL(1U, callback.m_calls);
+    CPPUNIT_ASSERT_EQUAL(0, xmlBufferLength(m_buffer));
+  }
+
+  librevenge::RVNGFileStream input(TDOC "/color-boxes.vsdx");
+  xmlTextWriterPtr writer = xmlNewTextWriterMemory(m_buffer, 0);
+  CPPUNIT_ASSERT(writer);
+  libvisio::XmlDrawingGenerator painter(writer);
+  librevenge::RVNGPropertyList stats;
+  libvisio::VisioParseOptions options;
+  options.stats = &stats;
+  CPPUNIT_ASSERT(libvisio::VisioDocument::parseText(&input, &painter, options));
+  xmlFreeTextWriter(writer);
+  CPPUNIT_ASSERT(stats["libvisio:xml-nodes"]->getInt() > 0);
+}
+
 CPPUNIT_TEST_SUITE_REGISTRATION(ImportTest);
 
 /* vim:set shiftwidth=2 softtabstop=2 expandtab: */
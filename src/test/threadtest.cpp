@@ -0,0 +1,127 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libvisio project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <librevenge-stream/librevenge-stream.h>
+#include <libvisio/libvisio.h>
+
+#include "xmldrawinggenerator.h"
+
+namespace
+{
+
+const char *const FILES[] =
+{
+  "Visio11FormatLine.vsd",
+  "Visio11TextFieldsWithCurrency.vsd",
+  "Visio11TextFieldsWithUnits.vsd",
+  "Visio5TextFieldsWithUnits.vsd",
+  "Visio6TextFieldsWithUnits.vsd",
+  "bgcolor.vsdx",
+  "bitmaps.vsd",
+  "bitmaps2.vsd",
+  "color-boxes.vsdx",
+  "dwg.vsd",
+  "dwg.vsdx",
+  "fdo86664.vsdx",
+  "fdo86729-ms1252.vsd",
+  "fdo86729-utf8.vsd",
+  "no-bgcolor.vsd",
+  "tdf76829-datetime-format.vsd",
+  "tdf76829-numeric-format.vsd"
+};
+
+const unsigned THREADS = 8;
+const unsigned ROUNDS = 3;
+
+/// Paints an XML representation of filename into output; returns false on failure.
+bool paint(const char *filename, std::string &output)
+{
+  std::string path(TDOC "/");
+  path.append(filename);
+  librevenge::RVNGFileStream input(path.c_str());
+
+  std::unique_ptr<xmlBuffer, void(*)(xmlBufferPtr)> buffer{xmlBufferCreate(), xmlBufferFree};
+  if (!buffer)
+    return false;
+  xmlTextWriterPtr writer = xmlNewTextWriterMemory(buffer.get(), 0);
+  if (!writer)
+    return false;
+  xmlTextWriterStartDocument(writer, 0, 0, 0);
+  bool parsed = false;
+  {
+    libvisio::XmlDrawingGenerator painter(writer);
+    parsed = libvisio::VisioDocument::parse(&input, &painter);
+  }
+  xmlTextWriterEndDocument(writer);
+  xmlFreeTextWriter(writer);
+
+  output.assign((const char *)xmlBufferContent(buffer.get()), size_t(xmlBufferLength(buffer.get())));
+  return parsed;
+}
+
+}
+
+class ThreadTest : public CPPUNIT_NS::TestFixture
+{
+  CPPUNIT_TEST_SUITE(ThreadTest);
+  CPPUNIT_TEST(testConcurrentParse);
+  CPPUNIT_TEST_SUITE_END();
+
+  void testConcurrentParse();
+};
+
+/* Parses the whole corpus from several threads at once, each starting at
+ * a different file, and compares the results with a sequential run. The
+ * threads go first, so that libxml2 is initialized by concurrent parses.
+ */
+void ThreadTest::testConcurrentParse()
+{
+  const size_t fileCount = sizeof(FILES) / sizeof(FILES[0]);
+  std::vector<std::vector<std::string> > outputs(THREADS, std::vector<std::string>(fileCount * ROUNDS));
+  std::atomic<unsigned> failures(0);
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < THREADS; ++t)
+  {
+    threads.push_back(std::thread([&outputs, &failures, fileCount, t]()
+    {
+      for (size_t i = 0; i < fileCount * ROUNDS; ++i)
+      {
+        if (!paint(FILES[(i + t) % fileCount], outputs[t][i]))
+          ++failures;
+      }
+    }));
+  }
+  for (auto &thread : threads)
+    thread.join();
+  CPPUNIT_ASSERT_EQUAL(0u, failures.load());
+
+  std::vector<std::string> expected(fileCount);
+  for (size_t i = 0; i < fileCount; ++i)
+    CPPUNIT_ASSERT_MESSAGE(FILES[i], paint(FILES[i], expected[i]));
+  for (unsigned t = 0; t < THREADS; ++t)
+  {
+    for (size_t i = 0; i < fileCount * ROUNDS; ++i)
+    {
+      const size_t file = (i + t) % fileCount;
+      CPPUNIT_ASSERT_MESSAGE(FILES[file], outputs[t][i] == expected[file]);
+    }
+  }
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ThreadTest);
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */